@@ -1,8 +1,9 @@
 #pragma once
-#include <cmath>
+#include "common/SmallVector.hpp"
+#include <algorithm>
+#include <bit>
 #include <cstddef>
 #include <cstdint>
-#include <math.h>
 #include <optional>
 #include <stdexcept>
 #include <string>
@@ -10,526 +11,715 @@
 
 namespace spark::common {
 
-template <class T = uint8_t> class BigInt {
+template <class T> struct BigIntWide;
+
+template <> struct BigIntWide<uint8_t> {
+  using type = uint16_t;
+};
+
+template <> struct BigIntWide<uint16_t> {
+  using type = uint32_t;
+};
+
+template <> struct BigIntWide<uint32_t> {
+  using type = uint64_t;
+};
+
+template <> struct BigIntWide<uint64_t> {
+  using type = unsigned __int128;
+};
+
+template <class T = uint64_t> class BigInt {
 private:
-  bool _negative;
-  std::vector<T> _data;
+  using Wide = typename BigIntWide<T>::type;
 
-public:
-  BigInt() : _negative(false), _data({0}) {}
+  static constexpr size_t BITS = sizeof(T) * 8;
 
-  BigInt(const BigInt &another)
-      : _data(another._data), _negative(another._negative) {}
+  static constexpr size_t INLINE_BITS = 128;
 
-  BigInt(BigInt &&another)
-      : _data(another._data), _negative(another._negative) {}
+  using Limbs = SmallVector<T, INLINE_BITS / BITS>;
 
-  BigInt(int64_t number) : _negative(number < 0) {
-    static uint64_t max = (uint64_t)((T)-1) + 1;
-    if (number < 0) {
-      number = -number;
+  static constexpr size_t KARATSUBA_THRESHOLD = 32;
+
+  static constexpr size_t DECIMAL_THRESHOLD = 32;
+
+  static constexpr T decimalBase() {
+    T base = 1;
+    for (size_t i = 0; i < decimalDigits(); i++) {
+      base *= 10;
     }
-    while (number > 0) {
-      _data.push_back((T)(number % max));
-      number >>= (sizeof(T) * 8);
+    return base;
+  }
+
+  static constexpr size_t decimalDigits() {
+    size_t digits = 0;
+    T max = (T)-1;
+    while (max >= 10) {
+      max /= 10;
+      digits++;
     }
-    if (_data.empty()) {
-      _data.push_back(0);
+    return digits;
+  }
+
+private:
+  bool _negative;
+  Limbs _data;
+
+private:
+  static void trim(Limbs &data) {
+    while (!data.empty() && data.back() == 0) {
+      data.pop_back();
     }
   }
 
-  BigInt(const std::wstring &source) : _negative(false), _data({0}) {
-    auto chr = source.c_str();
-    if (*chr == L'+') {
-      chr++;
-    } else if (*chr == L'-') {
-      _negative = true;
-      chr++;
+  static int compare(const Limbs &a, const Limbs &b) {
+    if (a.size() != b.size()) {
+      return a.size() < b.size() ? -1 : 1;
     }
-    while (*chr) {
-      if (*chr < '0' || *chr > '9') {
-        throw std::runtime_error("Cannot convert to a BigInt");
+    for (size_t index = a.size(); index-- > 0;) {
+      if (a[index] != b[index]) {
+        return a[index] < b[index] ? -1 : 1;
       }
-      *this *= 10;
-      *this += (uint64_t)(*chr - '0');
-      chr++;
-    }
-    while (*_data.rbegin() == 0) {
-      _data.pop_back();
-    }
-    if (_data.empty()) {
-      _data.push_back(0);
     }
+    return 0;
   }
 
-  std::wstring toString() const {
-    std::wstring result;
-    BigInt<> tmp = *this;
-    tmp._negative = 0;
-    if (tmp == 0) {
-      result += L"0";
-    } else {
-      while (tmp > 0) {
-        result += (tmp % 10)._data[0] + '0';
-        tmp /= 10;
+  static Limbs add(const Limbs &a, const Limbs &b) {
+    auto &longer = a.size() >= b.size() ? a : b;
+    auto &shorter = a.size() >= b.size() ? b : a;
+    Limbs result(longer.size() + 1);
+    T carry = 0;
+    for (size_t index = 0; index < longer.size(); index++) {
+      Wide sum = (Wide)longer[index] + carry;
+      if (index < shorter.size()) {
+        sum += shorter[index];
       }
+      result[index] = (T)sum;
+      carry = (T)(sum >> BITS);
     }
-    result = std::wstring(result.rbegin(), result.rend());
-    if (_negative) {
-      result = L"-" + result;
-    }
+    result[longer.size()] = carry;
+    trim(result);
     return result;
   }
 
-  std::optional<int64_t> toInt64() const {
-    if (_data.size() == 1) {
-      return _data[0];
+  static Limbs sub(const Limbs &a, const Limbs &b) {
+    Limbs result(a.size());
+    T borrow = 0;
+    for (size_t index = 0; index < a.size(); index++) {
+      T right = index < b.size() ? b[index] : 0;
+      T diff = a[index] - right;
+      T next = a[index] < right;
+      result[index] = diff - borrow;
+      borrow = next | (diff < borrow);
+    }
+    trim(result);
+    return result;
+  }
+
+  static void addTo(Limbs &target, const Limbs &value, size_t offset) {
+    if (target.size() < offset + value.size() + 1) {
+      target.resize(offset + value.size() + 1);
+    }
+    T carry = 0;
+    size_t index = 0;
+    for (; index < value.size(); index++) {
+      Wide sum = (Wide)target[offset + index] + value[index] + carry;
+      target[offset + index] = (T)sum;
+      carry = (T)(sum >> BITS);
+    }
+    for (; carry != 0; index++) {
+      if (offset + index == target.size()) {
+        target.push_back(0);
+      }
+      Wide sum = (Wide)target[offset + index] + carry;
+      target[offset + index] = (T)sum;
+      carry = (T)(sum >> BITS);
     }
-    return std::nullopt;
   }
 
-  BigInt abs() const {
-    BigInt result = *this;
-    result._negative = true;
+  static Limbs slice(const Limbs &data, size_t from, size_t to) {
+    from = std::min(from, data.size());
+    to = std::min(to, data.size());
+    Limbs result(data.begin() + from, data.begin() + to);
+    trim(result);
     return result;
   }
 
-  BigInt uadd(const BigInt &another) const {
-    static uint64_t max = (uint64_t)((T)-1) + 1;
-    size_t index = 0;
-    uint64_t next = 0;
-    BigInt result;
-    while (next != 0 || _data.size() > index || another._data.size() > index) {
-      uint64_t val = next;
-      if (index < _data.size()) {
-        val += _data[index];
-      }
-      if (index < another._data.size()) {
-        val += another._data[index];
-      }
-      if (index >= result._data.size()) {
-        result._data.push_back(0);
+  static Limbs schoolbook(const Limbs &a, const Limbs &b) {
+    Limbs result(a.size() + b.size());
+    for (size_t i = 0; i < a.size(); i++) {
+      T carry = 0;
+      for (size_t j = 0; j < b.size(); j++) {
+        Wide product = (Wide)a[i] * b[j] + result[i + j] + carry;
+        result[i + j] = (T)product;
+        carry = (T)(product >> BITS);
       }
-      result._data[index] = (T)(val % max);
-      next = val / max;
-      index++;
+      result[i + b.size()] = carry;
     }
+    trim(result);
     return result;
   }
 
-  BigInt usub(const BigInt &another) const {
-    BigInt left = abs();
-    BigInt right = another.abs();
-    BigInt *a = &left;
-    BigInt *b = &right;
-    bool neg = false;
-    if (left > right) {
-      a = &right;
-      b = &left;
-      neg = true;
+  static Limbs mul(const Limbs &a, const Limbs &b) {
+    if (a.empty() || b.empty()) {
+      return {};
     }
-    int64_t next = 0;
-    BigInt result;
-    result._data.clear();
-    for (size_t index = 0; index < a->_data.size(); index++) {
-      uint64_t pa = a->_data[index];
-      pa += next;
-      if (index < b->_data.size()) {
-        uint64_t pb = b->_data[index];
-        if (pa < pb) {
-          pa += 1 << sizeof(T) * 8;
-          next = -1;
-        }
-        result._data.push_back((T)(pa - pb));
-      } else {
-        result._data.push_back((T)pa);
-      }
+    if (a.size() < b.size()) {
+      return mul(b, a);
     }
-    while (result._data.size() > 1 && *result._data.rbegin() == 0) {
-      result._data.pop_back();
+    if (b.size() < KARATSUBA_THRESHOLD) {
+      return schoolbook(a, b);
     }
-    result._negative = neg;
+    auto half = a.size() / 2;
+    auto a0 = slice(a, 0, half);
+    auto a1 = slice(a, half, a.size());
+    if (b.size() <= half) {
+      auto result = mul(a0, b);
+      addTo(result, mul(a1, b), half);
+      trim(result);
+      return result;
+    }
+    auto b0 = slice(b, 0, half);
+    auto b1 = slice(b, half, b.size());
+    auto z0 = mul(a0, b0);
+    auto z2 = mul(a1, b1);
+    auto z1 = sub(sub(mul(add(a0, a1), add(b0, b1)), z0), z2);
+    auto result = z0;
+    addTo(result, z1, half);
+    addTo(result, z2, half * 2);
+    trim(result);
     return result;
   }
 
-  BigInt &operator=(const BigInt &another) {
-    if (this == &another) {
-      return *this;
+  static T divSmall(Limbs &data, T divisor) {
+    Wide rem = 0;
+    for (size_t index = data.size(); index-- > 0;) {
+      Wide cur = (rem << BITS) | data[index];
+      data[index] = (T)(cur / divisor);
+      rem = cur % divisor;
     }
-    _negative = another._negative;
-    _data = another._data;
-    return *this;
+    trim(data);
+    return (T)rem;
   }
 
-  BigInt operator+(const BigInt &another) const {
-    if (_negative == another._negative) {
-      BigInt result = uadd(another);
-      result._negative = _negative;
-      return result;
-    } else {
-      return *this - (-another);
+  static void mulAddSmall(Limbs &data, T factor, T addend) {
+    T carry = addend;
+    for (auto &limb : data) {
+      Wide product = (Wide)limb * factor + carry;
+      limb = (T)product;
+      carry = (T)(product >> BITS);
+    }
+    if (carry != 0) {
+      data.push_back(carry);
     }
   }
 
-  BigInt operator*(const BigInt &another) const {
+  static Limbs shiftLeft(const Limbs &data, size_t shift) {
+    if (data.empty()) {
+      return {};
+    }
+    auto limbs = shift / BITS;
+    auto bits = shift % BITS;
+    Limbs result(data.size() + limbs + 1);
+    for (size_t index = 0; index < data.size(); index++) {
+      result[index + limbs] |= (T)(data[index] << bits);
+      if (bits != 0) {
+        result[index + limbs + 1] = (T)(data[index] >> (BITS - bits));
+      }
+    }
+    trim(result);
+    return result;
+  }
 
-    static uint64_t max = (uint64_t)((T)-1) + 1;
-    BigInt result;
-    uint64_t rindex = 0;
-    for (auto &part : another._data) {
-      uint64_t next = 0;
-      for (size_t index = 0; index < _data.size(); index++) {
-        auto &src = _data[index];
-        if (index + rindex >= result._data.size()) {
-          result._data.push_back(0);
+  static Limbs shiftRight(const Limbs &data, size_t shift) {
+    auto limbs = shift / BITS;
+    auto bits = shift % BITS;
+    if (limbs >= data.size()) {
+      return {};
+    }
+    Limbs result(data.size() - limbs);
+    for (size_t index = 0; index < result.size(); index++) {
+      result[index] = (T)(data[index + limbs] >> bits);
+      if (bits != 0 && index + limbs + 1 < data.size()) {
+        result[index] |= (T)(data[index + limbs + 1] << (BITS - bits));
+      }
+    }
+    trim(result);
+    return result;
+  }
+
+  static void divMod(const Limbs &a, const Limbs &b, Limbs &quotient,
+                     Limbs &remainder) {
+    if (compare(a, b) < 0) {
+      quotient.clear();
+      remainder = a;
+      return;
+    }
+    if (b.size() == 1) {
+      quotient = a;
+      T rem = divSmall(quotient, b[0]);
+      remainder.clear();
+      if (rem != 0) {
+        remainder.push_back(rem);
+      }
+      return;
+    }
+    auto n = b.size();
+    auto m = a.size() - n;
+    auto shift = (size_t)std::countl_zero(b.back());
+    auto v = shiftLeft(b, shift);
+    auto u = shiftLeft(a, shift);
+    u.resize(a.size() + 1);
+    quotient.assign(m + 1, 0);
+    const Wide base = (Wide)1 << BITS;
+    for (size_t j = m + 1; j-- > 0;) {
+      Wide numerator = ((Wide)u[j + n] << BITS) | u[j + n - 1];
+      Wide qhat = numerator / v[n - 1];
+      Wide rhat = numerator % v[n - 1];
+      while (qhat >= base ||
+             qhat * v[n - 2] > ((rhat << BITS) | u[j + n - 2])) {
+        qhat--;
+        rhat += v[n - 1];
+        if (rhat >= base) {
+          break;
         }
-        auto val = part * src + next;
-        result._data[index + rindex] += (T)(val % max);
-        next = val / max;
       }
-      if (next > 0) {
-        result._data.push_back((T)(next));
+      T borrow = 0;
+      T carry = 0;
+      for (size_t i = 0; i < n; i++) {
+        Wide product = qhat * v[i] + carry;
+        carry = (T)(product >> BITS);
+        T low = (T)product;
+        T diff = u[i + j] - low;
+        T next = u[i + j] < low;
+        u[i + j] = diff - borrow;
+        borrow = next | (diff < borrow);
       }
-      rindex++;
+      T diff = u[j + n] - carry;
+      T next = u[j + n] < carry;
+      u[j + n] = diff - borrow;
+      borrow = next | (diff < borrow);
+      if (borrow) {
+        qhat--;
+        carry = 0;
+        for (size_t i = 0; i < n; i++) {
+          Wide sum = (Wide)u[i + j] + v[i] + carry;
+          u[i + j] = (T)sum;
+          carry = (T)(sum >> BITS);
+        }
+        u[j + n] += carry;
+      }
+      quotient[j] = (T)qhat;
     }
-    while (result._data.size() > 1 && *result._data.rbegin() == 0) {
-      result._data.pop_back();
+    trim(quotient);
+    u.resize(n);
+    trim(u);
+    remainder = shiftRight(u, shift);
+  }
+
+  static Limbs toTwos(const BigInt &value, size_t size) {
+    Limbs result = value._data;
+    result.resize(size);
+    if (value._negative) {
+      T carry = 1;
+      for (auto &limb : result) {
+        limb = ~limb;
+        Wide sum = (Wide)limb + carry;
+        limb = (T)sum;
+        carry = (T)(sum >> BITS);
+      }
     }
-    result._negative = _negative != another._negative;
     return result;
   }
 
-  BigInt operator-(const BigInt &another) const {
-    if (_negative == another._negative) {
-      BigInt result = usub(another);
-      if (_negative) {
-        result._negative = !result._negative;
+  static BigInt fromTwos(Limbs data) {
+    BigInt result;
+    result._negative = !data.empty() && (data.back() >> (BITS - 1)) != 0;
+    if (result._negative) {
+      T carry = 1;
+      for (auto &limb : data) {
+        limb = ~limb;
+        Wide sum = (Wide)limb + carry;
+        limb = (T)sum;
+        carry = (T)(sum >> BITS);
       }
-      return result;
-    } else {
-      return *this + (-another);
     }
+    trim(data);
+    result._data = std::move(data);
+    return result;
   }
 
-  BigInt operator/(const BigInt &another) const {
-    if (another == 0) {
-      throw std::runtime_error("Division by zero");
-    }
-    if (another > *this) {
-      return 0;
+  template <class F> static BigInt bitwise(const BigInt &a, const BigInt &b,
+                                           F &&op) {
+    auto size = std::max(a._data.size(), b._data.size()) + 1;
+    auto left = toTwos(a, size);
+    auto right = toTwos(b, size);
+    for (size_t index = 0; index < size; index++) {
+      left[index] = op(left[index], right[index]);
     }
-    if (another == *this) {
-      return 1;
-    }
-    size_t len = _data.size() - another._data.size();
-    BigInt next;
+    return fromTwos(std::move(left));
+  }
+
+  static BigInt fromLimbs(Limbs data, bool negative) {
     BigInt result;
-    std::vector<T> rdata;
-    for (auto index = 0; index <= len; index++) {
-      BigInt tmp;
-      tmp._data.clear();
-      std::vector<T> data;
-      for (auto i = 0; i < another._data.size(); i++) {
-        data.push_back(_data[_data.size() - 1 - index - i]);
-      }
-      for (auto it = data.rbegin(); it != data.rend(); it++) {
-        tmp._data.push_back(*it);
+    trim(data);
+    result._data = std::move(data);
+    result._negative = negative && !result._data.empty();
+    return result;
+  }
+
+  static Limbs parseDecimal(const wchar_t *begin, const wchar_t *end,
+                            std::vector<Limbs> &powers) {
+    auto length = (size_t)(end - begin);
+    auto digits = decimalDigits();
+    if (length <= digits * DECIMAL_THRESHOLD) {
+      Limbs result;
+      auto head = length % digits;
+      if (head == 0) {
+        head = digits;
       }
-      tmp += next * (int64_t)std::pow(2, sizeof(T) * 8);
-      T v = 0;
-      while (tmp >= another) {
-        tmp -= another;
-        v++;
+      for (auto chr = begin; chr < end;) {
+        T chunk = 0;
+        T scale = 1;
+        for (auto last = chr + head; chr < last; chr++) {
+          chunk = chunk * 10 + (T)(*chr - L'0');
+          scale *= 10;
+        }
+        mulAddSmall(result, scale, chunk);
+        trim(result);
+        head = digits;
       }
-      next = tmp;
-      rdata.push_back(v);
-    }
-    result._data.clear();
-    while (rdata.size() > 1 && *rdata.begin() == 0) {
-      rdata.erase(rdata.begin());
+      return result;
     }
-    for (auto it = rdata.rbegin(); it != rdata.rend(); it++) {
-      result._data.push_back(*it);
+    size_t level = 0;
+    while (digits << (level + 1) < length) {
+      level++;
     }
+    auto split = digits << level;
+    auto high = parseDecimal(begin, end - split, powers);
+    auto low = parseDecimal(end - split, end, powers);
+    auto result = mul(high, power(powers, level));
+    addTo(result, low, 0);
+    trim(result);
     return result;
   }
 
-  BigInt operator%(const BigInt &another) const {
-    if (another == 0) {
-      throw std::runtime_error("Division by zero");
+  static const Limbs &power(std::vector<Limbs> &powers, size_t level) {
+    if (powers.empty()) {
+      powers.push_back({decimalBase()});
     }
-    if (another > *this) {
-      return *this;
+    while (powers.size() <= level) {
+      powers.push_back(mul(powers.back(), powers.back()));
     }
-    if (another == *this) {
-      return 0;
-    }
-    size_t len = _data.size() - another._data.size();
-    BigInt next;
-    for (auto index = 0; index <= len; index++) {
-      BigInt tmp;
-      tmp._data.clear();
-      std::vector<T> data;
-      for (auto i = 0; i < another._data.size(); i++) {
-        data.push_back(_data[_data.size() - 1 - index - i]);
+    return powers[level];
+  }
+
+  static void formatDecimal(const Limbs &data, size_t width,
+                            std::vector<Limbs> &powers, std::wstring &output) {
+    auto digits = decimalDigits();
+    if (data.size() <= DECIMAL_THRESHOLD) {
+      Limbs tmp = data;
+      std::wstring chunk;
+      while (!tmp.empty()) {
+        T rem = divSmall(tmp, decimalBase());
+        for (size_t index = 0; index < digits; index++) {
+          chunk.push_back((wchar_t)(L'0' + rem % 10));
+          rem /= 10;
+        }
       }
-      for (auto it = data.rbegin(); it != data.rend(); it++) {
-        tmp._data.push_back(*it);
+      while (!chunk.empty() && chunk.back() == L'0') {
+        chunk.pop_back();
       }
-      tmp += next * (int64_t)(std::pow(2, sizeof(T) * 8));
-      while (tmp >= another) {
-        tmp -= another;
+      if (chunk.size() < width) {
+        chunk.append(width - chunk.size(), L'0');
       }
-      next = tmp;
-    }
-    next._negative = _negative;
-    return next;
+      output.append(chunk.rbegin(), chunk.rend());
+      return;
+    }
+    size_t level = 0;
+    while (power(powers, level + 1).size() * 2 <= data.size() + 1) {
+      level++;
+    }
+    Limbs high, low;
+    divMod(data, power(powers, level), high, low);
+    auto split = digits << level;
+    formatDecimal(high, width > split ? width - split : 0, powers, output);
+    formatDecimal(low, split, powers, output);
   }
 
-  BigInt operator+() const { return *this; }
+public:
+  BigInt() : _negative(false) {}
 
-  BigInt operator-() const {
-    BigInt result = *this;
-    result._negative = !result._negative;
-    return result;
-  }
+  BigInt(const BigInt &another) = default;
 
-  BigInt operator~() const {
-    BigInt result = *this;
-    result += 1;
-    result = -result;
-    return result;
-  }
-
-  bool operator>(const BigInt &another) const {
+  BigInt(BigInt &&another) = default;
 
-    if (!_negative && another._negative) {
-      return true;
-    } else if (_negative && !another._negative) {
-      return false;
-    }
-    if (_data.size() > another._data.size()) {
-      return !_negative;
-    } else if (_data.size() < another._data.size()) {
-      return _negative;
-    }
-    for (size_t index = 0; index < _data.size(); index++) {
-      if (_data[index] > another._data[index]) {
-        return !_negative;
-      } else if (_data[index] < another._data[index]) {
-        return _negative;
-      }
+  BigInt(int64_t number) : _negative(number < 0) {
+    uint64_t magnitude = number < 0 ? 0 - (uint64_t)number : (uint64_t)number;
+    while (magnitude != 0) {
+      _data.push_back((T)magnitude);
+      magnitude = BITS >= 64 ? 0 : magnitude >> (BITS % 64);
     }
-    return false;
   }
 
-  bool operator<(const BigInt &another) const {
-    if (!_negative && another._negative) {
-      return false;
-    } else if (_negative && !another._negative) {
-      return true;
-    }
-    if (_data.size() > another._data.size()) {
-      return _negative;
-    } else if (another._data.size() > _data.size()) {
-      return !_negative;
+  BigInt(const std::wstring &source) : _negative(false) {
+    auto chr = source.c_str();
+    auto end = chr + source.size();
+    bool negative = false;
+    if (chr != end && *chr == L'+') {
+      chr++;
+    } else if (chr != end && *chr == L'-') {
+      negative = true;
+      chr++;
     }
-    for (size_t index = 0; index < _data.size(); index++) {
-      if (_data[index] > another._data[index]) {
-        return _negative;
-      } else if (_data[index] < another._data[index]) {
-        return !_negative;
+    if (chr == end) {
+      throw std::runtime_error("Cannot convert to a BigInt");
+    }
+    uint32_t radix = 10;
+    if (end - chr > 2 && chr[0] == L'0') {
+      switch (chr[1]) {
+      case L'x':
+      case L'X':
+        radix = 16;
+        break;
+      case L'o':
+      case L'O':
+        radix = 8;
+        break;
+      case L'b':
+      case L'B':
+        radix = 2;
+        break;
+      }
+      if (radix != 10) {
+        chr += 2;
       }
     }
-    return false;
-  }
-
-  bool operator>=(const BigInt &another) const {
-    if (!_negative && another._negative) {
-      return true;
-    } else if (_negative && !another._negative) {
-      return false;
-    }
-    if (_data.size() > another._data.size()) {
-      return !_negative;
-    } else if (_data.size() < another._data.size()) {
-      return _negative;
-    }
-    for (size_t index = 0; index < _data.size(); index++) {
-      if (_data[index] > another._data[index]) {
-        return !_negative;
-      } else if (_data[index] < another._data[index]) {
-        return _negative;
+    for (auto it = chr; it != end; it++) {
+      auto digit = *it >= L'a'   ? *it - L'a' + 10
+                   : *it >= L'A' ? *it - L'A' + 10
+                   : *it >= L'0' && *it <= L'9' ? *it - L'0'
+                                                : 36;
+      if (digit >= (int)radix) {
+        throw std::runtime_error("Cannot convert to a BigInt");
       }
     }
-    return true;
-  }
-
-  bool operator<=(const BigInt &another) const {
-    if (!_negative && another._negative) {
-      return false;
-    } else if (_negative && !another._negative) {
-      return true;
-    }
-    if (_data.size() > another._data.size()) {
-      return _negative;
-    } else if (_data.size() < another._data.size()) {
-      return !_negative;
-    }
-    for (size_t index = 0; index < _data.size(); index++) {
-      if (_data[index] > another._data[index]) {
-        return _negative;
-      } else if (_data[index] < another._data[index]) {
-        return !_negative;
+    if (radix == 10) {
+      std::vector<Limbs> powers;
+      _data = parseDecimal(chr, end, powers);
+    } else {
+      auto bits = (size_t)std::countr_zero(radix);
+      size_t offset = 0;
+      for (auto it = end; it-- != chr; offset += bits) {
+        T digit = (T)(*it >= L'a'   ? *it - L'a' + 10
+                      : *it >= L'A' ? *it - L'A' + 10
+                                    : *it - L'0');
+        if (offset / BITS >= _data.size()) {
+          _data.push_back(0);
+        }
+        _data[offset / BITS] |= (T)(digit << (offset % BITS));
+        if (offset % BITS + bits > BITS) {
+          _data.push_back((T)(digit >> (BITS - offset % BITS)));
+        }
       }
+      trim(_data);
     }
-    return true;
+    _negative = negative && !_data.empty();
   }
 
-  bool operator==(const BigInt &another) const {
-    if (_negative != another._negative) {
-      return false;
-    }
-    if (_data.size() != another._data.size()) {
-      return false;
+  std::wstring toString() const {
+    if (_data.empty()) {
+      return L"0";
     }
-    for (size_t index = 0; index < _data.size(); index++) {
-      if (_data[index] != another._data[index]) {
-        return false;
-      }
+    std::wstring result;
+    if (_negative) {
+      result += L'-';
     }
-    return true;
+    std::vector<Limbs> powers;
+    formatDecimal(_data, 0, powers, result);
+    return result;
   }
 
-  bool operator!=(const BigInt &another) const {
-    if (_negative != another._negative) {
-      return true;
+  std::optional<int64_t> toInt64() const {
+    if (_data.size() * BITS > 64 && _data.size() > 1) {
+      return std::nullopt;
     }
-    if (_data.size() != another._data.size()) {
-      return true;
+    uint64_t magnitude = 0;
+    for (size_t index = _data.size(); index-- > 0;) {
+      magnitude = BITS >= 64 ? (uint64_t)_data[index]
+                             : (magnitude << (BITS % 64)) | _data[index];
     }
-    for (size_t index = 0; index < _data.size(); index++) {
-      if (_data[index] != another._data[index]) {
-        return true;
+    if (_negative) {
+      if (magnitude > (uint64_t)INT64_MAX + 1) {
+        return std::nullopt;
       }
+      return (int64_t)(0 - magnitude);
+    }
+    if (magnitude > (uint64_t)INT64_MAX) {
+      return std::nullopt;
     }
-    return false;
+    return (int64_t)magnitude;
   }
 
-  BigInt pow(const BigInt &another) {
-    BigInt result = 1;
-    for (BigInt i = 0; i < another; i += 1) {
-      result *= *this;
+  // the value modulo 2^64, as stored by BigUint64Array
+  uint64_t toUint64() const {
+    auto data = toTwos(*this, (64 + BITS - 1) / BITS);
+    uint64_t result = 0;
+    for (size_t index = data.size(); index-- > 0;) {
+      result = BITS >= 64 ? (uint64_t)data[index]
+                          : (result << (BITS % 64)) | data[index];
     }
     return result;
   }
 
-  BigInt operator<<(const BigInt &another) {
-    BigInt result = *this;
-    for (BigInt i = 0; i < another; i += 1) {
-      result *= 2;
+  static BigInt fromUint64(uint64_t number) {
+    Limbs data;
+    while (number != 0) {
+      data.push_back((T)number);
+      number = BITS >= 64 ? 0 : number >> (BITS % 64);
     }
-    return result;
+    return fromLimbs(std::move(data), false);
   }
 
-  BigInt operator>>(const BigInt &another) {
-    BigInt result = *this;
-    for (BigInt i = 0; i < another; i += 1) {
-      result /= 2;
+  BigInt abs() const { return fromLimbs(_data, false); }
+
+  BigInt &operator=(const BigInt &another) = default;
+
+  BigInt &operator=(BigInt &&another) = default;
+
+  BigInt operator+(const BigInt &another) const {
+    if (_negative == another._negative) {
+      return fromLimbs(add(_data, another._data), _negative);
     }
-    return result;
+    auto order = compare(_data, another._data);
+    if (order >= 0) {
+      return fromLimbs(sub(_data, another._data), _negative);
+    }
+    return fromLimbs(sub(another._data, _data), another._negative);
   }
 
-  BigInt operator&(const BigInt &another) {
-    BigInt result;
-    result._data.clear();
-    size_t index = 0;
-    BigInt a = *this;
-    BigInt b = another;
-    BigInt max;
-    max._data.clear();
-    while (a._data.size() > index || b._data.size() > index) {
-      max._data.push_back((T)-1);
-      index++;
-    }
-    if (a._negative) {
-      a = max + 1 + a;
-    }
-    if (b._negative) {
-      b = max + 1 + b;
-    }
-    index = 0;
-    while (a._data.size() > index || b._data.size() > index) {
-      T val1 = 0;
-      T val2 = 0;
-      if (index < a._data.size()) {
-        val1 = a._data[index];
-      }
-      if (index < b._data.size()) {
-        val2 = b._data[index];
-      }
-      result._data.push_back(val1 & val2);
-      index++;
+  BigInt operator-(const BigInt &another) const { return *this + (-another); }
+
+  BigInt operator*(const BigInt &another) const {
+    return fromLimbs(mul(_data, another._data),
+                     _negative != another._negative);
+  }
+
+  BigInt operator/(const BigInt &another) const {
+    if (another._data.empty()) {
+      throw std::runtime_error("Division by zero");
     }
-    while (!*result._data.rbegin()) {
-      result._data.pop_back();
+    Limbs quotient, remainder;
+    divMod(_data, another._data, quotient, remainder);
+    return fromLimbs(std::move(quotient), _negative != another._negative);
+  }
+
+  BigInt operator%(const BigInt &another) const {
+    if (another._data.empty()) {
+      throw std::runtime_error("Division by zero");
     }
-    if (result._data.empty()) {
-      result._data.push_back(0);
+    Limbs quotient, remainder;
+    divMod(_data, another._data, quotient, remainder);
+    return fromLimbs(std::move(remainder), _negative);
+  }
+
+  BigInt operator+() const { return *this; }
+
+  BigInt operator-() const { return fromLimbs(_data, !_negative); }
+
+  BigInt operator~() const { return -*this - 1; }
+
+  int compare(const BigInt &another) const {
+    if (_negative != another._negative) {
+      return _negative ? -1 : 1;
     }
-    if (_negative && another._negative) {
-      result = max + 1 - result;
+    auto order = compare(_data, another._data);
+    return _negative ? -order : order;
+  }
+
+  bool operator>(const BigInt &another) const { return compare(another) > 0; }
+
+  bool operator<(const BigInt &another) const { return compare(another) < 0; }
+
+  bool operator>=(const BigInt &another) const {
+    return compare(another) >= 0;
+  }
+
+  bool operator<=(const BigInt &another) const {
+    return compare(another) <= 0;
+  }
+
+  bool operator==(const BigInt &another) const {
+    return _negative == another._negative && _data == another._data;
+  }
+
+  bool operator!=(const BigInt &another) const { return !(*this == another); }
+
+  BigInt pow(const BigInt &another) const {
+    if (another._negative) {
+      throw std::runtime_error("Exponent must be non-negative");
+    }
+    BigInt result = 1;
+    BigInt base = *this;
+    for (size_t index = 0; index < another._data.size(); index++) {
+      auto limb = another._data[index];
+      for (size_t bit = 0; bit < BITS; bit++) {
+        if (limb & 1) {
+          result *= base;
+        }
+        limb >>= 1;
+        if (limb == 0 && index + 1 == another._data.size()) {
+          break;
+        }
+        base *= base;
+      }
     }
-    result._negative = _negative && another._negative;
     return result;
   }
 
-  BigInt operator|(const BigInt &another) {
-    BigInt result;
-    result._data.clear();
-    size_t index = 0;
-    BigInt a = *this;
-    BigInt b = another;
-    BigInt max;
-    max._data.clear();
-    while (a._data.size() > index || b._data.size() > index) {
-      max._data.push_back((T)-1);
-      index++;
-    }
-    if (a._negative) {
-      a = max + 1 + a;
-    }
-    if (b._negative) {
-      b = max + 1 + b;
-    }
-    index = 0;
-    while (a._data.size() > index || b._data.size() > index) {
-      T val1 = 0;
-      T val2 = 0;
-      if (index < a._data.size()) {
-        val1 = a._data[index];
-      }
-      if (index < b._data.size()) {
-        val2 = b._data[index];
+  BigInt operator<<(const BigInt &another) const {
+    if (another._negative) {
+      return *this >> -another;
+    }
+    auto shift = another.toInt64();
+    if (!shift.has_value()) {
+      if (_data.empty()) {
+        return *this;
       }
-      result._data.push_back(val1 | val2);
-      index++;
+      throw std::runtime_error("Maximum BigInt size exceeded");
     }
-    while (!*result._data.rbegin()) {
-      result._data.pop_back();
+    return fromLimbs(shiftLeft(_data, (size_t)shift.value()), _negative);
+  }
+
+  BigInt operator>>(const BigInt &another) const {
+    if (another._negative) {
+      return *this << -another;
     }
-    if (result._data.empty()) {
-      result._data.push_back(0);
+    auto shift = another.toInt64();
+    if (!_negative) {
+      if (!shift.has_value()) {
+        return BigInt();
+      }
+      return fromLimbs(shiftRight(_data, (size_t)shift.value()), false);
     }
-    if (_negative || another._negative) {
-      result = max + 1 - result;
+    if (!shift.has_value()) {
+      return BigInt(-1);
     }
-    result._negative = _negative || another._negative;
-    return result;
+    auto magnitude = sub(_data, {1});
+    return -fromLimbs(shiftRight(magnitude, (size_t)shift.value()), false) -
+           1;
+  }
+
+  BigInt operator&(const BigInt &another) const {
+    return bitwise(*this, another, [](T a, T b) -> T { return a & b; });
+  }
+
+  BigInt operator|(const BigInt &another) const {
+    return bitwise(*this, another, [](T a, T b) -> T { return a | b; });
   }
 
-  BigInt operator^(const BigInt &another) {
-    return (*this & ~another) | (~*this & another);
+  BigInt operator^(const BigInt &another) const {
+    return bitwise(*this, another, [](T a, T b) -> T { return a ^ b; });
   }
 
   BigInt &operator*=(const BigInt &another) { return *this = *this * another; }
@@ -542,4 +732,4 @@ public:
 
   BigInt &operator%=(const BigInt &another) { return *this = *this % another; }
 };
-} // namespace spark::common
\ No newline at end of file
+} // namespace spark::common
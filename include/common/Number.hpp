@@ -0,0 +1,23 @@
+#pragma once
+#include <cstdint>
+#include <string>
+
+namespace spark::common {
+class Number {
+public:
+  static constexpr uint32_t CACHE_SIZE = 1024;
+
+private:
+  static double parseRadix(const wchar_t *begin, const wchar_t *end,
+                           uint32_t radix);
+
+  static double parseDecimal(const wchar_t *begin, const wchar_t *end);
+
+public:
+  static bool isWhitespace(wchar_t chr);
+
+  static std::wstring toString(double value);
+
+  static double parse(const std::wstring &source);
+};
+} // namespace spark::common
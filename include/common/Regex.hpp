@@ -0,0 +1,189 @@
+#pragma once
+#include "common/Object.hpp"
+#include <bitset>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace spark::common {
+class Regex : public Object {
+public:
+  enum Flag {
+    ICASE = 1 << 0,
+    MULTILINE = 1 << 1,
+    DOTALL = 1 << 2,
+    UNICODE = 1 << 3,
+  };
+
+  struct Capture {
+    int64_t start;
+    int64_t end;
+  };
+
+private:
+  enum class Opcode : uint8_t {
+    CHAR,
+    ANY,
+    CLASS,
+    LINE_START,
+    LINE_END,
+    WORD_BOUNDARY,
+    NOT_WORD_BOUNDARY,
+    SPLIT,
+    JMP,
+    SAVE,
+    CLEAR,
+    MARK,
+    CHECK,
+    BACKREF,
+    LOOKAHEAD,
+    NEGATIVE_LOOKAHEAD,
+    LOOKBEHIND,
+    NEGATIVE_LOOKBEHIND,
+    MATCH,
+  };
+
+  struct Instruction {
+    Opcode opcode;
+    uint32_t a;
+    uint32_t b;
+    uint32_t c;
+  };
+
+  struct CharClass {
+    std::vector<std::pair<uint32_t, uint32_t>> ranges;
+    std::bitset<128> ascii;
+    bool negate;
+  };
+
+  enum class NodeType {
+    EMPTY,
+    CHAR,
+    ANY,
+    CLASS,
+    ASSERTION,
+    GROUP,
+    BACKREF,
+    LOOK,
+    ALTERNATIVE,
+    SEQUENCE,
+    REPEAT,
+  };
+
+  struct Node {
+    NodeType type;
+    uint32_t value;
+    uint32_t min;
+    uint32_t max;
+    bool greedy;
+    Opcode opcode;
+    std::vector<std::unique_ptr<Node>> children;
+  };
+
+  struct Frame {
+    uint32_t kind;
+    uint32_t index;
+    int64_t value;
+  };
+
+private:
+  std::wstring _source;
+  uint32_t _flags;
+  std::vector<Instruction> _program;
+  std::vector<CharClass> _classes;
+  std::vector<std::wstring> _names;
+  uint32_t _groups;
+  uint32_t _registers;
+  uint32_t _splits;
+  uint32_t _marks;
+  bool _memoizable;
+  bool _nullable;
+  bool _anchored;
+  std::wstring _prefix;
+  std::bitset<128> _first;
+  bool _firstAny;
+
+  size_t _index;
+  uint32_t _capture;
+
+private:
+  static bool isLineTerminator(uint32_t chr);
+
+  static bool isWordChar(uint32_t chr);
+
+  static uint32_t canonicalize(uint32_t chr);
+
+  static void addRanges(CharClass &cls, uint32_t kind);
+
+  static std::vector<std::pair<uint32_t, uint32_t>>
+  complement(const std::vector<std::pair<uint32_t, uint32_t>> &ranges);
+
+  [[noreturn]] void error(const std::wstring &message) const;
+
+  bool isEnd() const;
+
+  uint32_t peek() const;
+
+  void scanGroups();
+
+  std::unique_ptr<Node> createNode(NodeType type, uint32_t value = 0);
+
+  std::unique_ptr<Node> parseDisjunction();
+
+  std::unique_ptr<Node> parseAlternative();
+
+  std::unique_ptr<Node> parseTerm();
+
+  std::unique_ptr<Node> parseGroup();
+
+  std::unique_ptr<Node> parseAtomEscape();
+
+  std::unique_ptr<Node> parseClass();
+
+  uint32_t parseOctal();
+
+  uint32_t parseClassAtom(CharClass &cls, bool &isClass);
+
+  uint32_t parseCharacterEscape();
+
+  bool parseQuantifier(uint32_t &min, uint32_t &max);
+
+  bool parseHex(size_t length, uint32_t &value);
+
+  static bool isNullable(const Node *node);
+
+  static void getGroups(const Node *node, uint32_t &first, uint32_t &last);
+
+  bool computeFirst(const Node *node);
+
+  uint32_t emit(Opcode opcode, uint32_t a = 0, uint32_t b = 0);
+
+  void compile(const Node *node);
+
+  void compileRepeat(const Node *node);
+
+  bool matchClass(const CharClass &cls, uint32_t chr) const;
+
+  bool canStart(uint32_t chr) const;
+
+  bool execute(const std::wstring &input, size_t start, uint32_t pc,
+               int64_t end, std::vector<int64_t> &slots,
+               std::vector<int64_t> &registers,
+               std::vector<uint64_t> *memo) const;
+
+public:
+  Regex(const std::wstring &source, uint32_t flags = 0);
+
+  const std::wstring &getSource() const;
+
+  uint32_t getFlags() const;
+
+  uint32_t getGroupCount() const;
+
+  const std::vector<std::wstring> &getGroupNames() const;
+
+  bool match(const std::wstring &input, size_t lastIndex, bool sticky,
+             std::vector<Capture> &captures) const;
+};
+} // namespace spark::common
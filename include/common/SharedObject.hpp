@@ -0,0 +1,24 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace spark::common {
+// Object with an atomic reference count, for immutable data that isolates
+// on different threads hold at the same time.
+class SharedObject {
+private:
+  std::atomic<uint32_t> _ref;
+
+public:
+  inline uint32_t addRef() { return ++_ref; }
+
+  inline uint32_t subRef() { return --_ref; }
+
+  inline uint32_t ref() const { return _ref; }
+
+  SharedObject() : _ref(0){};
+
+  virtual ~SharedObject() = default;
+};
+} // namespace spark::common
@@ -0,0 +1,152 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <type_traits>
+
+namespace spark::common {
+template <class T, size_t N> class SmallVector {
+  static_assert(std::is_trivially_copyable_v<T>);
+
+private:
+  T *_data;
+  size_t _size;
+  size_t _capacity;
+  T _inline[N];
+
+private:
+  bool isInline() const { return _data == _inline; }
+
+  void grow(size_t capacity) {
+    if (capacity <= _capacity) {
+      return;
+    }
+    capacity = std::max(capacity, _capacity * 2);
+    auto data = new T[capacity];
+    std::memcpy(data, _data, _size * sizeof(T));
+    if (!isInline()) {
+      delete[] _data;
+    }
+    _data = data;
+    _capacity = capacity;
+  }
+
+  void copy(const SmallVector &another) {
+    _size = 0;
+    grow(another._size);
+    std::memcpy(_data, another._data, another._size * sizeof(T));
+    _size = another._size;
+  }
+
+  void take(SmallVector &&another) {
+    if (another.isInline()) {
+      copy(another);
+      return;
+    }
+    if (!isInline()) {
+      delete[] _data;
+    }
+    _data = another._data;
+    _size = another._size;
+    _capacity = another._capacity;
+    another._data = another._inline;
+    another._size = 0;
+    another._capacity = N;
+  }
+
+public:
+  SmallVector() : _data(_inline), _size(0), _capacity(N) {}
+
+  SmallVector(size_t size, const T &value = T())
+      : _data(_inline), _size(0), _capacity(N) {
+    assign(size, value);
+  }
+
+  SmallVector(std::initializer_list<T> items)
+      : SmallVector(items.begin(), items.end()) {}
+
+  SmallVector(const T *first, const T *last)
+      : _data(_inline), _size(0), _capacity(N) {
+    grow(last - first);
+    std::memcpy(_data, first, (last - first) * sizeof(T));
+    _size = last - first;
+  }
+
+  SmallVector(const SmallVector &another)
+      : _data(_inline), _size(0), _capacity(N) {
+    copy(another);
+  }
+
+  SmallVector(SmallVector &&another) : _data(_inline), _size(0), _capacity(N) {
+    take(std::move(another));
+  }
+
+  ~SmallVector() {
+    if (!isInline()) {
+      delete[] _data;
+    }
+  }
+
+  SmallVector &operator=(const SmallVector &another) {
+    if (this != &another) {
+      copy(another);
+    }
+    return *this;
+  }
+
+  SmallVector &operator=(SmallVector &&another) {
+    if (this != &another) {
+      take(std::move(another));
+    }
+    return *this;
+  }
+
+  bool operator==(const SmallVector &another) const {
+    return _size == another._size &&
+           std::equal(_data, _data + _size, another._data);
+  }
+
+  T &operator[](size_t index) { return _data[index]; }
+
+  const T &operator[](size_t index) const { return _data[index]; }
+
+  T *begin() { return _data; }
+
+  T *end() { return _data + _size; }
+
+  const T *begin() const { return _data; }
+
+  const T *end() const { return _data + _size; }
+
+  T &back() { return _data[_size - 1]; }
+
+  const T &back() const { return _data[_size - 1]; }
+
+  size_t size() const { return _size; }
+
+  bool empty() const { return _size == 0; }
+
+  void clear() { _size = 0; }
+
+  void push_back(const T &value) {
+    if (_size == _capacity) {
+      grow(_size + 1);
+    }
+    _data[_size++] = value;
+  }
+
+  void pop_back() { _size--; }
+
+  void resize(size_t size, const T &value = T()) {
+    grow(size);
+    std::fill(_data + std::min(_size, size), _data + size, value);
+    _size = size;
+  }
+
+  void assign(size_t size, const T &value) {
+    _size = 0;
+    resize(size, value);
+  }
+};
+} // namespace spark::common
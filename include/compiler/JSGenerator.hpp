@@ -25,9 +25,15 @@ private:
     engine::JSEvalType evalType;
     engine::JSEvalType lexContextType;
     double currentClass;
+    bool loopBody;
+    const JSNode *discard;
+    bool discarded;
     JSGeneratorContext() {
       currentScope = nullptr;
       scopeChain = 0;
+      loopBody = false;
+      discard = nullptr;
+      discarded = false;
     }
     ~JSGeneratorContext() {
       while (currentScope) {
@@ -58,6 +64,9 @@ private:
   uint32_t resolveConstant(common::AutoPtr<JSModule> &module,
                            const std::wstring &source);
 
+  uint32_t resolveBigIntConstant(common::AutoPtr<JSModule> &module,
+                                 const std::wstring &source);
+
   void resolveExport(JSGeneratorContext &ctx, common::AutoPtr<JSModule> &module,
                      common::AutoPtr<JSNode> node);
 
@@ -66,8 +75,9 @@ private:
 
   void popLexScope(JSGeneratorContext &ctx, common::AutoPtr<JSModule> &module);
 
-  void pushScope(JSGeneratorContext &ctx, common::AutoPtr<JSModule> &module,
-                 const common::AutoPtr<JSSourceScope> &scope);
+  bool pushScope(JSGeneratorContext &ctx, common::AutoPtr<JSModule> &module,
+                 const common::AutoPtr<JSSourceScope> &scope,
+                 bool force = false);
 
   void popScope(JSGeneratorContext &ctx, common::AutoPtr<JSModule> &module);
 
@@ -427,7 +437,7 @@ private:
   void generate(common::AutoPtr<JSModule> &module, const vm::JSAsmOperator &opt,
                 const std::wstring &a, const std::wstring &b) {
     auto size = module->codes.size();
-    module->codes.resize(size + 6);
+    module->codes.resize(size + 10);
     auto buffer = module->codes.data() + size;
     uint16_t code = (uint16_t)opt;
     *(uint16_t *)buffer = code;
@@ -0,0 +1,59 @@
+#pragma once
+#include "base/JSModule.hpp"
+#include "common/AutoPtr.hpp"
+#include "common/Object.hpp"
+#include "vm/JSAsmOperator.hpp"
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace spark::compiler {
+class JSOptimizer : public common::Object {
+private:
+  struct JSInstruction {
+    uint32_t offset;
+    vm::JSAsmOperator opt;
+    uint64_t arg;
+    bool removed;
+  };
+
+private:
+  static size_t getArgumentSize(const vm::JSAsmOperator &opt);
+
+  static bool isAddress(const vm::JSAsmOperator &opt);
+
+  static bool isTerminator(const vm::JSAsmOperator &opt);
+
+  static bool isConstant(const vm::JSAsmOperator &opt);
+
+  static size_t next(const std::vector<JSInstruction> &instructions,
+                     size_t index);
+
+  static double getNumber(const JSInstruction &instruction);
+
+  static void setNumber(JSInstruction &instruction, double value);
+
+  std::vector<JSInstruction> decode(const common::AutoPtr<JSModule> &module);
+
+  void encode(common::AutoPtr<JSModule> &module,
+              const std::vector<JSInstruction> &instructions);
+
+  std::set<uint32_t> resolveLabels(common::AutoPtr<JSModule> &module,
+                                   std::vector<JSInstruction> &instructions,
+                                   uint32_t end);
+
+  bool foldConstant(std::vector<JSInstruction> &instructions,
+                    const std::set<uint32_t> &labels);
+
+  bool threadJump(std::vector<JSInstruction> &instructions, uint32_t end);
+
+  bool removeDeadCode(std::vector<JSInstruction> &instructions,
+                      const std::set<uint32_t> &labels);
+
+  bool peephole(std::vector<JSInstruction> &instructions,
+                const std::set<uint32_t> &labels);
+
+public:
+  void optimize(common::AutoPtr<JSModule> &module);
+};
+} // namespace spark::compiler
@@ -1,14 +1,30 @@
 #pragma once
 #include "JSNode.hpp"
-#include "common/Object.hpp"
+#include "common/BigInt.hpp"
+#include "common/SharedObject.hpp"
 #include <string>
 #include <unordered_map>
 #include <vector>
 namespace spark::compiler {
-struct JSModule : public common::Object {
+// Covers the instructions in [begin, end). handle and defer are the catch
+// and finally addresses, 0 when absent; depth counts the scopes pushed
+// since the start of the enclosing function.
+struct JSExceptionHandler {
+  uint32_t begin;
+  uint32_t end;
+  uint32_t handle;
+  uint32_t defer;
+  uint32_t depth;
+};
+
+struct JSModule : public common::SharedObject {
   std::wstring filename;
   std::unordered_map<uint32_t, JSSourceLocation::Position> sourceMap;
   std::vector<std::wstring> constants;
+  std::unordered_map<std::wstring, uint32_t> constantIndices;
+  std::vector<common::BigInt<>> bigints;
+  std::unordered_map<std::wstring, uint32_t> bigintIndices;
   std::vector<std::uint8_t> codes;
+  std::vector<JSExceptionHandler> handlers;
 };
 } // namespace spark::compiler
\ No newline at end of file
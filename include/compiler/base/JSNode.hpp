@@ -2,6 +2,7 @@
 #include "JSNodeType.hpp"
 #include "common/AutoPtr.hpp"
 #include "common/Object.hpp"
+#include <atomic>
 #include <string>
 #include <vector>
 
@@ -64,7 +65,7 @@ struct JSSourceScope : public common::Object {
   uint32_t id;
   JSSourceScope *parent;
   JSSourceScope(JSSourceScope *parent = nullptr) : parent(parent) {
-    static uint32_t id = 0;
+    static std::atomic<uint32_t> id = 0;
     this->id = ++id;
     if (parent) {
       parent->children.push_back(this);
@@ -86,7 +87,7 @@ struct JSNode : public common::Object {
   }
   JSNode(const JSNodeType &type, int32_t level = 0)
       : type(type), level(level), parent(nullptr) {
-    static uint32_t id = 0;
+    static std::atomic<uint32_t> id = 0;
     this->id = ++id;
   }
 };
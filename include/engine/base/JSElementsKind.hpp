@@ -0,0 +1,4 @@
+#pragma once
+namespace spark::engine {
+enum class JSElementsKind { PACKED_SMI = 0, PACKED_DOUBLE, PACKED, HOLEY };
+}
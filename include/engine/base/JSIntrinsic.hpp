@@ -0,0 +1,37 @@
+#pragma once
+namespace spark::engine {
+enum class JSIntrinsic {
+  SYMBOL_ASYNC_ITERATOR = 0,
+  SYMBOL_HAS_INSTANCE,
+  SYMBOL_IS_CONCAT_SPREADABLE,
+  SYMBOL_ITERATOR,
+  SYMBOL_MATCH,
+  SYMBOL_REPLACE,
+  SYMBOL_SEARCH,
+  SYMBOL_SPECIES,
+  SYMBOL_SPLIT,
+  SYMBOL_TO_PRIMITIVE,
+  SYMBOL_TO_STRING_TAG,
+  SYMBOL_UNSCOPABLES,
+  INTERNAL_VALUE,
+  INTERNAL_PACK,
+  INTERNAL_IDENTIFY,
+  INTERNAL_REGEX_VALUE,
+  INTERNAL_REGEX_FLAG,
+  INTERNAL_LAST_INDEX,
+  SYMBOL_REGISTRY,
+  OBJECT_PROTOTYPE,
+  FUNCTION_PROTOTYPE,
+  ASYNC_FUNCTION_PROTOTYPE,
+  GENERATOR_FUNCTION_PROTOTYPE,
+  SYMBOL_PROTOTYPE,
+  ARRAY_PROTOTYPE,
+  ITERATOR_PROTOTYPE,
+  ASYNC_ITERATOR_PROTOTYPE,
+  ERROR_PROTOTYPE,
+  PROMISE_PROTOTYPE,
+  PROMISE_THEN,
+  ARRAY_VALUES,
+  COUNT
+};
+}
@@ -1,4 +1,5 @@
 #pragma once
+#include "engine/base/JSElementsKind.hpp"
 #include "engine/entity/JSObjectEntity.hpp"
 #include <vector>
 namespace spark::engine {
@@ -6,11 +7,19 @@ class JSArrayEntity : public JSObjectEntity {
 private:
   std::vector<JSStore *> _items;
 
+  JSElementsKind _kind;
+
 public:
   JSArrayEntity(JSStore *prototype);
 
   const std::vector<JSStore *> &getItems() const;
 
   std::vector<JSStore *> &getItems();
+
+  JSElementsKind getKind() const;
+
+  bool isPacked() const;
+
+  void transition(JSElementsKind kind);
 };
-}; // namespace spark::engine
\ No newline at end of file
+}; // namespace spark::engine
@@ -3,6 +3,7 @@
 #include "common/Object.hpp"
 #include "engine/base/JSValueType.hpp"
 #include <any>
+#include <cstddef>
 #include <optional>
 #include <string>
 
@@ -36,9 +37,11 @@ public:
   template <class T> T &getOpaque() { return std::any_cast<T &>(_opaque); }
 
   template <class T> const bool hasOpaque() const {
-    return _opaque.type() != typeid(nullptr);
+    return _opaque.type() == typeid(T);
   }
 
+  bool hasOpaque() const { return _opaque.type() != typeid(std::nullptr_t); }
+
   virtual std::wstring toString(common::AutoPtr<JSContext> ctx) const;
 
   virtual std::optional<double> toNumber(common::AutoPtr<JSContext> ctx) const;
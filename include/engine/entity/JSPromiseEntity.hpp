@@ -11,20 +11,29 @@ public:
     REJECTED,
   };
 
+  enum class ReactionKind {
+    THEN,
+    FINALLY,
+    AWAIT,
+  };
+
+  struct Reaction {
+    ReactionKind kind;
+    JSStore *onFulfilled;
+    JSStore *onRejected;
+    JSStore *target;
+  };
+
 private:
   Status _status;
   JSStore *_value;
-  std::vector<JSStore *> _fulfilledCallbacks;
-  std::vector<JSStore *> _rejectedCallbacks;
-  std::vector<JSStore *> _finallyCallbacks;
+  std::vector<Reaction> _reactions;
 
 public:
   JSPromiseEntity(JSStore *prototype);
   JSStore *getValue();
   void setValue(JSStore *value);
   Status &getStatus();
-  std::vector<JSStore *> &getFulfilledCallbacks();
-  std::vector<JSStore *> &getRejectedCallbacks();
-  std::vector<JSStore *> &getFinallyCallbacks();
+  std::vector<Reaction> &getReactions();
 };
 } // namespace spark::engine
\ No newline at end of file
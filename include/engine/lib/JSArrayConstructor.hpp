@@ -21,8 +21,26 @@ private:
   static JS_FUNC(join);
   static JS_FUNC(values);
   static JS_FUNC(push);
+  static JS_FUNC(pop);
+  static JS_FUNC(shift);
+  static JS_FUNC(unshift);
+  static JS_FUNC(splice);
+  static JS_FUNC(slice);
+  static JS_FUNC(concat);
+  static JS_FUNC(reverse);
+  static JS_FUNC(sort);
+  static JS_FUNC(fill);
+  static JS_FUNC(at);
+  static JS_FUNC(indexOf);
+  static JS_FUNC(lastIndexOf);
+  static JS_FUNC(includes);
   static JS_FUNC(forEach);
   static JS_FUNC(map);
+  static JS_FUNC(filter);
+  static JS_FUNC(every);
+  static JS_FUNC(some);
+  template <bool REVERSE, bool INDEX> static JS_FUNC(find);
+  template <bool REVERSE> static JS_FUNC(reduce);
   static JS_FUNC(iterator_next);
 
 public:
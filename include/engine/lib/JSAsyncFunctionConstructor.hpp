@@ -4,6 +4,10 @@ namespace spark::engine {
 class JSAsyncFunctionConstructor {
 
 public:
+  static common::AutoPtr<JSValue> resume(common::AutoPtr<JSContext> ctx,
+                                         common::AutoPtr<JSValue> frame,
+                                         common::AutoPtr<JSValue> value);
+
   static JS_FUNC(constructor);
   static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
 };
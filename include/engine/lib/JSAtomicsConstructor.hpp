@@ -0,0 +1,22 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSAtomicsConstructor {
+private:
+  static JS_FUNC(load);
+  static JS_FUNC(store);
+  static JS_FUNC(add);
+  static JS_FUNC(sub);
+  static JS_FUNC(and_);
+  static JS_FUNC(or_);
+  static JS_FUNC(xor_);
+  static JS_FUNC(exchange);
+  static JS_FUNC(compareExchange);
+  static JS_FUNC(wait);
+  static JS_FUNC(notify);
+  static JS_FUNC(toStringTag);
+
+public:
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
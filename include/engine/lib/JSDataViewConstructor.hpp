@@ -0,0 +1,19 @@
+#pragma once
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSDataViewConstructor {
+private:
+  template <JSTypedArray::Type TYPE> static JS_FUNC(get);
+  template <JSTypedArray::Type TYPE> static JS_FUNC(set);
+
+  static JS_FUNC(getBuffer);
+  static JS_FUNC(getByteLength);
+  static JS_FUNC(getByteOffset);
+  static JS_FUNC(toStringTag);
+
+public:
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
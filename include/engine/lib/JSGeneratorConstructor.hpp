@@ -2,6 +2,7 @@
 #include "common/AutoPtr.hpp"
 #include "engine/base/JSValueType.hpp"
 #include "engine/runtime/JSValue.hpp"
+#include "vm/JSCoroutineContext.hpp"
 namespace spark::engine {
 class JSGeneratorConstructor {
 private:
@@ -10,6 +11,10 @@ private:
   static JS_FUNC(throw_);
 
 public:
+  static common::AutoPtr<JSValue> resume(common::AutoPtr<JSContext> ctx,
+                                         vm::JSCoroutineContext &co,
+                                         common::AutoPtr<JSValue> value);
+
   static JS_FUNC(constructor);
   static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
 };
@@ -0,0 +1,13 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSJSONConstructor {
+private:
+  static JS_FUNC(parse);
+  static JS_FUNC(stringify);
+  static JS_FUNC(toStringTag);
+
+public:
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
@@ -10,6 +10,21 @@ private:
   static JS_FUNC(reject);
 
 public:
+  static common::AutoPtr<JSValue> createPromise(common::AutoPtr<JSContext> ctx);
+
+  static common::AutoPtr<JSValue>
+  resolvePromise(common::AutoPtr<JSContext> ctx,
+                 common::AutoPtr<JSValue> promise,
+                 common::AutoPtr<JSValue> value);
+
+  static void rejectPromise(common::AutoPtr<JSContext> ctx,
+                            common::AutoPtr<JSValue> promise,
+                            common::AutoPtr<JSValue> value);
+
+  static void await(common::AutoPtr<JSContext> ctx,
+                    common::AutoPtr<JSValue> value,
+                    common::AutoPtr<JSValue> frame);
+
   static JS_FUNC(constructor);
   static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
 };
@@ -1,8 +1,12 @@
 #pragma once
+#include "common/Regex.hpp"
 #include "engine/runtime/JSContext.hpp"
 namespace spark::engine {
 class JSRegexConstructor {
 private:
+  static common::AutoPtr<common::Regex>
+  getRegex(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self);
+
   static JS_FUNC(test);
   static JS_FUNC(exec);
   static JS_FUNC(getDotAll);
@@ -0,0 +1,23 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSSetConstructor {
+private:
+  static JS_FUNC(add);
+  static JS_FUNC(has);
+  static JS_FUNC(remove);
+  static JS_FUNC(clear);
+  static JS_FUNC(forEach);
+  static JS_FUNC(values);
+  static JS_FUNC(entries);
+  static JS_FUNC(getSize);
+  static JS_FUNC(toStringTag);
+  static JS_FUNC(iterator_next);
+
+public:
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+  static common::AutoPtr<JSValue>
+  initializeIterator(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
@@ -0,0 +1,14 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSSharedArrayBufferConstructor {
+private:
+  static JS_FUNC(getByteLength);
+  static JS_FUNC(slice);
+  static JS_FUNC(toStringTag);
+
+public:
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
@@ -9,11 +9,6 @@
 #include <unordered_map>
 namespace spark::engine {
 class JSSymbolConstructor {
-private:
-  struct JSSymbolOpaque : public common::Object {
-    std::unordered_map<std::wstring, JSStore *> symbols;
-  };
-
 private:
   static JS_FUNC(toPrimitive);
   static JS_FUNC(toString);
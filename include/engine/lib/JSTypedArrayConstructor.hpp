@@ -0,0 +1,37 @@
+#pragma once
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSTypedArrayConstructor {
+private:
+  static common::AutoPtr<JSValue>
+  create(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self,
+         JSTypedArray::Type type,
+         const std::vector<common::AutoPtr<JSValue>> &args);
+
+  template <JSTypedArray::Type TYPE> static JS_FUNC(construct) {
+    return create(ctx, self, TYPE, args);
+  }
+
+  template <JSTypedArray::Type TYPE>
+  static void initializeType(common::AutoPtr<JSContext> ctx,
+                             common::AutoPtr<JSValue> prototype);
+
+  static JS_FUNC(getBuffer);
+  static JS_FUNC(getByteLength);
+  static JS_FUNC(getByteOffset);
+  static JS_FUNC(getLength);
+  static JS_FUNC(toStringTag);
+  static JS_FUNC(at);
+  static JS_FUNC(fill);
+  static JS_FUNC(includes);
+  static JS_FUNC(indexOf);
+  static JS_FUNC(set);
+  static JS_FUNC(slice);
+  static JS_FUNC(subarray);
+
+public:
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
@@ -0,0 +1,16 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSWeakMapConstructor {
+private:
+  static JS_FUNC(get);
+  static JS_FUNC(set);
+  static JS_FUNC(has);
+  static JS_FUNC(remove);
+  static JS_FUNC(toStringTag);
+
+public:
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
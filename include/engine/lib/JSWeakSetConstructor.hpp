@@ -0,0 +1,15 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSWeakSetConstructor {
+private:
+  static JS_FUNC(add);
+  static JS_FUNC(has);
+  static JS_FUNC(remove);
+  static JS_FUNC(toStringTag);
+
+public:
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
@@ -0,0 +1,29 @@
+#pragma once
+#include "engine/runtime/JSContext.hpp"
+namespace spark::engine {
+class JSWorkerConstructor {
+private:
+  static JS_FUNC(postMessage);
+  static JS_FUNC(terminate);
+  static JS_FUNC(toStringTag);
+  static JS_FUNC(postToParent);
+  static JS_FUNC(close);
+
+public:
+  static common::AutoPtr<JSValue> onMessage(common::AutoPtr<JSContext> ctx,
+                                            common::AutoPtr<JSValue> target,
+                                            common::AutoPtr<JSValue> handler,
+                                            common::AutoPtr<JSValue> data);
+
+  static common::AutoPtr<JSValue> onError(common::AutoPtr<JSContext> ctx,
+                                          common::AutoPtr<JSValue> target,
+                                          common::AutoPtr<JSValue> handler,
+                                          common::AutoPtr<JSValue> message);
+
+  static JS_FUNC(constructor);
+  static common::AutoPtr<JSValue> initialize(common::AutoPtr<JSContext> ctx);
+
+  // globals of a context that runs inside a worker
+  static void initializeWorker(common::AutoPtr<JSContext> ctx);
+};
+}; // namespace spark::engine
@@ -0,0 +1,150 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "common/SharedObject.hpp"
+#include "engine/runtime/JSStore.hpp"
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace spark::engine {
+class JSContext;
+class JSValue;
+
+// Zero initialized, 16 byte aligned backing store of an ArrayBuffer. Typed
+// arrays and data views hold a reference to it and access the bytes in
+// place, so views created by subarray never copy. The reference count is
+// atomic: a shared buffer is held by the contexts of several workers at once.
+class JSArrayBuffer : public common::SharedObject {
+public:
+  static constexpr size_t ALIGNMENT = 16;
+
+  enum class WaitResult { OK, NOT_EQUAL, TIMED_OUT };
+
+private:
+  struct JSWaiter {
+    size_t offset;
+    bool notified;
+  };
+
+  struct JSWaitList {
+    std::mutex mutex;
+    std::condition_variable condition;
+    std::list<JSWaiter *> waiters;
+  };
+
+  uint8_t *_data;
+  size_t _length;
+  bool _shared;
+  bool _detached;
+  // agents blocked in Atomics.wait, only shared buffers have one
+  std::unique_ptr<JSWaitList> _waitList;
+
+public:
+  JSArrayBuffer(size_t length, bool shared = false);
+
+  ~JSArrayBuffer() override;
+
+  static common::AutoPtr<JSValue>
+  create(common::AutoPtr<JSContext> ctx,
+         common::AutoPtr<JSArrayBuffer> buffer);
+
+  static common::AutoPtr<JSArrayBuffer> unwrap(common::AutoPtr<JSValue> self,
+                                               const std::wstring &method,
+                                               bool shared = false);
+
+  static size_t toIndex(common::AutoPtr<JSContext> ctx,
+                        common::AutoPtr<JSValue> value,
+                        const std::wstring &name);
+
+  static size_t toRelativeIndex(common::AutoPtr<JSContext> ctx,
+                                common::AutoPtr<JSValue> value, size_t length,
+                                size_t fallback);
+
+  uint8_t *getData() const;
+
+  size_t getLength() const;
+
+  bool isShared() const;
+
+  bool isDetached() const;
+
+  // moves the bytes into a new buffer and leaves this one detached
+  common::AutoPtr<JSArrayBuffer> transfer();
+
+  // blocks while the element of size 4 or 8 at offset equals expected;
+  // timeout is in milliseconds, infinity waits for a notify
+  WaitResult wait(size_t offset, int64_t expected, size_t size,
+                  double timeout);
+
+  uint32_t notify(size_t offset, uint32_t count);
+};
+
+struct JSTypedArray {
+  enum class Type {
+    INT8,
+    UINT8,
+    UINT8_CLAMPED,
+    INT16,
+    UINT16,
+    INT32,
+    UINT32,
+    FLOAT32,
+    FLOAT64,
+    BIGINT64,
+    BIGUINT64
+  };
+
+  common::AutoPtr<JSArrayBuffer> buffer;
+  // ArrayBuffer object exposed through `buffer`, created on first use
+  JSStore *object;
+  Type type;
+  size_t offset;
+  size_t length;
+
+  static size_t getElementSize(Type type);
+
+  static const wchar_t *getName(Type type);
+
+  static bool isBigInt(Type type);
+
+  static double load(Type type, const uint8_t *data);
+
+  static void store(Type type, uint8_t *data, double value);
+
+  static common::AutoPtr<JSValue> read(common::AutoPtr<JSContext> ctx,
+                                       Type type, const uint8_t *data,
+                                       bool littleEndian = true);
+
+  static void write(common::AutoPtr<JSContext> ctx, Type type, uint8_t *data,
+                    common::AutoPtr<JSValue> value, bool littleEndian = true);
+
+  // views on a detached buffer only answer their accessors
+  static JSTypedArray &unwrap(common::AutoPtr<JSValue> self,
+                              const std::wstring &method,
+                              bool detached = false);
+
+  static common::AutoPtr<JSValue>
+  getBuffer(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self);
+
+  uint8_t *getData() const;
+
+  size_t getByteLength() const;
+
+  common::AutoPtr<JSValue> get(common::AutoPtr<JSContext> ctx,
+                               size_t index) const;
+
+  void set(common::AutoPtr<JSContext> ctx, size_t index,
+           common::AutoPtr<JSValue> value);
+};
+
+struct JSDataView {
+  common::AutoPtr<JSArrayBuffer> buffer;
+  JSStore *object;
+  size_t offset;
+  size_t length;
+};
+}; // namespace spark::engine
@@ -0,0 +1,122 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "common/Object.hpp"
+#include "engine/entity/JSEntity.hpp"
+#include "engine/runtime/JSStore.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace spark::engine {
+class JSContext;
+class JSValue;
+
+// Insertion-ordered open addressing table shared by Map, Set, WeakMap and
+// WeakSet. Keys are compared with SameValueZero, removed entries are
+// tombstoned and compacted once they outnumber the live ones.
+class JSCollection : public common::Object {
+public:
+  enum class Type { MAP, SET, WEAK_MAP, WEAK_SET };
+
+  enum class Kind { KEYS, VALUES, ENTRIES };
+
+  struct Entry {
+    common::AutoPtr<JSEntity> identity;
+    JSStore *key;
+    JSStore *value;
+    size_t hash;
+    bool deleted;
+  };
+
+  class Cursor : public common::Object {
+  public:
+    size_t index = 0;
+    bool done = false;
+  };
+
+  struct Iterator {
+    common::AutoPtr<JSCollection> collection;
+    common::AutoPtr<Cursor> cursor;
+    Kind kind;
+  };
+
+private:
+  static constexpr uint32_t EMPTY = 0;
+  static constexpr uint32_t TOMBSTONE = UINT32_MAX;
+  static constexpr size_t NPOS = SIZE_MAX;
+
+  Type _type;
+  JSStore *_holder;
+  std::vector<Entry> _entries;
+  std::vector<uint32_t> _slots;
+  std::vector<JSStore *> _garbage;
+  std::vector<common::AutoPtr<Cursor>> _cursors;
+  size_t _size;
+  size_t _used;
+  size_t _deleted;
+
+private:
+  static size_t hashOf(const common::AutoPtr<JSEntity> &entity);
+
+  static bool isSame(const common::AutoPtr<JSEntity> &a,
+                     const common::AutoPtr<JSEntity> &b);
+
+  size_t find(const common::AutoPtr<JSEntity> &identity, size_t hash) const;
+
+  void rehash(size_t capacity);
+
+  void release(size_t slot);
+
+  void collect(common::AutoPtr<JSContext> ctx);
+
+  void compact(common::AutoPtr<JSContext> ctx);
+
+  JSStore *store(common::AutoPtr<JSContext> ctx,
+                 common::AutoPtr<JSValue> value);
+
+public:
+  JSCollection(Type type, JSStore *holder);
+
+  static common::AutoPtr<JSCollection> create(common::AutoPtr<JSContext> ctx,
+                                              common::AutoPtr<JSValue> self,
+                                              Type type);
+
+  static common::AutoPtr<JSCollection> unwrap(common::AutoPtr<JSValue> self,
+                                              Type type,
+                                              const std::wstring &method);
+
+  static common::AutoPtr<JSValue>
+  iterate(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> iterable,
+          const std::function<void(common::AutoPtr<JSValue>)> &callback);
+
+  static bool canBeHeldWeakly(common::AutoPtr<JSValue> value);
+
+  Type getType() const;
+
+  bool isWeak() const;
+
+  size_t getSize() const;
+
+  const Entry *get(common::AutoPtr<JSValue> key) const;
+
+  void set(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> key,
+           common::AutoPtr<JSValue> value = nullptr);
+
+  bool remove(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> key);
+
+  void clear(common::AutoPtr<JSContext> ctx);
+
+  void sweep(common::AutoPtr<JSContext> ctx);
+
+  common::AutoPtr<Cursor> createCursor();
+
+  const Entry *next(common::AutoPtr<Cursor> cursor) const;
+
+  common::AutoPtr<JSValue> next(common::AutoPtr<JSContext> ctx,
+                                Iterator &iterator);
+
+  common::AutoPtr<JSValue> createIterator(common::AutoPtr<JSContext> ctx,
+                                          Kind kind);
+};
+}; // namespace spark::engine
@@ -6,13 +6,20 @@
 #include "common/Object.hpp"
 #include "compiler/base/JSModule.hpp"
 #include "engine/base/JSEvalType.hpp"
+#include "engine/base/JSIntrinsic.hpp"
 #include "engine/base/JSLocation.hpp"
 #include "engine/base/JSValueType.hpp"
 #include "engine/entity/JSEntity.hpp"
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/runtime/JSMessageQueue.hpp"
 #include "engine/runtime/JSRuntime.hpp"
 #include "engine/runtime/JSScope.hpp"
+#include "engine/runtime/JSSnapshot.hpp"
 #include "engine/runtime/JSStore.hpp"
 #include "engine/runtime/JSValue.hpp"
+#include "engine/runtime/JSWorker.hpp"
+#include "error/JSError.hpp"
+#include <array>
 #include <chrono>
 #include <functional>
 #include <string>
@@ -34,11 +41,18 @@ public:
     }
   };
 
+  using JSJob = common::AutoPtr<JSValue>(
+      common::AutoPtr<JSContext>, common::AutoPtr<JSValue>,
+      common::AutoPtr<JSValue>, common::AutoPtr<JSValue>);
+
   struct Task {
     uint32_t identifier;
     common::AutoPtr<JSValue> exec;
     int64_t timeout;
     std::chrono::system_clock::time_point start;
+    JSJob *job;
+    common::AutoPtr<JSValue> handler;
+    common::AutoPtr<JSValue> argument;
   };
 
 private:
@@ -59,6 +73,18 @@ private:
   common::AutoPtr<JSValue> _Boolean;
   common::AutoPtr<JSValue> _BigInt;
   common::AutoPtr<JSValue> _RegExp;
+  common::AutoPtr<JSValue> _Map;
+  common::AutoPtr<JSValue> _Set;
+  common::AutoPtr<JSValue> _WeakMap;
+  common::AutoPtr<JSValue> _WeakSet;
+  common::AutoPtr<JSValue> _MapIterator;
+  common::AutoPtr<JSValue> _SetIterator;
+  common::AutoPtr<JSValue> _ArrayBuffer;
+  common::AutoPtr<JSValue> _SharedArrayBuffer;
+  common::AutoPtr<JSValue> _TypedArray;
+  common::AutoPtr<JSValue> _DataView;
+  common::AutoPtr<JSValue> _JSON;
+  common::AutoPtr<JSValue> _Atomics;
   common::AutoPtr<JSValue> _Promise;
   common::AutoPtr<JSValue> _Error;
   common::AutoPtr<JSValue> _AggregateError;
@@ -69,8 +95,7 @@ private:
   common::AutoPtr<JSValue> _SyntaxError;
   common::AutoPtr<JSValue> _URIError;
 
-  // internal
-  std::unordered_map<std::wstring, common::AutoPtr<JSValue>> _symbols;
+  std::array<common::AutoPtr<JSValue>, (size_t)JSIntrinsic::COUNT> _intrinsics;
 
 private:
   common::AutoPtr<JSScope> _root;
@@ -81,8 +106,19 @@ private:
   std::vector<Task> _microTasks;
   std::vector<Task> _macroTasks;
 
+  common::AutoPtr<JSMessageQueue> _inbox;
+
+  // the worker this context runs in, nullptr on the main thread
+  common::AutoPtr<JSWorker> _worker;
+
+  std::unordered_map<uint32_t, std::pair<common::AutoPtr<JSWorker>,
+                                         common::AutoPtr<JSValue>>>
+      _workers;
+
   std::unordered_map<std::wstring, common::AutoPtr<JSValue>> _modules;
 
+  std::vector<common::AutoPtr<JSCollection>> _weakCollections;
+
   std::pair<std::wstring, common::AutoPtr<JSValue>> _currentModule;
 
   JSCallFrame *_callStack;
@@ -90,11 +126,19 @@ private:
 private:
   void initialize();
 
+  std::vector<common::AutoPtr<JSValue> *> getBuiltins();
+
+  void restore(const common::AutoPtr<JSSnapshot> &snapshot);
+
+  void receive();
+
 public:
   JSContext(const common::AutoPtr<JSRuntime> &runtime);
 
   ~JSContext() override;
 
+  common::AutoPtr<JSSnapshot> createSnapshot();
+
   common::AutoPtr<JSRuntime> &getRuntime();
 
   const std::pair<std::wstring, common::AutoPtr<JSValue>> &
@@ -116,6 +160,8 @@ public:
 
   void gc();
 
+  void registerWeakCollection(common::AutoPtr<JSCollection> collection);
+
   void pushScope();
 
   void popScope();
@@ -136,14 +182,29 @@ public:
 
   uint32_t createMicroTask(common::AutoPtr<JSValue> exec);
 
+  uint32_t createMicroTask(JSJob *job, common::AutoPtr<JSValue> target,
+                           common::AutoPtr<JSValue> handler,
+                           common::AutoPtr<JSValue> argument);
+
   uint32_t createMacroTask(common::AutoPtr<JSValue> exec, int64_t timeout = 0);
 
+  uint32_t createMacroTask(JSJob *job, common::AutoPtr<JSValue> target,
+                           common::AutoPtr<JSValue> handler,
+                           common::AutoPtr<JSValue> argument);
+
   common::AutoPtr<JSValue> nextTick();
 
   bool isTaskComplete() const;
 
   void removeMacroTask(uint32_t id);
 
+  common::AutoPtr<JSWorker> createWorker(const std::wstring &filename,
+                                         common::AutoPtr<JSValue> object);
+
+  void setWorker(const common::AutoPtr<JSWorker> &worker);
+
+  common::AutoPtr<JSWorker> &getWorker();
+
   common::AutoPtr<JSValue> applyGenerator(common::AutoPtr<JSValue> func,
                                           common::AutoPtr<JSValue> arguments,
                                           common::AutoPtr<JSValue> self);
@@ -191,6 +252,9 @@ public:
 
   common::AutoPtr<JSValue> createArray(const std::wstring &name = L"");
 
+  common::AutoPtr<JSValue> createIteratorResult(common::AutoPtr<JSValue> value,
+                                                bool done);
+
   common::AutoPtr<JSValue>
   constructObject(common::AutoPtr<JSValue> constructor,
                   const std::vector<common::AutoPtr<JSValue>> &args = {},
@@ -245,6 +309,8 @@ public:
 
   common::AutoPtr<JSValue> createException(common::AutoPtr<JSValue> target);
 
+  common::AutoPtr<JSValue> createException(const error::JSError &error);
+
   common::AutoPtr<JSValue> undefined();
 
   common::AutoPtr<JSValue> null();
@@ -259,6 +325,30 @@ public:
 
   common::AutoPtr<JSValue> RegExp();
 
+  common::AutoPtr<JSValue> Map();
+
+  common::AutoPtr<JSValue> Set();
+
+  common::AutoPtr<JSValue> WeakMap();
+
+  common::AutoPtr<JSValue> WeakSet();
+
+  common::AutoPtr<JSValue> MapIterator();
+
+  common::AutoPtr<JSValue> SetIterator();
+
+  common::AutoPtr<JSValue> ArrayBuffer();
+
+  common::AutoPtr<JSValue> SharedArrayBuffer();
+
+  common::AutoPtr<JSValue> TypedArray();
+
+  common::AutoPtr<JSValue> DataView();
+
+  common::AutoPtr<JSValue> JSON();
+
+  common::AutoPtr<JSValue> Atomics();
+
   common::AutoPtr<JSValue> Function();
 
   common::AutoPtr<JSValue> AsyncFunction();
@@ -301,7 +391,7 @@ public:
 
   common::AutoPtr<JSValue> uninitialized();
 
-  common::AutoPtr<JSValue> internalSymbol(const std::wstring &name);
+  common::AutoPtr<JSValue> getIntrinsic(JSIntrinsic intrinsic);
 
   common::AutoPtr<JSValue> load(const std::wstring &name);
 };
@@ -0,0 +1,54 @@
+#pragma once
+#include "common/SharedObject.hpp"
+#include "engine/runtime/JSStructuredClone.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+
+namespace spark::engine {
+// Inbox of a context. Any thread may post, only the owning context receives.
+// Posting is a Vyukov multi-producer single-consumer push; the mutex is only
+// taken to wake a consumer that sleeps in wait, never to reach the queue.
+class JSMessageQueue : public common::SharedObject {
+public:
+  enum class JSMessageType : uint8_t { MESSAGE, EXCEPTION, EXIT, TERMINATE };
+
+  struct JSMessage {
+    uint32_t port;
+    JSMessageType type;
+    JSCloneRecord record;
+  };
+
+private:
+  struct JSNode {
+    std::atomic<JSNode *> next;
+    JSMessage message;
+  };
+
+  std::atomic<JSNode *> _head;
+
+  JSNode *_tail;
+
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+public:
+  JSMessageQueue();
+
+  ~JSMessageQueue() override;
+
+  void post(JSMessage &&message);
+
+  bool receive(JSMessage &message);
+
+  bool empty() const;
+
+  // blocks until a message is posted or the timeout, when given, expires
+  void wait();
+
+  void wait(std::chrono::milliseconds timeout);
+};
+} // namespace spark::engine
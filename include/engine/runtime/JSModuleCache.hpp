@@ -0,0 +1,28 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "common/SharedObject.hpp"
+#include "compiler/base/JSModule.hpp"
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace spark::engine {
+// Compiled modules by filename. A module is never changed once compiled, so
+// isolates created from the same runtime share one cache and only the table
+// itself needs a lock.
+class JSModuleCache : public common::SharedObject {
+private:
+  mutable std::mutex _mutex;
+
+  std::unordered_map<std::wstring, common::AutoPtr<compiler::JSModule>>
+      _modules;
+
+public:
+  bool contains(const std::wstring &filename) const;
+
+  common::AutoPtr<compiler::JSModule> get(const std::wstring &filename) const;
+
+  void set(const std::wstring &filename,
+           const common::AutoPtr<compiler::JSModule> &module);
+};
+} // namespace spark::engine
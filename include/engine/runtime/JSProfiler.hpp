@@ -0,0 +1,113 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "common/Object.hpp"
+#include "compiler/base/JSModule.hpp"
+#include "compiler/base/JSNode.hpp"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace spark::engine {
+class JSContext;
+
+// Sampling CPU profiler of one runtime. The watcher thread only counts
+// ticks; the virtual machine notices a pending tick between two
+// instructions and records its own pc and call frames, so no state of the
+// running thread is ever read from the watcher. Time spent in a native
+// function is charged to the instruction that follows the call.
+class JSProfiler : public common::Object {
+private:
+  struct JSFrame {
+    std::wstring funcname;
+    std::wstring filename;
+    // 1-based, like the locations of the call frames
+    uint32_t line;
+    uint32_t column;
+  };
+
+  struct JSSample {
+    // frame indices, outermost first
+    std::vector<uint32_t> stack;
+    int64_t timestamp;
+    // ticks elapsed since the previous sample
+    uint64_t weight;
+  };
+
+  using JSSourceMap =
+      std::vector<std::pair<uint32_t, compiler::JSSourceLocation::Position>>;
+
+  std::chrono::microseconds _interval;
+
+  std::atomic<uint64_t> _ticks;
+
+  uint64_t _sampled;
+
+  bool _running;
+
+  std::mutex _mutex;
+
+  std::condition_variable _condition;
+
+  std::thread _thread;
+
+  int64_t _startTime;
+
+  int64_t _endTime;
+
+  std::vector<JSFrame> _frames;
+
+  std::unordered_map<std::wstring, uint32_t> _frameIndices;
+
+  std::vector<JSSample> _samples;
+
+  // source maps sorted by offset, the module is kept alive with its map
+  std::unordered_map<const compiler::JSModule *,
+                     std::pair<common::AutoPtr<compiler::JSModule>,
+                               JSSourceMap>>
+      _sourceMaps;
+
+private:
+  static int64_t now();
+
+  compiler::JSSourceLocation::Position
+  locate(const common::AutoPtr<compiler::JSModule> &module, size_t offset);
+
+  uint32_t intern(const std::wstring &funcname, const std::wstring &filename,
+                  uint32_t line, uint32_t column);
+
+public:
+  JSProfiler(std::chrono::microseconds interval);
+
+  ~JSProfiler() override;
+
+  void start();
+
+  void stop();
+
+  bool isPending() const {
+    return _ticks.load(std::memory_order_relaxed) != _sampled;
+  }
+
+  // drops the ticks that passed while the context waited for a task
+  void skip();
+
+  void sample(common::AutoPtr<JSContext> ctx,
+              const common::AutoPtr<compiler::JSModule> &module,
+              size_t offset);
+
+  // one `frame;frame;frame weight` line per distinct stack, the input of
+  // flamegraph.pl and speedscope
+  std::wstring getCollapsedStacks() const;
+
+  // the Profile object of the Chrome DevTools protocol, as read from a
+  // .cpuprofile file
+  std::wstring getCpuProfile() const;
+};
+} // namespace spark::engine
@@ -1,9 +1,18 @@
 #pragma once
 #include "common/AutoPtr.hpp"
 #include "common/Object.hpp"
+#include "common/Regex.hpp"
 #include "compiler/JSGenerator.hpp"
+#include "compiler/JSOptimizer.hpp"
 #include "compiler/JSParser.hpp"
+#include "compiler/base/JSModule.hpp"
+#include "compiler/base/JSNode.hpp"
+#include "engine/base/JSEvalType.hpp"
+#include "engine/runtime/JSModuleCache.hpp"
+#include "engine/runtime/JSProfiler.hpp"
+#include "engine/runtime/JSSnapshot.hpp"
 #include "vm/JSVirtualMachine.hpp"
+#include <chrono>
 #include <functional>
 #include <string>
 #include <unordered_map>
@@ -26,6 +35,10 @@ private:
 
   common::AutoPtr<compiler::JSGenerator> _generator;
 
+  common::AutoPtr<compiler::JSOptimizer> _optimizer;
+
+  bool _optimize;
+
   common::AutoPtr<vm::JSVirtualMachine> _vm;
 
   std::vector<std::wstring> _argv;
@@ -36,26 +49,82 @@ private:
 
   std::unordered_map<std::wstring, std::wstring> _importAttributes;
 
+  common::AutoPtr<JSModuleCache> _modules;
+
+  std::unordered_map<std::wstring, common::AutoPtr<common::Regex>> _regexes;
+
+  common::AutoPtr<JSSnapshot> _snapshot;
+
+  JSHook _workerCallback;
+
+  common::AutoPtr<JSProfiler> _profiler;
+
 private:
   static std::wstring normalizePath(const std::wstring &path);
 
+  static std::vector<std::wstring>
+  getImportSources(const common::AutoPtr<compiler::JSNode> &root);
+
 public:
   JSRuntime(int argc, char **argv);
 
   ~JSRuntime() override;
 
+  // A runtime is an isolate: its parser, generator and virtual machine
+  // serve one thread at a time. The isolate returned here is meant for
+  // another thread and shares only the module cache and the snapshot.
+  common::AutoPtr<JSRuntime> createIsolate() const;
+
   std::wstring getCurrentPath();
 
   void setPathResolver(const PathResolveFunc &resolver);
 
   const PathResolveFunc &getPathResolver() const;
 
+  static std::wstring readSource(const std::wstring &filename);
+
+  std::pair<std::wstring, JSEvalType>
+  resolveModule(const std::wstring &current, const std::wstring &source) const;
+
+  void compileImports(const std::wstring &filename,
+                      const common::AutoPtr<compiler::JSNode> &root);
+
+  common::AutoPtr<compiler::JSModule>
+  getCompiledModule(const std::wstring &filename);
+
+  common::AutoPtr<common::Regex> compileRegex(const std::wstring &source,
+                                              uint32_t flags);
+
   common::AutoPtr<compiler::JSParser> &getParser();
 
   common::AutoPtr<compiler::JSGenerator> &getGenerator();
 
+  common::AutoPtr<compiler::JSOptimizer> &getOptimizer();
+
+  void setOptimize(bool optimize);
+
+  bool isOptimize() const;
+
   common::AutoPtr<vm::JSVirtualMachine> &getVirtualMachine();
 
+  void setSnapshot(const common::AutoPtr<JSSnapshot> &snapshot);
+
+  common::AutoPtr<JSSnapshot> &getSnapshot();
+
+  // samples the virtual machine of this runtime until stopProfiling; the
+  // isolates of workers run on machines of their own and are not sampled
+  void startProfiling(std::chrono::microseconds interval =
+                          std::chrono::microseconds(1000));
+
+  common::AutoPtr<JSProfiler> stopProfiling();
+
+  common::AutoPtr<JSProfiler> &getProfiler();
+
+  // called on the worker thread for each context a Worker starts
+  void setWorkerCallback(const JSHook &setup);
+
+  const JSHook &getWorkerCallback() const;
+
   void setDirectiveCallback(const std::wstring &name, const JSHook &setup,
                             const JSHook &cleanup);
 
@@ -14,6 +14,7 @@ private:
   JSStore *_root;
   JSScope *_parent;
   JSStore *_gcRoot;
+  uint32_t _depth;
 
   std::vector<common::AutoPtr<JSScope>> _children;
 
@@ -35,6 +36,8 @@ public:
 
   common::AutoPtr<JSScope> getParent();
 
+  uint32_t getDepth() const;
+
   void removeChild(const common::AutoPtr<JSScope> &child);
 
   common::AutoPtr<JSValue> createValue(JSStore *store,
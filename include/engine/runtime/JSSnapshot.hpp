@@ -0,0 +1,144 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "common/BigInt.hpp"
+#include "common/SharedObject.hpp"
+#include "compiler/base/JSModule.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSEntity.hpp"
+#include "engine/runtime/JSStore.hpp"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace spark::engine {
+// Image of a context heap. Stores are numbered in the order they are reached
+// from the roots and every reference between them is such an index; native
+// callees, strings and bytecode modules live in tables of their own, so a
+// restore allocates the stores once and wires them without any lookups.
+class JSSnapshot : public common::SharedObject {
+public:
+  static constexpr uint32_t NONE = UINT32_MAX;
+
+  struct JSRoot {
+    std::wstring name;
+    JSStore *store;
+    bool isConst;
+  };
+
+  struct JSRootRecord {
+    uint32_t name;
+    uint32_t store;
+    bool isConst;
+  };
+
+private:
+  enum JSFlag : uint8_t {
+    NOT_EXTENSIBLE = 1,
+    SEALED = 2,
+    FROZEN = 4,
+    ASYNC = 8,
+    GENERATOR = 16,
+    VALUE = 32,
+  };
+
+  enum JSFieldFlag : uint8_t {
+    CONFIGURABLE = 1,
+    ENUMABLE = 2,
+    WRITABLE = 4,
+    SYMBOL = 8,
+    PRIVATE = 16,
+  };
+
+  struct JSFieldRecord {
+    uint32_t key;
+    uint32_t value;
+    uint32_t get;
+    uint32_t set;
+    uint8_t flags;
+  };
+
+  struct JSFunctionRecord {
+    uint32_t module;
+    uint32_t address;
+    uint32_t length;
+  };
+
+  // payload indexes _numbers, _bigints, _strings, _natives or _functions
+  // depending on type, name is the native name or the function source,
+  // and items is a range of _items for arrays and of _closures otherwise.
+  struct JSEntityRecord {
+    JSValueType type;
+    uint8_t flags;
+    uint32_t payload;
+    uint32_t name;
+    uint32_t prototype;
+    uint32_t bind;
+    uint32_t opaque;
+    uint32_t fields;
+    uint32_t fieldsEnd;
+    uint32_t items;
+    uint32_t itemsEnd;
+  };
+
+  struct JSStoreRecord {
+    uint32_t entity;
+    uint32_t children;
+    uint32_t childrenEnd;
+  };
+
+  struct JSCapture {
+    std::unordered_map<JSStore *, uint32_t> stores;
+    std::unordered_map<const JSEntity *, uint32_t> entities;
+    std::unordered_map<std::wstring, uint32_t> strings;
+    std::unordered_map<JSFunction *, uint32_t> natives;
+    std::unordered_map<const compiler::JSModule *, uint32_t> modules;
+    std::vector<JSStore *> pending;
+  };
+
+private:
+  std::vector<JSStoreRecord> _stores;
+  std::vector<JSEntityRecord> _entities;
+  std::vector<JSFieldRecord> _fields;
+  std::vector<uint32_t> _children;
+  std::vector<uint32_t> _items;
+  std::vector<std::pair<uint32_t, uint32_t>> _closures;
+
+  std::vector<std::wstring> _strings;
+  std::vector<double> _numbers;
+  std::vector<common::BigInt<>> _bigints;
+  std::vector<std::function<JSFunction>> _natives;
+  std::vector<JSFunctionRecord> _functions;
+  std::vector<common::AutoPtr<compiler::JSModule>> _modules;
+
+  std::vector<uint32_t> _builtins;
+  std::vector<JSRootRecord> _globals;
+  std::vector<JSRootRecord> _exports;
+
+private:
+  uint32_t capture(JSCapture &state, JSStore *store);
+
+  uint32_t intern(JSCapture &state, const std::wstring &value);
+
+  uint32_t encode(JSCapture &state, common::AutoPtr<JSEntity> entity);
+
+  common::AutoPtr<JSEntity> decode(const JSEntityRecord &record,
+                                   const std::vector<JSStore *> &stores) const;
+
+public:
+  JSSnapshot(const std::vector<JSStore *> &builtins,
+             const std::vector<JSRoot> &globals,
+             const std::vector<JSRoot> &modules);
+
+  std::vector<JSStore *> restore() const;
+
+  const std::vector<uint32_t> &getBuiltins() const;
+
+  const std::vector<JSRootRecord> &getGlobals() const;
+
+  const std::vector<JSRootRecord> &getModules() const;
+
+  const std::wstring &getString(uint32_t index) const;
+};
+} // namespace spark::engine
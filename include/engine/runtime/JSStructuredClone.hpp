@@ -0,0 +1,33 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include <cstdint>
+#include <vector>
+
+namespace spark::engine {
+class JSContext;
+
+struct JSCloneRecord {
+  std::vector<uint8_t> data;
+  // backing stores passed by handle instead of by copy: the transfer list
+  // first, in its order, then every SharedArrayBuffer met on the way
+  std::vector<common::AutoPtr<JSArrayBuffer>> buffers;
+};
+
+// Structured clone of a value into a flat record that holds no store, so it
+// can be handed to a context on another thread. Objects, arrays and buffers
+// keep their identity inside one record, cycles included; array buffers are
+// copied with their bytes unless they are shared or transferred.
+class JSStructuredClone {
+public:
+  // the exception raised by a getter, or nullptr once output is complete;
+  // the buffers of the transfer list are detached only on success
+  static common::AutoPtr<JSValue>
+  serialize(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> value,
+            JSCloneRecord &output, common::AutoPtr<JSValue> transfer = nullptr);
+
+  static common::AutoPtr<JSValue> deserialize(common::AutoPtr<JSContext> ctx,
+                                              const JSCloneRecord &input);
+};
+} // namespace spark::engine
@@ -56,6 +56,8 @@ public:
 
   std::optional<double> getNumber() const;
 
+  std::optional<uint32_t> getArrayIndex() const;
+
   std::optional<std::wstring> getString() const;
 
   std::optional<bool> getBoolean() const;
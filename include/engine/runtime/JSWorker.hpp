@@ -0,0 +1,67 @@
+#pragma once
+#include "common/AutoPtr.hpp"
+#include "common/SharedObject.hpp"
+#include "engine/runtime/JSMessageQueue.hpp"
+#include "engine/runtime/JSRuntime.hpp"
+#include "engine/runtime/JSStructuredClone.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+namespace spark::engine {
+// A module running in a context of its own on its own thread. The parent
+// and the worker only share the two inboxes; every message is a structured
+// clone record, so no store ever crosses between the threads.
+class JSWorker : public common::SharedObject {
+public:
+  // port of the messages a worker receives from its parent
+  static constexpr uint32_t PARENT = 0;
+
+private:
+  std::wstring _filename;
+
+  // handed to the worker thread, the parent never touches it after start
+  common::AutoPtr<JSRuntime> _runtime;
+
+  uint32_t _port;
+
+  common::AutoPtr<JSMessageQueue> _inbox;
+
+  common::AutoPtr<JSMessageQueue> _parent;
+
+  std::atomic<bool> _closed;
+
+  std::thread _thread;
+
+private:
+  void run();
+
+public:
+  JSWorker(const std::wstring &filename,
+           const common::AutoPtr<JSRuntime> &runtime,
+           const common::AutoPtr<JSMessageQueue> &parent);
+
+  ~JSWorker() override;
+
+  void start();
+
+  uint32_t getPort() const;
+
+  const common::AutoPtr<JSMessageQueue> &getInbox() const;
+
+  void postMessage(JSCloneRecord &&record);
+
+  void postParent(JSMessageQueue::JSMessageType type,
+                  JSCloneRecord &&record = {});
+
+  // a closed worker stops after the task it is running
+  void close();
+
+  bool isClosed() const;
+
+  void terminate();
+
+  void join();
+};
+} // namespace spark::engine
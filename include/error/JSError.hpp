@@ -18,7 +18,8 @@ private:
   engine::JSLocation _location;
 
   std::string format(const std::wstring &type, const std::wstring &message) {
-    static std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+    static thread_local std::wstring_convert<std::codecvt_utf8<wchar_t>>
+        converter;
     if (type.empty()) {
       return converter.to_bytes(message);
     }
@@ -71,10 +71,8 @@ enum class JSAsmOperator {
   JTRUE,
   JNOT_NULL,
   JNULL,
-  TRY,
   DEFER,
   END_DEFER,
-  END_TRY,
   SETUP_DIRECTIVE,
   CLEANUP_DIRECTIVE,
   POW,
@@ -108,5 +106,10 @@ enum class JSAsmOperator {
   IMPORT_MODULE,
   SET_IMPORT_ATTRIBUTE,
   EXPORT,
+  GET_NAMED_FIELD,
+  CALL_DISCARD,
+  MEMBER_CALL_DISCARD,
+  INC_LOCAL,
+  DEC_LOCAL,
 };
 }
\ No newline at end of file
@@ -14,6 +14,7 @@ struct JSCoroutineContext {
   bool done;
   std::wstring funcname;
   size_t pc;
+  engine::JSStore *promise;
   ~JSCoroutineContext() {
     while (scope != nullptr) {
       scope = scope->getParent();
@@ -1,15 +1,17 @@
 #pragma once
-#include "JSErrorFrame.hpp"
 #include "common/AutoPtr.hpp"
 #include "engine/runtime/JSValue.hpp"
+#include <utility>
 #include <vector>
 
 namespace spark::vm {
 struct JSEvalContext : public common::Object {
   std::vector<common::AutoPtr<engine::JSValue>> stack;
   std::vector<size_t> stackTops;
-  std::vector<size_t> deferStack;
-  common::AutoPtr<JSErrorFrame> errorStacks;
-  JSEvalContext(){};
+  std::vector<std::pair<size_t, size_t>> deferStack;
+  bool suspended = false;
+  size_t address = 0;
+  size_t depth;
+  JSEvalContext(size_t depth = 0) : depth(depth){};
 };
 } // namespace spark::vm
\ No newline at end of file
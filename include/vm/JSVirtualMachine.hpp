@@ -4,6 +4,7 @@
 #include "common/AutoPtr.hpp"
 #include "common/Object.hpp"
 #include "compiler/base/JSModule.hpp"
+#include "engine/runtime/JSProfiler.hpp"
 #include "engine/runtime/JSValue.hpp"
 #include <string>
 
@@ -18,6 +19,8 @@ class JSVirtualMachine : public common::Object {
 private:
   common::AutoPtr<JSEvalContext> _ctx;
   size_t _pc;
+  // checked before every instruction, owned by the runtime
+  engine::JSProfiler *_profiler;
 
 private:
   vm::JSAsmOperator next(const common::AutoPtr<compiler::JSModule> &module);
@@ -28,6 +31,21 @@ private:
 
   const std::wstring &args(const common::AutoPtr<compiler::JSModule> &module);
 
+  bool isIndexIterable(common::AutoPtr<engine::JSContext> ctx,
+                       common::AutoPtr<engine::JSValue> value);
+
+  common::AutoPtr<engine::JSValue>
+  nextIndex(common::AutoPtr<engine::JSContext> ctx,
+            common::AutoPtr<engine::JSValue> value,
+            common::AutoPtr<engine::JSValue> index);
+
+  void suspend(const common::AutoPtr<compiler::JSModule> &module,
+               common::AutoPtr<engine::JSValue> value, size_t address);
+
+  void unwind(common::AutoPtr<engine::JSContext> ctx,
+              const common::AutoPtr<compiler::JSModule> &module,
+              size_t address);
+
 private:
   JS_OPT(pushNull);
   JS_OPT(pushUndefined);
@@ -61,6 +79,7 @@ private:
   JS_OPT(setPrivateField);
   JS_OPT(getPrivateField);
   JS_OPT(setPrivateMethod);
+  JS_OPT(getNamedField);
   JS_OPT(getKeys);
   JS_OPT(setAccessor);
   JS_OPT(setPrivateAccessor);
@@ -89,13 +108,13 @@ private:
   JS_OPT(popScope);
   JS_OPT(call);
   JS_OPT(memberCall);
+  JS_OPT(callDiscard);
+  JS_OPT(memberCallDiscard);
   JS_OPT(memberPrivateCall);
   JS_OPT(superMemberCall);
   JS_OPT(superCall);
   JS_OPT(optionalCall);
   JS_OPT(memberOptionalCall);
-  JS_OPT(tryStart);
-  JS_OPT(tryEnd);
   JS_OPT(defer);
   JS_OPT(deferEnd);
   JS_OPT(jmp);
@@ -111,6 +130,8 @@ private:
   JS_OPT(sub);
   JS_OPT(inc);
   JS_OPT(dec);
+  JS_OPT(incLocal);
+  JS_OPT(decLocal);
   JS_OPT(plus);
   JS_OPT(netation);
   JS_OPT(not_);
@@ -144,6 +165,8 @@ public:
 
   void setContext(common::AutoPtr<JSEvalContext> ctx);
 
+  void setProfiler(engine::JSProfiler *profiler);
+
   void run(common::AutoPtr<engine::JSContext> ctx,
            const common::AutoPtr<compiler::JSModule> &module, size_t offset);
 
@@ -0,0 +1,245 @@
+#include "common/Number.hpp"
+#include <array>
+#include <charconv>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
+using namespace spark;
+using namespace spark::common;
+
+static const std::array<std::wstring, Number::CACHE_SIZE> &getCache() {
+  static const auto cache = []() {
+    std::array<std::wstring, Number::CACHE_SIZE> cache;
+    for (uint32_t index = 0; index < Number::CACHE_SIZE; index++) {
+      cache[index] = std::to_wstring(index);
+    }
+    return cache;
+  }();
+  return cache;
+}
+
+static int32_t toDigit(wchar_t chr) {
+  if (chr >= L'0' && chr <= L'9') {
+    return chr - L'0';
+  }
+  if (chr >= L'a' && chr <= L'z') {
+    return chr - L'a' + 10;
+  }
+  if (chr >= L'A' && chr <= L'Z') {
+    return chr - L'A' + 10;
+  }
+  return -1;
+}
+
+bool Number::isWhitespace(wchar_t chr) {
+  switch (chr) {
+  case 0x9:
+  case 0xa:
+  case 0xb:
+  case 0xc:
+  case 0xd:
+  case 0x20:
+  case 0xa0:
+  case 0x1680:
+  case 0x2028:
+  case 0x2029:
+  case 0x202f:
+  case 0x205f:
+  case 0x3000:
+  case 0xfeff:
+    return true;
+  default:
+    return chr >= 0x2000 && chr <= 0x200a;
+  }
+}
+
+// Number::toString from ECMA-262 with radix 10. std::to_chars produces the
+// shortest digit string that round-trips, which is exactly the k digits the
+// specification asks for; only the placement of the point and the exponent
+// is done here.
+std::wstring Number::toString(double value) {
+  if (std::isnan(value)) {
+    return L"NaN";
+  }
+  if (std::isinf(value)) {
+    return value < 0 ? L"-Infinity" : L"Infinity";
+  }
+  if (value >= 0 && value < CACHE_SIZE && value == (uint32_t)value) {
+    return getCache()[(uint32_t)value];
+  }
+  char buffer[32];
+  if (std::abs(value) < 9007199254740992.0 && value == std::trunc(value)) {
+    auto end = std::to_chars(buffer, buffer + sizeof(buffer), (int64_t)value);
+    return std::wstring(buffer, end.ptr);
+  }
+  auto end = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                           std::chars_format::scientific)
+                 .ptr;
+  std::wstring result;
+  auto cursor = buffer;
+  if (*cursor == '-') {
+    result += L'-';
+    cursor++;
+  }
+  std::wstring digits;
+  while (cursor != end && *cursor != 'e') {
+    if (*cursor != '.') {
+      digits += (wchar_t)*cursor;
+    }
+    cursor++;
+  }
+  int32_t exponent = 0;
+  if (cursor != end) {
+    cursor++;
+    if (*cursor == '+') {
+      cursor++;
+    }
+    std::from_chars(cursor, end, exponent);
+  }
+  auto k = (int32_t)digits.size();
+  auto n = exponent + 1;
+  if (k <= n && n <= 21) {
+    result += digits;
+    result.append(n - k, L'0');
+  } else if (0 < n && n <= 21) {
+    result.append(digits, 0, n);
+    result += L'.';
+    result.append(digits, n);
+  } else if (-6 < n && n <= 0) {
+    result += L"0.";
+    result.append(-n, L'0');
+    result += digits;
+  } else {
+    result += digits[0];
+    if (k > 1) {
+      result += L'.';
+      result.append(digits, 1);
+    }
+    result += n > 0 ? L"e+" : L"e-";
+    result += getCache()[std::abs(n - 1)];
+  }
+  return result;
+}
+
+double Number::parseRadix(const wchar_t *begin, const wchar_t *end,
+                          uint32_t radix) {
+  if (begin == end) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  uint64_t mantissa = 0;
+  auto limit = std::numeric_limits<uint64_t>::max() / radix;
+  auto cursor = begin;
+  for (; cursor != end; cursor++) {
+    auto digit = toDigit(*cursor);
+    if (digit < 0 || digit >= (int32_t)radix) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    if (mantissa > limit) {
+      break;
+    }
+    mantissa = mantissa * radix + digit;
+  }
+  auto value = (double)mantissa;
+  for (; cursor != end; cursor++) {
+    auto digit = toDigit(*cursor);
+    if (digit < 0 || digit >= (int32_t)radix) {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    value = value * radix + digit;
+  }
+  return value;
+}
+
+// Validates StrUnsignedDecimalLiteral and hands it to std::from_chars, which
+// is an Eisel-Lemire parser in libstdc++. Plain integers of up to 15 digits
+// are exact in a double and skip it.
+double Number::parseDecimal(const wchar_t *begin, const wchar_t *end) {
+  static constexpr std::wstring_view INFINITY_LITERAL = L"Infinity";
+  if (std::wstring_view(begin, end - begin) == INFINITY_LITERAL) {
+    return std::numeric_limits<double>::infinity();
+  }
+  std::string source;
+  source.reserve(end - begin);
+  uint64_t mantissa = 0;
+  size_t digits = 0;
+  bool integral = true;
+  auto cursor = begin;
+  while (cursor != end && *cursor >= L'0' && *cursor <= L'9') {
+    mantissa = mantissa * 10 + (*cursor - L'0');
+    source += (char)*cursor++;
+    digits++;
+  }
+  if (cursor != end && *cursor == L'.') {
+    integral = false;
+    source += (char)*cursor++;
+    while (cursor != end && *cursor >= L'0' && *cursor <= L'9') {
+      source += (char)*cursor++;
+      digits++;
+    }
+  }
+  if (digits == 0) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  if (cursor != end && (*cursor == L'e' || *cursor == L'E')) {
+    integral = false;
+    source += (char)*cursor++;
+    if (cursor != end && (*cursor == L'+' || *cursor == L'-')) {
+      source += (char)*cursor++;
+    }
+    if (cursor == end || *cursor < L'0' || *cursor > L'9') {
+      return std::numeric_limits<double>::quiet_NaN();
+    }
+    while (cursor != end && *cursor >= L'0' && *cursor <= L'9') {
+      source += (char)*cursor++;
+    }
+  }
+  if (cursor != end) {
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+  if (integral && digits <= 15) {
+    return (double)mantissa;
+  }
+  double value = 0;
+  auto [_, error] =
+      std::from_chars(source.data(), source.data() + source.size(), value);
+  if (error == std::errc::result_out_of_range) {
+    return std::strtod(source.c_str(), nullptr);
+  }
+  return value;
+}
+
+// StringToNumber from ECMA-262: surrounding whitespace is ignored, the empty
+// string is zero and prefixed literals take no sign.
+double Number::parse(const std::wstring &source) {
+  auto begin = source.data();
+  auto end = begin + source.size();
+  while (begin != end && isWhitespace(*begin)) {
+    begin++;
+  }
+  while (begin != end && isWhitespace(*(end - 1))) {
+    end--;
+  }
+  if (begin == end) {
+    return 0;
+  }
+  if (end - begin > 1 && begin[0] == L'0') {
+    switch (begin[1]) {
+    case L'x':
+    case L'X':
+      return parseRadix(begin + 2, end, 16);
+    case L'o':
+    case L'O':
+      return parseRadix(begin + 2, end, 8);
+    case L'b':
+    case L'B':
+      return parseRadix(begin + 2, end, 2);
+    }
+  }
+  if (*begin == L'-') {
+    return -parseDecimal(begin + 1, end);
+  }
+  if (*begin == L'+') {
+    return parseDecimal(begin + 1, end);
+  }
+  return parseDecimal(begin, end);
+}
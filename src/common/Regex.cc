@@ -0,0 +1,1096 @@
+#include "common/Regex.hpp"
+#include "error/JSSyntaxError.hpp"
+#include <algorithm>
+#include <cwctype>
+#include <fmt/xchar.h>
+#include <limits>
+using namespace spark;
+using namespace spark::common;
+
+static constexpr uint32_t INFINITE = std::numeric_limits<uint32_t>::max();
+
+static constexpr uint32_t FRAME_BRANCH = 0;
+
+static constexpr uint32_t FRAME_SLOT = 1;
+
+static constexpr uint32_t FRAME_REGISTER = 2;
+
+static constexpr uint32_t NO_MEMO = std::numeric_limits<uint32_t>::max();
+
+static constexpr size_t MAX_PROGRAM_SIZE = 1 << 20;
+
+static constexpr uint64_t MAX_MEMO_BITS = 1 << 26;
+
+Regex::Regex(const std::wstring &source, uint32_t flags)
+    : _source(source), _flags(flags), _groups(0), _registers(0), _splits(0),
+      _marks(0), _memoizable(true), _nullable(false), _anchored(false),
+      _firstAny(false), _index(0), _capture(0) {
+  scanGroups();
+  _groups = (uint32_t)_names.size();
+  auto root = parseDisjunction();
+  if (!isEnd()) {
+    if (peek() == L')') {
+      error(L"Unmatched ')'");
+    }
+    error(L"Unexpected character");
+  }
+  emit(Opcode::SAVE, 0);
+  compile(root.get());
+  emit(Opcode::SAVE, 1);
+  emit(Opcode::MATCH);
+  _nullable = computeFirst(root.get());
+  const Node *head = root.get();
+  if (head->type == NodeType::SEQUENCE && !head->children.empty()) {
+    if (!(_flags & ICASE)) {
+      for (auto &child : head->children) {
+        if (child->type != NodeType::CHAR) {
+          break;
+        }
+        _prefix.push_back((wchar_t)child->value);
+      }
+    }
+    head = head->children[0].get();
+  }
+  if (head->type == NodeType::ASSERTION &&
+      head->opcode == Opcode::LINE_START && !(_flags & MULTILINE)) {
+    _anchored = true;
+  }
+}
+
+bool Regex::isLineTerminator(uint32_t chr) {
+  return chr == L'\n' || chr == L'\r' || chr == 0x2028 || chr == 0x2029;
+}
+
+bool Regex::isWordChar(uint32_t chr) {
+  return (chr >= L'a' && chr <= L'z') || (chr >= L'A' && chr <= L'Z') ||
+         (chr >= L'0' && chr <= L'9') || chr == L'_';
+}
+
+uint32_t Regex::canonicalize(uint32_t chr) {
+  auto upper = (uint32_t)std::towupper((wint_t)chr);
+  if (chr >= 128 && upper < 128) {
+    return chr;
+  }
+  return upper;
+}
+
+void Regex::addRanges(CharClass &cls, uint32_t kind) {
+  std::vector<std::pair<uint32_t, uint32_t>> ranges;
+  switch (std::towlower(kind)) {
+  case L'd':
+    ranges = {{L'0', L'9'}};
+    break;
+  case L'w':
+    ranges = {{L'0', L'9'}, {L'A', L'Z'}, {L'_', L'_'}, {L'a', L'z'}};
+    break;
+  case L's':
+    ranges = {{0x09, 0x0d},     {0x20, 0x20},     {0xa0, 0xa0},
+              {0x1680, 0x1680}, {0x2000, 0x200a}, {0x2028, 0x2029},
+              {0x202f, 0x202f}, {0x205f, 0x205f}, {0x3000, 0x3000},
+              {0xfeff, 0xfeff}};
+    break;
+  }
+  if (std::iswupper(kind)) {
+    ranges = complement(ranges);
+  }
+  cls.ranges.insert(cls.ranges.end(), ranges.begin(), ranges.end());
+}
+
+std::vector<std::pair<uint32_t, uint32_t>>
+Regex::complement(const std::vector<std::pair<uint32_t, uint32_t>> &ranges) {
+  std::vector<std::pair<uint32_t, uint32_t>> result;
+  uint32_t next = 0;
+  for (auto &[from, to] : ranges) {
+    if (from > next) {
+      result.push_back({next, from - 1});
+    }
+    next = to + 1;
+  }
+  if (next <= 0x10ffff) {
+    result.push_back({next, 0x10ffff});
+  }
+  return result;
+}
+
+void Regex::error(const std::wstring &message) const {
+  throw error::JSSyntaxError(
+      fmt::format(L"Invalid regular expression: /{}/: {}", _source, message));
+}
+
+bool Regex::isEnd() const { return _index >= _source.size(); }
+
+uint32_t Regex::peek() const { return _source[_index]; }
+
+void Regex::scanGroups() {
+  bool inClass = false;
+  for (size_t index = 0; index < _source.size(); index++) {
+    auto chr = _source[index];
+    if (chr == L'\\') {
+      index++;
+    } else if (inClass) {
+      if (chr == L']') {
+        inClass = false;
+      }
+    } else if (chr == L'[') {
+      inClass = true;
+    } else if (chr == L'(') {
+      if (index + 1 < _source.size() && _source[index + 1] == L'?') {
+        if (index + 3 < _source.size() && _source[index + 2] == L'<' &&
+            _source[index + 3] != L'=' && _source[index + 3] != L'!') {
+          auto end = _source.find(L'>', index + 3);
+          if (end == std::wstring::npos) {
+            error(L"Invalid capture group name");
+          }
+          auto name = _source.substr(index + 3, end - index - 3);
+          if (name.empty()) {
+            error(L"Invalid capture group name");
+          }
+          if (std::find(_names.begin(), _names.end(), name) != _names.end()) {
+            error(L"Duplicate capture group name");
+          }
+          _names.push_back(name);
+        }
+      } else {
+        _names.push_back(L"");
+      }
+    }
+  }
+}
+
+std::unique_ptr<Regex::Node> Regex::createNode(NodeType type, uint32_t value) {
+  auto node = std::make_unique<Node>();
+  node->type = type;
+  node->value = value;
+  node->min = 0;
+  node->max = 0;
+  node->greedy = true;
+  node->opcode = Opcode::MATCH;
+  return node;
+}
+
+std::unique_ptr<Regex::Node> Regex::parseDisjunction() {
+  auto node = createNode(NodeType::ALTERNATIVE);
+  node->children.push_back(parseAlternative());
+  while (!isEnd() && peek() == L'|') {
+    _index++;
+    node->children.push_back(parseAlternative());
+  }
+  if (node->children.size() == 1) {
+    return std::move(node->children[0]);
+  }
+  return node;
+}
+
+std::unique_ptr<Regex::Node> Regex::parseAlternative() {
+  auto node = createNode(NodeType::SEQUENCE);
+  while (!isEnd() && peek() != L'|' && peek() != L')') {
+    node->children.push_back(parseTerm());
+  }
+  if (node->children.size() == 1) {
+    return std::move(node->children[0]);
+  }
+  if (node->children.empty()) {
+    node->type = NodeType::EMPTY;
+  }
+  return node;
+}
+
+std::unique_ptr<Regex::Node> Regex::parseTerm() {
+  std::unique_ptr<Node> atom;
+  auto chr = peek();
+  switch (chr) {
+  case L'^':
+  case L'$':
+    _index++;
+    atom = createNode(NodeType::ASSERTION);
+    atom->opcode = chr == L'^' ? Opcode::LINE_START : Opcode::LINE_END;
+    break;
+  case L'(':
+    atom = parseGroup();
+    break;
+  case L'.':
+    _index++;
+    atom = createNode(NodeType::ANY);
+    break;
+  case L'[':
+    atom = parseClass();
+    break;
+  case L'\\':
+    atom = parseAtomEscape();
+    break;
+  case L'*':
+  case L'+':
+  case L'?':
+    error(L"Nothing to repeat");
+  case L'{': {
+    uint32_t min = 0, max = 0;
+    if (parseQuantifier(min, max)) {
+      error(L"Nothing to repeat");
+    }
+    _index++;
+    atom = createNode(NodeType::CHAR, chr);
+    break;
+  }
+  default:
+    _index++;
+    atom = createNode(NodeType::CHAR, chr);
+  }
+  uint32_t min = 0, max = 0;
+  if (!parseQuantifier(min, max)) {
+    return atom;
+  }
+  if (atom->type == NodeType::ASSERTION) {
+    error(L"Nothing to repeat");
+  }
+  if (min > max) {
+    error(L"numbers out of order in {} quantifier");
+  }
+  auto node = createNode(NodeType::REPEAT);
+  node->min = min;
+  node->max = max;
+  if (!isEnd() && peek() == L'?') {
+    _index++;
+    node->greedy = false;
+  }
+  node->children.push_back(std::move(atom));
+  return node;
+}
+
+std::unique_ptr<Regex::Node> Regex::parseGroup() {
+  _index++;
+  std::unique_ptr<Node> node;
+  if (!isEnd() && peek() == L'?') {
+    _index++;
+    if (isEnd()) {
+      error(L"Invalid group");
+    }
+    auto chr = peek();
+    _index++;
+    if (chr == L':') {
+      node = parseDisjunction();
+    } else if (chr == L'=' || chr == L'!') {
+      node = createNode(NodeType::LOOK);
+      node->opcode =
+          chr == L'=' ? Opcode::LOOKAHEAD : Opcode::NEGATIVE_LOOKAHEAD;
+      node->children.push_back(parseDisjunction());
+    } else if (chr == L'<' && !isEnd() &&
+               (peek() == L'=' || peek() == L'!')) {
+      node = createNode(NodeType::LOOK);
+      node->opcode =
+          peek() == L'=' ? Opcode::LOOKBEHIND : Opcode::NEGATIVE_LOOKBEHIND;
+      _index++;
+      node->children.push_back(parseDisjunction());
+    } else if (chr == L'<') {
+      _index = _source.find(L'>', _index) + 1;
+      node = createNode(NodeType::GROUP, ++_capture);
+      node->children.push_back(parseDisjunction());
+    } else {
+      error(L"Invalid group");
+    }
+  } else {
+    node = createNode(NodeType::GROUP, ++_capture);
+    node->children.push_back(parseDisjunction());
+  }
+  if (isEnd() || peek() != L')') {
+    error(L"Unterminated group");
+  }
+  _index++;
+  return node;
+}
+
+std::unique_ptr<Regex::Node> Regex::parseAtomEscape() {
+  _index++;
+  if (isEnd()) {
+    error(L"\\ at end of pattern");
+  }
+  auto chr = peek();
+  if (chr == L'b' || chr == L'B') {
+    _index++;
+    auto node = createNode(NodeType::ASSERTION);
+    node->opcode =
+        chr == L'b' ? Opcode::WORD_BOUNDARY : Opcode::NOT_WORD_BOUNDARY;
+    return node;
+  }
+  if (std::wcschr(L"dDwWsS", chr)) {
+    _index++;
+    CharClass cls{.negate = false};
+    addRanges(cls, chr);
+    for (auto &[from, to] : cls.ranges) {
+      for (auto c = from; c <= to && c < 128; c++) {
+        cls.ascii.set(c);
+      }
+    }
+    _classes.push_back(cls);
+    return createNode(NodeType::CLASS, (uint32_t)_classes.size() - 1);
+  }
+  if (chr >= L'1' && chr <= L'9') {
+    auto start = _index;
+    uint32_t value = 0;
+    while (!isEnd() && peek() >= L'0' && peek() <= L'9' &&
+           value * 10 + (peek() - L'0') <= _groups) {
+      value = value * 10 + (peek() - L'0');
+      _index++;
+    }
+    if (value != 0) {
+      return createNode(NodeType::BACKREF, value);
+    }
+    _index = start;
+    if (chr >= L'8') {
+      _index++;
+      return createNode(NodeType::CHAR, chr);
+    }
+    return createNode(NodeType::CHAR, parseOctal());
+  }
+  if (chr == L'k' && std::any_of(_names.begin(), _names.end(),
+                                  [](auto &name) { return !name.empty(); })) {
+    _index++;
+    if (isEnd() || peek() != L'<') {
+      error(L"Invalid named reference");
+    }
+    auto end = _source.find(L'>', _index);
+    if (end == std::wstring::npos) {
+      error(L"Invalid named reference");
+    }
+    auto name = _source.substr(_index + 1, end - _index - 1);
+    auto it = std::find(_names.begin(), _names.end(), name);
+    if (it == _names.end()) {
+      error(L"Invalid named capture referenced");
+    }
+    _index = end + 1;
+    return createNode(NodeType::BACKREF,
+                      (uint32_t)(it - _names.begin()) + 1);
+  }
+  return createNode(NodeType::CHAR, parseCharacterEscape());
+}
+
+std::unique_ptr<Regex::Node> Regex::parseClass() {
+  _index++;
+  CharClass cls{.negate = false};
+  if (!isEnd() && peek() == L'^') {
+    _index++;
+    cls.negate = true;
+  }
+  for (;;) {
+    if (isEnd()) {
+      error(L"Unterminated character class");
+    }
+    if (peek() == L']') {
+      _index++;
+      break;
+    }
+    bool isClass = false;
+    auto from = parseClassAtom(cls, isClass);
+    if (!isEnd() && peek() == L'-' && _index + 1 < _source.size() &&
+        _source[_index + 1] != L']') {
+      _index++;
+      bool isRangeClass = false;
+      auto to = parseClassAtom(cls, isRangeClass);
+      if (isClass || isRangeClass) {
+        if (!isClass) {
+          cls.ranges.push_back({from, from});
+        }
+        cls.ranges.push_back({L'-', L'-'});
+        if (!isRangeClass) {
+          cls.ranges.push_back({to, to});
+        }
+      } else {
+        if (from > to) {
+          error(L"Range out of order in character class");
+        }
+        cls.ranges.push_back({from, to});
+      }
+    } else if (!isClass) {
+      cls.ranges.push_back({from, from});
+    }
+  }
+  for (auto &[from, to] : cls.ranges) {
+    for (auto c = from; c <= to && c < 128; c++) {
+      cls.ascii.set(c);
+    }
+  }
+  _classes.push_back(cls);
+  return createNode(NodeType::CLASS, (uint32_t)_classes.size() - 1);
+}
+
+uint32_t Regex::parseOctal() {
+  uint32_t value = 0;
+  size_t count = 0;
+  while (!isEnd() && peek() >= L'0' && peek() <= L'7' && count < 3 &&
+         value * 8 + (peek() - L'0') <= 0377) {
+    value = value * 8 + (peek() - L'0');
+    _index++;
+    count++;
+  }
+  return value;
+}
+
+uint32_t Regex::parseClassAtom(CharClass &cls, bool &isClass) {
+  auto chr = peek();
+  _index++;
+  if (chr != L'\\') {
+    return chr;
+  }
+  if (isEnd()) {
+    error(L"\\ at end of pattern");
+  }
+  chr = peek();
+  if (std::wcschr(L"dDwWsS", chr)) {
+    _index++;
+    addRanges(cls, chr);
+    isClass = true;
+    return 0;
+  }
+  if (chr == L'b') {
+    _index++;
+    return L'\b';
+  }
+  if (chr == L'-') {
+    _index++;
+    return L'-';
+  }
+  if (chr >= L'1' && chr <= L'7') {
+    return parseOctal();
+  }
+  return parseCharacterEscape();
+}
+
+uint32_t Regex::parseCharacterEscape() {
+  auto chr = peek();
+  _index++;
+  uint32_t value = 0;
+  switch (chr) {
+  case L't':
+    return L'\t';
+  case L'n':
+    return L'\n';
+  case L'v':
+    return L'\v';
+  case L'f':
+    return L'\f';
+  case L'r':
+    return L'\r';
+  case L'0':
+    if (!isEnd() && peek() >= L'0' && peek() <= L'7') {
+      _index--;
+      return parseOctal();
+    }
+    return 0;
+  case L'c':
+    if (!isEnd() && std::iswalpha(peek()) && peek() < 128) {
+      value = peek() % 32;
+      _index++;
+      return value;
+    }
+    _index--;
+    return L'\\';
+  case L'x':
+    if (parseHex(2, value)) {
+      return value;
+    }
+    return chr;
+  case L'u':
+    if ((_flags & UNICODE) && !isEnd() && peek() == L'{') {
+      auto start = _index;
+      _index++;
+      value = 0;
+      while (!isEnd() && std::iswxdigit(peek()) && value <= 0x10ffff) {
+        auto digit = peek();
+        value = value * 16 +
+                (std::iswdigit(digit) ? digit - L'0'
+                                      : std::towlower(digit) - L'a' + 10);
+        _index++;
+      }
+      if (!isEnd() && peek() == L'}' && _index > start + 1 &&
+          value <= 0x10ffff) {
+        _index++;
+        return value;
+      }
+      error(L"Invalid Unicode escape");
+    }
+    if (parseHex(4, value)) {
+      return value;
+    }
+    return chr;
+  default:
+    return chr;
+  }
+}
+
+bool Regex::parseQuantifier(uint32_t &min, uint32_t &max) {
+  if (isEnd()) {
+    return false;
+  }
+  switch (peek()) {
+  case L'*':
+    _index++;
+    min = 0;
+    max = INFINITE;
+    return true;
+  case L'+':
+    _index++;
+    min = 1;
+    max = INFINITE;
+    return true;
+  case L'?':
+    _index++;
+    min = 0;
+    max = 1;
+    return true;
+  case L'{':
+    break;
+  default:
+    return false;
+  }
+  auto start = _index;
+  auto readNumber = [&](uint32_t &value) -> bool {
+    auto begin = _index;
+    uint64_t number = 0;
+    while (!isEnd() && peek() >= L'0' && peek() <= L'9') {
+      number = std::min<uint64_t>(number * 10 + (peek() - L'0'), INFINITE - 1);
+      _index++;
+    }
+    value = (uint32_t)number;
+    return _index != begin;
+  };
+  _index++;
+  if (!readNumber(min)) {
+    _index = start;
+    return false;
+  }
+  max = min;
+  if (!isEnd() && peek() == L',') {
+    _index++;
+    if (!isEnd() && peek() == L'}') {
+      max = INFINITE;
+    } else if (!readNumber(max)) {
+      _index = start;
+      return false;
+    }
+  }
+  if (isEnd() || peek() != L'}') {
+    _index = start;
+    return false;
+  }
+  _index++;
+  return true;
+}
+
+bool Regex::parseHex(size_t length, uint32_t &value) {
+  if (_index + length > _source.size()) {
+    return false;
+  }
+  uint32_t result = 0;
+  for (size_t index = 0; index < length; index++) {
+    auto digit = _source[_index + index];
+    if (!std::iswxdigit(digit)) {
+      return false;
+    }
+    result = result * 16 + (std::iswdigit(digit)
+                                ? digit - L'0'
+                                : std::towlower(digit) - L'a' + 10);
+  }
+  _index += length;
+  value = result;
+  return true;
+}
+
+bool Regex::isNullable(const Node *node) {
+  switch (node->type) {
+  case NodeType::CHAR:
+  case NodeType::ANY:
+  case NodeType::CLASS:
+    return false;
+  case NodeType::GROUP:
+    return isNullable(node->children[0].get());
+  case NodeType::SEQUENCE:
+    return std::all_of(node->children.begin(), node->children.end(),
+                       [](auto &child) { return isNullable(child.get()); });
+  case NodeType::ALTERNATIVE:
+    return std::any_of(node->children.begin(), node->children.end(),
+                       [](auto &child) { return isNullable(child.get()); });
+  case NodeType::REPEAT:
+    return node->min == 0 || isNullable(node->children[0].get());
+  default:
+    return true;
+  }
+}
+
+void Regex::getGroups(const Node *node, uint32_t &first, uint32_t &last) {
+  if (node->type == NodeType::GROUP) {
+    if (first == 0 || node->value < first) {
+      first = node->value;
+    }
+    last = std::max(last, node->value);
+  }
+  for (auto &child : node->children) {
+    getGroups(child.get(), first, last);
+  }
+}
+
+bool Regex::computeFirst(const Node *node) {
+  switch (node->type) {
+  case NodeType::CHAR:
+    if (node->value < 128) {
+      _first.set(node->value);
+      if (_flags & ICASE) {
+        _first.set(std::towlower(node->value));
+        _first.set(std::towupper(node->value));
+      }
+    } else {
+      _firstAny = true;
+    }
+    return false;
+  case NodeType::ANY:
+    _first.set();
+    _firstAny = true;
+    return false;
+  case NodeType::CLASS: {
+    auto &cls = _classes[node->value];
+    if (cls.negate) {
+      _first.set();
+      _firstAny = true;
+      return false;
+    }
+    for (auto &[from, to] : cls.ranges) {
+      for (auto c = from; c <= to && c < 128; c++) {
+        _first.set(c);
+        if (_flags & ICASE) {
+          _first.set(std::towlower(c));
+          _first.set(std::towupper(c));
+        }
+      }
+      if (to >= 128) {
+        _firstAny = true;
+      }
+    }
+    return false;
+  }
+  case NodeType::BACKREF:
+    _first.set();
+    _firstAny = true;
+    return true;
+  case NodeType::GROUP:
+    return computeFirst(node->children[0].get());
+  case NodeType::SEQUENCE:
+    for (auto &child : node->children) {
+      if (!computeFirst(child.get())) {
+        return false;
+      }
+    }
+    return true;
+  case NodeType::ALTERNATIVE: {
+    bool nullable = false;
+    for (auto &child : node->children) {
+      nullable = computeFirst(child.get()) || nullable;
+    }
+    return nullable;
+  }
+  case NodeType::REPEAT:
+    if (node->max == 0) {
+      return true;
+    }
+    return computeFirst(node->children[0].get()) || node->min == 0;
+  default:
+    return true;
+  }
+}
+
+uint32_t Regex::emit(Opcode opcode, uint32_t a, uint32_t b) {
+  if (_program.size() >= MAX_PROGRAM_SIZE) {
+    error(L"Regular expression too large");
+  }
+  Instruction instruction = {.opcode = opcode, .a = a, .b = b, .c = 0};
+  if (opcode == Opcode::SPLIT) {
+    instruction.c = _marks ? NO_MEMO : _splits++;
+  }
+  _program.push_back(instruction);
+  return (uint32_t)_program.size() - 1;
+}
+
+void Regex::compile(const Node *node) {
+  switch (node->type) {
+  case NodeType::EMPTY:
+    break;
+  case NodeType::CHAR:
+    emit(Opcode::CHAR,
+         (_flags & ICASE) ? canonicalize(node->value) : node->value);
+    break;
+  case NodeType::ANY:
+    emit(Opcode::ANY);
+    break;
+  case NodeType::CLASS:
+    emit(Opcode::CLASS, node->value);
+    break;
+  case NodeType::ASSERTION:
+    emit(node->opcode);
+    break;
+  case NodeType::GROUP:
+    emit(Opcode::SAVE, node->value * 2);
+    compile(node->children[0].get());
+    emit(Opcode::SAVE, node->value * 2 + 1);
+    break;
+  case NodeType::BACKREF:
+    _memoizable = false;
+    emit(Opcode::BACKREF, node->value);
+    break;
+  case NodeType::LOOK: {
+    _memoizable = false;
+    auto look = emit(node->opcode);
+    compile(node->children[0].get());
+    emit(Opcode::MATCH);
+    _program[look].a = (uint32_t)_program.size();
+    break;
+  }
+  case NodeType::SEQUENCE:
+    for (auto &child : node->children) {
+      compile(child.get());
+    }
+    break;
+  case NodeType::ALTERNATIVE: {
+    std::vector<uint32_t> jumps;
+    for (size_t index = 0; index < node->children.size(); index++) {
+      if (index + 1 == node->children.size()) {
+        compile(node->children[index].get());
+        break;
+      }
+      auto split = emit(Opcode::SPLIT);
+      _program[split].a = split + 1;
+      compile(node->children[index].get());
+      jumps.push_back(emit(Opcode::JMP));
+      _program[split].b = (uint32_t)_program.size();
+    }
+    for (auto &jump : jumps) {
+      _program[jump].a = (uint32_t)_program.size();
+    }
+    break;
+  }
+  case NodeType::REPEAT:
+    compileRepeat(node);
+    break;
+  }
+}
+
+void Regex::compileRepeat(const Node *node) {
+  auto child = node->children[0].get();
+  uint32_t first = 0, last = 0;
+  getGroups(child, first, last);
+  auto body = [&]() -> void {
+    if (first != 0) {
+      emit(Opcode::CLEAR, first, last);
+    }
+    compile(child);
+  };
+  for (uint32_t index = 0; index < node->min; index++) {
+    body();
+  }
+  if (node->max == INFINITE) {
+    auto nullable = isNullable(child);
+    auto loop = emit(Opcode::SPLIT);
+    uint32_t reg = 0;
+    if (nullable) {
+      reg = _registers++;
+      emit(Opcode::MARK, reg);
+      _marks++;
+    }
+    body();
+    if (nullable) {
+      _marks--;
+      emit(Opcode::CHECK, reg);
+    }
+    emit(Opcode::JMP, loop);
+    auto exit = (uint32_t)_program.size();
+    _program[loop].a = node->greedy ? loop + 1 : exit;
+    _program[loop].b = node->greedy ? exit : loop + 1;
+    return;
+  }
+  std::vector<uint32_t> splits;
+  for (uint32_t index = node->min; index < node->max; index++) {
+    splits.push_back(emit(Opcode::SPLIT));
+    body();
+  }
+  auto exit = (uint32_t)_program.size();
+  for (auto &split : splits) {
+    _program[split].a = node->greedy ? split + 1 : exit;
+    _program[split].b = node->greedy ? exit : split + 1;
+  }
+}
+
+bool Regex::matchClass(const CharClass &cls, uint32_t chr) const {
+  auto contains = [&](uint32_t c) -> bool {
+    if (c < 128) {
+      return cls.ascii.test(c);
+    }
+    for (auto &[from, to] : cls.ranges) {
+      if (c >= from && c <= to) {
+        return true;
+      }
+    }
+    return false;
+  };
+  auto found = contains(chr);
+  if (!found && (_flags & ICASE)) {
+    auto lower = (uint32_t)std::towlower(chr);
+    auto upper = (uint32_t)std::towupper(chr);
+    found = (lower != chr && contains(lower)) ||
+            (upper != chr && contains(upper));
+  }
+  return found != cls.negate;
+}
+
+bool Regex::canStart(uint32_t chr) const {
+  if (chr < 128) {
+    return _first.test(chr);
+  }
+  return _firstAny;
+}
+
+bool Regex::execute(const std::wstring &input, size_t start, uint32_t pc,
+                    int64_t end, std::vector<int64_t> &slots,
+                    std::vector<int64_t> &registers,
+                    std::vector<uint64_t> *memo) const {
+  std::vector<Frame> stack;
+  auto size = (int64_t)input.size();
+  auto sp = (int64_t)start;
+  auto icase = (_flags & ICASE) != 0;
+  for (;;) {
+    auto &instruction = _program[pc];
+    auto fail = false;
+    switch (instruction.opcode) {
+    case Opcode::CHAR:
+      if (sp < size && (icase ? canonicalize(input[sp]) : input[sp]) ==
+                           instruction.a) {
+        sp++;
+        pc++;
+      } else {
+        fail = true;
+      }
+      break;
+    case Opcode::ANY:
+      if (sp < size && ((_flags & DOTALL) || !isLineTerminator(input[sp]))) {
+        sp++;
+        pc++;
+      } else {
+        fail = true;
+      }
+      break;
+    case Opcode::CLASS:
+      if (sp < size && matchClass(_classes[instruction.a], input[sp])) {
+        sp++;
+        pc++;
+      } else {
+        fail = true;
+      }
+      break;
+    case Opcode::LINE_START:
+      if (sp == 0 ||
+          ((_flags & MULTILINE) && isLineTerminator(input[sp - 1]))) {
+        pc++;
+      } else {
+        fail = true;
+      }
+      break;
+    case Opcode::LINE_END:
+      if (sp == size || ((_flags & MULTILINE) && isLineTerminator(input[sp]))) {
+        pc++;
+      } else {
+        fail = true;
+      }
+      break;
+    case Opcode::WORD_BOUNDARY:
+    case Opcode::NOT_WORD_BOUNDARY: {
+      auto before = sp > 0 && isWordChar(input[sp - 1]);
+      auto after = sp < size && isWordChar(input[sp]);
+      if ((before != after) == (instruction.opcode == Opcode::WORD_BOUNDARY)) {
+        pc++;
+      } else {
+        fail = true;
+      }
+      break;
+    }
+    case Opcode::SPLIT:
+      if (memo && instruction.c != NO_MEMO) {
+        auto bit = (uint64_t)instruction.c * (size + 1) + sp;
+        auto &word = (*memo)[bit / 64];
+        auto mask = 1ULL << (bit % 64);
+        if (word & mask) {
+          fail = true;
+          break;
+        }
+        word |= mask;
+      }
+      stack.push_back({FRAME_BRANCH, instruction.b, sp});
+      pc = instruction.a;
+      break;
+    case Opcode::JMP:
+      pc = instruction.a;
+      break;
+    case Opcode::SAVE:
+      stack.push_back({FRAME_SLOT, instruction.a, slots[instruction.a]});
+      slots[instruction.a] = sp;
+      pc++;
+      break;
+    case Opcode::CLEAR:
+      for (auto slot = instruction.a * 2; slot <= instruction.b * 2 + 1;
+           slot++) {
+        stack.push_back({FRAME_SLOT, slot, slots[slot]});
+        slots[slot] = -1;
+      }
+      pc++;
+      break;
+    case Opcode::MARK:
+      stack.push_back(
+          {FRAME_REGISTER, instruction.a, registers[instruction.a]});
+      registers[instruction.a] = sp;
+      pc++;
+      break;
+    case Opcode::CHECK:
+      if (registers[instruction.a] == sp) {
+        fail = true;
+      } else {
+        pc++;
+      }
+      break;
+    case Opcode::BACKREF: {
+      auto from = slots[instruction.a * 2];
+      auto to = slots[instruction.a * 2 + 1];
+      if (from < 0 || to < 0) {
+        pc++;
+        break;
+      }
+      auto length = to - from;
+      if (sp + length > size) {
+        fail = true;
+        break;
+      }
+      for (int64_t index = 0; index < length; index++) {
+        auto left = input[from + index];
+        auto right = input[sp + index];
+        if (icase ? canonicalize(left) != canonicalize(right)
+                  : left != right) {
+          fail = true;
+          break;
+        }
+      }
+      if (!fail) {
+        sp += length;
+        pc++;
+      }
+      break;
+    }
+    case Opcode::LOOKAHEAD:
+    case Opcode::NEGATIVE_LOOKAHEAD:
+    case Opcode::LOOKBEHIND:
+    case Opcode::NEGATIVE_LOOKBEHIND: {
+      auto behind = instruction.opcode == Opcode::LOOKBEHIND ||
+                    instruction.opcode == Opcode::NEGATIVE_LOOKBEHIND;
+      auto positive = instruction.opcode == Opcode::LOOKAHEAD ||
+                      instruction.opcode == Opcode::LOOKBEHIND;
+      auto captured = slots;
+      auto regs = registers;
+      auto matched = false;
+      if (behind) {
+        for (auto from = sp; from >= 0 && !matched; from--) {
+          captured = slots;
+          regs = registers;
+          matched = execute(input, from, pc + 1, sp, captured, regs, nullptr);
+        }
+      } else {
+        matched = execute(input, sp, pc + 1, -1, captured, regs, nullptr);
+      }
+      if (matched != positive) {
+        fail = true;
+        break;
+      }
+      if (positive) {
+        for (uint32_t slot = 0; slot < slots.size(); slot++) {
+          if (captured[slot] != slots[slot]) {
+            stack.push_back({FRAME_SLOT, slot, slots[slot]});
+            slots[slot] = captured[slot];
+          }
+        }
+      }
+      pc = instruction.a;
+      break;
+    }
+    case Opcode::MATCH:
+      if (end < 0 || sp == end) {
+        return true;
+      }
+      fail = true;
+      break;
+    }
+    while (fail) {
+      if (stack.empty()) {
+        return false;
+      }
+      auto frame = stack.back();
+      stack.pop_back();
+      if (frame.kind == FRAME_SLOT) {
+        slots[frame.index] = frame.value;
+      } else if (frame.kind == FRAME_REGISTER) {
+        registers[frame.index] = frame.value;
+      } else {
+        pc = frame.index;
+        sp = frame.value;
+        fail = false;
+      }
+    }
+  }
+}
+
+const std::wstring &Regex::getSource() const { return _source; }
+
+uint32_t Regex::getFlags() const { return _flags; }
+
+uint32_t Regex::getGroupCount() const { return _groups; }
+
+const std::vector<std::wstring> &Regex::getGroupNames() const {
+  return _names;
+}
+
+bool Regex::match(const std::wstring &input, size_t lastIndex, bool sticky,
+                  std::vector<Capture> &captures) const {
+  auto size = input.size();
+  if (lastIndex > size) {
+    return false;
+  }
+  std::vector<int64_t> slots((_groups + 1) * 2, -1);
+  std::vector<int64_t> registers(_registers, -1);
+  std::vector<uint64_t> memo;
+  std::vector<uint64_t> *pmemo = nullptr;
+  if (_memoizable && _splits != 0 &&
+      (uint64_t)_splits * (size + 1) <= MAX_MEMO_BITS) {
+    memo.resize(((uint64_t)_splits * (size + 1) + 63) / 64);
+    pmemo = &memo;
+  }
+  for (auto start = lastIndex; start <= size; start++) {
+    if ((sticky || _anchored) && start != lastIndex) {
+      break;
+    }
+    if (!sticky && !_anchored) {
+      if (!_prefix.empty()) {
+        start = input.find(_prefix, start);
+        if (start == std::wstring::npos) {
+          break;
+        }
+      } else if (!_nullable) {
+        while (start < size && !canStart(input[start])) {
+          start++;
+        }
+        if (start == size) {
+          break;
+        }
+      }
+    }
+    std::fill(slots.begin(), slots.end(), -1);
+    std::fill(registers.begin(), registers.end(), -1);
+    if (execute(input, start, 0, -1, slots, registers, pmemo)) {
+      captures.resize(_groups + 1);
+      for (size_t index = 0; index <= _groups; index++) {
+        captures[index] = {slots[index * 2], slots[index * 2 + 1]};
+      }
+      return true;
+    }
+  }
+  return false;
+}
@@ -6,6 +6,7 @@
 #include "error/JSSyntaxError.hpp"
 #include "vm/JSAsmOperator.hpp"
 #include "vm/JSRegExpFlag.hpp"
+#include <atomic>
 #include <cstdint>
 #include <fmt/xchar.h>
 #include <string>
@@ -16,14 +17,23 @@ using namespace spark;
 using namespace spark::compiler;
 uint32_t JSGenerator::resolveConstant(common::AutoPtr<JSModule> &module,
                                       const std::wstring &source) {
-  auto it =
-      std::find(module->constants.begin(), module->constants.end(), source);
-  if (it != module->constants.end()) {
-    return it - module->constants.begin();
-  } else {
+  auto [it, inserted] = module->constantIndices.try_emplace(
+      source, (uint32_t)module->constants.size());
+  if (inserted) {
     module->constants.push_back(source);
-    return module->constants.size() - 1;
   }
+  return it->second;
+}
+
+uint32_t
+JSGenerator::resolveBigIntConstant(common::AutoPtr<JSModule> &module,
+                                   const std::wstring &source) {
+  auto [it, inserted] = module->bigintIndices.try_emplace(
+      source, (uint32_t)module->bigints.size());
+  if (inserted) {
+    module->bigints.push_back(common::BigInt<>(source));
+  }
+  return it->second;
 }
 
 void JSGenerator::resolveExport(JSGeneratorContext &ctx,
@@ -179,7 +189,7 @@ void JSGenerator::pushLexScope(JSGeneratorContext &ctx,
   auto s = new JSLexScope;
   s->parent = ctx.currentScope;
   ctx.currentScope = s;
-  pushScope(ctx, module, scope);
+  pushScope(ctx, module, scope, true);
 }
 
 void JSGenerator::popLexScope(JSGeneratorContext &ctx,
@@ -190,9 +200,13 @@ void JSGenerator::popLexScope(JSGeneratorContext &ctx,
   popScope(ctx, module);
 }
 
-void JSGenerator::pushScope(JSGeneratorContext &ctx,
+bool JSGenerator::pushScope(JSGeneratorContext &ctx,
                             common::AutoPtr<JSModule> &module,
-                            const common::AutoPtr<JSSourceScope> &scope) {
+                            const common::AutoPtr<JSSourceScope> &scope,
+                            bool force) {
+  if (!force && scope->declarations.empty()) {
+    return false;
+  }
   generate(module, vm::JSAsmOperator::PUSH_SCOPE);
   std::vector<JSSourceDeclaration> closures;
   for (auto &declar : scope->declarations) {
@@ -206,6 +220,7 @@ void JSGenerator::pushScope(JSGeneratorContext &ctx,
     resolveClosure(ctx, module, declar);
   }
   ctx.scopeChain++;
+  return true;
 }
 
 void JSGenerator::popScope(JSGeneratorContext &ctx,
@@ -237,9 +252,8 @@ void JSGenerator::resolveMemberChian(JSGeneratorContext &ctx,
     } else {
       resolveNode(ctx, module, n->left);
       if (n->right->type == JSNodeType::LITERAL_IDENTITY) {
-        generate(module, vm::JSAsmOperator::LOAD_CONST,
+        generate(module, vm::JSAsmOperator::GET_NAMED_FIELD,
                  n->right.cast<JSIdentifierLiteral>()->value);
-        generate(module, vm::JSAsmOperator::GET_FIELD);
       } else if (n->right->type == JSNodeType::PRIVATE_NAME) {
         auto f = n->right.cast<JSPrivateName>();
         if (n->left->type != JSNodeType::THIS) {
@@ -282,9 +296,8 @@ void JSGenerator::resolveMemberChian(JSGeneratorContext &ctx,
     resolveNode(ctx, module, n->left);
     offsets.push_back(module->codes.size() + sizeof(uint16_t));
     generate(module, vm::JSAsmOperator::JNULL, 0U);
-    generate(module, vm::JSAsmOperator::LOAD_CONST,
+    generate(module, vm::JSAsmOperator::GET_NAMED_FIELD,
              n->right.cast<JSIdentifierLiteral>()->value);
-    generate(module, vm::JSAsmOperator::GET_FIELD);
   } else if (node->type == JSNodeType::EXPRESSION_OPTIONAL_COMPUTED_MEMBER) {
     resolveNode(ctx, module, n->left);
     offsets.push_back(module->codes.size() + sizeof(uint16_t));
@@ -299,12 +312,23 @@ void JSGenerator::resolveStatements(JSGeneratorContext &ctx,
                                     common::AutoPtr<JSModule> &module,
                                     const JSNodeArray &nodes) {
   bool clean = false;
-  for (auto &item : nodes) {
+  for (size_t index = 0; index < nodes.size(); index++) {
+    auto &item = nodes[index];
     if (clean) {
       generate(module, vm::JSAsmOperator::POP, 1U);
       clean = false;
     }
+    if (item->type == JSNodeType::STATEMENT_EXPRESSION &&
+        index != nodes.size() - 1) {
+      ctx.discard =
+          item.cast<JSExpressionStatement>()->expression.getRawPointer();
+    }
     resolveNode(ctx, module, item);
+    ctx.discard = nullptr;
+    if (ctx.discarded) {
+      ctx.discarded = false;
+      continue;
+    }
     if (item->type == JSNodeType::STATEMENT_EXPRESSION) {
       auto expr = item.cast<JSExpressionStatement>()->expression;
       if (expr->type != JSNodeType::EXPRESSION_ASSIGMENT &&
@@ -338,7 +362,14 @@ void JSGenerator::resolveLiteralRegex(JSGeneratorContext &ctx,
   if (n->sticky) {
     flag |= vm::JSRegExpFlag::STICKY;
   }
-  generate(module, vm::JSAsmOperator::LOAD_CONST, n->value);
+  std::wstring source;
+  for (auto &chr : n->value) {
+    if (chr == L'\\') {
+      source += L'\\';
+    }
+    source += chr;
+  }
+  generate(module, vm::JSAsmOperator::LOAD_CONST, source);
   generate(module, vm::JSAsmOperator::PUSH_REGEX, flag);
 }
 
@@ -478,7 +509,8 @@ void JSGenerator::resolveLiteralBigint(JSGeneratorContext &ctx,
                                        common::AutoPtr<JSModule> &module,
                                        const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSBigIntLiteral>();
-  generate(module, vm::JSAsmOperator::PUSH_BIGINT, n->value);
+  generate(module, vm::JSAsmOperator::PUSH_BIGINT,
+           resolveBigIntConstant(module, n->value));
 }
 
 void JSGenerator::resolveThis(JSGeneratorContext &ctx,
@@ -535,9 +567,13 @@ void JSGenerator::resolveStatementBlock(JSGeneratorContext &ctx,
                                         common::AutoPtr<JSModule> &module,
                                         const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSBlockStatement>();
-  pushScope(ctx, module, n->scope);
+  auto loopBody = ctx.loopBody;
+  ctx.loopBody = false;
+  auto scoped = pushScope(ctx, module, n->scope, loopBody);
   resolveStatements(ctx, module, n->body);
-  popScope(ctx, module);
+  if (scoped) {
+    popScope(ctx, module);
+  }
 }
 
 void JSGenerator::resolveStatementDebugger(
@@ -792,34 +828,49 @@ void JSGenerator::resolveStatementTry(JSGeneratorContext &ctx,
                                       common::AutoPtr<JSModule> &module,
                                       const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSTryStatement>();
-  auto catchStart = (module->codes.size() + sizeof(uint16_t));
-  generate(module, vm::JSAsmOperator::TRY, 0U);
-  auto finallyStart = (module->codes.size() + sizeof(uint16_t));
+  JSExceptionHandler handler = {
+      .begin = (uint32_t)module->codes.size(),
+      .depth = (uint32_t)ctx.scopeChain,
+  };
+  JSExceptionHandler catchHandler = {.depth = (uint32_t)ctx.scopeChain};
+  std::vector<size_t> finallyStarts;
+  std::vector<size_t> ends;
+  resolveNode(ctx, module, n->try_);
+  handler.end = (uint32_t)module->codes.size();
   if (n->finally != nullptr) {
+    finallyStarts.push_back(module->codes.size() + sizeof(uint16_t));
     generate(module, vm::JSAsmOperator::DEFER, 0U);
   }
-  resolveNode(ctx, module, n->try_);
-  generate(module, vm::JSAsmOperator::END_TRY);
-  auto catchEnd = (module->codes.size() + sizeof(uint16_t));
+  ends.push_back(module->codes.size() + sizeof(uint16_t));
   generate(module, vm::JSAsmOperator::JMP, 0U);
   if (n->catch_ != nullptr) {
-    *(uint32_t *)(module->codes.data() + catchStart) =
-        (uint32_t)(module->codes.size());
+    handler.handle = (uint32_t)module->codes.size();
+    catchHandler.begin = handler.handle;
     resolveNode(ctx, module, n->catch_);
+    catchHandler.end = (uint32_t)module->codes.size();
+    if (n->finally != nullptr) {
+      finallyStarts.push_back(module->codes.size() + sizeof(uint16_t));
+      generate(module, vm::JSAsmOperator::DEFER, 0U);
+      ends.push_back(module->codes.size() + sizeof(uint16_t));
+      generate(module, vm::JSAsmOperator::JMP, 0U);
+    }
   }
-  *(uint32_t *)(module->codes.data() + catchEnd) =
-      (uint32_t)(module->codes.size());
   if (n->finally != nullptr) {
-    auto finallyEnd = (module->codes.size() + sizeof(uint16_t));
-    generate(module, vm::JSAsmOperator::JMP, 0U);
-    *(uint32_t *)(module->codes.data() + finallyStart) =
-        (uint32_t)(module->codes.size());
-    if (n->finally != nullptr) {
-      resolveNode(ctx, module, n->finally);
+    handler.defer = (uint32_t)module->codes.size();
+    catchHandler.defer = handler.defer;
+    for (auto offset : finallyStarts) {
+      *(uint32_t *)(module->codes.data() + offset) = handler.defer;
     }
+    resolveNode(ctx, module, n->finally);
     generate(module, vm::JSAsmOperator::END_DEFER);
-    *(uint32_t *)(module->codes.data() + finallyEnd) =
-        (uint32_t)(module->codes.size());
+  }
+  for (auto offset : ends) {
+    *(uint32_t *)(module->codes.data() + offset) =
+        (uint32_t)module->codes.size();
+  }
+  module->handlers.push_back(handler);
+  if (n->catch_ != nullptr && n->finally != nullptr) {
+    module->handlers.push_back(catchHandler);
   }
 }
 
@@ -828,12 +879,13 @@ void JSGenerator::resolveStatementTryCatch(
     const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSTryCatchStatement>();
   generate(module, vm::JSAsmOperator::PUSH_SCOPE);
+  ctx.scopeChain++;
   if (n->binding != nullptr) {
     generate(module, vm::JSAsmOperator::STORE,
              n->binding.cast<JSIdentifierLiteral>()->value);
   }
   resolveNode(ctx, module, n->statement);
-  generate(module, vm::JSAsmOperator::POP_SCOPE);
+  popScope(ctx, module);
 }
 
 void JSGenerator::resolveStatementWhile(JSGeneratorContext &ctx,
@@ -847,11 +899,14 @@ void JSGenerator::resolveStatementWhile(JSGeneratorContext &ctx,
   auto endOffset = module->codes.size() + sizeof(uint16_t);
   generate(module, vm::JSAsmOperator::JFALSE, 0U);
   generate(module, vm::JSAsmOperator::POP, 1U);
+  ctx.loopBody = true;
   resolveNode(ctx, module, n->body);
+  ctx.loopBody = false;
   generate(module, vm::JSAsmOperator::JMP, start);
-  auto end = (uint32_t)module->codes.size();
-  *(uint32_t *)(module->codes.data() + endOffset) = end;
+  *(uint32_t *)(module->codes.data() + endOffset) =
+      (uint32_t)module->codes.size();
   generate(module, vm::JSAsmOperator::POP, 1U);
+  auto end = (uint32_t)module->codes.size();
   auto &chunk = *_labels.rbegin();
   for (auto &[node, offset] : chunk.second) {
     if (node->type == JSNodeType::STATEMENT_BREAK) {
@@ -872,7 +927,9 @@ void JSGenerator::resolveStatementDoWhile(JSGeneratorContext &ctx,
   generate(module, vm::JSAsmOperator::PUSH_UNDEFINED);
   auto start = (uint32_t)module->codes.size();
   generate(module, vm::JSAsmOperator::POP, 1U);
+  ctx.loopBody = true;
   resolveNode(ctx, module, n->body);
+  ctx.loopBody = false;
   resolveNode(ctx, module, n->condition);
   auto condition = (uint32_t)module->codes.size();
   generate(module, vm::JSAsmOperator::JTRUE, start);
@@ -894,8 +951,8 @@ void JSGenerator::resolveStatementFor(JSGeneratorContext &ctx,
                                       const common::AutoPtr<JSNode> &node,
                                       const std::wstring &label) {
   auto n = node.cast<JSForStatement>();
+  auto scoped = pushScope(ctx, module, n->scope);
   _labels.push_back({{label, ctx.scopeChain}, {}});
-  pushScope(ctx, module, n->scope);
   if (n->init != nullptr) {
     resolveNode(ctx, module, n->init);
   }
@@ -908,23 +965,36 @@ void JSGenerator::resolveStatementFor(JSGeneratorContext &ctx,
   auto endOffset = module->codes.size() + sizeof(uint16_t);
   generate(module, vm::JSAsmOperator::JFALSE, 0U);
   generate(module, vm::JSAsmOperator::POP, 1U);
+  ctx.loopBody = true;
   resolveNode(ctx, module, n->body);
+  ctx.loopBody = false;
+  auto update = (uint32_t)module->codes.size();
   if (n->update != nullptr) {
+    ctx.discard = n->update.getRawPointer();
     resolveNode(ctx, module, n->update);
+    ctx.discard = nullptr;
+    if (ctx.discarded) {
+      ctx.discarded = false;
+    } else if (n->update->type != JSNodeType::EXPRESSION_ASSIGMENT) {
+      generate(module, vm::JSAsmOperator::POP, 1U);
+    }
   }
   generate(module, vm::JSAsmOperator::JMP, start);
-  auto end = (uint32_t)module->codes.size();
-  *(uint32_t *)(module->codes.data() + endOffset) = end;
+  *(uint32_t *)(module->codes.data() + endOffset) =
+      (uint32_t)module->codes.size();
   generate(module, vm::JSAsmOperator::POP, 1U);
+  auto end = (uint32_t)module->codes.size();
   auto &chunk = *_labels.rbegin();
   for (auto &[node, offset] : chunk.second) {
     if (node->type == JSNodeType::STATEMENT_BREAK) {
       *(uint32_t *)(module->codes.data() + offset) = end;
     } else {
-      *(uint32_t *)(module->codes.data() + offset) = start;
+      *(uint32_t *)(module->codes.data() + offset) = update;
     }
   }
-  popScope(ctx, module);
+  if (scoped) {
+    popScope(ctx, module);
+  }
   _labels.pop_back();
 }
 
@@ -943,9 +1013,9 @@ void JSGenerator::resolveStatementForIn(JSGeneratorContext &ctx,
   generate(module, vm::JSAsmOperator::POP, 1U); // remove done
   generate(module, vm::JSAsmOperator::POP, 1U); // remove res
   generate(module, vm::JSAsmOperator::NEXT);
-  pushScope(ctx, module, n->scope);
   auto endOffset = module->codes.size() + sizeof(uint16_t);
   generate(module, vm::JSAsmOperator::JTRUE, 0U);
+  pushScope(ctx, module, n->scope, true);
   generate(module, vm::JSAsmOperator::PUSH_VALUE, 2U);
   resolveVariableIdentifier(ctx, module, n->declaration);
   resolveNode(ctx, module, n->body);
@@ -953,7 +1023,6 @@ void JSGenerator::resolveStatementForIn(JSGeneratorContext &ctx,
   generate(module, vm::JSAsmOperator::JMP, start);
   auto end = (uint32_t)module->codes.size();
   *(uint32_t *)(module->codes.data() + endOffset) = end;
-  popScope(ctx, module);
   generate(module, vm::JSAsmOperator::POP, 1U);
   generate(module, vm::JSAsmOperator::POP, 1U);
   generate(module, vm::JSAsmOperator::POP, 1U);
@@ -984,9 +1053,9 @@ void JSGenerator::resolveStatementForOf(JSGeneratorContext &ctx,
   generate(module, vm::JSAsmOperator::POP, 1U); // remove done
   generate(module, vm::JSAsmOperator::POP, 1U); // remove res
   generate(module, vm::JSAsmOperator::NEXT);
-  pushScope(ctx, module, n->scope);
   auto endOffset = module->codes.size() + sizeof(uint16_t);
   generate(module, vm::JSAsmOperator::JTRUE, 0U);
+  pushScope(ctx, module, n->scope, true);
   generate(module, vm::JSAsmOperator::PUSH_VALUE, 2U);
   resolveVariableIdentifier(ctx, module, n->declaration);
   resolveNode(ctx, module, n->body);
@@ -994,7 +1063,6 @@ void JSGenerator::resolveStatementForOf(JSGeneratorContext &ctx,
   generate(module, vm::JSAsmOperator::JMP, start);
   auto end = (uint32_t)module->codes.size();
   *(uint32_t *)(module->codes.data() + endOffset) = end;
-  popScope(ctx, module);
   generate(module, vm::JSAsmOperator::POP, 1U);
   generate(module, vm::JSAsmOperator::POP, 1U);
   generate(module, vm::JSAsmOperator::POP, 1U);
@@ -1027,14 +1095,13 @@ void JSGenerator::resolveStatementForAwaitOf(
   generate(module, vm::JSAsmOperator::POP, 1U); // remove value
   generate(module, vm::JSAsmOperator::AWAIT_NEXT);
   generate(module, vm::JSAsmOperator::PUSH_VALUE, 1U);
-  generate(module, vm::JSAsmOperator::LOAD_CONST, L"value");
-  generate(module, vm::JSAsmOperator::GET_FIELD);
+  generate(module, vm::JSAsmOperator::GET_NAMED_FIELD, L"value");
   generate(module, vm::JSAsmOperator::PUSH_VALUE, 2U);
-  generate(module, vm::JSAsmOperator::LOAD_CONST, L"done");
-  generate(module, vm::JSAsmOperator::GET_FIELD); // gen,res,done,value
-  pushScope(ctx, module, n->scope);
+  generate(module, vm::JSAsmOperator::GET_NAMED_FIELD,
+           L"done"); // gen,res,done,value
   auto endOffset = module->codes.size() + sizeof(uint16_t);
   generate(module, vm::JSAsmOperator::JTRUE, 0U);
+  pushScope(ctx, module, n->scope, true);
   generate(module, vm::JSAsmOperator::PUSH_VALUE, 2U);
   resolveVariableIdentifier(ctx, module, n->declaration);
   resolveNode(ctx, module, n->body);
@@ -1042,7 +1109,6 @@ void JSGenerator::resolveStatementForAwaitOf(
   generate(module, vm::JSAsmOperator::JMP, start);
   auto end = (uint32_t)module->codes.size();
   *(uint32_t *)(module->codes.data() + endOffset) = end;
-  popScope(ctx, module);
   generate(module, vm::JSAsmOperator::POP, 1U);
   generate(module, vm::JSAsmOperator::POP, 1U);
   generate(module, vm::JSAsmOperator::POP, 1U);
@@ -1336,6 +1402,17 @@ void JSGenerator::resolveExpressionUnary(JSGeneratorContext &ctx,
                                          common::AutoPtr<JSModule> &module,
                                          const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSUnaryExpression>();
+  if (ctx.discard == node && (n->opt == L"++" || n->opt == L"--") &&
+      n->right->type == JSNodeType::LITERAL_IDENTITY) {
+    ctx.discard = nullptr;
+    ctx.discarded = true;
+    generate(module,
+             n->opt == L"++" ? vm::JSAsmOperator::INC_LOCAL
+                             : vm::JSAsmOperator::DEC_LOCAL,
+             n->right.cast<JSIdentifierLiteral>()->value);
+    return;
+  }
+  ctx.discard = nullptr;
   resolveNode(ctx, module, n->right);
   if (n->opt == L"!") {
     generate(module, vm::JSAsmOperator::LNOT);
@@ -1356,6 +1433,16 @@ void JSGenerator::resolveExpressionUpdate(JSGeneratorContext &ctx,
                                           common::AutoPtr<JSModule> &module,
                                           const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSUpdateExpression>();
+  if (ctx.discard == node && n->left->type == JSNodeType::LITERAL_IDENTITY) {
+    ctx.discard = nullptr;
+    ctx.discarded = true;
+    generate(module,
+             n->opt == L"++" ? vm::JSAsmOperator::INC_LOCAL
+                             : vm::JSAsmOperator::DEC_LOCAL,
+             n->left.cast<JSIdentifierLiteral>()->value);
+    return;
+  }
+  ctx.discard = nullptr;
   resolveNode(ctx, module, n->left);
   if (n->opt == L"++") {
     generate(module, vm::JSAsmOperator::INC, 1U);
@@ -1404,7 +1491,7 @@ void JSGenerator::resolveExpressionBinary(JSGeneratorContext &ctx,
       generate(module, vm::JSAsmOperator::USHR);
     } else if (n->opt == L">>") {
       generate(module, vm::JSAsmOperator::SHR);
-    } else if (n->opt == L">>") {
+    } else if (n->opt == L"<<") {
       generate(module, vm::JSAsmOperator::SHL);
     } else if (n->opt == L">=") {
       generate(module, vm::JSAsmOperator::GE);
@@ -1472,9 +1559,8 @@ void JSGenerator::resolveExpressionMember(JSGeneratorContext &ctx,
       generate(module, vm::JSAsmOperator::PUSH, ctx.currentClass);
       generate(module, vm::JSAsmOperator::GET_PRIVATE_FIELD);
     } else {
-      generate(module, vm::JSAsmOperator::LOAD_CONST,
+      generate(module, vm::JSAsmOperator::GET_NAMED_FIELD,
                n->right.cast<JSIdentifierLiteral>()->value);
-      generate(module, vm::JSAsmOperator::GET_FIELD);
     }
     for (auto &offset : offsets) {
       *(uint32_t *)(module->codes.data() + offset) =
@@ -1491,9 +1577,8 @@ void JSGenerator::resolveExpressionOptionalMember(
   resolveMemberChian(ctx, module, n->left, offsets);
   offsets.push_back(module->codes.size() + sizeof(uint16_t));
   generate(module, vm::JSAsmOperator::JNULL, 0U);
-  generate(module, vm::JSAsmOperator::LOAD_CONST,
+  generate(module, vm::JSAsmOperator::GET_NAMED_FIELD,
            n->right.cast<JSIdentifierLiteral>()->value);
-  generate(module, vm::JSAsmOperator::GET_FIELD);
   for (auto &offset : offsets) {
     *(uint32_t *)(module->codes.data() + offset) =
         (uint32_t)(module->codes.size());
@@ -1566,6 +1651,8 @@ void JSGenerator::resolveExpressionCall(JSGeneratorContext &ctx,
                                         common::AutoPtr<JSModule> &module,
                                         const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSCallExpression>();
+  auto discard = ctx.discard == node;
+  ctx.discard = nullptr;
   auto func = n->left;
   std::vector<size_t> offsets;
   vm::JSAsmOperator opt = vm::JSAsmOperator::CALL;
@@ -1644,6 +1731,15 @@ void JSGenerator::resolveExpressionCall(JSGeneratorContext &ctx,
   if (opt == vm::JSAsmOperator::MEMBER_PRIVATE_CALL) {
     generate(module, vm::JSAsmOperator::PUSH, ctx.currentClass);
   }
+  if (discard && offsets.empty()) {
+    if (opt == vm::JSAsmOperator::CALL) {
+      opt = vm::JSAsmOperator::CALL_DISCARD;
+      ctx.discarded = true;
+    } else if (opt == vm::JSAsmOperator::MEMBER_CALL) {
+      opt = vm::JSAsmOperator::MEMBER_CALL_DISCARD;
+      ctx.discarded = true;
+    }
+  }
   module->sourceMap[module->codes.size()] = node->location.start;
   generate(module, opt, (uint32_t)n->arguments.size());
   for (auto &offset : offsets) {
@@ -1882,8 +1978,7 @@ void JSGenerator::resolveClassMethod(JSGeneratorContext &ctx,
   auto n = node.cast<JSClassMethod>();
   if (!n->static_) {
     generate(module, vm::JSAsmOperator::PUSH_VALUE, 1U);
-    generate(module, vm::JSAsmOperator::LOAD_CONST, L"prototype");
-    generate(module, vm::JSAsmOperator::GET_FIELD);
+    generate(module, vm::JSAsmOperator::GET_NAMED_FIELD, L"prototype");
   }
   ctx.currentScope->functionDeclarations.push_back(
       (JSNode *)node.getRawPointer());
@@ -1960,8 +2055,7 @@ void JSGenerator::resolveClassAccessor(JSGeneratorContext &ctx,
   auto n = node.cast<JSClassAccessor>();
   if (!n->static_) {
     generate(module, vm::JSAsmOperator::PUSH_VALUE, 1U);
-    generate(module, vm::JSAsmOperator::LOAD_CONST, L"prototype");
-    generate(module, vm::JSAsmOperator::GET_FIELD);
+    generate(module, vm::JSAsmOperator::GET_NAMED_FIELD, L"prototype");
   }
   ctx.currentScope->functionDeclarations.push_back(
       (JSNode *)node.getRawPointer());
@@ -1998,10 +2092,11 @@ void JSGenerator::resolveStaticBlock(JSGeneratorContext &ctx,
                                      const common::AutoPtr<JSNode> &node) {
   auto n = node.cast<JSBlockStatement>();
   generate(module, vm::JSAsmOperator::PUSH_SCOPE);
+  ctx.scopeChain++;
   generate(module, vm::JSAsmOperator::PUSH_VALUE, 1U);
   generate(module, vm::JSAsmOperator::CREATE_CONST, L"this");
   resolveStatementBlock(ctx, module, node);
-  generate(module, vm::JSAsmOperator::POP_SCOPE);
+  popScope(ctx, module);
 }
 
 void JSGenerator::resolveImportDeclaration(
@@ -2209,6 +2304,8 @@ void JSGenerator::resolveDeclarationFunction(
     auto offset = ctx.currentScope->functionAddr.at(n->id);
     *(uint32_t *)(module->codes.data() + offset) =
         (uint32_t)module->codes.size();
+    auto scopeChain = ctx.scopeChain;
+    ctx.scopeChain = 0;
     pushLexScope(ctx, module, node->scope);
     if (n->arguments.size()) {
       generate(module, vm::JSAsmOperator::LOAD, L"arguments");
@@ -2243,11 +2340,14 @@ void JSGenerator::resolveDeclarationFunction(
       }
     }
     popLexScope(ctx, module);
+    ctx.scopeChain = scopeChain;
   } else {
     auto n = node.cast<JSFunctionDeclaration>();
     auto offset = ctx.currentScope->functionAddr.at(n->id);
     *(uint32_t *)(module->codes.data() + offset) =
         (uint32_t)module->codes.size();
+    auto scopeChain = ctx.scopeChain;
+    ctx.scopeChain = 0;
     pushLexScope(ctx, module, node->scope);
     if (n->arguments.size()) {
       generate(module, vm::JSAsmOperator::LOAD, L"arguments");
@@ -2284,6 +2384,7 @@ void JSGenerator::resolveDeclarationFunction(
     resolveNode(ctx, module, n->body);
     ctx.lexContextType = old;
     popLexScope(ctx, module);
+    ctx.scopeChain = scopeChain;
   }
 }
 
@@ -2392,7 +2493,7 @@ void JSGenerator::resolveDeclarationArray(JSGeneratorContext &ctx,
 void JSGenerator::resolveDeclarationClass(JSGeneratorContext &ctx,
                                           common::AutoPtr<JSModule> &module,
                                           const common::AutoPtr<JSNode> &node) {
-  static uint32_t identify = 0;
+  static std::atomic<uint32_t> identify = 0;
   auto n = node.cast<JSClassDeclaration>();
   auto oldClass = ctx.currentClass;
   ctx.currentClass = ++identify;
@@ -2535,6 +2636,15 @@ void JSGenerator::resolveDeclarationClass(JSGeneratorContext &ctx,
 void JSGenerator::resolveNode(JSGeneratorContext &ctx,
                               common::AutoPtr<JSModule> &module,
                               const common::AutoPtr<JSNode> &node) {
+  // statements are mapped as well, so any pc finds the line it belongs to;
+  // an instruction mapped for its own sake keeps its position
+  if ((node->type >= JSNodeType::STATEMENT_DEBUGGER &&
+       node->type <= JSNodeType::STATEMENT_EXPRESSION) ||
+      node->type == JSNodeType::VARIABLE_DECLARATION ||
+      node->type == JSNodeType::DECLARATION_FUNCTION_BODY) {
+    module->sourceMap.try_emplace((uint32_t)module->codes.size(),
+                                  node->location.start);
+  }
   switch (node->type) {
   case JSNodeType::LITERAL_REGEX:
     resolveLiteralRegex(ctx, module, node);
@@ -0,0 +1,469 @@
+#include "compiler/JSOptimizer.hpp"
+#include "common/AutoPtr.hpp"
+#include "compiler/base/JSModule.hpp"
+#include "vm/JSAsmOperator.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+using namespace spark;
+using namespace spark::compiler;
+
+static int32_t toInt32(double value) {
+  if (!std::isfinite(value)) {
+    return 0;
+  }
+  auto result = std::fmod(std::trunc(value), 4294967296.0);
+  if (result < 0) {
+    result += 4294967296.0;
+  }
+  return (int32_t)(uint32_t)result;
+}
+
+size_t JSOptimizer::getArgumentSize(const vm::JSAsmOperator &opt) {
+  switch (opt) {
+  case vm::JSAsmOperator::PUSH:
+  case vm::JSAsmOperator::SET_IMPORT_ATTRIBUTE:
+    return sizeof(uint64_t);
+  case vm::JSAsmOperator::PUSH_BIGINT:
+  case vm::JSAsmOperator::PUSH_REGEX:
+  case vm::JSAsmOperator::PUSH_VALUE:
+  case vm::JSAsmOperator::SET_FUNC_ADDRESS:
+  case vm::JSAsmOperator::SET_FUNC_NAME:
+  case vm::JSAsmOperator::SET_FUNC_LEN:
+  case vm::JSAsmOperator::SET_FUNC_SOURCE:
+  case vm::JSAsmOperator::SET_CLOSURE:
+  case vm::JSAsmOperator::SET_ACCESSOR:
+  case vm::JSAsmOperator::SET_PRIVATE_ACCESSOR:
+  case vm::JSAsmOperator::POP:
+  case vm::JSAsmOperator::STORE:
+  case vm::JSAsmOperator::CREATE:
+  case vm::JSAsmOperator::CREATE_CONST:
+  case vm::JSAsmOperator::LOAD:
+  case vm::JSAsmOperator::LOAD_CONST:
+  case vm::JSAsmOperator::NEW:
+  case vm::JSAsmOperator::REST_OBJECT:
+  case vm::JSAsmOperator::CALL:
+  case vm::JSAsmOperator::MEMBER_CALL:
+  case vm::JSAsmOperator::MEMBER_PRIVATE_CALL:
+  case vm::JSAsmOperator::SUPER_MEMBER_CALL:
+  case vm::JSAsmOperator::SUPER_CALL:
+  case vm::JSAsmOperator::OPTIONAL_CALL:
+  case vm::JSAsmOperator::MEMBER_OPTIONAL_CALL:
+  case vm::JSAsmOperator::CALL_DISCARD:
+  case vm::JSAsmOperator::MEMBER_CALL_DISCARD:
+  case vm::JSAsmOperator::INC:
+  case vm::JSAsmOperator::DEC:
+  case vm::JSAsmOperator::INC_LOCAL:
+  case vm::JSAsmOperator::DEC_LOCAL:
+  case vm::JSAsmOperator::GET_NAMED_FIELD:
+  case vm::JSAsmOperator::DEFER:
+  case vm::JSAsmOperator::JMP:
+  case vm::JSAsmOperator::JFALSE:
+  case vm::JSAsmOperator::JTRUE:
+  case vm::JSAsmOperator::JNOT_NULL:
+  case vm::JSAsmOperator::JNULL:
+  case vm::JSAsmOperator::IMPORT:
+  case vm::JSAsmOperator::IMPORT_MODULE:
+  case vm::JSAsmOperator::EXPORT:
+  case vm::JSAsmOperator::SETUP_DIRECTIVE:
+  case vm::JSAsmOperator::CLEANUP_DIRECTIVE:
+    return sizeof(uint32_t);
+  default:
+    return 0;
+  }
+}
+
+bool JSOptimizer::isAddress(const vm::JSAsmOperator &opt) {
+  switch (opt) {
+  case vm::JSAsmOperator::SET_FUNC_ADDRESS:
+  case vm::JSAsmOperator::DEFER:
+  case vm::JSAsmOperator::JMP:
+  case vm::JSAsmOperator::JFALSE:
+  case vm::JSAsmOperator::JTRUE:
+  case vm::JSAsmOperator::JNOT_NULL:
+  case vm::JSAsmOperator::JNULL:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool JSOptimizer::isTerminator(const vm::JSAsmOperator &opt) {
+  switch (opt) {
+  case vm::JSAsmOperator::JMP:
+  case vm::JSAsmOperator::RET:
+  case vm::JSAsmOperator::HLT:
+  case vm::JSAsmOperator::THROW:
+    return true;
+  default:
+    return false;
+  }
+}
+
+bool JSOptimizer::isConstant(const vm::JSAsmOperator &opt) {
+  switch (opt) {
+  case vm::JSAsmOperator::PUSH:
+  case vm::JSAsmOperator::PUSH_NULL:
+  case vm::JSAsmOperator::PUSH_UNDEFINED:
+  case vm::JSAsmOperator::PUSH_TRUE:
+  case vm::JSAsmOperator::PUSH_FALSE:
+  case vm::JSAsmOperator::LOAD_CONST:
+    return true;
+  default:
+    return false;
+  }
+}
+
+size_t JSOptimizer::next(const std::vector<JSInstruction> &instructions,
+                         size_t index) {
+  index++;
+  while (index < instructions.size() && instructions[index].removed) {
+    index++;
+  }
+  return index;
+}
+
+double JSOptimizer::getNumber(const JSInstruction &instruction) {
+  double value;
+  std::memcpy(&value, &instruction.arg, sizeof(double));
+  return value;
+}
+
+void JSOptimizer::setNumber(JSInstruction &instruction, double value) {
+  std::memcpy(&instruction.arg, &value, sizeof(double));
+}
+
+std::vector<JSOptimizer::JSInstruction>
+JSOptimizer::decode(const common::AutoPtr<JSModule> &module) {
+  std::vector<JSInstruction> instructions;
+  auto buffer = module->codes.data();
+  size_t offset = 0;
+  while (offset < module->codes.size()) {
+    JSInstruction instruction = {(uint32_t)offset, {}, 0, false};
+    instruction.opt = (vm::JSAsmOperator) * (uint16_t *)(buffer + offset);
+    offset += sizeof(uint16_t);
+    auto size = getArgumentSize(instruction.opt);
+    std::memcpy(&instruction.arg, buffer + offset, size);
+    offset += size;
+    instructions.push_back(instruction);
+  }
+  return instructions;
+}
+
+void JSOptimizer::encode(common::AutoPtr<JSModule> &module,
+                         const std::vector<JSInstruction> &instructions) {
+  std::vector<std::pair<uint32_t, uint32_t>> offsets;
+  uint32_t size = 0;
+  for (auto &instruction : instructions) {
+    offsets.push_back({instruction.offset, size});
+    size += sizeof(uint16_t) + getArgumentSize(instruction.opt);
+  }
+  auto resolve = [&](uint32_t offset) -> uint32_t {
+    auto it = std::lower_bound(
+        offsets.begin(), offsets.end(), offset,
+        [](const std::pair<uint32_t, uint32_t> &item, uint32_t offset) {
+          return item.first < offset;
+        });
+    if (it == offsets.end()) {
+      return size;
+    }
+    return it->second;
+  };
+  std::vector<uint8_t> codes;
+  codes.resize(size);
+  std::unordered_map<uint32_t, JSSourceLocation::Position> sourceMap;
+  auto buffer = codes.data();
+  for (auto &instruction : instructions) {
+    auto offset = resolve(instruction.offset);
+    if (module->sourceMap.contains(instruction.offset)) {
+      sourceMap[offset] = module->sourceMap.at(instruction.offset);
+    }
+    *(uint16_t *)(buffer + offset) = (uint16_t)instruction.opt;
+    auto arg = instruction.arg;
+    if (isAddress(instruction.opt)) {
+      arg = resolve((uint32_t)arg);
+    }
+    std::memcpy(buffer + offset + sizeof(uint16_t), &arg,
+                getArgumentSize(instruction.opt));
+  }
+  for (auto &handler : module->handlers) {
+    handler.begin = resolve(handler.begin);
+    handler.end = resolve(handler.end);
+    if (handler.handle != 0) {
+      handler.handle = resolve(handler.handle);
+    }
+    if (handler.defer != 0) {
+      handler.defer = resolve(handler.defer);
+    }
+  }
+  module->codes = codes;
+  module->sourceMap = sourceMap;
+}
+
+// Jump targets and the bounds of exception handlers are labels: code is
+// never merged across them and catch blocks, reached only through the
+// handler table, are not dead.
+std::set<uint32_t>
+JSOptimizer::resolveLabels(common::AutoPtr<JSModule> &module,
+                           std::vector<JSInstruction> &instructions,
+                           uint32_t end) {
+  std::set<uint32_t> labels;
+  auto resolve = [&](uint32_t &offset) -> void {
+    auto it = std::lower_bound(
+        instructions.begin(), instructions.end(), offset,
+        [](const JSInstruction &item, uint32_t offset) {
+          return item.offset < offset;
+        });
+    offset = it == instructions.end() ? end : it->offset;
+    labels.insert(offset);
+  };
+  for (auto &instruction : instructions) {
+    if (!isAddress(instruction.opt)) {
+      continue;
+    }
+    auto offset = (uint32_t)instruction.arg;
+    resolve(offset);
+    instruction.arg = offset;
+  }
+  for (auto &handler : module->handlers) {
+    resolve(handler.begin);
+    resolve(handler.end);
+    if (handler.handle != 0) {
+      resolve(handler.handle);
+    }
+    if (handler.defer != 0) {
+      resolve(handler.defer);
+    }
+  }
+  return labels;
+}
+
+bool JSOptimizer::foldConstant(std::vector<JSInstruction> &instructions,
+                               const std::set<uint32_t> &labels) {
+  bool changed = false;
+  for (size_t index = 0; index < instructions.size(); index++) {
+    auto &left = instructions[index];
+    if (left.removed || left.opt != vm::JSAsmOperator::PUSH) {
+      continue;
+    }
+    auto nextIndex = next(instructions, index);
+    if (nextIndex >= instructions.size() ||
+        labels.contains(instructions[nextIndex].offset)) {
+      continue;
+    }
+    auto &unary = instructions[nextIndex];
+    if (unary.opt == vm::JSAsmOperator::PLUS) {
+      unary.removed = true;
+      changed = true;
+      index--;
+      continue;
+    }
+    if (unary.opt == vm::JSAsmOperator::NETA) {
+      auto value = -getNumber(left);
+      if (value != 0 && std::isfinite(value)) {
+        setNumber(left, value);
+        unary.removed = true;
+        changed = true;
+        index--;
+      }
+      continue;
+    }
+    if (unary.opt != vm::JSAsmOperator::PUSH) {
+      continue;
+    }
+    auto &right = unary;
+    auto optIndex = next(instructions, nextIndex);
+    if (optIndex >= instructions.size() ||
+        labels.contains(instructions[optIndex].offset)) {
+      continue;
+    }
+    auto &opt = instructions[optIndex];
+    auto a = getNumber(left);
+    auto b = getNumber(right);
+    double value = NAN;
+    switch (opt.opt) {
+    case vm::JSAsmOperator::ADD:
+      value = a + b;
+      break;
+    case vm::JSAsmOperator::SUB:
+      value = a - b;
+      break;
+    case vm::JSAsmOperator::MUL:
+      value = a * b;
+      break;
+    case vm::JSAsmOperator::DIV:
+      value = a / b;
+      break;
+    case vm::JSAsmOperator::MOD:
+      value = std::fmod(a, b);
+      break;
+    case vm::JSAsmOperator::POW:
+      if (std::isfinite(a) && std::isfinite(b)) {
+        value = std::pow(a, b);
+      }
+      break;
+    case vm::JSAsmOperator::AND:
+      value = toInt32(a) & toInt32(b);
+      break;
+    case vm::JSAsmOperator::OR:
+      value = toInt32(a) | toInt32(b);
+      break;
+    case vm::JSAsmOperator::XOR:
+      value = toInt32(a) ^ toInt32(b);
+      break;
+    case vm::JSAsmOperator::SHL:
+      value = (int32_t)((uint32_t)toInt32(a) << (toInt32(b) & 0x1f));
+      break;
+    case vm::JSAsmOperator::SHR:
+      value = toInt32(a) >> (toInt32(b) & 0x1f);
+      break;
+    case vm::JSAsmOperator::USHR:
+      value = (uint32_t)toInt32(a) >> (toInt32(b) & 0x1f);
+      break;
+    default:
+      break;
+    }
+    if (value == 0 && std::signbit(value)) {
+      continue;
+    }
+    if (!std::isfinite(value)) {
+      continue;
+    }
+    setNumber(left, value);
+    right.removed = true;
+    opt.removed = true;
+    changed = true;
+    index--;
+  }
+  return changed;
+}
+
+bool JSOptimizer::threadJump(std::vector<JSInstruction> &instructions,
+                             uint32_t end) {
+  bool changed = false;
+  std::unordered_map<uint32_t, size_t> indices;
+  for (size_t index = 0; index < instructions.size(); index++) {
+    indices[instructions[index].offset] = index;
+  }
+  for (size_t index = 0; index < instructions.size(); index++) {
+    auto &instruction = instructions[index];
+    switch (instruction.opt) {
+    case vm::JSAsmOperator::JMP:
+    case vm::JSAsmOperator::JFALSE:
+    case vm::JSAsmOperator::JTRUE:
+    case vm::JSAsmOperator::JNULL:
+    case vm::JSAsmOperator::JNOT_NULL:
+      break;
+    default:
+      continue;
+    }
+    for (size_t hop = 0; hop < instructions.size(); hop++) {
+      if (!indices.contains((uint32_t)instruction.arg)) {
+        break;
+      }
+      auto &target = instructions[indices.at((uint32_t)instruction.arg)];
+      if (&target == &instruction) {
+        break;
+      }
+      if (target.opt != vm::JSAsmOperator::JMP &&
+          target.opt != instruction.opt) {
+        break;
+      }
+      if (target.arg == instruction.arg) {
+        break;
+      }
+      instruction.arg = target.arg;
+      changed = true;
+    }
+    auto nextIndex = next(instructions, index);
+    auto offset =
+        nextIndex < instructions.size() ? instructions[nextIndex].offset : end;
+    if (instruction.arg == offset) {
+      instruction.removed = true;
+      changed = true;
+    }
+  }
+  return changed;
+}
+
+bool JSOptimizer::removeDeadCode(std::vector<JSInstruction> &instructions,
+                                 const std::set<uint32_t> &labels) {
+  bool changed = false;
+  bool reachable = true;
+  for (auto &instruction : instructions) {
+    if (labels.contains(instruction.offset)) {
+      reachable = true;
+    }
+    if (instruction.removed) {
+      continue;
+    }
+    if (!reachable) {
+      instruction.removed = true;
+      changed = true;
+      continue;
+    }
+    if (isTerminator(instruction.opt)) {
+      reachable = false;
+    }
+  }
+  return changed;
+}
+
+bool JSOptimizer::peephole(std::vector<JSInstruction> &instructions,
+                           const std::set<uint32_t> &labels) {
+  bool changed = false;
+  for (size_t index = 0; index < instructions.size(); index++) {
+    auto &current = instructions[index];
+    if (current.removed) {
+      continue;
+    }
+    auto nextIndex = next(instructions, index);
+    if (nextIndex >= instructions.size() ||
+        labels.contains(instructions[nextIndex].offset)) {
+      continue;
+    }
+    auto &following = instructions[nextIndex];
+    if (current.opt == vm::JSAsmOperator::PUSH_SCOPE &&
+        following.opt == vm::JSAsmOperator::POP_SCOPE) {
+      current.removed = true;
+      following.removed = true;
+      changed = true;
+    } else if (isConstant(current.opt) &&
+               following.opt == vm::JSAsmOperator::POP &&
+               following.arg == 1) {
+      current.removed = true;
+      following.removed = true;
+      changed = true;
+    } else if (current.opt == vm::JSAsmOperator::POP &&
+               following.opt == vm::JSAsmOperator::POP) {
+      current.arg = (uint32_t)current.arg + (uint32_t)following.arg;
+      following.removed = true;
+      changed = true;
+      index--;
+    }
+  }
+  return changed;
+}
+
+void JSOptimizer::optimize(common::AutoPtr<JSModule> &module) {
+  auto end = (uint32_t)module->codes.size();
+  auto instructions = decode(module);
+  for (;;) {
+    auto labels = resolveLabels(module, instructions, end);
+    bool changed = false;
+    changed |= foldConstant(instructions, labels);
+    changed |= threadJump(instructions, end);
+    changed |= removeDeadCode(instructions, labels);
+    changed |= peephole(instructions, labels);
+    if (!changed) {
+      break;
+    }
+    std::erase_if(instructions,
+                  [](const JSInstruction &item) { return item.removed; });
+  }
+  encode(module, instructions);
+}
@@ -1,5 +1,6 @@
 #include "compiler/JSParser.hpp"
 #include "common/AutoPtr.hpp"
+#include "common/Number.hpp"
 #include "compiler/base/JSNode.hpp"
 #include "compiler/base/JSNodeType.hpp"
 #include "error/JSSyntaxError.hpp"
@@ -335,7 +336,8 @@ std::wstring JSParser::formatException(const std::wstring &message,
                                        const std::wstring &filename,
                                        const std::wstring &source,
                                        JSSourceLocation::Position position) {
-  static std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+  static thread_local std::wstring_convert<std::codecvt_utf8<wchar_t>>
+      converter;
   std::wstring line;
   std::wstring spaceLine;
   auto index = position.offset - position.column;
@@ -687,6 +689,17 @@ JSParser::readNumberToken(const std::wstring &filename,
           break;
         }
       }
+    } else if (chr == '0' && (source[current.offset + 1] == 'b' ||
+                              source[current.offset + 1] == 'B')) {
+      current.offset += 2;
+      for (;;) {
+        auto &chr = source[current.offset];
+        if (chr == '0' || chr == '1') {
+          current.offset++;
+        } else {
+          break;
+        }
+      }
     } else {
       bool dec = false;
       for (;;) {
@@ -760,6 +773,17 @@ JSParser::readBigIntToken(const std::wstring &filename,
           break;
         }
       }
+    } else if (chr == '0' && (source[current.offset + 1] == 'b' ||
+                              source[current.offset + 1] == 'B')) {
+      current.offset += 2;
+      for (;;) {
+        auto &chr = source[current.offset];
+        if (chr == '0' || chr == '1') {
+          current.offset++;
+        } else {
+          break;
+        }
+      }
     } else {
       for (;;) {
         auto &chr = source[current.offset];
@@ -2674,13 +2698,7 @@ JSParser::readNumberLiteral(const std::wstring &filename,
   if (token != nullptr) {
     common::AutoPtr node = new JSNumberLiteral;
     auto source = token->location.getSource(src);
-    if (source[0] == '0' && (source[1] == 'x' || source[1] == 'X')) {
-      node->value = (double)std::stol(source, nullptr, 16);
-    } else if (source[0] == '0' && (source[1] == 'o' && source[1] == 'O')) {
-      node->value = (double)std::stol(source, nullptr, 8);
-    } else {
-      node->value = std::stold(source);
-    }
+    node->value = common::Number::parse(source);
     node->location = token->location;
     position = current;
     return node;
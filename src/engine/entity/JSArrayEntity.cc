@@ -1,9 +1,11 @@
 #include "engine/entity/JSArrayEntity.hpp"
+#include "engine/base/JSElementsKind.hpp"
 #include "engine/base/JSValueType.hpp"
 #include "engine/entity/JSObjectEntity.hpp"
 using namespace spark;
 using namespace spark::engine;
-JSArrayEntity::JSArrayEntity(JSStore *prototype) : JSObjectEntity(prototype) {
+JSArrayEntity::JSArrayEntity(JSStore *prototype)
+    : JSObjectEntity(prototype), _kind(JSElementsKind::PACKED_SMI) {
   _type = JSValueType::JS_ARRAY;
 };
 
@@ -11,4 +13,14 @@ const std::vector<JSStore *> &JSArrayEntity::getItems() const {
   return _items;
 }
 
-std::vector<JSStore *> &JSArrayEntity::getItems() { return _items; }
\ No newline at end of file
+std::vector<JSStore *> &JSArrayEntity::getItems() { return _items; }
+
+JSElementsKind JSArrayEntity::getKind() const { return _kind; }
+
+bool JSArrayEntity::isPacked() const { return _kind != JSElementsKind::HOLEY; }
+
+void JSArrayEntity::transition(JSElementsKind kind) {
+  if (kind > _kind) {
+    _kind = kind;
+  }
+}
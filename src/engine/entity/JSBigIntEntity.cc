@@ -9,7 +9,7 @@ using namespace spark;
 using namespace spark::engine;
 
 JSBigIntEntity::JSBigIntEntity(const common::BigInt<> &val)
-    : JSEntity(JSValueType::JS_BIGINT), _value(common::BigInt<>(val)){};
+    : JSEntity(JSValueType::JS_BIGINT), _value(val){};
 
 const common::BigInt<> &JSBigIntEntity::getValue() const { return _value; }
 
@@ -1,7 +1,7 @@
 #include "engine/entity/JSNumberEntity.hpp"
+#include "common/Number.hpp"
 #include "engine/runtime/JSContext.hpp"
 #include "engine/base/JSValueType.hpp"
-#include <fmt/xchar.h>
 using namespace spark;
 using namespace spark::engine;
 
@@ -15,7 +15,7 @@ double &JSNumberEntity::getValue() {
 const double JSNumberEntity::getValue() const { return _value; }
 
 std::wstring JSNumberEntity::toString(common::AutoPtr<JSContext> ctx) const {
-  return fmt::format(L"{:g}", getValue());
+  return common::Number::toString(getValue());
 };
 
 std::optional<double>
@@ -54,7 +54,7 @@ JSObjectEntity::getPrivateProperties() {
 
 std::wstring JSObjectEntity::toString(common::AutoPtr<JSContext> ctx) const {
   std::wstring str = L"Object";
-  auto symbol = ctx->Symbol()->getProperty(ctx, L"toStringTag");
+  auto symbol = ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG);
   if (_symbolFields.contains(symbol->getStore())) {
     str =
         ctx->getScope()
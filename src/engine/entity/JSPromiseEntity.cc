@@ -11,14 +11,6 @@ void JSPromiseEntity::setValue(JSStore *value) { _value = value; }
 
 JSPromiseEntity::Status &JSPromiseEntity::getStatus() { return _status; }
 
-std::vector<JSStore *> &JSPromiseEntity::getFulfilledCallbacks() {
-  return _fulfilledCallbacks;
-}
-
-std::vector<JSStore *> &JSPromiseEntity::getRejectedCallbacks() {
-  return _rejectedCallbacks;
-}
-
-std::vector<JSStore *> &JSPromiseEntity::getFinallyCallbacks() {
-  return _finallyCallbacks;
+std::vector<JSPromiseEntity::Reaction> &JSPromiseEntity::getReactions() {
+  return _reactions;
 }
\ No newline at end of file
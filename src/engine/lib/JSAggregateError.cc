@@ -15,7 +15,7 @@ JS_FUNC(JSAggregateErrorConstructor::constructor) {
 common::AutoPtr<JSValue>
 JSAggregateErrorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   auto prototype =
-      ctx->createObject(ctx->Error()->getProperty(ctx, L"prototype"));
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::ERROR_PROTOTYPE));
   auto Error = ctx->createNativeFunction(&constructor, L"AggregateError",
                                          L"AggregateError");
   Error->setPropertyDescriptor(ctx, L"prototype", prototype);
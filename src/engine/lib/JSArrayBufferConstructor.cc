@@ -0,0 +1,118 @@
+#include "engine/lib/JSArrayBufferConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+JS_FUNC(JSArrayBufferConstructor::constructor) {
+  auto length = JSArrayBuffer::toIndex(
+      ctx, args.empty() ? ctx->undefined() : args[0], L"array buffer length");
+  self->setOpaque(common::AutoPtr<JSArrayBuffer>(new JSArrayBuffer(length)));
+  return ctx->undefined();
+}
+
+JS_FUNC(JSArrayBufferConstructor::isView) {
+  if (args.empty() || args[0]->getType() != JSValueType::JS_OBJECT) {
+    return ctx->falsely();
+  }
+  return ctx->createBoolean(args[0]->hasOpaque<JSTypedArray>() ||
+                            args[0]->hasOpaque<JSDataView>());
+}
+
+JS_FUNC(JSArrayBufferConstructor::getByteLength) {
+  return ctx->createNumber(
+      JSArrayBuffer::unwrap(self, L"get ArrayBuffer.prototype.byteLength")
+          ->getLength());
+}
+
+JS_FUNC(JSArrayBufferConstructor::getDetached) {
+  return ctx->createBoolean(
+      JSArrayBuffer::unwrap(self, L"get ArrayBuffer.prototype.detached")
+          ->isDetached());
+}
+
+JS_FUNC(JSArrayBufferConstructor::slice) {
+  auto buffer = JSArrayBuffer::unwrap(self, L"ArrayBuffer.prototype.slice");
+  auto length = buffer->getLength();
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 0 ? args[0] : nullptr, length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, length, length);
+  if (buffer->isDetached()) {
+    throw error::JSTypeError(L"Cannot perform ArrayBuffer.prototype.slice on "
+                             L"a detached ArrayBuffer");
+  }
+  common::AutoPtr<JSArrayBuffer> result =
+      new JSArrayBuffer(end > begin ? end - begin : 0);
+  std::memcpy(result->getData(), buffer->getData() + begin,
+              result->getLength());
+  auto object = ctx->createObject(self->getPrototype(ctx));
+  object->setOpaque(result);
+  return object;
+}
+
+// without a new length the bytes change owner and nothing is copied
+JS_FUNC(JSArrayBufferConstructor::transfer) {
+  auto buffer =
+      JSArrayBuffer::unwrap(self, L"ArrayBuffer.prototype.transfer");
+  auto resize = !args.empty() && !args[0]->isUndefined();
+  auto length = resize ? JSArrayBuffer::toIndex(ctx, args[0],
+                                                L"array buffer length")
+                       : buffer->getLength();
+  if (buffer->isDetached()) {
+    throw error::JSTypeError(L"Cannot perform ArrayBuffer.prototype.transfer "
+                             L"on a detached ArrayBuffer");
+  }
+  auto result = buffer->transfer();
+  if (resize && length != result->getLength()) {
+    common::AutoPtr<JSArrayBuffer> resized = new JSArrayBuffer(length);
+    std::memcpy(resized->getData(), result->getData(),
+                std::min(length, result->getLength()));
+    result = resized;
+  }
+  return JSArrayBuffer::create(ctx, result);
+}
+
+JS_FUNC(JSArrayBufferConstructor::toStringTag) {
+  return ctx->createString(L"ArrayBuffer");
+}
+
+common::AutoPtr<JSValue>
+JSArrayBufferConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto ArrayBuffer =
+      ctx->createNativeFunction(constructor, L"ArrayBuffer", L"ArrayBuffer");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", ArrayBuffer, true,
+                                   false);
+  ArrayBuffer->setPropertyDescriptor(ctx, L"prototype", prototype, true,
+                                     false);
+  ArrayBuffer->setPropertyDescriptor(
+      ctx, L"isView", ctx->createNativeFunction(isView, L"isView"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"byteLength",
+      ctx->createNativeFunction(getByteLength, L"byteLength"), nullptr, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"detached", ctx->createNativeFunction(getDetached, L"detached"),
+      nullptr, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"slice", ctx->createNativeFunction(slice, L"slice"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"transfer", ctx->createNativeFunction(transfer, L"transfer"), true,
+      false);
+  ctx->popScope();
+  return ArrayBuffer;
+}
@@ -1,16 +1,336 @@
 #include "engine/lib/JSArrayConstructor.hpp"
+#include "engine/base/JSElementsKind.hpp"
 #include "engine/base/JSValueType.hpp"
 #include "engine/entity/JSArrayEntity.hpp"
+#include "engine/entity/JSBigIntEntity.hpp"
+#include "engine/entity/JSBooleanEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/entity/JSNumberEntity.hpp"
+#include "engine/entity/JSStringEntity.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
 #include "engine/runtime/JSStore.hpp"
 #include "error/JSTypeError.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/xchar.h>
+#include <functional>
 #include <string>
+#include <vector>
 using namespace spark;
 using namespace spark::engine;
+
+static common::AutoPtr<JSValue>
+argument(common::AutoPtr<JSContext> ctx,
+         const std::vector<common::AutoPtr<JSValue>> &args, size_t index) {
+  return index < args.size() ? args[index] : ctx->undefined();
+}
+
+static common::AutoPtr<JSValue>
+getCallback(common::AutoPtr<JSContext> ctx,
+            const std::vector<common::AutoPtr<JSValue>> &args) {
+  auto callback = argument(ctx, args, 0);
+  if (!callback->isFunction()) {
+    throw error::JSTypeError(
+        fmt::format(L"{} is not a function",
+                    callback->toString(ctx)->getString().value()));
+  }
+  return callback;
+}
+
+static bool isArray(common::AutoPtr<JSValue> self) {
+  return self->getType() == JSValueType::JS_ARRAY;
+}
+
+static JSElementsKind getElementsKind(JSStore *item) {
+  if (item == nullptr) {
+    return JSElementsKind::HOLEY;
+  }
+  switch (item->getEntity()->getType()) {
+  case JSValueType::JS_NUMBER: {
+    auto value = item->getEntity().cast<JSNumberEntity>()->getValue();
+    if (value >= INT32_MIN && value <= INT32_MAX && value == (int32_t)value &&
+        (value != 0 || !std::signbit(value))) {
+      return JSElementsKind::PACKED_SMI;
+    }
+    return JSElementsKind::PACKED_DOUBLE;
+  }
+  case JSValueType::JS_NAN:
+  case JSValueType::JS_INFINITY:
+    return JSElementsKind::PACKED_DOUBLE;
+  case JSValueType::JS_UNINITIALIZED:
+    return JSElementsKind::HOLEY;
+  default:
+    return JSElementsKind::PACKED;
+  }
+}
+
+static common::AutoPtr<JSValue> createResult(common::AutoPtr<JSContext> ctx) {
+  auto prototype = ctx->getIntrinsic(JSIntrinsic::ARRAY_PROTOTYPE)->getStore();
+  auto result = ctx->createValue(new JSStore(new JSArrayEntity(prototype)));
+  result->getStore()->appendChild(prototype);
+  return result;
+}
+
+static void append(JSStore *store, JSStore *item) {
+  auto entity = store->getEntity().cast<JSArrayEntity>();
+  entity->getItems().push_back(item);
+  entity->transition(getElementsKind(item));
+  if (item != nullptr) {
+    store->appendChild(item);
+  }
+}
+
+static void checkFrozen(common::AutoPtr<JSContext> ctx,
+                        common::AutoPtr<JSValue> self) {
+  if (self->getEntity<JSObjectEntity>()->isFrozen()) {
+    throw error::JSTypeError(fmt::format(
+        L"Cannot assign to read only property 'length' of object '{}'",
+        self->toString(ctx)->getString().value()));
+  }
+}
+
+static size_t toLength(common::AutoPtr<JSContext> ctx,
+                       common::AutoPtr<JSValue> self) {
+  if (isArray(self)) {
+    return self->getEntity<JSArrayEntity>()->getItems().size();
+  }
+  auto length = self->getProperty(ctx, L"length")->toNumber(ctx)->getNumber();
+  if (!length.has_value() || !(length.value() > 0)) {
+    return 0;
+  }
+  return (size_t)std::min(std::trunc(length.value()), 9007199254740991.0);
+}
+
+static common::AutoPtr<JSValue> getItem(common::AutoPtr<JSContext> ctx,
+                                        common::AutoPtr<JSValue> self,
+                                        size_t index) {
+  if (isArray(self)) {
+    return self->getIndex(ctx, index);
+  }
+  return self->getProperty(ctx, ctx->createNumber(index));
+}
+
+static void setItem(common::AutoPtr<JSContext> ctx,
+                    common::AutoPtr<JSValue> self, size_t index,
+                    common::AutoPtr<JSValue> value) {
+  if (isArray(self)) {
+    self->setIndex(ctx, index, value);
+  } else {
+    self->setProperty(ctx, ctx->createNumber(index), value);
+  }
+}
+
+// Replaces count items at start with inserted and returns the removed
+// stores. Arrays are edited in place; other receivers go through the
+// generic property protocol.
+static std::vector<JSStore *>
+spliceItems(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self,
+            size_t start, size_t count,
+            const std::vector<common::AutoPtr<JSValue>> &inserted) {
+  std::vector<JSStore *> removed;
+  if (isArray(self)) {
+    checkFrozen(ctx, self);
+    auto store = self->getStore();
+    auto entity = self->getEntity<JSArrayEntity>();
+    auto &items = entity->getItems();
+    auto first = items.begin() + start;
+    removed.assign(first, first + count);
+    for (auto item : removed) {
+      if (item != nullptr) {
+        ctx->getScope()->getRoot()->appendChild(item);
+        store->removeChild(item);
+      }
+    }
+    if (count > inserted.size()) {
+      items.erase(first, first + (count - inserted.size()));
+    } else if (count < inserted.size()) {
+      items.insert(first, inserted.size() - count, nullptr);
+    }
+    first = items.begin() + start;
+    for (auto &value : inserted) {
+      auto item = (JSStore *)value->getStore();
+      *first++ = item;
+      entity->transition(getElementsKind(item));
+      store->appendChild(item);
+    }
+    return removed;
+  }
+  auto length = toLength(ctx, self);
+  for (size_t index = 0; index < count; index++) {
+    removed.push_back(getItem(ctx, self, start + index)->getStore());
+  }
+  if (inserted.size() < count) {
+    for (auto index = start; index + count < length; index++) {
+      setItem(ctx, self, index + inserted.size(),
+              getItem(ctx, self, index + count));
+    }
+    for (auto index = length; index > length - count + inserted.size();
+         index--) {
+      self->removeProperty(ctx, ctx->createNumber(index - 1));
+    }
+  } else if (inserted.size() > count) {
+    for (auto index = length - count; index > start; index--) {
+      setItem(ctx, self, index + inserted.size() - 1,
+              getItem(ctx, self, index + count - 1));
+    }
+  }
+  for (size_t index = 0; index < inserted.size(); index++) {
+    setItem(ctx, self, start + index, inserted[index]);
+  }
+  self->setProperty(ctx, L"length",
+                    ctx->createNumber(length - count + inserted.size()));
+  return removed;
+}
+
+// Items are moved as stores, so sorting never changes the array's edges.
+// Holes and undefined go to the tail as the specification requires.
+static common::AutoPtr<JSValue>
+sortItems(common::AutoPtr<JSContext> ctx, std::vector<JSStore *> &items,
+          common::AutoPtr<JSValue> comparator) {
+  std::vector<JSStore *> values;
+  std::vector<JSStore *> undefineds;
+  size_t holes = 0;
+  values.reserve(items.size());
+  for (auto item : items) {
+    if (item == nullptr ||
+        item->getEntity()->getType() == JSValueType::JS_UNINITIALIZED) {
+      holes++;
+    } else if (item->getEntity()->getType() == JSValueType::JS_UNDEFINED) {
+      undefineds.push_back(item);
+    } else {
+      values.push_back(item);
+    }
+  }
+  common::AutoPtr<JSValue> exception;
+  if (comparator->isUndefined()) {
+    std::vector<std::pair<std::wstring, JSStore *>> keyed;
+    keyed.reserve(values.size());
+    for (auto item : values) {
+      auto type = item->getEntity()->getType();
+      if (type == JSValueType::JS_STRING) {
+        keyed.push_back(
+            {item->getEntity().cast<JSStringEntity>()->getValue(), item});
+      } else if (type < JSValueType::JS_OBJECT) {
+        keyed.push_back({item->getEntity()->toString(ctx), item});
+      } else {
+        keyed.push_back(
+            {ctx->createValue(item)->toString(ctx)->getString().value(),
+             item});
+      }
+    }
+    std::stable_sort(keyed.begin(), keyed.end(),
+                     [](const auto &a, const auto &b) -> bool {
+                       return a.first < b.first;
+                     });
+    for (size_t index = 0; index < keyed.size(); index++) {
+      values[index] = keyed[index].second;
+    }
+  } else {
+    auto undefined = ctx->undefined();
+    std::stable_sort(
+        values.begin(), values.end(), [&](JSStore *a, JSStore *b) -> bool {
+          if (exception != nullptr) {
+            return false;
+          }
+          auto res = comparator->apply(
+              ctx, undefined, {ctx->createValue(a), ctx->createValue(b)});
+          if (res->getType() == JSValueType::JS_NUMBER) {
+            return res->getNumber().value() < 0;
+          }
+          if (res->isException()) {
+            exception = res;
+            return false;
+          }
+          return res->toNumber(ctx)->getNumber().value_or(0) < 0;
+        });
+  }
+  auto it = std::copy(values.begin(), values.end(), items.begin());
+  it = std::copy(undefineds.begin(), undefineds.end(), it);
+  std::fill_n(it, holes, nullptr);
+  return exception;
+}
+
+static bool sameValueZero(JSStore *item, common::AutoPtr<JSValue> search) {
+  if (item == nullptr) {
+    return search->isUndefined();
+  }
+  auto type = item->getEntity()->getType();
+  if (type != search->getType()) {
+    return false;
+  }
+  switch (type) {
+  case JSValueType::JS_UNDEFINED:
+  case JSValueType::JS_NULL:
+  case JSValueType::JS_NAN:
+    return true;
+  case JSValueType::JS_NUMBER:
+    return item->getEntity().cast<JSNumberEntity>()->getValue() ==
+           search->getNumber().value();
+  case JSValueType::JS_STRING:
+    return item->getEntity().cast<JSStringEntity>()->getValue() ==
+           search->getEntity<JSStringEntity>()->getValue();
+  case JSValueType::JS_BOOLEAN:
+    return item->getEntity().cast<JSBooleanEntity>()->getValue() ==
+           search->getEntity<JSBooleanEntity>()->getValue();
+  case JSValueType::JS_INFINITY:
+    return item->getEntity().cast<JSInfinityEntity>()->isNegative() ==
+           search->getEntity<JSInfinityEntity>()->isNegative();
+  case JSValueType::JS_BIGINT:
+    return item->getEntity().cast<JSBigIntEntity>()->getValue() ==
+           search->getEntity<JSBigIntEntity>()->getValue();
+  default:
+    return item->getEntity() == search->getEntity();
+  }
+}
+
+// Searches [from, to) forwards or backwards with SameValueZero, or with
+// strict equality when NaN must not match. Packed numeric arrays compare
+// the stored doubles directly.
+static int64_t searchItems(common::AutoPtr<JSContext> ctx,
+                           common::AutoPtr<JSValue> self,
+                           common::AutoPtr<JSValue> target, int64_t from,
+                           int64_t to, bool strict) {
+  auto step = from <= to ? 1 : -1;
+  if (strict && target->getType() == JSValueType::JS_NAN) {
+    return -1;
+  }
+  if (isArray(self)) {
+    auto entity = self->getEntity<JSArrayEntity>();
+    auto &items = entity->getItems();
+    if (target->getType() == JSValueType::JS_NUMBER &&
+        entity->getKind() <= JSElementsKind::PACKED_DOUBLE) {
+      auto value = target->getNumber().value();
+      for (auto index = from; index != to; index += step) {
+        auto item = items[index]->getEntity();
+        if (item->getType() == JSValueType::JS_NUMBER &&
+            item.cast<JSNumberEntity>()->getValue() == value) {
+          return index;
+        }
+      }
+      return -1;
+    }
+    for (auto index = from; index != to; index += step) {
+      if ((items[index] != nullptr || !strict) &&
+          sameValueZero(items[index], target)) {
+        return index;
+      }
+    }
+    return -1;
+  }
+  for (auto index = from; index != to; index += step) {
+    auto item = getItem(ctx, self, index);
+    if (sameValueZero(item->getStore(), target)) {
+      return index;
+    }
+  }
+  return -1;
+}
+
 JS_FUNC(JSArrayConstructor::constructor) {
   JSStore *store = nullptr;
   if (self == nullptr) {
     store = new JSStore(new JSArrayEntity(
-        ctx->Array()->getProperty(ctx, L"prototype")->getStore()));
+        ctx->getIntrinsic(JSIntrinsic::ARRAY_PROTOTYPE)->getStore()));
     self = ctx->createValue(store);
   } else {
     store = self->getStore();
@@ -53,6 +373,9 @@ JS_FUNC(JSArrayConstructor::setLength) {
     store->removeChild(e);
     entity->getItems().pop_back();
   }
+  if (entity->getItems().size() < len) {
+    entity->transition(JSElementsKind::PACKED);
+  }
   while (entity->getItems().size() < len) {
     auto e = ctx->undefined()->getStore();
     entity->getItems().push_back(e);
@@ -68,11 +391,25 @@ JS_FUNC(JSArrayConstructor::join) {
   if (args.size() > 0) {
     separator = args[0]->toString(ctx)->getString().value();
   }
+  std::wstring result;
+  if (self->getType() == JSValueType::JS_ARRAY &&
+      self->getEntity<JSArrayEntity>()->isPacked()) {
+    auto &items = self->getEntity<JSArrayEntity>()->getItems();
+    for (size_t index = 0; index < items.size(); index++) {
+      auto item = ctx->createValue(items[index]);
+      if (!item->isNull() && !item->isUndefined()) {
+        result += item->toString(ctx)->getString().value();
+      }
+      if (index != items.size() - 1) {
+        result += separator;
+      }
+    }
+    return ctx->createString(result);
+  }
   auto len = self->getProperty(ctx, L"length")->toNumber(ctx)->getNumber();
   if (!len.has_value()) {
     return ctx->createString();
   }
-  std::wstring result;
   auto length = (int64_t)len.value();
   for (size_t index = 0; index < length; index++) {
     auto item = self->getProperty(ctx, ctx->createNumber(index));
@@ -103,36 +440,363 @@ JS_FUNC(JSArrayConstructor::values) {
 }
 
 JS_FUNC(JSArrayConstructor::push) {
-  auto len = self->getProperty(ctx, L"length");
+  if (isArray(self)) {
+    auto entity = self->getEntity<JSArrayEntity>();
+    if (entity->isFrozen() || !entity->isExtensible()) {
+      throw error::JSTypeError(fmt::format(
+          L"Cannot add property {}, object is not extensible",
+          entity->getItems().size()));
+    }
+    for (auto &arg : args) {
+      append(self->getStore(), arg->getStore());
+    }
+    return ctx->createNumber(entity->getItems().size());
+  }
+  auto length = toLength(ctx, self);
   for (auto &arg : args) {
-    self->setProperty(ctx, len, arg);
-    len->increment(ctx);
+    setItem(ctx, self, length++, arg);
+  }
+  auto result = ctx->createNumber(length);
+  self->setProperty(ctx, L"length", result);
+  return result;
+}
+
+JS_FUNC(JSArrayConstructor::pop) {
+  auto length = toLength(ctx, self);
+  if (length == 0) {
+    if (!isArray(self)) {
+      self->setProperty(ctx, L"length", ctx->createNumber(0));
+    }
+    return ctx->undefined();
+  }
+  auto item = spliceItems(ctx, self, length - 1, 1, {})[0];
+  return item ? ctx->createValue(item) : ctx->undefined();
+}
+
+JS_FUNC(JSArrayConstructor::shift) {
+  if (toLength(ctx, self) == 0) {
+    if (!isArray(self)) {
+      self->setProperty(ctx, L"length", ctx->createNumber(0));
+    }
+    return ctx->undefined();
+  }
+  auto item = spliceItems(ctx, self, 0, 1, {})[0];
+  return item ? ctx->createValue(item) : ctx->undefined();
+}
+
+JS_FUNC(JSArrayConstructor::unshift) {
+  spliceItems(ctx, self, 0, 0, args);
+  return ctx->createNumber(toLength(ctx, self));
+}
+
+JS_FUNC(JSArrayConstructor::splice) {
+  auto length = toLength(ctx, self);
+  auto start = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 0 ? args[0] : nullptr, length, 0);
+  auto count = length - start;
+  if (args.empty()) {
+    count = 0;
+  } else if (args.size() > 1) {
+    auto value = args[1]->toNumber(ctx)->getNumber().value_or(0);
+    count = (size_t)std::clamp(std::trunc(value), 0.0, (double)count);
+  }
+  std::vector<common::AutoPtr<JSValue>> inserted;
+  if (args.size() > 2) {
+    inserted.assign(args.begin() + 2, args.end());
+  }
+  auto result = createResult(ctx);
+  for (auto item : spliceItems(ctx, self, start, count, inserted)) {
+    append(result->getStore(), item);
+  }
+  return result;
+}
+
+JS_FUNC(JSArrayConstructor::slice) {
+  auto length = toLength(ctx, self);
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 0 ? args[0] : nullptr, length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, length, length);
+  auto result = createResult(ctx);
+  auto store = result->getStore();
+  if (isArray(self)) {
+    auto &items = self->getEntity<JSArrayEntity>()->getItems();
+    if (begin < end) {
+      result->getEntity<JSArrayEntity>()->getItems().reserve(end - begin);
+    }
+    for (auto index = begin; index < end; index++) {
+      append(store, items[index]);
+    }
+    return result;
+  }
+  for (auto index = begin; index < end; index++) {
+    append(store, getItem(ctx, self, index)->getStore());
+  }
+  return result;
+}
+
+JS_FUNC(JSArrayConstructor::concat) {
+  auto result = createResult(ctx);
+  auto store = result->getStore();
+  std::vector<common::AutoPtr<JSValue>> sources = {self};
+  sources.insert(sources.end(), args.begin(), args.end());
+  for (auto &source : sources) {
+    if (isArray(source)) {
+      for (auto item : source->getEntity<JSArrayEntity>()->getItems()) {
+        append(store, item);
+      }
+    } else {
+      append(store, source->getStore());
+    }
+  }
+  return result;
+}
+
+JS_FUNC(JSArrayConstructor::reverse) {
+  if (isArray(self)) {
+    checkFrozen(ctx, self);
+    auto &items = self->getEntity<JSArrayEntity>()->getItems();
+    std::reverse(items.begin(), items.end());
+    return self;
   }
-  return len;
+  auto length = toLength(ctx, self);
+  for (size_t lower = 0; lower < length / 2; lower++) {
+    auto upper = length - lower - 1;
+    auto value = getItem(ctx, self, lower);
+    setItem(ctx, self, lower, getItem(ctx, self, upper));
+    setItem(ctx, self, upper, value);
+  }
+  return self;
 }
+
+JS_FUNC(JSArrayConstructor::sort) {
+  auto comparator = argument(ctx, args, 0);
+  if (!comparator->isUndefined() && !comparator->isFunction()) {
+    throw error::JSTypeError(
+        L"The comparison function must be either a function or undefined");
+  }
+  if (isArray(self)) {
+    checkFrozen(ctx, self);
+    auto &items = self->getEntity<JSArrayEntity>()->getItems();
+    std::vector<JSStore *> sorted = items;
+    auto exception = sortItems(ctx, sorted, comparator);
+    if (exception != nullptr) {
+      return exception;
+    }
+    if (sorted.size() == items.size()) {
+      items = sorted;
+    }
+    return self;
+  }
+  auto length = toLength(ctx, self);
+  std::vector<JSStore *> items;
+  for (size_t index = 0; index < length; index++) {
+    items.push_back(getItem(ctx, self, index)->getStore());
+  }
+  auto exception = sortItems(ctx, items, comparator);
+  if (exception != nullptr) {
+    return exception;
+  }
+  for (size_t index = 0; index < length; index++) {
+    setItem(ctx, self, index, ctx->createValue(items[index]));
+  }
+  return self;
+}
+
+JS_FUNC(JSArrayConstructor::fill) {
+  auto value = argument(ctx, args, 0);
+  auto length = toLength(ctx, self);
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 2 ? args[2] : nullptr, length, length);
+  for (auto index = begin; index < end; index++) {
+    setItem(ctx, self, index, ctx->createValue(value));
+  }
+  return self;
+}
+
+JS_FUNC(JSArrayConstructor::at) {
+  auto length = toLength(ctx, self);
+  auto index = 0.0;
+  if (!args.empty()) {
+    index = std::trunc(args[0]->toNumber(ctx)->getNumber().value_or(0));
+  }
+  if (index < 0) {
+    index += length;
+  }
+  if (index < 0 || index >= length) {
+    return ctx->undefined();
+  }
+  return getItem(ctx, self, (size_t)index);
+}
+
+JS_FUNC(JSArrayConstructor::indexOf) {
+  auto length = toLength(ctx, self);
+  auto from = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, length, 0);
+  return ctx->createNumber(
+      searchItems(ctx, self, argument(ctx, args, 0), from, length, true));
+}
+
+JS_FUNC(JSArrayConstructor::lastIndexOf) {
+  auto length = toLength(ctx, self);
+  int64_t from = (int64_t)length - 1;
+  if (args.size() > 1) {
+    auto value = std::trunc(args[1]->toNumber(ctx)->getNumber().value_or(0));
+    if (value < 0) {
+      value += length;
+    }
+    from = (int64_t)std::min(value, (double)length - 1);
+  }
+  if (from < 0) {
+    return ctx->createNumber(-1);
+  }
+  return ctx->createNumber(
+      searchItems(ctx, self, argument(ctx, args, 0), from, -1, true));
+}
+
+JS_FUNC(JSArrayConstructor::includes) {
+  auto length = toLength(ctx, self);
+  auto from = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, length, 0);
+  return ctx->createBoolean(
+      searchItems(ctx, self, argument(ctx, args, 0), from, length, false) >= 0);
+}
+
 JS_FUNC(JSArrayConstructor::forEach) {
-  auto len = self->getProperty(ctx, L"length");
-  auto index = ctx->createNumber();
-  while (index->lt(ctx, len)->getBoolean().value()) {
-    args[0]->apply(ctx, ctx->undefined(),
-                   {self->getProperty(ctx, index), index, self});
-    index->increment(ctx);
+  auto callback = getCallback(ctx, args);
+  auto thisArg = argument(ctx, args, 1);
+  auto length = toLength(ctx, self);
+  for (size_t index = 0; index < length; index++) {
+    auto res = callback->apply(
+        ctx, thisArg,
+        {getItem(ctx, self, index), ctx->createNumber(index), self});
+    if (res->isException()) {
+      return res;
+    }
   }
   return ctx->undefined();
 }
+
 JS_FUNC(JSArrayConstructor::map) {
-  auto result = ctx->createArray();
-  auto len = self->getProperty(ctx, L"length");
-  auto index = ctx->createNumber();
-  while (index->lt(ctx, len)->getBoolean().value()) {
-    auto res = args[0]->apply(ctx, ctx->undefined(),
-                              {self->getProperty(ctx, index), index, self});
-    result->setProperty(ctx, index, res);
-    index->increment(ctx);
+  auto callback = getCallback(ctx, args);
+  auto thisArg = argument(ctx, args, 1);
+  auto length = toLength(ctx, self);
+  auto result = createResult(ctx);
+  result->getEntity<JSArrayEntity>()->getItems().reserve(length);
+  for (size_t index = 0; index < length; index++) {
+    auto res = callback->apply(
+        ctx, thisArg,
+        {getItem(ctx, self, index), ctx->createNumber(index), self});
+    if (res->isException()) {
+      return res;
+    }
+    append(result->getStore(), res->getStore());
   }
   return result;
 }
 
+JS_FUNC(JSArrayConstructor::filter) {
+  auto callback = getCallback(ctx, args);
+  auto thisArg = argument(ctx, args, 1);
+  auto length = toLength(ctx, self);
+  auto result = createResult(ctx);
+  for (size_t index = 0; index < length; index++) {
+    auto item = getItem(ctx, self, index);
+    auto res =
+        callback->apply(ctx, thisArg, {item, ctx->createNumber(index), self});
+    if (res->isException()) {
+      return res;
+    }
+    if (res->toBoolean(ctx)->getBoolean().value()) {
+      append(result->getStore(), item->getStore());
+    }
+  }
+  return result;
+}
+
+JS_FUNC(JSArrayConstructor::every) {
+  auto callback = getCallback(ctx, args);
+  auto thisArg = argument(ctx, args, 1);
+  auto length = toLength(ctx, self);
+  for (size_t index = 0; index < length; index++) {
+    auto res = callback->apply(
+        ctx, thisArg,
+        {getItem(ctx, self, index), ctx->createNumber(index), self});
+    if (res->isException()) {
+      return res;
+    }
+    if (!res->toBoolean(ctx)->getBoolean().value()) {
+      return ctx->falsely();
+    }
+  }
+  return ctx->truly();
+}
+
+JS_FUNC(JSArrayConstructor::some) {
+  auto callback = getCallback(ctx, args);
+  auto thisArg = argument(ctx, args, 1);
+  auto length = toLength(ctx, self);
+  for (size_t index = 0; index < length; index++) {
+    auto res = callback->apply(
+        ctx, thisArg,
+        {getItem(ctx, self, index), ctx->createNumber(index), self});
+    if (res->isException()) {
+      return res;
+    }
+    if (res->toBoolean(ctx)->getBoolean().value()) {
+      return ctx->truly();
+    }
+  }
+  return ctx->falsely();
+}
+
+template <bool REVERSE, bool INDEX> JS_FUNC(JSArrayConstructor::find) {
+  auto callback = getCallback(ctx, args);
+  auto thisArg = argument(ctx, args, 1);
+  auto length = toLength(ctx, self);
+  for (size_t step = 0; step < length; step++) {
+    auto index = REVERSE ? length - step - 1 : step;
+    auto item = getItem(ctx, self, index);
+    auto res =
+        callback->apply(ctx, thisArg, {item, ctx->createNumber(index), self});
+    if (res->isException()) {
+      return res;
+    }
+    if (res->toBoolean(ctx)->getBoolean().value()) {
+      return INDEX ? ctx->createNumber(index) : item;
+    }
+  }
+  return INDEX ? ctx->createNumber(-1) : ctx->undefined();
+}
+
+template <bool REVERSE> JS_FUNC(JSArrayConstructor::reduce) {
+  auto callback = getCallback(ctx, args);
+  auto length = toLength(ctx, self);
+  size_t step = 0;
+  common::AutoPtr<JSValue> accumulator;
+  if (args.size() > 1) {
+    accumulator = args[1];
+  } else if (length == 0) {
+    return ctx->createException(
+        error::JSTypeError(L"Reduce of empty array with no initial value"));
+  } else {
+    accumulator = getItem(ctx, self, REVERSE ? length - 1 : 0);
+    step = 1;
+  }
+  for (; step < length; step++) {
+    auto index = REVERSE ? length - step - 1 : step;
+    accumulator = callback->apply(ctx, ctx->undefined(),
+                                  {accumulator, getItem(ctx, self, index),
+                                   ctx->createNumber(index), self});
+    if (accumulator->isException()) {
+      return accumulator;
+    }
+  }
+  return accumulator;
+}
+
 JS_FUNC(JSArrayConstructor::iterator_next) {
   if (!self->hasOpaque<JSArrayIteratorContext>()) {
     throw error::JSTypeError(
@@ -163,8 +827,7 @@ JS_FUNC(JSArrayConstructor::toString) {
       join->getType() == JSValueType::JS_NATIVE_FUNCTION) {
     return join->apply(ctx, self);
   }
-  return ctx->Object()
-      ->getProperty(ctx, L"prototype")
+  return ctx->getIntrinsic(JSIntrinsic::OBJECT_PROTOTYPE)
       ->getProperty(ctx, L"toString")
       ->apply(ctx, self);
 }
@@ -184,7 +847,7 @@ JSArrayConstructor::initialize(common::AutoPtr<JSContext> ctx) {
       ctx->createNativeFunction(setLength), true, false);
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"toStringTag"),
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
       ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
       false);
 
@@ -195,15 +858,37 @@ JSArrayConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   prototype->setPropertyDescriptor(
       ctx, L"join", ctx->createNativeFunction(join, L"join"), true, false);
 
-  prototype->setPropertyDescriptor(
-      ctx, L"push", ctx->createNativeFunction(push, L"push"), true, false);
-
-  prototype->setPropertyDescriptor(
-      ctx, L"forEach", ctx->createNativeFunction(forEach, L"forEach"), true,
-      false);
-  
-  prototype->setPropertyDescriptor(
-      ctx, L"map", ctx->createNativeFunction(map, L"map"), true, false);
+  std::vector<std::pair<std::wstring, std::function<JSFunction>>> methods = {
+      {L"push", push},
+      {L"pop", pop},
+      {L"shift", shift},
+      {L"unshift", unshift},
+      {L"splice", splice},
+      {L"slice", slice},
+      {L"concat", concat},
+      {L"reverse", reverse},
+      {L"sort", sort},
+      {L"fill", fill},
+      {L"at", at},
+      {L"indexOf", indexOf},
+      {L"lastIndexOf", lastIndexOf},
+      {L"includes", includes},
+      {L"forEach", forEach},
+      {L"map", map},
+      {L"filter", filter},
+      {L"every", every},
+      {L"some", some},
+      {L"find", find<false, false>},
+      {L"findIndex", find<false, true>},
+      {L"findLast", find<true, false>},
+      {L"findLastIndex", find<true, true>},
+      {L"reduce", reduce<false>},
+      {L"reduceRight", reduce<true>},
+  };
+  for (auto &[name, method] : methods) {
+    prototype->setPropertyDescriptor(
+        ctx, name, ctx->createNativeFunction(method, name), true, false);
+  }
 
   auto values =
       ctx->createNativeFunction(JSArrayConstructor::values, L"values");
@@ -211,7 +896,8 @@ JSArrayConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   prototype->setPropertyDescriptor(ctx, L"values", values, true, false);
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"iterator"), values, true, false);
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR), values, true,
+      false);
   ctx->popScope();
   return Array;
 }
\ No newline at end of file
@@ -1,22 +1,52 @@
 #include "engine/lib/JSAsyncFunctionConstructor.hpp"
 #include "common/AutoPtr.hpp"
 #include "engine/base/JSValueType.hpp"
+#include "engine/lib/JSGeneratorConstructor.hpp"
+#include "engine/lib/JSPromiseConstructor.hpp"
 #include "engine/runtime/JSContext.hpp"
+#include "vm/JSCoroutineContext.hpp"
 #include <fmt/xchar.h>
 using namespace spark;
 using namespace spark::engine;
+
+// Runs an async frame up to its next await or to completion. An exception
+// as value is thrown at the suspended await. Awaited promises hold the
+// frame until they settle and resume it from the microtask queue.
+common::AutoPtr<JSValue>
+JSAsyncFunctionConstructor::resume(common::AutoPtr<JSContext> ctx,
+                                   common::AutoPtr<JSValue> frame,
+                                   common::AutoPtr<JSValue> value) {
+  auto &co = frame->getOpaque<vm::JSCoroutineContext>();
+  auto promise = ctx->createValue(co.promise);
+  if (value->isException()) {
+    co.pc = co.module->codes.size();
+  }
+  auto result = JSGeneratorConstructor::resume(ctx, co, value);
+  if (result->getType() == JSValueType::JS_EXCEPTION) {
+    JSPromiseConstructor::rejectPromise(ctx, promise, ctx->createError(result));
+  } else if (co.done) {
+    auto err = JSPromiseConstructor::resolvePromise(ctx, promise, result);
+    if (err->isException()) {
+      JSPromiseConstructor::rejectPromise(ctx, promise, ctx->createError(err));
+    }
+  } else {
+    JSPromiseConstructor::await(ctx, result, frame);
+  }
+  return ctx->undefined();
+}
+
 JS_FUNC(JSAsyncFunctionConstructor::constructor) { return self; }
 
 common::AutoPtr<JSValue>
 JSAsyncFunctionConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   auto prototype =
-      ctx->createObject(ctx->Function()->getProperty(ctx, L"prototype"));
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE));
   auto AsyncFunction = ctx->createNativeFunction(constructor, L"AsyncFunction");
   AsyncFunction->setProperty(ctx, L"prototype", prototype);
   prototype->setProperty(ctx, L"constructor", AsyncFunction);
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"toStringTag"),
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
       ctx->createString(L"AsyncFunction"));
   return AsyncFunction;
 }
\ No newline at end of file
@@ -2,7 +2,6 @@
 #include "common/AutoPtr.hpp"
 #include "common/Map.hpp"
 #include "engine/base/JSValueType.hpp"
-#include "engine/entity/JSTasKEntity.hpp"
 #include "engine/runtime/JSContext.hpp"
 #include "engine/runtime/JSValue.hpp"
 #include "vm/JSAsmOperator.hpp"
@@ -39,6 +38,7 @@ JS_FUNC(JSAsyncGeneratorConstructor::next) {
       ctx->pushCallStack({.funcname = co.funcname});
       vm->setContext(co.eval);
       ctx->setScope(co.scope);
+      co.eval->suspended = false;
       co.eval->stack.push_back(co.scope->createValue(arg->getStore()));
       common::AutoPtr<JSValue> result;
       vm->run(ctx, co.module, co.pc);
@@ -71,19 +71,18 @@ JS_FUNC(JSAsyncGeneratorConstructor::next) {
       };
       common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
       closure[L"resolve"] = resolve;
-      closure[L"done"] =
-          ctx->createBoolean(task->getType() != JSValueType::JS_TASK);
+      closure[L"done"] = ctx->createBoolean(!co.eval->suspended);
       auto callbackFunc = ctx->createNativeFunction(callback, closure);
       auto awaitCallbackFunc =
           ctx->createNativeFunction(awaitCallback, closure);
-      if (task->getType() == JSValueType::JS_TASK) {
-        auto e = task->getEntity<JSTaskEntity>();
+      if (co.eval->suspended) {
+        auto address = co.eval->address;
         auto currentOpt =
             (vm::JSAsmOperator) *
-            (uint16_t *)(&co.module->codes[e->getAddress() - sizeof(uint16_t)]);
+            (uint16_t *)(&co.module->codes[address - sizeof(uint16_t)]);
         if (currentOpt == vm::JSAsmOperator::AWAIT ||
             currentOpt == vm::JSAsmOperator::AWAIT_NEXT) {
-          co.pc = e->getAddress();
+          co.pc = address;
           co.value = ctx->Promise()
                          ->getProperty(ctx, L"resolve")
                          ->apply(ctx, ctx->Promise());
@@ -91,7 +90,7 @@ JS_FUNC(JSAsyncGeneratorConstructor::next) {
           ctx->setScope(scope);
           vm->setContext(eval);
           self->getProperty(ctx, L"next")
-              ->apply(ctx, self, {ctx->createValue(e->getValue())});
+              ->apply(ctx, self, {ctx->createValue(task->getStore())});
           co.value->getProperty(ctx, L"then")
               ->apply(ctx, co.value, {awaitCallbackFunc, reject});
           return ctx->undefined();
@@ -99,10 +98,10 @@ JS_FUNC(JSAsyncGeneratorConstructor::next) {
           auto next = ctx->Promise()
                           ->getProperty(ctx, L"resolve")
                           ->apply(ctx, ctx->Promise(),
-                                  {ctx->createValue(e->getValue())});
+                                  {ctx->createValue(task->getStore())});
           next->getProperty(ctx, L"then")
               ->apply(ctx, next, {callbackFunc, reject});
-          co.pc = e->getAddress();
+          co.pc = address;
         }
       } else if (task->getType() == JSValueType::JS_EXCEPTION) {
         reject->apply(ctx, ctx->undefined(), {ctx->createError(task)});
@@ -177,8 +176,8 @@ JS_FUNC(JSAsyncGeneratorConstructor::constructor) { return self; }
 
 common::AutoPtr<JSValue>
 JSAsyncGeneratorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
-  auto prototype =
-      ctx->createObject(ctx->AsyncIterator()->getProperty(ctx, L"prototype"));
+  auto prototype = ctx->createObject(
+      ctx->getIntrinsic(JSIntrinsic::ASYNC_ITERATOR_PROTOTYPE));
   auto Generator = ctx->createNativeFunction(constructor, L"Generator");
   Generator->setPropertyDescriptor(ctx, L"prototype", prototype);
   prototype->setPropertyDescriptor(ctx, L"constructor", Generator);
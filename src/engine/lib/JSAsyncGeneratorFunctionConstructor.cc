@@ -10,14 +10,14 @@ JS_FUNC(JSAsyncGeneratorFunctionConstructor::constructor) { return self; }
 common::AutoPtr<JSValue> JSAsyncGeneratorFunctionConstructor::initialize(
     common::AutoPtr<JSContext> ctx) {
   auto prototype =
-      ctx->createObject(ctx->Function()->getProperty(ctx, L"prototype"));
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE));
   auto AsyncFunction =
       ctx->createNativeFunction(constructor, L"AsyncGeneratorFunction");
   AsyncFunction->setProperty(ctx, L"prototype", prototype);
   prototype->setProperty(ctx, L"constructor", AsyncFunction);
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"toStringTag"),
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
       ctx->createString(L"AsyncFunction"));
   return AsyncFunction;
 }
\ No newline at end of file
@@ -18,7 +18,7 @@ JSAsyncIteratorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   Iterator->setPropertyDescriptor(ctx, L"prototype", prototype);
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"asyncIterator"),
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ASYNC_ITERATOR),
       ctx->createNativeFunction(asyncIterator, L"[Symbol.asyncIterator]"));
 
   return Iterator;
@@ -0,0 +1,275 @@
+#include "engine/lib/JSAtomicsConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSRangeError.hpp"
+#include "error/JSTypeError.hpp"
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <fmt/xchar.h>
+#include <limits>
+#include <string>
+#include <utility>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+using Type = JSTypedArray::Type;
+
+static constexpr bool NATIVE = std::endian::native == std::endian::little;
+
+// only integer views are atomic, and only Int32Array and BigInt64Array
+// can be waited on
+static JSTypedArray &unwrap(const std::vector<common::AutoPtr<JSValue>> &args,
+                            bool waitable) {
+  auto target = args.empty() ? common::AutoPtr<JSValue>() : args[0];
+  if (target == nullptr || target->getType() != JSValueType::JS_OBJECT ||
+      !target->hasOpaque<JSTypedArray>()) {
+    throw error::JSTypeError(L"Argument is not a typed array");
+  }
+  auto &array = target->getOpaque<JSTypedArray>();
+  auto name = JSTypedArray::getName(array.type);
+  if (waitable && array.type != Type::INT32 && array.type != Type::BIGINT64) {
+    throw error::JSTypeError(
+        fmt::format(L"{} is not an int32 or BigInt64 typed array", name));
+  }
+  if (array.type == Type::UINT8_CLAMPED || array.type == Type::FLOAT32 ||
+      array.type == Type::FLOAT64) {
+    throw error::JSTypeError(
+        fmt::format(L"{} is not an integer typed array", name));
+  }
+  return array;
+}
+
+static size_t locate(common::AutoPtr<JSContext> ctx, const JSTypedArray &array,
+                     const std::vector<common::AutoPtr<JSValue>> &args) {
+  auto index = JSArrayBuffer::toIndex(ctx, args.size() > 1 ? args[1] : nullptr,
+                                      L"atomic access index");
+  if (index >= array.length) {
+    throw error::JSRangeError(L"Invalid atomic access index");
+  }
+  return index;
+}
+
+// resolved after every argument is converted, a valueOf may have
+// transferred the buffer away
+template <class T>
+static std::atomic_ref<T> element(const JSTypedArray &array, size_t index) {
+  if (array.buffer->isDetached()) {
+    throw error::JSTypeError(
+        L"Cannot perform Atomics operation on a detached ArrayBuffer");
+  }
+  return std::atomic_ref<T>(*(T *)(array.getData() + index * sizeof(T)));
+}
+
+template <class T>
+static T toElement(common::AutoPtr<JSContext> ctx, Type type,
+                   common::AutoPtr<JSValue> value) {
+  T result;
+  JSTypedArray::write(ctx, type, (uint8_t *)&result, value, NATIVE);
+  return result;
+}
+
+template <class T>
+static common::AutoPtr<JSValue> toValue(common::AutoPtr<JSContext> ctx,
+                                        Type type, T value) {
+  return JSTypedArray::read(ctx, type, (const uint8_t *)&value, NATIVE);
+}
+
+// undefined and NaN fall back, infinities are kept
+static double toDouble(common::AutoPtr<JSContext> ctx,
+                       common::AutoPtr<JSValue> value, double fallback) {
+  if (value == nullptr || value->isUndefined()) {
+    return fallback;
+  }
+  value = value->toNumber(ctx);
+  switch (value->getType()) {
+  case JSValueType::JS_NUMBER:
+    return value->getNumber().value();
+  case JSValueType::JS_INFINITY:
+    return value->getEntity<JSInfinityEntity>()->isNegative()
+               ? -std::numeric_limits<double>::infinity()
+               : std::numeric_limits<double>::infinity();
+  default:
+    return fallback;
+  }
+}
+
+template <class F> static common::AutoPtr<JSValue> dispatch(Type type, F &&f) {
+  switch (type) {
+  case Type::INT8:
+    return f.template operator()<int8_t>();
+  case Type::INT16:
+    return f.template operator()<int16_t>();
+  case Type::UINT16:
+    return f.template operator()<uint16_t>();
+  case Type::INT32:
+    return f.template operator()<int32_t>();
+  case Type::UINT32:
+    return f.template operator()<uint32_t>();
+  case Type::BIGINT64:
+    return f.template operator()<int64_t>();
+  case Type::BIGUINT64:
+    return f.template operator()<uint64_t>();
+  default:
+    return f.template operator()<uint8_t>();
+  }
+}
+
+// read-modify-write operations answer the previous value
+template <class F>
+static common::AutoPtr<JSValue>
+update(common::AutoPtr<JSContext> ctx,
+       const std::vector<common::AutoPtr<JSValue>> &args, F &&f) {
+  auto &array = unwrap(args, false);
+  auto index = locate(ctx, array, args);
+  auto value = args.size() > 2 ? args[2] : ctx->undefined();
+  return dispatch(array.type, [&]<class T>() -> common::AutoPtr<JSValue> {
+    auto operand = toElement<T>(ctx, array.type, value);
+    T previous = f(element<T>(array, index), operand);
+    return toValue(ctx, array.type, previous);
+  });
+}
+
+JS_FUNC(JSAtomicsConstructor::load) {
+  auto &array = unwrap(args, false);
+  auto index = locate(ctx, array, args);
+  return dispatch(array.type, [&]<class T>() -> common::AutoPtr<JSValue> {
+    return toValue(ctx, array.type, element<T>(array, index).load());
+  });
+}
+
+JS_FUNC(JSAtomicsConstructor::store) {
+  auto &array = unwrap(args, false);
+  auto index = locate(ctx, array, args);
+  auto value = args.size() > 2 ? args[2] : ctx->undefined();
+  return dispatch(array.type, [&]<class T>() -> common::AutoPtr<JSValue> {
+    auto operand = toElement<T>(ctx, array.type, value);
+    element<T>(array, index).store(operand);
+    return toValue(ctx, array.type, operand);
+  });
+}
+
+JS_FUNC(JSAtomicsConstructor::add) {
+  return update(ctx, args,
+                [](auto ref, auto operand) { return ref.fetch_add(operand); });
+}
+
+JS_FUNC(JSAtomicsConstructor::sub) {
+  return update(ctx, args,
+                [](auto ref, auto operand) { return ref.fetch_sub(operand); });
+}
+
+JS_FUNC(JSAtomicsConstructor::and_) {
+  return update(ctx, args,
+                [](auto ref, auto operand) { return ref.fetch_and(operand); });
+}
+
+JS_FUNC(JSAtomicsConstructor::or_) {
+  return update(ctx, args,
+                [](auto ref, auto operand) { return ref.fetch_or(operand); });
+}
+
+JS_FUNC(JSAtomicsConstructor::xor_) {
+  return update(ctx, args,
+                [](auto ref, auto operand) { return ref.fetch_xor(operand); });
+}
+
+JS_FUNC(JSAtomicsConstructor::exchange) {
+  return update(ctx, args,
+                [](auto ref, auto operand) { return ref.exchange(operand); });
+}
+
+JS_FUNC(JSAtomicsConstructor::compareExchange) {
+  auto &array = unwrap(args, false);
+  auto index = locate(ctx, array, args);
+  auto expected = args.size() > 2 ? args[2] : ctx->undefined();
+  auto replacement = args.size() > 3 ? args[3] : ctx->undefined();
+  return dispatch(array.type, [&]<class T>() -> common::AutoPtr<JSValue> {
+    auto previous = toElement<T>(ctx, array.type, expected);
+    auto operand = toElement<T>(ctx, array.type, replacement);
+    element<T>(array, index).compare_exchange_strong(previous, operand);
+    return toValue(ctx, array.type, previous);
+  });
+}
+
+// blocks the calling context, so a worker can sleep until another agent
+// notifies the same element of a shared buffer
+JS_FUNC(JSAtomicsConstructor::wait) {
+  auto &array = unwrap(args, true);
+  if (!array.buffer->isShared()) {
+    throw error::JSTypeError(fmt::format(L"{} is not a shared typed array",
+                                         JSTypedArray::getName(array.type)));
+  }
+  auto index = locate(ctx, array, args);
+  auto value = args.size() > 2 ? args[2] : ctx->undefined();
+  auto expected = array.type == Type::INT32
+                      ? (int64_t)toElement<int32_t>(ctx, array.type, value)
+                      : toElement<int64_t>(ctx, array.type, value);
+  auto timeout = std::max(
+      toDouble(ctx, args.size() > 3 ? args[3] : nullptr,
+               std::numeric_limits<double>::infinity()),
+      0.0);
+  auto size = JSTypedArray::getElementSize(array.type);
+  switch (array.buffer->wait(array.offset + index * size, expected, size,
+                             timeout)) {
+  case JSArrayBuffer::WaitResult::OK:
+    return ctx->createString(L"ok");
+  case JSArrayBuffer::WaitResult::NOT_EQUAL:
+    return ctx->createString(L"not-equal");
+  default:
+    return ctx->createString(L"timed-out");
+  }
+}
+
+JS_FUNC(JSAtomicsConstructor::notify) {
+  auto &array = unwrap(args, true);
+  auto index = locate(ctx, array, args);
+  auto count = std::max(
+      std::trunc(toDouble(ctx, args.size() > 2 ? args[2] : nullptr,
+                          std::numeric_limits<double>::infinity())),
+      0.0);
+  auto size = JSTypedArray::getElementSize(array.type);
+  return ctx->createNumber(array.buffer->notify(
+      array.offset + index * size,
+      count >= std::numeric_limits<uint32_t>::max()
+          ? std::numeric_limits<uint32_t>::max()
+          : (uint32_t)count));
+}
+
+JS_FUNC(JSAtomicsConstructor::toStringTag) {
+  return ctx->createString(L"Atomics");
+}
+
+common::AutoPtr<JSValue>
+JSAtomicsConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto Atomics = ctx->createObject(L"Atomics");
+  ctx->pushScope();
+  Atomics->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  std::pair<JSFunction *, const wchar_t *> functions[] = {
+      {load, L"load"},
+      {store, L"store"},
+      {add, L"add"},
+      {sub, L"sub"},
+      {and_, L"and"},
+      {or_, L"or"},
+      {xor_, L"xor"},
+      {exchange, L"exchange"},
+      {compareExchange, L"compareExchange"},
+      {wait, L"wait"},
+      {notify, L"notify"},
+  };
+  for (auto &[function, name] : functions) {
+    Atomics->setPropertyDescriptor(
+        ctx, name, ctx->createNativeFunction(function, name), true, false);
+  }
+  ctx->popScope();
+  return Atomics;
+}
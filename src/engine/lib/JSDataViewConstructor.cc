@@ -0,0 +1,162 @@
+#include "engine/lib/JSDataViewConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSRangeError.hpp"
+#include "error/JSTypeError.hpp"
+#include <fmt/xchar.h>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+using Type = JSTypedArray::Type;
+
+static JSDataView &unwrap(common::AutoPtr<JSValue> self,
+                          const std::wstring &method) {
+  if (self->getType() != JSValueType::JS_OBJECT ||
+      !self->hasOpaque<JSDataView>()) {
+    throw error::JSTypeError(
+        fmt::format(L"Method {} called on incompatible receiver", method));
+  }
+  return self->getOpaque<JSDataView>();
+}
+
+static uint8_t *locate(common::AutoPtr<JSContext> ctx, JSDataView &view,
+                       Type type,
+                       const std::vector<common::AutoPtr<JSValue>> &args) {
+  auto offset = JSArrayBuffer::toIndex(
+      ctx, args.empty() ? nullptr : args[0], L"DataView offset");
+  if (view.buffer->isDetached()) {
+    throw error::JSTypeError(
+        L"Cannot perform DataView access on a detached ArrayBuffer");
+  }
+  if (offset + JSTypedArray::getElementSize(type) > view.length) {
+    throw error::JSRangeError(L"Offset is outside the bounds of the DataView");
+  }
+  return view.buffer->getData() + view.offset + offset;
+}
+
+template <Type TYPE> JS_FUNC(JSDataViewConstructor::get) {
+  auto &view = unwrap(self, L"DataView.prototype.get");
+  auto data = locate(ctx, view, TYPE, args);
+  auto littleEndian =
+      args.size() > 1 && args[1]->toBoolean(ctx)->getBoolean().value();
+  return JSTypedArray::read(ctx, TYPE, data, littleEndian);
+}
+
+template <Type TYPE> JS_FUNC(JSDataViewConstructor::set) {
+  auto &view = unwrap(self, L"DataView.prototype.set");
+  auto data = locate(ctx, view, TYPE, args);
+  auto littleEndian =
+      args.size() > 2 && args[2]->toBoolean(ctx)->getBoolean().value();
+  JSTypedArray::write(ctx, TYPE, data,
+                      args.size() > 1 ? args[1] : ctx->undefined(),
+                      littleEndian);
+  return ctx->undefined();
+}
+
+JS_FUNC(JSDataViewConstructor::constructor) {
+  if (args.empty() || args[0]->getType() != JSValueType::JS_OBJECT ||
+      !args[0]->hasOpaque<common::AutoPtr<JSArrayBuffer>>()) {
+    throw error::JSTypeError(
+        L"First argument to DataView constructor must be an ArrayBuffer");
+  }
+  auto buffer = args[0]->getOpaque<common::AutoPtr<JSArrayBuffer>>();
+  if (buffer->isDetached()) {
+    throw error::JSTypeError(
+        L"Cannot construct DataView on a detached ArrayBuffer");
+  }
+  auto offset = JSArrayBuffer::toIndex(ctx, args.size() > 1 ? args[1] : nullptr,
+                                       L"DataView offset");
+  if (offset > buffer->getLength()) {
+    throw error::JSRangeError(fmt::format(
+        L"Start offset {} is outside the bounds of the buffer", offset));
+  }
+  auto length = buffer->getLength() - offset;
+  if (args.size() > 2 && !args[2]->isUndefined()) {
+    length = JSArrayBuffer::toIndex(ctx, args[2], L"DataView length");
+    if (offset + length > buffer->getLength()) {
+      throw error::JSRangeError(
+          fmt::format(L"Invalid DataView length {}", length));
+    }
+  }
+  self->setOpaque(JSDataView{
+      .buffer = buffer,
+      .object = args[0]->getStore(),
+      .offset = offset,
+      .length = length,
+  });
+  self->getStore()->appendChild(args[0]->getStore());
+  return ctx->undefined();
+}
+
+JS_FUNC(JSDataViewConstructor::getBuffer) {
+  return ctx->createValue(
+      unwrap(self, L"get DataView.prototype.buffer").object);
+}
+
+JS_FUNC(JSDataViewConstructor::getByteLength) {
+  auto &view = unwrap(self, L"get DataView.prototype.byteLength");
+  return ctx->createNumber(view.buffer->isDetached() ? 0 : view.length);
+}
+
+JS_FUNC(JSDataViewConstructor::getByteOffset) {
+  auto &view = unwrap(self, L"get DataView.prototype.byteOffset");
+  return ctx->createNumber(view.buffer->isDetached() ? 0 : view.offset);
+}
+
+JS_FUNC(JSDataViewConstructor::toStringTag) {
+  return ctx->createString(L"DataView");
+}
+
+common::AutoPtr<JSValue>
+JSDataViewConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto DataView =
+      ctx->createNativeFunction(constructor, L"DataView", L"DataView");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", DataView, true, false);
+  DataView->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"buffer", ctx->createNativeFunction(getBuffer, L"buffer"), nullptr,
+      true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"byteLength",
+      ctx->createNativeFunction(getByteLength, L"byteLength"), nullptr, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"byteOffset",
+      ctx->createNativeFunction(getByteOffset, L"byteOffset"), nullptr, true,
+      false);
+  std::vector<std::tuple<std::wstring, std::function<JSFunction>,
+                         std::function<JSFunction>>>
+      accessors = {
+          {L"Int8", get<Type::INT8>, set<Type::INT8>},
+          {L"Uint8", get<Type::UINT8>, set<Type::UINT8>},
+          {L"Int16", get<Type::INT16>, set<Type::INT16>},
+          {L"Uint16", get<Type::UINT16>, set<Type::UINT16>},
+          {L"Int32", get<Type::INT32>, set<Type::INT32>},
+          {L"Uint32", get<Type::UINT32>, set<Type::UINT32>},
+          {L"Float32", get<Type::FLOAT32>, set<Type::FLOAT32>},
+          {L"Float64", get<Type::FLOAT64>, set<Type::FLOAT64>},
+          {L"BigInt64", get<Type::BIGINT64>, set<Type::BIGINT64>},
+          {L"BigUint64", get<Type::BIGUINT64>, set<Type::BIGUINT64>},
+      };
+  for (auto &[name, getter, setter] : accessors) {
+    prototype->setPropertyDescriptor(
+        ctx, L"get" + name, ctx->createNativeFunction(getter, L"get" + name),
+        true, false);
+    prototype->setPropertyDescriptor(
+        ctx, L"set" + name, ctx->createNativeFunction(setter, L"set" + name),
+        true, false);
+  }
+  ctx->popScope();
+  return DataView;
+}
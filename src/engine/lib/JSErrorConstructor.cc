@@ -1,12 +1,25 @@
 #include "engine/lib/JSErrorConstructor.hpp"
 #include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSNativeFunctionEntity.hpp"
 #include <fmt/xchar.h>
 #include <string>
 using namespace spark;
 using namespace spark::engine;
+
+static std::wstring getTypeName(common::AutoPtr<JSContext> ctx,
+                                common::AutoPtr<JSValue> self) {
+  auto constructor = self->getProperty(ctx, L"constructor");
+  if (constructor->getType() == JSValueType::JS_NATIVE_FUNCTION) {
+    return constructor->getEntity<JSNativeFunctionEntity>()
+        ->getFunctionName();
+  }
+  auto name = constructor->getProperty(ctx, L"name")->getString();
+  return name.value_or(L"Error");
+}
+
 JS_FUNC(JSErrorConstructor::constructor) {
   if (self->getType() != JSValueType::JS_OBJECT) {
-    auto prop = ctx->Error()->getProperty(ctx, L"prototype");
+    auto prop = ctx->getIntrinsic(JSIntrinsic::ERROR_PROTOTYPE);
     self = ctx->createObject(prop);
   }
   if (args.empty()) {
@@ -16,11 +29,8 @@ JS_FUNC(JSErrorConstructor::constructor) {
         ctx, L"message",
         ctx->createString(args[0]->toString(ctx)->getString().value()));
   }
-  auto constructor = self->getProperty(ctx, L"constructor");
-  std::wstring type =
-      constructor->getProperty(ctx, L"name")->getString().value();
-  auto trace =
-      ctx->trace({.filename = 0, .line = 0, .column = 0, .funcname = type});
+  auto type = getTypeName(ctx, self);
+  auto trace = ctx->trace({.line = 0, .column = 0, .funcname = type});
   std::wstring stack;
   for (auto it = trace.begin() + 1; it != trace.end(); it++) {
     auto &loc = *it;
@@ -41,9 +51,7 @@ JS_FUNC(JSErrorConstructor::constructor) {
 JS_FUNC(JSErrorConstructor::toString) {
   auto message = self->getProperty(ctx, L"message");
   std::wstring result;
-  auto constructor = self->getProperty(ctx, L"constructor");
-  std::wstring type =
-      constructor->getProperty(ctx, L"name")->getString().value();
+  auto type = getTypeName(ctx, self);
   auto msg = message->toString(ctx)->getString().value();
   if (!message->isUndefined() && !msg.empty()) {
     result = fmt::format(L"{}: {}", type, msg);
@@ -62,7 +70,7 @@ JSErrorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   auto prototype = ctx->createObject();
   auto Error = ctx->createNativeFunction(&constructor, L"Error", L"Error");
   Error->setPropertyDescriptor(ctx, L"prototype", prototype);
-  prototype->setPropertyDescriptor(ctx, L"constructor", prototype);
+  prototype->setPropertyDescriptor(ctx, L"constructor", Error);
   prototype->setPropertyDescriptor(
       ctx, L"toString", ctx->createNativeFunction(toString, L"toString"));
   return Error;
@@ -23,8 +23,8 @@ JS_FUNC(JSFunctionConstructor::toString) {
     return ctx->createString(fmt::format(L"{}", entity->getFunctionSource()));
   }
 
-  throw error::JSTypeError(
-      L"Function.prototype.toString called on incompatible object");
+  return ctx->createException(error::JSTypeError(
+      L"Function.prototype.toString called on incompatible object"));
 }
 
 JS_FUNC(JSFunctionConstructor::call) {
@@ -79,7 +79,8 @@ JS_FUNC(JSFunctionConstructor::bind) {
       return result;
     }
   }
-  throw error::JSTypeError(L"Bind must be called on a function");
+  return ctx->createException(
+      error::JSTypeError(L"Bind must be called on a function"));
 }
 
 void JSFunctionConstructor::initialize(common::AutoPtr<JSContext> ctx,
@@ -89,7 +90,7 @@ void JSFunctionConstructor::initialize(common::AutoPtr<JSContext> ctx,
       ctx, L"toString", ctx->createNativeFunction(toString, L"toString"));
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"toStringTag"),
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
       ctx->createString(L"Function"));
 
   prototype->setPropertyDescriptor(ctx, L"call",
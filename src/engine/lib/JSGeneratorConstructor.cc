@@ -1,52 +1,45 @@
 #include "engine/lib/JSGeneratorConstructor.hpp"
 #include "common/AutoPtr.hpp"
 #include "engine/base/JSValueType.hpp"
-#include "engine/entity/JSTasKEntity.hpp"
 #include "engine/runtime/JSContext.hpp"
 #include "engine/runtime/JSValue.hpp"
 #include "vm/JSCoroutineContext.hpp"
 using namespace spark;
 using namespace spark::engine;
 
-JS_FUNC(JSGeneratorConstructor::next) {
-  auto result = ctx->createObject();
-  auto &co = self->getOpaque<vm::JSCoroutineContext>();
-  if (co.done) {
-    result->setProperty(ctx, L"value", co.value);
-    result->setProperty(ctx, L"done", ctx->truly());
-    return result;
-  }
+// Runs the frame up to its next yield or await, or to completion. While the
+// frame is suspended the result is the yielded value, still rooted in the
+// frame's scope; co.done tells the two apart.
+common::AutoPtr<JSValue>
+JSGeneratorConstructor::resume(common::AutoPtr<JSContext> ctx,
+                               vm::JSCoroutineContext &co,
+                               common::AutoPtr<JSValue> value) {
   auto vm = ctx->getRuntime()->getVirtualMachine();
   auto eval = vm->getContext();
   auto scope = ctx->getScope();
   ctx->pushCallStack({.funcname = co.funcname});
   vm->setContext(co.eval);
   ctx->setScope(co.scope);
-  if (args.empty()) {
-    co.eval->stack.push_back(ctx->undefined());
-  } else {
-    co.eval->stack.push_back(co.scope->createValue(args[0]->getStore()));
-  }
+  // The running frame is owned by the context alone, so scopes popped by
+  // the VM are released while their parents are still alive.
+  co.scope = nullptr;
+  co.eval->suspended = false;
+  co.eval->stack.push_back(ctx->getScope()->createValue(value->getStore()));
   vm->run(ctx, co.module, co.pc);
   co.scope = ctx->getScope();
-  auto task = *co.eval->stack.rbegin();
+  auto result = *co.eval->stack.rbegin();
   co.eval->stack.pop_back();
-  if (task->getType() == JSValueType::JS_TASK) {
-    auto e = task->getEntity<JSTaskEntity>();
-    result->setProperty(ctx, L"done", ctx->falsely());
-    result->setProperty(ctx, L"value", ctx->createValue(e->getValue()));
-    co.pc = e->getAddress();
-  } else if (task->getType() == JSValueType::JS_EXCEPTION) {
-    result = task;
+  if (co.eval->suspended) {
+    co.pc = co.eval->address;
+  } else if (result->getType() == JSValueType::JS_EXCEPTION) {
     co.value = ctx->undefined();
     co.value->getStore()->appendChild(ctx->undefined()->getStore());
+    co.done = true;
     co.pc = co.module->codes.size();
   } else {
-    result->setProperty(ctx, L"done", ctx->truly());
-    result->setProperty(ctx, L"value", task);
-    co.value = task;
+    co.value = result;
     co.done = true;
-    co.value->getStore()->appendChild(task->getStore());
+    co.value->getStore()->appendChild(result->getStore());
     co.pc = co.module->codes.size();
   }
   ctx->popCallStack();
@@ -55,6 +48,18 @@ JS_FUNC(JSGeneratorConstructor::next) {
   return result;
 }
 
+JS_FUNC(JSGeneratorConstructor::next) {
+  auto &co = self->getOpaque<vm::JSCoroutineContext>();
+  if (co.done) {
+    return ctx->createIteratorResult(co.value, true);
+  }
+  auto result = resume(ctx, co, args.empty() ? ctx->undefined() : args[0]);
+  if (result->getType() == JSValueType::JS_EXCEPTION) {
+    return result;
+  }
+  return ctx->createIteratorResult(result, co.done);
+}
+
 JS_FUNC(JSGeneratorConstructor::throw_) {
   auto arg = ctx->undefined();
   if (!args.empty()) {
@@ -80,7 +85,7 @@ JS_FUNC(JSGeneratorConstructor::constructor) { return self; }
 common::AutoPtr<JSValue>
 JSGeneratorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   auto prototype =
-      ctx->createObject(ctx->Iterator()->getProperty(ctx, L"prototype"));
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::ITERATOR_PROTOTYPE));
   auto Generator = ctx->createNativeFunction(constructor, L"Generator");
   Generator->setPropertyDescriptor(ctx, L"prototype", prototype);
   prototype->setPropertyDescriptor(ctx, L"constructor", Generator);
@@ -9,7 +9,7 @@ using namespace spark::engine;
 JS_FUNC(JSGeneratorFunctionConstructor::constructor) { return self; }
 common::AutoPtr<JSValue>
 JSGeneratorFunctionConstructor::initialize(common::AutoPtr<JSContext> ctx) {
-  auto prototype = ctx->Function()->getProperty(ctx, L"prototype");
+  auto prototype = ctx->getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE);
   auto GeneratorFunction =
       ctx->createNativeFunction(constructor, L"GeneratorFunction");
   GeneratorFunction->setPropertyDescriptor(ctx, L"prototype", prototype);
@@ -15,10 +15,10 @@ JS_FUNC(JSInternalErrorConstructor::constructor) {
 common::AutoPtr<JSValue>
 JSInternalErrorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   auto prototype =
-      ctx->createObject(ctx->Error()->getProperty(ctx, L"prototype"));
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::ERROR_PROTOTYPE));
   auto Error = ctx->createNativeFunction(&constructor, L"InternalError",
                                          L"InternalError");
   Error->setPropertyDescriptor(ctx, L"prototype", prototype);
-  prototype->setPropertyDescriptor(ctx, L"constructor", prototype);
+  prototype->setPropertyDescriptor(ctx, L"constructor", Error);
   return Error;
 }
\ No newline at end of file
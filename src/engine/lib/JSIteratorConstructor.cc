@@ -18,7 +18,7 @@ JSIteratorConstructor::initialize(common::AutoPtr<JSContext> ctx) {
   Iterator->setPropertyDescriptor(ctx, L"prototype", prototype);
 
   prototype->setPropertyDescriptor(
-      ctx, ctx->Symbol()->getProperty(ctx, L"iterator"),
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR),
       ctx->createNativeFunction(iterator, L"[Symbol.iterator]"));
 
   return Iterator;
@@ -0,0 +1,755 @@
+#include "engine/lib/JSJSONConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "common/Number.hpp"
+#include "engine/base/JSElementsKind.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSArrayEntity.hpp"
+#include "engine/entity/JSBooleanEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/entity/JSNullEntity.hpp"
+#include "engine/entity/JSNumberEntity.hpp"
+#include "engine/entity/JSObjectEntity.hpp"
+#include "engine/entity/JSStringEntity.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSSyntaxError.hpp"
+#include "error/JSTypeError.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fmt/xchar.h>
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+namespace {
+// Recursive descent JSON reader that builds stores directly. Every store is
+// linked to its parent before it is filled, so a syntax error leaves a tree
+// that the scope collects as usual.
+class JSONParser {
+private:
+  common::AutoPtr<JSContext> _ctx;
+  const wchar_t *_begin;
+  const wchar_t *_cursor;
+  const wchar_t *_end;
+  JSStore *_objectPrototype;
+  JSStore *_arrayPrototype;
+  std::wstring _key;
+
+private:
+  [[noreturn]] void unexpected() {
+    if (_cursor >= _end) {
+      throw error::JSSyntaxError(L"Unexpected end of JSON input");
+    }
+    throw error::JSSyntaxError(
+        fmt::format(L"Unexpected token {} in JSON at position {}",
+                    std::wstring(1, *_cursor), _cursor - _begin));
+  }
+
+  void skipWhitespace() {
+    while (_cursor != _end && (*_cursor == L' ' || *_cursor == L'\n' ||
+                               *_cursor == L'\r' || *_cursor == L'\t')) {
+      _cursor++;
+    }
+  }
+
+  void expect(wchar_t chr) {
+    if (_cursor == _end || *_cursor != chr) {
+      unexpected();
+    }
+    _cursor++;
+  }
+
+  void expect(const wchar_t *literal) {
+    for (; *literal; literal++) {
+      expect(*literal);
+    }
+  }
+
+  uint32_t parseHex() {
+    uint32_t value = 0;
+    for (int index = 0; index < 4; index++) {
+      if (_cursor == _end) {
+        unexpected();
+      }
+      auto chr = *_cursor;
+      value <<= 4;
+      if (chr >= L'0' && chr <= L'9') {
+        value |= chr - L'0';
+      } else if (chr >= L'a' && chr <= L'f') {
+        value |= chr - L'a' + 10;
+      } else if (chr >= L'A' && chr <= L'F') {
+        value |= chr - L'A' + 10;
+      } else {
+        unexpected();
+      }
+      _cursor++;
+    }
+    return value;
+  }
+
+  void parseString(std::wstring &output) {
+    output.clear();
+    expect(L'"');
+    for (;;) {
+      auto run = _cursor;
+      while (_cursor != _end && *_cursor != L'"' && *_cursor != L'\\' &&
+             (uint32_t)*_cursor >= 0x20) {
+        _cursor++;
+      }
+      output.append(run, _cursor);
+      if (_cursor == _end || (uint32_t)*_cursor < 0x20) {
+        unexpected();
+      }
+      if (*_cursor == L'"') {
+        _cursor++;
+        return;
+      }
+      _cursor++;
+      if (_cursor == _end) {
+        unexpected();
+      }
+      switch (*_cursor++) {
+      case L'"':
+        output += L'"';
+        break;
+      case L'\\':
+        output += L'\\';
+        break;
+      case L'/':
+        output += L'/';
+        break;
+      case L'b':
+        output += L'\b';
+        break;
+      case L'f':
+        output += L'\f';
+        break;
+      case L'n':
+        output += L'\n';
+        break;
+      case L'r':
+        output += L'\r';
+        break;
+      case L't':
+        output += L'\t';
+        break;
+      case L'u': {
+        auto code = parseHex();
+        if (sizeof(wchar_t) > 2 && code >= 0xd800 && code <= 0xdbff &&
+            _end - _cursor >= 6 && _cursor[0] == L'\\' && _cursor[1] == L'u') {
+          auto backup = _cursor;
+          _cursor += 2;
+          auto low = parseHex();
+          if (low >= 0xdc00 && low <= 0xdfff) {
+            code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+          } else {
+            _cursor = backup;
+          }
+        }
+        output += (wchar_t)code;
+        break;
+      }
+      default:
+        _cursor--;
+        unexpected();
+      }
+    }
+  }
+
+  double parseNumber() {
+    auto start = _cursor;
+    bool negative = false;
+    if (*_cursor == L'-') {
+      negative = true;
+      _cursor++;
+    }
+    if (_cursor == _end || *_cursor < L'0' || *_cursor > L'9') {
+      unexpected();
+    }
+    uint64_t mantissa = 0;
+    size_t digits = 0;
+    if (*_cursor == L'0') {
+      _cursor++;
+    } else {
+      while (_cursor != _end && *_cursor >= L'0' && *_cursor <= L'9') {
+        mantissa = mantissa * 10 + (*_cursor - L'0');
+        digits++;
+        _cursor++;
+      }
+    }
+    bool integral = true;
+    if (_cursor != _end && *_cursor == L'.') {
+      integral = false;
+      _cursor++;
+      if (_cursor == _end || *_cursor < L'0' || *_cursor > L'9') {
+        unexpected();
+      }
+      while (_cursor != _end && *_cursor >= L'0' && *_cursor <= L'9') {
+        _cursor++;
+      }
+    }
+    if (_cursor != _end && (*_cursor == L'e' || *_cursor == L'E')) {
+      integral = false;
+      _cursor++;
+      if (_cursor != _end && (*_cursor == L'+' || *_cursor == L'-')) {
+        _cursor++;
+      }
+      if (_cursor == _end || *_cursor < L'0' || *_cursor > L'9') {
+        unexpected();
+      }
+      while (_cursor != _end && *_cursor >= L'0' && *_cursor <= L'9') {
+        _cursor++;
+      }
+    }
+    if (integral && digits <= 15) {
+      if (negative) {
+        return mantissa == 0 ? -0.0 : -(double)mantissa;
+      }
+      return (double)mantissa;
+    }
+    return common::Number::parse(std::wstring(start, _cursor));
+  }
+
+  void parseObject(JSStore *store) {
+    auto entity = store->getEntity().cast<JSObjectEntity>();
+    auto &fields = entity->getProperties();
+    expect(L'{');
+    skipWhitespace();
+    if (_cursor != _end && *_cursor == L'}') {
+      _cursor++;
+      return;
+    }
+    for (;;) {
+      skipWhitespace();
+      if (_cursor == _end || *_cursor != L'"') {
+        unexpected();
+      }
+      parseString(_key);
+      skipWhitespace();
+      expect(L':');
+      auto [it, inserted] = fields.try_emplace(_key);
+      auto old = inserted ? nullptr : it->second.value;
+      auto value = parseValue(store);
+      if (old != nullptr && old != value) {
+        store->removeChild(old);
+        _ctx->getScope()->getRoot()->appendChild(old);
+      }
+      it->second = {
+          .configurable = true,
+          .enumable = true,
+          .value = value,
+          .writable = true,
+          .get = nullptr,
+          .set = nullptr,
+      };
+      skipWhitespace();
+      if (_cursor != _end && *_cursor == L',') {
+        _cursor++;
+        continue;
+      }
+      expect(L'}');
+      return;
+    }
+  }
+
+  void parseArray(JSStore *store) {
+    auto entity = store->getEntity().cast<JSArrayEntity>();
+    auto &items = entity->getItems();
+    expect(L'[');
+    skipWhitespace();
+    if (_cursor != _end && *_cursor == L']') {
+      _cursor++;
+      return;
+    }
+    for (;;) {
+      auto item = parseValue(store);
+      items.push_back(item);
+      auto type = item->getEntity()->getType();
+      if (type == JSValueType::JS_NUMBER) {
+        auto value = item->getEntity().cast<JSNumberEntity>()->getValue();
+        if (value < INT32_MIN || value > INT32_MAX ||
+            value != (int32_t)value || (value == 0 && std::signbit(value))) {
+          entity->transition(JSElementsKind::PACKED_DOUBLE);
+        }
+      } else if (type == JSValueType::JS_INFINITY) {
+        entity->transition(JSElementsKind::PACKED_DOUBLE);
+      } else {
+        entity->transition(JSElementsKind::PACKED);
+      }
+      skipWhitespace();
+      if (_cursor != _end && *_cursor == L',') {
+        _cursor++;
+        continue;
+      }
+      expect(L']');
+      return;
+    }
+  }
+
+  JSStore *parseValue(JSStore *parent) {
+    skipWhitespace();
+    if (_cursor == _end) {
+      unexpected();
+    }
+    JSStore *store = nullptr;
+    switch (*_cursor) {
+    case L'{':
+      store = new JSStore(new JSObjectEntity(_objectPrototype));
+      store->appendChild(_objectPrototype);
+      parent->appendChild(store);
+      parseObject(store);
+      return store;
+    case L'[':
+      store = new JSStore(new JSArrayEntity(_arrayPrototype));
+      store->appendChild(_arrayPrototype);
+      parent->appendChild(store);
+      parseArray(store);
+      return store;
+    case L'"': {
+      std::wstring value;
+      parseString(value);
+      store = new JSStore(new JSStringEntity(value));
+      break;
+    }
+    case L't':
+      expect(L"true");
+      store = new JSStore(new JSBooleanEntity(true));
+      break;
+    case L'f':
+      expect(L"false");
+      store = new JSStore(new JSBooleanEntity(false));
+      break;
+    case L'n':
+      expect(L"null");
+      store = new JSStore(new JSNullEntity());
+      break;
+    default:
+      if (*_cursor != L'-' && (*_cursor < L'0' || *_cursor > L'9')) {
+        unexpected();
+      }
+      auto value = parseNumber();
+      if (std::isinf(value)) {
+        store = new JSStore(new JSInfinityEntity(value < 0));
+      } else {
+        store = new JSStore(new JSNumberEntity(value));
+      }
+    }
+    parent->appendChild(store);
+    return store;
+  }
+
+public:
+  JSONParser(common::AutoPtr<JSContext> ctx, const std::wstring &source)
+      : _ctx(ctx), _begin(source.data()), _cursor(source.data()),
+        _end(source.data() + source.size()) {
+    _objectPrototype =
+        ctx->getIntrinsic(JSIntrinsic::OBJECT_PROTOTYPE)->getStore();
+    _arrayPrototype =
+        ctx->getIntrinsic(JSIntrinsic::ARRAY_PROTOTYPE)->getStore();
+  }
+
+  JSStore *parse(JSStore *holder) {
+    auto store = parseValue(holder);
+    skipWhitespace();
+    if (_cursor != _end) {
+      unexpected();
+    }
+    return store;
+  }
+};
+
+// Writes JSON text into a single growing buffer. Plain data is read straight
+// from the stores; JS values are only created for toJSON, getters and the
+// replacer function.
+class JSONSerializer {
+public:
+  // unwinds the recursion when a user callback returned an exception
+  struct Abort {};
+
+private:
+  common::AutoPtr<JSContext> _ctx;
+  common::AutoPtr<JSValue> _replacer;
+  std::vector<std::wstring> _keys;
+  bool _filtered;
+  std::wstring _gap;
+  std::wstring _indent;
+  std::vector<JSEntity *> _stack;
+  std::wstring _output;
+  common::AutoPtr<JSValue> _exception;
+
+private:
+  common::AutoPtr<JSValue> check(common::AutoPtr<JSValue> value) {
+    if (value->isException()) {
+      _exception = value;
+      throw Abort{};
+    }
+    return value;
+  }
+
+  static bool findToJSON(JSStore *store) {
+    auto entity = store->getEntity();
+    while (entity != nullptr && entity->getType() >= JSValueType::JS_OBJECT) {
+      auto object = entity.cast<JSObjectEntity>();
+      if (object->getProperties().contains(L"toJSON")) {
+        return true;
+      }
+      auto prototype = object->getPrototype();
+      if (prototype == nullptr) {
+        break;
+      }
+      entity = prototype->getEntity();
+    }
+    return false;
+  }
+
+  static bool isCallable(JSValueType type) {
+    return type == JSValueType::JS_FUNCTION ||
+           type == JSValueType::JS_NATIVE_FUNCTION ||
+           type == JSValueType::JS_CLASS;
+  }
+
+  void quote(const std::wstring &value) {
+    static const wchar_t *hex = L"0123456789abcdef";
+    _output += L'"';
+    auto cursor = value.data();
+    auto end = cursor + value.size();
+    while (cursor != end) {
+      auto run = cursor;
+      while (cursor != end && *cursor != L'"' && *cursor != L'\\' &&
+             (uint32_t)*cursor >= 0x20 &&
+             ((uint32_t)*cursor < 0xd800 || (uint32_t)*cursor > 0xdfff)) {
+        cursor++;
+      }
+      _output.append(run, cursor);
+      if (cursor == end) {
+        break;
+      }
+      auto chr = (uint32_t)*cursor++;
+      switch (chr) {
+      case L'"':
+        _output += L"\\\"";
+        continue;
+      case L'\\':
+        _output += L"\\\\";
+        continue;
+      case L'\b':
+        _output += L"\\b";
+        continue;
+      case L'\f':
+        _output += L"\\f";
+        continue;
+      case L'\n':
+        _output += L"\\n";
+        continue;
+      case L'\r':
+        _output += L"\\r";
+        continue;
+      case L'\t':
+        _output += L"\\t";
+        continue;
+      }
+      if (sizeof(wchar_t) == 2 && chr >= 0xd800 && chr <= 0xdbff &&
+          cursor != end && (uint32_t)*cursor >= 0xdc00 &&
+          (uint32_t)*cursor <= 0xdfff) {
+        _output += (wchar_t)chr;
+        _output += *cursor++;
+        continue;
+      }
+      _output += L"\\u";
+      _output += hex[(chr >> 12) & 0xf];
+      _output += hex[(chr >> 8) & 0xf];
+      _output += hex[(chr >> 4) & 0xf];
+      _output += hex[chr & 0xf];
+    }
+    _output += L'"';
+  }
+
+  void newline() {
+    if (!_gap.empty()) {
+      _output += L'\n';
+      _output += _indent;
+    }
+  }
+
+  void enter(JSEntity *entity) {
+    if (std::find(_stack.begin(), _stack.end(), entity) != _stack.end()) {
+      throw error::JSTypeError(L"Converting circular structure to JSON");
+    }
+    _stack.push_back(entity);
+    _indent += _gap;
+  }
+
+  void leave() {
+    _stack.pop_back();
+    _indent.resize(_indent.size() - _gap.size());
+  }
+
+  void member(JSStore *holder, const std::wstring &key, JSStore *store,
+              bool &first) {
+    auto mark = _output.size();
+    if (!first) {
+      _output += L',';
+    }
+    newline();
+    quote(key);
+    _output += _gap.empty() ? L":" : L": ";
+    if (serialize(holder, key, store)) {
+      first = false;
+    } else {
+      _output.resize(mark);
+    }
+  }
+
+  void serializeObject(JSStore *store) {
+    auto entity = store->getEntity().cast<JSObjectEntity>();
+    enter(entity.getRawPointer());
+    _output += L'{';
+    bool first = true;
+    if (_filtered) {
+      auto object = _ctx->createValue(store);
+      for (auto &key : _keys) {
+        auto value = check(object->getProperty(_ctx, key));
+        member(store, key, value->getStore(), first);
+      }
+    } else if (entity->hasOpaque<JSTypedArray>()) {
+      auto object = _ctx->createValue(store);
+      auto length = entity->getOpaque<JSTypedArray>().length;
+      for (size_t index = 0; index < length; index++) {
+        member(store, fmt::format(L"{}", index),
+               object->getIndex(_ctx, index)->getStore(), first);
+      }
+    } else {
+      // toJSON and the replacer may reshape the object while it is written
+      std::vector<std::pair<std::wstring, JSStore *>> fields;
+      for (auto &[key, field] : entity->getProperties()) {
+        if (field.enumable) {
+          fields.push_back({key, field.value});
+        }
+      }
+      for (auto &[key, value] : fields) {
+        if (value == nullptr) {
+          value = check(_ctx->createValue(store)->getProperty(_ctx, key))
+                      ->getStore();
+        }
+        member(store, key, value, first);
+      }
+    }
+    leave();
+    if (!first) {
+      newline();
+    }
+    _output += L'}';
+  }
+
+  void serializeArray(JSStore *store) {
+    auto entity = store->getEntity().cast<JSArrayEntity>();
+    enter(entity.getRawPointer());
+    _output += L'[';
+    auto &items = entity->getItems();
+    for (size_t index = 0; index < items.size(); index++) {
+      if (index != 0) {
+        _output += L',';
+      }
+      newline();
+      auto item = items[index];
+      if (item == nullptr ||
+          !serialize(store, fmt::format(L"{}", index), item)) {
+        _output += L"null";
+      }
+    }
+    leave();
+    if (!items.empty()) {
+      newline();
+    }
+    _output += L']';
+  }
+
+public:
+  JSONSerializer(common::AutoPtr<JSContext> ctx,
+                 common::AutoPtr<JSValue> replacer,
+                 common::AutoPtr<JSValue> space)
+      : _ctx(ctx), _filtered(false) {
+    if (replacer != nullptr && replacer->isFunction()) {
+      _replacer = replacer;
+    } else if (replacer != nullptr &&
+               replacer->getType() == JSValueType::JS_ARRAY) {
+      _filtered = true;
+      auto &items = replacer->getEntity<JSArrayEntity>()->getItems();
+      for (auto item : items) {
+        if (item == nullptr) {
+          continue;
+        }
+        auto type = item->getEntity()->getType();
+        if (type != JSValueType::JS_STRING && type != JSValueType::JS_NUMBER) {
+          continue;
+        }
+        auto key = ctx->createValue(item)->toString(ctx)->getString().value();
+        if (std::find(_keys.begin(), _keys.end(), key) == _keys.end()) {
+          _keys.push_back(key);
+        }
+      }
+    }
+    if (space != nullptr) {
+      if (space->getType() == JSValueType::JS_NUMBER) {
+        auto count = std::clamp(space->getNumber().value(), 0.0, 10.0);
+        _gap = std::wstring((size_t)count, L' ');
+      } else if (space->getType() == JSValueType::JS_STRING) {
+        _gap = space->getString().value().substr(0, 10);
+      }
+    }
+  }
+
+  // false when the value has no JSON representation (undefined, functions
+  // and symbols), in which case nothing is written
+  bool serialize(JSStore *holder, const std::wstring &key, JSStore *store) {
+    auto type = store->getEntity()->getType();
+    if (type >= JSValueType::JS_OBJECT && findToJSON(store)) {
+      auto value = _ctx->createValue(store);
+      auto toJSON = check(value->getProperty(_ctx, L"toJSON"));
+      if (toJSON->isFunction()) {
+        auto res = check(toJSON->apply(_ctx, value, {_ctx->createString(key)}));
+        store = res->getStore();
+        type = store->getEntity()->getType();
+      }
+    }
+    if (_replacer != nullptr) {
+      auto res = check(_replacer->apply(_ctx, _ctx->createValue(holder),
+                                        {_ctx->createString(key),
+                                         _ctx->createValue(store)}));
+      store = res->getStore();
+      type = store->getEntity()->getType();
+    }
+    switch (type) {
+    case JSValueType::JS_NULL:
+    case JSValueType::JS_NAN:
+    case JSValueType::JS_INFINITY:
+      _output += L"null";
+      return true;
+    case JSValueType::JS_BOOLEAN:
+      _output += store->getEntity().cast<JSBooleanEntity>()->getValue()
+                     ? L"true"
+                     : L"false";
+      return true;
+    case JSValueType::JS_NUMBER:
+      _output += store->getEntity()->toString(_ctx);
+      return true;
+    case JSValueType::JS_STRING:
+      quote(store->getEntity().cast<JSStringEntity>()->getValue());
+      return true;
+    case JSValueType::JS_BIGINT:
+      throw error::JSTypeError(L"Do not know how to serialize a BigInt");
+    case JSValueType::JS_ARRAY:
+      serializeArray(store);
+      return true;
+    default:
+      if (type < JSValueType::JS_OBJECT || isCallable(type)) {
+        return false;
+      }
+      serializeObject(store);
+      return true;
+    }
+  }
+
+  std::wstring &getOutput() { return _output; }
+
+  common::AutoPtr<JSValue> getException() { return _exception; }
+};
+
+common::AutoPtr<JSValue> revive(common::AutoPtr<JSContext> ctx,
+                                common::AutoPtr<JSValue> reviver,
+                                common::AutoPtr<JSValue> holder,
+                                common::AutoPtr<JSValue> key) {
+  auto value = holder->getProperty(ctx, key);
+  if (value->isException()) {
+    return value;
+  }
+  if (value->getType() == JSValueType::JS_ARRAY) {
+    auto length = value->getEntity<JSArrayEntity>()->getItems().size();
+    for (size_t index = 0; index < length; index++) {
+      auto name = ctx->createNumber(index);
+      auto item = revive(ctx, reviver, value, name);
+      if (item->isException()) {
+        return item;
+      }
+      value->setIndex(ctx, index, item);
+    }
+  } else if (value->getType() == JSValueType::JS_OBJECT) {
+    std::vector<std::wstring> keys;
+    for (auto &[name, field] : value->getEntity<JSObjectEntity>()
+                                   ->getProperties()) {
+      if (field.enumable) {
+        keys.push_back(name);
+      }
+    }
+    for (auto &name : keys) {
+      auto item = revive(ctx, reviver, value, ctx->createString(name));
+      if (item->isException()) {
+        return item;
+      }
+      if (item->isUndefined()) {
+        value->removeProperty(ctx, name);
+      } else {
+        value->setProperty(ctx, name, item);
+      }
+    }
+  }
+  return reviver->apply(ctx, holder, {key->toString(ctx), value});
+}
+} // namespace
+
+JS_FUNC(JSJSONConstructor::parse) {
+  auto source = (args.empty() ? ctx->undefined() : args[0])
+                    ->toString(ctx)
+                    ->getString()
+                    .value();
+  auto holder =
+      ctx->createValue(new JSStore(new JSEntity(JSValueType::JS_OBJECT)));
+  JSONParser parser(ctx, source);
+  auto result = ctx->createValue(parser.parse(holder->getStore()));
+  if (args.size() > 1 && args[1]->isFunction()) {
+    auto root = ctx->createObject();
+    root->setProperty(ctx, L"", result);
+    return revive(ctx, args[1], root, ctx->createString());
+  }
+  return result;
+}
+
+JS_FUNC(JSJSONConstructor::stringify) {
+  auto value = args.empty() ? ctx->undefined() : args[0];
+  JSONSerializer serializer(ctx, args.size() > 1 ? args[1] : nullptr,
+                            args.size() > 2 ? args[2] : nullptr);
+  JSStore *holder = nullptr;
+  if (args.size() > 1 && args[1]->isFunction()) {
+    auto root = ctx->createObject();
+    root->setProperty(ctx, L"", value);
+    holder = root->getStore();
+  }
+  try {
+    if (!serializer.serialize(holder, L"", value->getStore())) {
+      return ctx->undefined();
+    }
+  } catch (JSONSerializer::Abort &) {
+    return serializer.getException();
+  }
+  return ctx->createString(serializer.getOutput());
+}
+
+JS_FUNC(JSJSONConstructor::toStringTag) { return ctx->createString(L"JSON"); }
+
+common::AutoPtr<JSValue>
+JSJSONConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto JSON = ctx->createObject(L"JSON");
+  ctx->pushScope();
+  JSON->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  JSON->setPropertyDescriptor(
+      ctx, L"parse", ctx->createNativeFunction(parse, L"parse"), true, false);
+  JSON->setPropertyDescriptor(
+      ctx, L"stringify", ctx->createNativeFunction(stringify, L"stringify"),
+      true, false);
+  ctx->popScope();
+  return JSON;
+}
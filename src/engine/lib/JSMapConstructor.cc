@@ -0,0 +1,184 @@
+#include "engine/lib/JSMapConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
+#include <fmt/xchar.h>
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+JS_FUNC(JSMapConstructor::constructor) {
+  auto collection = JSCollection::create(ctx, self, JSCollection::Type::MAP);
+  if (args.empty()) {
+    return ctx->undefined();
+  }
+  auto err = JSCollection::iterate(
+      ctx, args[0], [&](common::AutoPtr<JSValue> item) -> void {
+        if (item->getType() != JSValueType::JS_OBJECT &&
+            item->getType() != JSValueType::JS_ARRAY) {
+          throw error::JSTypeError(
+              fmt::format(L"Iterator value {} is not an entry object",
+                          item->toString(ctx)->getString().value()));
+        }
+        collection->set(ctx, item->getIndex(ctx, 0), item->getIndex(ctx, 1));
+      });
+  if (err != nullptr) {
+    return err;
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSMapConstructor::get) {
+  auto collection =
+      JSCollection::unwrap(self, JSCollection::Type::MAP, L"Map.prototype.get");
+  auto entry = collection->get(args.empty() ? ctx->undefined() : args[0]);
+  if (!entry) {
+    return ctx->undefined();
+  }
+  return ctx->createValue(entry->value);
+}
+
+JS_FUNC(JSMapConstructor::set) {
+  auto collection =
+      JSCollection::unwrap(self, JSCollection::Type::MAP, L"Map.prototype.set");
+  collection->set(ctx, args.size() > 0 ? args[0] : ctx->undefined(),
+                  args.size() > 1 ? args[1] : ctx->undefined());
+  return self;
+}
+
+JS_FUNC(JSMapConstructor::has) {
+  auto collection =
+      JSCollection::unwrap(self, JSCollection::Type::MAP, L"Map.prototype.has");
+  return ctx->createBoolean(
+      collection->get(args.empty() ? ctx->undefined() : args[0]) != nullptr);
+}
+
+JS_FUNC(JSMapConstructor::remove) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::MAP,
+                                         L"Map.prototype.delete");
+  return ctx->createBoolean(
+      collection->remove(ctx, args.empty() ? ctx->undefined() : args[0]));
+}
+
+JS_FUNC(JSMapConstructor::clear) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::MAP,
+                                         L"Map.prototype.clear");
+  collection->clear(ctx);
+  return ctx->undefined();
+}
+
+JS_FUNC(JSMapConstructor::forEach) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::MAP,
+                                         L"Map.prototype.forEach");
+  if (args.empty() || !args[0]->isFunction()) {
+    return ctx->createException(error::JSTypeError(
+        L"Map.prototype.forEach callback is not a function"));
+  }
+  auto thisArg = args.size() > 1 ? args[1] : ctx->undefined();
+  auto cursor = collection->createCursor();
+  for (auto entry = collection->next(cursor); entry != nullptr;
+       entry = collection->next(cursor)) {
+    auto res = args[0]->apply(ctx, thisArg,
+                              {ctx->createValue(entry->value),
+                               ctx->createValue(entry->key), self});
+    if (res->isException()) {
+      return res;
+    }
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSMapConstructor::keys) {
+  return JSCollection::unwrap(self, JSCollection::Type::MAP,
+                              L"Map.prototype.keys")
+      ->createIterator(ctx, JSCollection::Kind::KEYS);
+}
+
+JS_FUNC(JSMapConstructor::values) {
+  return JSCollection::unwrap(self, JSCollection::Type::MAP,
+                              L"Map.prototype.values")
+      ->createIterator(ctx, JSCollection::Kind::VALUES);
+}
+
+JS_FUNC(JSMapConstructor::entries) {
+  return JSCollection::unwrap(self, JSCollection::Type::MAP,
+                              L"Map.prototype.entries")
+      ->createIterator(ctx, JSCollection::Kind::ENTRIES);
+}
+
+JS_FUNC(JSMapConstructor::getSize) {
+  return ctx->createNumber(
+      JSCollection::unwrap(self, JSCollection::Type::MAP, L"get Map.size")
+          ->getSize());
+}
+
+JS_FUNC(JSMapConstructor::toStringTag) { return ctx->createString(L"Map"); }
+
+JS_FUNC(JSMapConstructor::iterator_next) {
+  if (!self->hasOpaque<JSCollection::Iterator>()) {
+    return ctx->createException(error::JSTypeError(
+        L"Method Map Iterator.prototype.next called on incompatible receiver"));
+  }
+  auto &iterator = self->getOpaque<JSCollection::Iterator>();
+  auto value = iterator.collection->next(ctx, iterator);
+  if (value == nullptr) {
+    return ctx->createIteratorResult(ctx->undefined(), true);
+  }
+  return ctx->createIteratorResult(value, false);
+}
+
+common::AutoPtr<JSValue>
+JSMapConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto Map = ctx->createNativeFunction(constructor, L"Map", L"Map");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", Map, true, false);
+  Map->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"get", ctx->createNativeFunction(get, L"get"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"set", ctx->createNativeFunction(set, L"set"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"has", ctx->createNativeFunction(has, L"has"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"delete", ctx->createNativeFunction(remove, L"delete"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"clear", ctx->createNativeFunction(clear, L"clear"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"forEach", ctx->createNativeFunction(forEach, L"forEach"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"keys", ctx->createNativeFunction(keys, L"keys"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"values", ctx->createNativeFunction(values, L"values"), true,
+      false);
+  auto entries =
+      ctx->createNativeFunction(JSMapConstructor::entries, L"entries");
+  prototype->setPropertyDescriptor(ctx, L"entries", entries, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR), entries, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"size", ctx->createNativeFunction(getSize, L"size"), nullptr, true,
+      false);
+  ctx->popScope();
+  return Map;
+}
+
+common::AutoPtr<JSValue>
+JSMapConstructor::initializeIterator(common::AutoPtr<JSContext> ctx) {
+  auto prototype =
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::ITERATOR_PROTOTYPE));
+  prototype->setPropertyDescriptor(
+      ctx, L"next", ctx->createNativeFunction(iterator_next, L"next"), true,
+      false);
+  return prototype;
+}
@@ -8,10 +8,12 @@ using namespace spark;
 using namespace spark::engine;
 JS_FUNC(JSObjectConstructor::valueOf) {
   if (self->getType() == JSValueType::JS_NULL) {
-    throw error::JSTypeError(L"Cannot convert undefined or null to object");
+    return ctx->createException(
+        error::JSTypeError(L"Cannot convert undefined or null to object"));
   }
   if (self->getType() == JSValueType::JS_UNDEFINED) {
-    throw error::JSTypeError(L"Cannot convert undefined or null to object");
+    return ctx->createException(
+        error::JSTypeError(L"Cannot convert undefined or null to object"));
   }
   if (self->getType() < JSValueType::JS_OBJECT) {
     return self->pack(ctx);
@@ -30,8 +32,8 @@ JS_FUNC(JSObjectConstructor::toString) {
     return JSObjectConstructor::toString(ctx, self->pack(ctx), args);
   }
   std::wstring tag = L"Object";
-  auto toStringTag =
-      self->getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"toStringTag"));
+  auto toStringTag = self->getProperty(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG));
   if (toStringTag->getType() == JSValueType::JS_STRING) {
     tag = toStringTag->getString().value();
   }
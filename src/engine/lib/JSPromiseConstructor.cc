@@ -1,230 +1,251 @@
 #include "engine/lib/JSPromiseConstructor.hpp"
 #include "common/AutoPtr.hpp"
-#include "common/Map.hpp"
 #include "engine/base/JSValueType.hpp"
-#include "engine/entity/JSNativeFunctionEntity.hpp"
 #include "engine/entity/JSPromiseEntity.hpp"
+#include "engine/lib/JSAsyncFunctionConstructor.hpp"
 #include "engine/runtime/JSValue.hpp"
 #include "error/JSTypeError.hpp"
 #include <string>
 using namespace spark;
 using namespace spark::engine;
 
-static JS_FUNC(onSettled) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  for (auto &cb : entity->getFinallyCallbacks()) {
-    auto func = ctx->createValue(cb);
-    auto res = func->apply(ctx, ctx->undefined());
-    if (res->isException()) {
-      return res;
-    }
+static void complete(common::AutoPtr<JSContext> ctx,
+                     common::AutoPtr<JSValue> target,
+                     common::AutoPtr<JSValue> result) {
+  if (result->isException()) {
+    JSPromiseConstructor::rejectPromise(ctx, target, ctx->createError(result));
+    return;
   }
-  auto value = ctx->createValue(entity->getValue());
-  for (auto &cb : entity->getFulfilledCallbacks()) {
-    auto func = ctx->createValue(cb);
-    auto res = func->apply(ctx, ctx->undefined(), {value});
-    if (res->isException()) {
-      return res;
-    }
+  auto err = JSPromiseConstructor::resolvePromise(ctx, target, result);
+  if (err->isException()) {
+    JSPromiseConstructor::rejectPromise(ctx, target, ctx->createError(err));
   }
-  return ctx->undefined();
 }
 
-static JS_FUNC(onRejected) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  for (auto &cb : entity->getFinallyCallbacks()) {
-    auto func = ctx->createValue(cb);
-    auto res = func->apply(ctx, ctx->undefined());
-    if (res->isException()) {
-      return res;
-    }
-  }
-  auto value = ctx->createValue(entity->getValue());
-  for (auto &cb : entity->getRejectedCallbacks()) {
-    auto func = ctx->createValue(cb);
-    auto res = func->apply(ctx, ctx->undefined(), {value});
-    if (res->isException()) {
-      return res;
-    }
+template <bool REJECTED>
+static common::AutoPtr<JSValue>
+onThen(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> target,
+       common::AutoPtr<JSValue> handler, common::AutoPtr<JSValue> value) {
+  if (handler != nullptr) {
+    complete(ctx, target, handler->apply(ctx, ctx->undefined(), {value}));
+  } else if (REJECTED) {
+    JSPromiseConstructor::rejectPromise(ctx, target, value);
+  } else {
+    complete(ctx, target, value);
   }
   return ctx->undefined();
 }
 
-static JS_FUNC(resolve) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  if (entity->getStatus() == JSPromiseEntity::Status::PENDING) {
-    auto value = ctx->undefined();
-    if (!args.empty()) {
-      value = args[0];
-    }
-    if (value->isFunction() || value->isObject()) {
-      auto then = value->getProperty(ctx, L"then");
-      if (then->isFunction()) {
-        auto rejectFunc = ctx->load(L"#reject");
-        auto resolveFunc = ctx->load(L"#resolve");
-        return then->apply(ctx, value, {resolveFunc, rejectFunc});
-      }
-    }
-    entity->setValue(value->getStore());
-    self->getStore()->appendChild(value->getStore());
-    entity->getStatus() = JSPromiseEntity::Status::FULFILLED;
-    auto onSettledFunc = ctx->createNativeFunction(onSettled);
-    onSettledFunc->setBind(ctx, self);
-    ctx->createMicroTask(onSettledFunc);
+template <bool REJECTED>
+static common::AutoPtr<JSValue>
+onFinally(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> target,
+          common::AutoPtr<JSValue> handler, common::AutoPtr<JSValue> value) {
+  auto res = handler->apply(ctx, ctx->undefined(), {});
+  if (res->isException()) {
+    JSPromiseConstructor::rejectPromise(ctx, target, ctx->createError(res));
+  } else if (REJECTED) {
+    JSPromiseConstructor::rejectPromise(ctx, target, value);
+  } else {
+    complete(ctx, target, value);
   }
   return ctx->undefined();
 }
 
-static JS_FUNC(reject) {
+static common::AutoPtr<JSValue>
+onAwait(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> frame,
+        common::AutoPtr<JSValue> handler, common::AutoPtr<JSValue> value) {
+  return JSAsyncFunctionConstructor::resume(ctx, frame, value);
+}
+
+// Queues the job of one reaction against a settled promise. Each reaction
+// becomes a single microtask that runs its handler and settles the derived
+// promise, or resumes the awaiting frame.
+static void enqueue(common::AutoPtr<JSContext> ctx,
+                    common::AutoPtr<JSValue> self,
+                    const JSPromiseEntity::Reaction &reaction) {
   auto entity = self->getEntity<JSPromiseEntity>();
-  if (entity->getStatus() == JSPromiseEntity::Status::PENDING) {
-    auto value = ctx->undefined();
-    if (!args.empty()) {
-      value = args[0];
+  auto rejected = entity->getStatus() == JSPromiseEntity::Status::REJECTED;
+  auto value = ctx->createValue(entity->getValue());
+  auto target = ctx->createValue(reaction.target);
+  auto store = rejected ? reaction.onRejected : reaction.onFulfilled;
+  common::AutoPtr<JSValue> handler;
+  if (store != nullptr) {
+    handler = ctx->createValue(store);
+  }
+  switch (reaction.kind) {
+  case JSPromiseEntity::ReactionKind::THEN:
+    ctx->createMicroTask(rejected ? onThen<true> : onThen<false>, target,
+                         handler, value);
+    break;
+  case JSPromiseEntity::ReactionKind::FINALLY:
+    ctx->createMicroTask(rejected ? onFinally<true> : onFinally<false>,
+                         target, handler, value);
+    break;
+  case JSPromiseEntity::ReactionKind::AWAIT:
+    if (rejected) {
+      value = ctx->createException(value);
     }
-    entity->setValue(value->getStore());
-    self->getStore()->appendChild(value->getStore());
-    entity->getStatus() = JSPromiseEntity::Status::REJECTED;
-    auto onRejectedFunc = ctx->createNativeFunction(onRejected);
-    onRejectedFunc->setBind(ctx, self);
-    ctx->createMicroTask(onRejectedFunc);
+    ctx->createMicroTask(onAwait, target, nullptr, value);
+    break;
   }
-  return ctx->undefined();
 }
 
-static JS_FUNC(pipeline) {
-  auto resolve = ctx->load(L"#resolve");
-  auto reject = ctx->load(L"#reject");
-  auto callback = ctx->load(L"#callback");
-  auto value = ctx->load(L"#value");
-  auto res = callback->apply(ctx, ctx->undefined(), {value});
-  if (res->isException()) {
-    reject->apply(ctx, ctx->undefined(), {ctx->createError(res)});
-  } else {
-    resolve->apply(ctx, ctx->undefined(), {res});
+// Pending reactions are held by the root scope rather than by the promise
+// store: rebinding a variable that holds the promise drops the edges of its
+// store while the entity lives on.
+static void react(common::AutoPtr<JSContext> ctx,
+                  common::AutoPtr<JSValue> self,
+                  const JSPromiseEntity::Reaction &reaction) {
+  auto entity = self->getEntity<JSPromiseEntity>();
+  if (entity->getStatus() != JSPromiseEntity::Status::PENDING) {
+    enqueue(ctx, self, reaction);
+    return;
   }
-  return ctx->undefined();
+  auto root = ctx->getRoot()->getRoot();
+  for (auto store : {reaction.onFulfilled, reaction.onRejected,
+                     reaction.target}) {
+    if (store != nullptr) {
+      root->appendChild(store);
+    }
+  }
+  entity->getReactions().push_back(reaction);
 }
 
-static JS_FUNC(nextCallback) {
-  auto resolve = args[0];
-  auto reject = args[1];
-  auto callback = ctx->load(L"#callback");
-  auto value = ctx->load(L"#value");
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#resolve"] = resolve;
-  closure[L"#reject"] = reject;
-  closure[L"#callback"] = callback;
-  closure[L"#value"] = value;
-  auto pipelineFunc = ctx->createNativeFunction(pipeline, closure);
-  ctx->createMicroTask(pipelineFunc);
-  return ctx->undefined();
+static void settle(common::AutoPtr<JSContext> ctx,
+                   common::AutoPtr<JSValue> self,
+                   common::AutoPtr<JSValue> value,
+                   JSPromiseEntity::Status status) {
+  auto entity = self->getEntity<JSPromiseEntity>();
+  entity->setValue(value->getStore());
+  self->getStore()->appendChild(value->getStore());
+  entity->getStatus() = status;
+  auto reactions = std::move(entity->getReactions());
+  entity->getReactions().clear();
+  auto root = ctx->getRoot()->getRoot();
+  for (auto &reaction : reactions) {
+    enqueue(ctx, self, reaction);
+    for (auto store : {reaction.onFulfilled, reaction.onRejected,
+                       reaction.target}) {
+      if (store != nullptr) {
+        ctx->getScope()->getRoot()->appendChild(store);
+        root->removeChild(store);
+      }
+    }
+  }
 }
 
-static JS_FUNC(onCreateFulfilled) {
-  auto value = ctx->load(L"#value");
-  args[0]->apply(ctx, ctx->undefined(), {value});
-  return ctx->undefined();
+static common::AutoPtr<JSValue>
+derive(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self,
+       const std::wstring &name, JSPromiseEntity::ReactionKind kind,
+       JSStore *onFulfilled, JSStore *onRejected) {
+  if (self->getEntity<JSPromiseEntity>() == nullptr) {
+    return ctx->createException(error::JSTypeError(fmt::format(
+        L"Method Promise.prototype.{} called on incompatible receiver {}",
+        name, self->toString(ctx)->getString().value())));
+  }
+  auto result = JSPromiseConstructor::createPromise(ctx);
+  react(ctx, self, {kind, onFulfilled, onRejected, result->getStore()});
+  return result;
 }
 
-static JS_FUNC(onCreateRejected) {
-  auto value = ctx->load(L"#value");
-  args[1]->apply(ctx, ctx->undefined(), {value});
-  return ctx->undefined();
+static JSStore *getHandler(const std::vector<common::AutoPtr<JSValue>> &args,
+                           size_t index) {
+  if (index >= args.size()) {
+    return nullptr;
+  }
+  common::AutoPtr<JSValue> handler = args[index];
+  return handler->isFunction() ? handler->getStore() : nullptr;
 }
 
-static JS_FUNC(onNextResolve) {
+static JS_FUNC(resolve) {
   auto value = ctx->undefined();
   if (!args.empty()) {
     value = args[0];
   }
-  auto callback = ctx->load(L"#callback");
-  auto resolve = ctx->load(L"#resolve");
-  auto reject = ctx->load(L"#reject");
-  if (callback->isFunction()) {
-    auto res = callback->apply(ctx, ctx->undefined(), {value});
-    if (res->isException()) {
-      reject->apply(ctx, ctx->undefined(), {ctx->createError(res)});
-    } else {
-      resolve->apply(ctx, ctx->undefined(), {res});
-    }
-  } else {
-    resolve->apply(ctx, ctx->undefined(), {value});
-  }
-  return ctx->undefined();
+  return JSPromiseConstructor::resolvePromise(ctx, self, value);
 }
 
-static JS_FUNC(onNextReject) {
-  auto value = ctx->constructObject(ctx->Error());
+static JS_FUNC(reject) {
+  auto value = ctx->undefined();
   if (!args.empty()) {
     value = args[0];
   }
-  auto callback = ctx->load(L"#onError");
-  auto resolve = ctx->load(L"#resolve");
-  auto reject = ctx->load(L"#reject");
-  if (callback->isFunction()) {
-    auto res = callback->apply(ctx, ctx->undefined(), {value});
-    if (res->isException()) {
-      reject->apply(ctx, ctx->undefined(), {ctx->createError(res)});
-    } else {
-      resolve->apply(ctx, ctx->undefined(), {res});
-    }
-  } else {
-    reject->apply(ctx, ctx->undefined(), {value});
-  }
+  JSPromiseConstructor::rejectPromise(ctx, self, value);
   return ctx->undefined();
 }
 
-static JS_FUNC(onNextFinally) {
-  auto callback = ctx->load(L"#callback");
-  auto resolve = ctx->load(L"#resolve");
-  auto reject = ctx->load(L"#reject");
-  if (callback->isFunction()) {
-    auto res = callback->apply(ctx, ctx->undefined(), {});
-    if (res->isException()) {
-      reject->apply(ctx, ctx->undefined(), {ctx->createError(res)});
-    } else {
-      resolve->apply(ctx, ctx->undefined(), {res});
+static std::vector<common::AutoPtr<JSValue>>
+createResolvingFunctions(common::AutoPtr<JSContext> ctx,
+                         common::AutoPtr<JSValue> self) {
+  auto resolveFunc = ctx->createNativeFunction(::resolve);
+  auto rejectFunc = ctx->createNativeFunction(::reject);
+  resolveFunc->setBind(ctx, self);
+  rejectFunc->setBind(ctx, self);
+  return {resolveFunc, rejectFunc};
+}
+
+common::AutoPtr<JSValue>
+JSPromiseConstructor::createPromise(common::AutoPtr<JSContext> ctx) {
+  auto prototype = ctx->getIntrinsic(JSIntrinsic::PROMISE_PROTOTYPE);
+  auto result = ctx->createValue(
+      new JSStore(new JSPromiseEntity(prototype->getStore())));
+  result->getStore()->appendChild(prototype->getStore());
+  result->setPropertyDescriptor(ctx, L"constructor", ctx->Promise());
+  return result;
+}
+
+// Native promises whose then is the builtin one are adopted through a
+// reaction instead of calling then with fresh resolving functions.
+common::AutoPtr<JSValue>
+JSPromiseConstructor::resolvePromise(common::AutoPtr<JSContext> ctx,
+                                     common::AutoPtr<JSValue> promise,
+                                     common::AutoPtr<JSValue> value) {
+  auto entity = promise->getEntity<JSPromiseEntity>();
+  if (entity->getStatus() != JSPromiseEntity::Status::PENDING) {
+    return ctx->undefined();
+  }
+  if (value->isFunction() || value->isObject()) {
+    auto then = value->getProperty(ctx, L"then");
+    if (value->getEntity<JSPromiseEntity>() != nullptr &&
+        then->getStore() ==
+            ctx->getIntrinsic(JSIntrinsic::PROMISE_THEN)->getStore()) {
+      react(ctx, value,
+            {JSPromiseEntity::ReactionKind::THEN, nullptr, nullptr,
+             promise->getStore()});
+      return ctx->undefined();
+    }
+    if (then->isFunction()) {
+      return then->apply(ctx, value, createResolvingFunctions(ctx, promise));
     }
-  } else {
-    reject->apply(ctx, ctx->undefined(), {});
   }
+  settle(ctx, promise, value, JSPromiseEntity::Status::FULFILLED);
   return ctx->undefined();
 }
 
-static JS_FUNC(nextPendding) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  auto callback = ctx->load(L"#callback");
-  auto onError = ctx->load(L"#onError");
-  auto resolve = args[0];
-  auto reject = args[1];
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#resolve"] = resolve;
-  closure[L"#reject"] = reject;
-  closure[L"#callback"] = callback;
-  closure[L"#onError"] = onError;
-  auto onNextResolveFunc = ctx->createNativeFunction(onNextResolve, closure);
-  auto onNextRejectFunc = ctx->createNativeFunction(onNextReject, closure);
-  entity->getFulfilledCallbacks().push_back(onNextResolveFunc->getStore());
-  self->getStore()->appendChild(onNextResolveFunc->getStore());
-  entity->getRejectedCallbacks().push_back(onNextRejectFunc->getStore());
-  self->getStore()->appendChild(onNextRejectFunc->getStore());
-  return ctx->undefined();
+void JSPromiseConstructor::rejectPromise(common::AutoPtr<JSContext> ctx,
+                                         common::AutoPtr<JSValue> promise,
+                                         common::AutoPtr<JSValue> value) {
+  auto entity = promise->getEntity<JSPromiseEntity>();
+  if (entity->getStatus() == JSPromiseEntity::Status::PENDING) {
+    settle(ctx, promise, value, JSPromiseEntity::Status::REJECTED);
+  }
 }
 
-static JS_FUNC(nextFinally) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  auto callback = ctx->load(L"#callback");
-  auto resolve = args[0];
-  auto reject = args[1];
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#resolve"] = resolve;
-  closure[L"#reject"] = reject;
-  closure[L"#callback"] = callback;
-  auto onNextFinallyFunc = ctx->createNativeFunction(onNextFinally, closure);
-  entity->getFinallyCallbacks().push_back(onNextFinallyFunc->getStore());
-  self->getStore()->appendChild(onNextFinallyFunc->getStore());
-  return ctx->undefined();
+void JSPromiseConstructor::await(common::AutoPtr<JSContext> ctx,
+                                 common::AutoPtr<JSValue> value,
+                                 common::AutoPtr<JSValue> frame) {
+  if (!value->isObject() && !value->isFunction()) {
+    ctx->createMicroTask(onAwait, frame, nullptr, value);
+    return;
+  }
+  auto promise = value;
+  if (value->getEntity<JSPromiseEntity>() == nullptr) {
+    promise = createPromise(ctx);
+    complete(ctx, promise, value);
+  }
+  react(ctx, promise,
+        {JSPromiseEntity::ReactionKind::AWAIT, nullptr, nullptr,
+         frame->getStore()});
 }
 
 JS_FUNC(JSPromiseConstructor::resolve) {
@@ -232,23 +253,24 @@ JS_FUNC(JSPromiseConstructor::resolve) {
   if (!args.empty()) {
     value = args[0];
   }
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#value"] = value;
-  auto onCreateFulfilledFunc =
-      ctx->createNativeFunction(onCreateFulfilled, closure);
-  return ctx->constructObject(ctx->Promise(), {onCreateFulfilledFunc});
+  if (value->getEntity<JSPromiseEntity>() != nullptr &&
+      value->getProperty(ctx, L"constructor")->getStore() ==
+          ctx->Promise()->getStore()) {
+    return value;
+  }
+  auto result = createPromise(ctx);
+  complete(ctx, result, value);
+  return result;
 }
 
 JS_FUNC(JSPromiseConstructor::reject) {
-  auto value = ctx->constructObject(ctx->Error());
+  auto value = ctx->undefined();
   if (!args.empty()) {
     value = args[0];
   }
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#value"] = value;
-  auto onCreateRejectedFunc =
-      ctx->createNativeFunction(onCreateRejected, closure);
-  return ctx->constructObject(ctx->Promise(), {onCreateRejectedFunc});
+  auto result = createPromise(ctx);
+  rejectPromise(ctx, result, value);
+  return result;
 }
 
 JS_FUNC(JSPromiseConstructor::constructor) {
@@ -259,25 +281,17 @@ JS_FUNC(JSPromiseConstructor::constructor) {
     resolver = args[0];
   }
   if (!resolver->isFunction()) {
-    throw error::JSTypeError(
+    return ctx->createException(error::JSTypeError(
         fmt::format(L"Promise resolver '{}' is not a function",
-                    resolver->toString(ctx)->getString().value()));
+                    resolver->toString(ctx)->getString().value())));
   }
   auto entity = self->getEntity<JSPromiseEntity>();
   if (self->getEntity<JSPromiseEntity>() == nullptr) {
-    throw error::JSTypeError(
-        L"Promise constructor cannot be invoked without 'new'");
+    return ctx->createException(error::JSTypeError(
+        L"Promise constructor cannot be invoked without 'new'"));
   }
-  auto rejectFunc = ctx->createNativeFunction(::reject);
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#reject"] = rejectFunc;
-  auto resolveFunc = ctx->createNativeFunction(::resolve, closure);
-  resolveFunc->getEntity<JSNativeFunctionEntity>()->getClosure()[L"#resolve"] =
-      resolveFunc->getStore();
-  resolveFunc->getStore()->appendChild(resolveFunc->getStore());
-  resolveFunc->setBind(ctx, self);
-  rejectFunc->setBind(ctx, self);
-  auto err = resolver->apply(ctx, ctx->undefined(), {resolveFunc, rejectFunc});
+  auto err = resolver->apply(ctx, ctx->undefined(),
+                             createResolvingFunctions(ctx, self));
   if (err->isException()) {
     return err;
   }
@@ -285,118 +299,23 @@ JS_FUNC(JSPromiseConstructor::constructor) {
 }
 
 JS_FUNC(JSPromiseConstructor::then) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  auto callback = ctx->undefined();
-  auto onError = ctx->undefined();
-  if (args.size() > 0) {
-    callback = args[0];
-  }
-  if (args.size() > 1) {
-    onError = args[1];
-  }
-  if (entity->getStatus() == JSPromiseEntity::Status::FULFILLED) {
-    auto value = ctx->createValue(entity->getValue());
-    if (callback->isFunction()) {
-      common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-      closure[L"#callback"] = callback;
-      closure[L"#value"] = value;
-      auto nextCallbackFunc = ctx->createNativeFunction(nextCallback, closure);
-      return ctx->constructObject(ctx->Promise(), {nextCallbackFunc});
-    } else {
-      return ctx->Promise()
-          ->getProperty(ctx, L"resolve")
-          ->apply(ctx, ctx->undefined(), {value});
-    }
-  } else if (entity->getStatus() == JSPromiseEntity::Status::REJECTED) {
-    auto value = ctx->createValue(entity->getValue());
-    if (callback->isFunction()) {
-      common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-      closure[L"#callback"] = onError;
-      closure[L"#value"] = value;
-      auto nextCallbackFunc = ctx->createNativeFunction(nextCallback, closure);
-      return ctx->constructObject(ctx->Promise(), {nextCallbackFunc});
-    } else {
-      return ctx->Promise()
-          ->getProperty(ctx, L"reject")
-          ->apply(ctx, ctx->undefined(), {value});
-    }
-  } else {
-    common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-    closure[L"#callback"] = callback;
-    closure[L"#onError"] = onError;
-    auto nextPenddingFunc = ctx->createNativeFunction(nextPendding, closure);
-    nextPenddingFunc->setBind(ctx, self);
-    return ctx->constructObject(ctx->Promise(), {nextPenddingFunc});
-  }
+  return derive(ctx, self, L"then", JSPromiseEntity::ReactionKind::THEN,
+                getHandler(args, 0), getHandler(args, 1));
 }
+
 JS_FUNC(JSPromiseConstructor::catch_) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  auto callback = ctx->undefined();
-  if (!args.empty()) {
-    callback = args[0];
-  }
-  if (entity->getStatus() == JSPromiseEntity::Status::REJECTED) {
-    auto value = ctx->createValue(entity->getValue());
-    if (callback->isFunction()) {
-      common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-      closure[L"#callback"] = callback;
-      closure[L"#value"] = value;
-      auto nextCallbackFunc = ctx->createNativeFunction(nextCallback, closure);
-      return ctx->constructObject(ctx->Promise(), {nextCallbackFunc});
-    } else {
-      return ctx->Promise()
-          ->getProperty(ctx, L"reject")
-          ->apply(ctx, ctx->undefined(), {value});
-    }
-  } else if (entity->getStatus() == JSPromiseEntity::Status::PENDING) {
-    common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-    closure[L"#onError"] = callback;
-    closure[L"#callback"] = ctx->undefined();
-    auto nextPenddingFunc = ctx->createNativeFunction(nextPendding, closure);
-    nextPenddingFunc->setBind(ctx, self);
-    return ctx->constructObject(ctx->Promise(), {nextPenddingFunc});
-  } else {
-    auto value = ctx->createValue(entity->getValue());
-    return ctx->Promise()
-        ->getProperty(ctx, L"resolve")
-        ->apply(ctx, ctx->undefined(), {value});
-  }
-  return ctx->undefined();
+  return derive(ctx, self, L"catch", JSPromiseEntity::ReactionKind::THEN,
+                nullptr, getHandler(args, 0));
 }
+
 JS_FUNC(JSPromiseConstructor::finally) {
-  auto entity = self->getEntity<JSPromiseEntity>();
-  auto callback = ctx->undefined();
-  if (!args.empty()) {
-    callback = args[0];
+  auto handler = getHandler(args, 0);
+  if (handler == nullptr) {
+    return derive(ctx, self, L"finally", JSPromiseEntity::ReactionKind::THEN,
+                  nullptr, nullptr);
   }
-  if (entity->getStatus() == JSPromiseEntity::Status::PENDING) {
-    common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-    closure[L"#callback"] = callback;
-    auto nextFinallyFunc = ctx->createNativeFunction(nextFinally, closure);
-    nextFinallyFunc->setBind(ctx, self);
-    return ctx->constructObject(ctx->Promise(), {nextFinallyFunc});
-  } else {
-    if (callback->isFunction()) {
-      common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-      closure[L"#callback"] = callback;
-      closure[L"#value"] = ctx->undefined();
-      auto nextCallbackFunc = ctx->createNativeFunction(nextCallback, closure);
-      return ctx->constructObject(ctx->Promise(), {nextCallbackFunc});
-    } else {
-      if (entity->getStatus() == JSPromiseEntity::Status::REJECTED) {
-        return ctx->Promise()
-            ->getProperty(ctx, L"reject")
-            ->apply(ctx, ctx->undefined(),
-                    {ctx->createValue(entity->getValue())});
-      } else {
-        return ctx->Promise()
-            ->getProperty(ctx, L"resolve")
-            ->apply(ctx, ctx->undefined(),
-                    {ctx->createValue(entity->getValue())});
-      }
-    }
-  }
-  return ctx->undefined();
+  return derive(ctx, self, L"finally", JSPromiseEntity::ReactionKind::FINALLY,
+                handler, handler);
 }
 
 common::AutoPtr<JSValue>
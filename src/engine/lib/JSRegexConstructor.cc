@@ -1,13 +1,34 @@
 #include "engine/lib/JSRegexConstructor.hpp"
 #include "common/AutoPtr.hpp"
+#include "common/Regex.hpp"
 #include "engine/base/JSValueType.hpp"
+#include "engine/runtime/JSRuntime.hpp"
 #include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
 #include "vm/JSRegExpFlag.hpp"
-#include <regex>
 #include <string>
+#include <vector>
 using namespace spark;
 using namespace spark::engine;
 
+static uint32_t getFlag(common::AutoPtr<JSContext> ctx,
+                        common::AutoPtr<JSValue> self) {
+  auto flag = self->getProperty(
+      ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_REGEX_FLAG));
+  return (uint32_t)flag->getNumber().value();
+}
+
+common::AutoPtr<common::Regex>
+JSRegexConstructor::getRegex(common::AutoPtr<JSContext> ctx,
+                             common::AutoPtr<JSValue> self) {
+  if (self->getType() != JSValueType::JS_OBJECT ||
+      !self->hasOpaque<common::AutoPtr<common::Regex>>()) {
+    throw error::JSTypeError(
+        L"Method RegExp.prototype.exec called on incompatible receiver");
+  }
+  return self->getOpaque<common::AutoPtr<common::Regex>>();
+}
+
 JS_FUNC(JSRegexConstructor::constructor) {
   common::AutoPtr<JSValue> value = ctx->createString(L"(?:)");
   common::AutoPtr<JSValue> flag = ctx->createNumber();
@@ -21,150 +42,118 @@ JS_FUNC(JSRegexConstructor::constructor) {
       flag = args[1];
     }
   }
-  self->setProperty(ctx, ctx->internalSymbol(L"regex_value"), value);
-  self->setProperty(ctx, ctx->internalSymbol(L"regex_flag"), flag);
-  return ctx->undefined();
-}
-
-JS_FUNC(JSRegexConstructor::test) {
-  auto value = self->getProperty(ctx, ctx->internalSymbol(L"regex_value"))
-                   ->getString()
-                   .value();
-  auto flag =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
-  auto cppflag = std::regex::ECMAScript;
-  if (flag & vm::DOTALL) {
-    cppflag = std::regex::extended;
+  auto flags = (uint32_t)flag->getNumber().value();
+  uint32_t options = 0;
+  if (flags & vm::ICASE) {
+    options |= common::Regex::ICASE;
+  }
+  if (flags & vm::MULTILINE) {
+    options |= common::Regex::MULTILINE;
   }
-  if (flag & vm::ICASE) {
-    cppflag |= std::regex::icase;
+  if (flags & vm::DOTALL) {
+    options |= common::Regex::DOTALL;
   }
-  if (flag & vm::MULTILINE) {
-    cppflag |= std::regex::multiline;
+  if (flags & vm::UNICODE) {
+    options |= common::Regex::UNICODE;
   }
+  self->setOpaque(ctx->getRuntime()->compileRegex(
+      value->getString().value(), options));
+  self->setProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_REGEX_VALUE),
+                    value);
+  self->setProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_REGEX_FLAG),
+                    flag);
+  return ctx->undefined();
+}
 
+JS_FUNC(JSRegexConstructor::test) {
+  auto regex = getRegex(ctx, self);
   auto arg = args[0]->toString(ctx)->getString().value();
-  std::wregex pattern(value, cppflag);
-  return ctx->createBoolean(std::regex_search(arg, pattern));
+  std::vector<common::Regex::Capture> captures;
+  return ctx->createBoolean(regex->match(arg, 0, false, captures));
 }
 
 JS_FUNC(JSRegexConstructor::exec) {
-  auto arg = args[0]->toString(ctx)->getString().value();
-  auto result = ctx->createArray();
-  result->setProperty(ctx, L"input", args[0]->toString(ctx));
-  auto lastIndex =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"lastIndex"))
-          ->getNumber()
-          .value();
-
-  auto value = self->getProperty(ctx, ctx->internalSymbol(L"regex_value"))
-                   ->getString()
-                   .value();
-  auto flag =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
-
-  auto cppflag = std::regex::ECMAScript;
-  if (flag & vm::DOTALL) {
-    cppflag = std::regex::extended;
-  }
-  if (flag & vm::ICASE) {
-    cppflag |= std::regex::icase;
-  }
-  if (flag & vm::MULTILINE) {
-    cppflag |= std::regex::multiline;
+  auto regex = getRegex(ctx, self);
+  auto input = args[0]->toString(ctx);
+  auto arg = input->getString().value();
+  auto flag = getFlag(ctx, self);
+  size_t lastIndex = 0;
+  if (flag & (vm::GLOBAL | vm::STICKY)) {
+    auto value = self->getProperty(
+        ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_LAST_INDEX));
+    lastIndex = (size_t)value->getNumber().value();
   }
-  std::wregex pattern(value, cppflag);
-
-  std::match_results<std::wstring::const_iterator> re;
-  std::wstring next(arg.begin() + lastIndex, arg.end());
-  std::regex_search(next, re, pattern);
-  if (re.empty()) {
-    self->setProperty(ctx, ctx->internalSymbol(L"lastIndex"),
+  std::vector<common::Regex::Capture> captures;
+  if (!regex->match(arg, lastIndex, flag & vm::STICKY, captures)) {
+    self->setProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_LAST_INDEX),
                       ctx->createNumber(0));
     return ctx->null();
   }
-  result->setIndex(ctx, 0, ctx->createString(re.str()));
-  result->setProperty(ctx, L"index",
-                      ctx->createNumber(re.position() + lastIndex));
-  if (flag & vm::GLOBAL) {
-    self->setProperty(ctx, ctx->internalSymbol(L"lastIndex"),
-                      ctx->createNumber(lastIndex + re.prefix().length() +
-                                        re.str().length()));
-  }
-  if (re.size()) {
-    auto group = ctx->createArray();
-
-    for (size_t i = 1; i < re.size(); i++) {
-      std::sub_match sub = re[i];
-      group->setIndex(ctx, i - 1, ctx->createString(sub.str()));
+  auto result = ctx->createArray();
+  auto group = ctx->createArray();
+  for (size_t index = 0; index < captures.size(); index++) {
+    auto &[start, end] = captures[index];
+    common::AutoPtr<JSValue> item = ctx->undefined();
+    if (start >= 0 && end >= 0) {
+      item = ctx->createString(arg.substr(start, end - start));
+    }
+    result->setIndex(ctx, index, item);
+    if (index != 0) {
+      group->setIndex(ctx, index - 1,
+                      start >= 0 ? item : ctx->createString(L""));
     }
-    result->setProperty(ctx, L"groups", group);
-  } else {
-    self->setProperty(ctx, L"groups", ctx->undefined());
+  }
+  result->setProperty(ctx, L"index", ctx->createNumber(captures[0].start));
+  result->setProperty(ctx, L"input", input);
+  result->setProperty(ctx, L"groups", group);
+  if (flag & (vm::GLOBAL | vm::STICKY)) {
+    self->setProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_LAST_INDEX),
+                      ctx->createNumber(captures[0].end));
   }
   return result;
 }
 
 JS_FUNC(JSRegexConstructor::getDotAll) {
-  auto flags =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
+  auto flags = getFlag(ctx, self);
   return ctx->createBoolean(flags & vm::DOTALL);
 }
 
 JS_FUNC(JSRegexConstructor::getGlobal) {
-  auto flags =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
+  auto flags = getFlag(ctx, self);
   return ctx->createBoolean(flags & vm::GLOBAL);
 }
 
 JS_FUNC(JSRegexConstructor::getMultiline) {
-  auto flags =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
+  auto flags = getFlag(ctx, self);
   return ctx->createBoolean(flags & vm::MULTILINE);
 }
 
 JS_FUNC(JSRegexConstructor::getUnicode) {
-  auto flags =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
+  auto flags = getFlag(ctx, self);
   return ctx->createBoolean(flags & vm::UNICODE);
 }
 
 JS_FUNC(JSRegexConstructor::getSticky) {
-  auto flags =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
+  auto flags = getFlag(ctx, self);
   return ctx->createBoolean(flags & vm::STICKY);
 }
 
 JS_FUNC(JSRegexConstructor::getIgnoreCase) {
-  auto flags =
-      (uint32_t)self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"))
-          ->getNumber()
-          .value();
+  auto flags = getFlag(ctx, self);
   return ctx->createBoolean(flags & vm::ICASE);
 }
 
 JS_FUNC(JSRegexConstructor::getFlags) {
-  return self->getProperty(ctx, ctx->internalSymbol(L"regex_flag"));
+  return self->getProperty(ctx,
+                           ctx->getIntrinsic(JSIntrinsic::INTERNAL_REGEX_FLAG));
 }
 JS_FUNC(JSRegexConstructor::getSource) {
-  return self->getProperty(ctx, ctx->internalSymbol(L"regex_value"));
+  return self->getProperty(
+      ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_REGEX_VALUE));
 }
 JS_FUNC(JSRegexConstructor::getLastIndex) {
-  return self->getProperty(ctx, ctx->internalSymbol(L"lastIndex"));
+  return self->getProperty(ctx,
+                           ctx->getIntrinsic(JSIntrinsic::INTERNAL_LAST_INDEX));
 }
 
 common::AutoPtr<JSValue>
@@ -177,8 +166,9 @@ JSRegexConstructor::initialize(common::AutoPtr<JSContext> ctx) {
                          ctx->createNativeFunction(test, L"test"));
   prototype->setProperty(ctx, L"exec",
                          ctx->createNativeFunction(exec, L"exec"));
-  prototype->setProperty(ctx, ctx->internalSymbol(L"lastIndex"),
-                         ctx->createNumber());
+  prototype->setProperty(
+      ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_LAST_INDEX),
+      ctx->createNumber());
   auto useless = ctx->createNativeFunction(
       [](common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue>,
          std::vector<common::AutoPtr<JSValue>>) -> common::AutoPtr<JSValue> {
@@ -0,0 +1,155 @@
+#include "engine/lib/JSSetConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+JS_FUNC(JSSetConstructor::constructor) {
+  auto collection = JSCollection::create(ctx, self, JSCollection::Type::SET);
+  if (args.empty()) {
+    return ctx->undefined();
+  }
+  auto err = JSCollection::iterate(
+      ctx, args[0], [&](common::AutoPtr<JSValue> item) -> void {
+        collection->set(ctx, item);
+      });
+  if (err != nullptr) {
+    return err;
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSSetConstructor::add) {
+  auto collection =
+      JSCollection::unwrap(self, JSCollection::Type::SET, L"Set.prototype.add");
+  collection->set(ctx, args.empty() ? ctx->undefined() : args[0]);
+  return self;
+}
+
+JS_FUNC(JSSetConstructor::has) {
+  auto collection =
+      JSCollection::unwrap(self, JSCollection::Type::SET, L"Set.prototype.has");
+  return ctx->createBoolean(
+      collection->get(args.empty() ? ctx->undefined() : args[0]) != nullptr);
+}
+
+JS_FUNC(JSSetConstructor::remove) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::SET,
+                                         L"Set.prototype.delete");
+  return ctx->createBoolean(
+      collection->remove(ctx, args.empty() ? ctx->undefined() : args[0]));
+}
+
+JS_FUNC(JSSetConstructor::clear) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::SET,
+                                         L"Set.prototype.clear");
+  collection->clear(ctx);
+  return ctx->undefined();
+}
+
+JS_FUNC(JSSetConstructor::forEach) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::SET,
+                                         L"Set.prototype.forEach");
+  if (args.empty() || !args[0]->isFunction()) {
+    return ctx->createException(error::JSTypeError(
+        L"Set.prototype.forEach callback is not a function"));
+  }
+  auto thisArg = args.size() > 1 ? args[1] : ctx->undefined();
+  auto cursor = collection->createCursor();
+  for (auto entry = collection->next(cursor); entry != nullptr;
+       entry = collection->next(cursor)) {
+    auto res = args[0]->apply(ctx, thisArg,
+                              {ctx->createValue(entry->key),
+                               ctx->createValue(entry->key), self});
+    if (res->isException()) {
+      return res;
+    }
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSSetConstructor::values) {
+  return JSCollection::unwrap(self, JSCollection::Type::SET,
+                              L"Set.prototype.values")
+      ->createIterator(ctx, JSCollection::Kind::VALUES);
+}
+
+JS_FUNC(JSSetConstructor::entries) {
+  return JSCollection::unwrap(self, JSCollection::Type::SET,
+                              L"Set.prototype.entries")
+      ->createIterator(ctx, JSCollection::Kind::ENTRIES);
+}
+
+JS_FUNC(JSSetConstructor::getSize) {
+  return ctx->createNumber(
+      JSCollection::unwrap(self, JSCollection::Type::SET, L"get Set.size")
+          ->getSize());
+}
+
+JS_FUNC(JSSetConstructor::toStringTag) { return ctx->createString(L"Set"); }
+
+JS_FUNC(JSSetConstructor::iterator_next) {
+  if (!self->hasOpaque<JSCollection::Iterator>()) {
+    return ctx->createException(error::JSTypeError(
+        L"Method Set Iterator.prototype.next called on incompatible receiver"));
+  }
+  auto &iterator = self->getOpaque<JSCollection::Iterator>();
+  auto value = iterator.collection->next(ctx, iterator);
+  if (value == nullptr) {
+    return ctx->createIteratorResult(ctx->undefined(), true);
+  }
+  return ctx->createIteratorResult(value, false);
+}
+
+common::AutoPtr<JSValue>
+JSSetConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto Set = ctx->createNativeFunction(constructor, L"Set", L"Set");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", Set, true, false);
+  Set->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"add", ctx->createNativeFunction(add, L"add"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"has", ctx->createNativeFunction(has, L"has"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"delete", ctx->createNativeFunction(remove, L"delete"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"clear", ctx->createNativeFunction(clear, L"clear"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"forEach", ctx->createNativeFunction(forEach, L"forEach"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"entries", ctx->createNativeFunction(entries, L"entries"), true,
+      false);
+  auto values = ctx->createNativeFunction(JSSetConstructor::values, L"values");
+  prototype->setPropertyDescriptor(ctx, L"values", values, true, false);
+  prototype->setPropertyDescriptor(ctx, L"keys", values, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR), values, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"size", ctx->createNativeFunction(getSize, L"size"), nullptr, true,
+      false);
+  ctx->popScope();
+  return Set;
+}
+
+common::AutoPtr<JSValue>
+JSSetConstructor::initializeIterator(common::AutoPtr<JSContext> ctx) {
+  auto prototype =
+      ctx->createObject(ctx->getIntrinsic(JSIntrinsic::ITERATOR_PROTOTYPE));
+  prototype->setPropertyDescriptor(
+      ctx, L"next", ctx->createNativeFunction(iterator_next, L"next"), true,
+      false);
+  return prototype;
+}
@@ -0,0 +1,69 @@
+#include "engine/lib/JSSharedArrayBufferConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include <cstring>
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+JS_FUNC(JSSharedArrayBufferConstructor::constructor) {
+  auto length = JSArrayBuffer::toIndex(
+      ctx, args.empty() ? ctx->undefined() : args[0], L"array buffer length");
+  self->setOpaque(
+      common::AutoPtr<JSArrayBuffer>(new JSArrayBuffer(length, true)));
+  return ctx->undefined();
+}
+
+JS_FUNC(JSSharedArrayBufferConstructor::getByteLength) {
+  return ctx->createNumber(
+      JSArrayBuffer::unwrap(self, L"get SharedArrayBuffer.prototype.byteLength",
+                            true)
+          ->getLength());
+}
+
+JS_FUNC(JSSharedArrayBufferConstructor::slice) {
+  auto buffer =
+      JSArrayBuffer::unwrap(self, L"SharedArrayBuffer.prototype.slice", true);
+  auto length = buffer->getLength();
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 0 ? args[0] : nullptr, length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, length, length);
+  common::AutoPtr<JSArrayBuffer> result =
+      new JSArrayBuffer(end > begin ? end - begin : 0, true);
+  std::memcpy(result->getData(), buffer->getData() + begin,
+              result->getLength());
+  auto object = ctx->createObject(self->getPrototype(ctx));
+  object->setOpaque(result);
+  return object;
+}
+
+JS_FUNC(JSSharedArrayBufferConstructor::toStringTag) {
+  return ctx->createString(L"SharedArrayBuffer");
+}
+
+common::AutoPtr<JSValue>
+JSSharedArrayBufferConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto SharedArrayBuffer = ctx->createNativeFunction(
+      constructor, L"SharedArrayBuffer", L"SharedArrayBuffer");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", SharedArrayBuffer,
+                                   true, false);
+  SharedArrayBuffer->setPropertyDescriptor(ctx, L"prototype", prototype, true,
+                                           false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"byteLength",
+      ctx->createNativeFunction(getByteLength, L"byteLength"), nullptr, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"slice", ctx->createNativeFunction(slice, L"slice"), true, false);
+  ctx->popScope();
+  return SharedArrayBuffer;
+}
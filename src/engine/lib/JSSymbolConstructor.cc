@@ -1,6 +1,8 @@
 #include "engine/lib/JSSymbolConstructor.hpp"
 #include "common/AutoPtr.hpp"
+#include "engine/base/JSIntrinsic.hpp"
 #include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSObjectEntity.hpp"
 #include "engine/entity/JSSymbolEntity.hpp"
 #include "error/JSTypeError.hpp"
 #include <fmt/xchar.h>
@@ -34,7 +36,8 @@ JS_FUNC(JSSymbolConstructor::valueOf) {
     throw error::JSTypeError(
         L"Symbol.prototype.description requires that 'this' be a Symbol");
   }
-  auto symbol = self->getProperty(ctx, ctx->internalSymbol(L"value"));
+  auto symbol =
+      self->getProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_VALUE));
 
   if (symbol->getType() != JSValueType::JS_SYMBOL) {
     throw error::JSTypeError(
@@ -50,14 +53,13 @@ JS_FUNC(JSSymbolConstructor::_for) {
   } else {
     key = args[0]->toString(ctx)->getString().value();
   }
-  auto &symbols =
-      ctx->Symbol()->getOpaque<common::AutoPtr<JSSymbolOpaque>>()->symbols;
+  auto registry = ctx->getIntrinsic(JSIntrinsic::SYMBOL_REGISTRY);
+  auto &symbols = registry->getEntity<JSObjectEntity>()->getProperties();
   if (symbols.contains(key)) {
-    return ctx->createValue(symbols.at(key));
+    return ctx->createValue(symbols.at(key).value);
   }
   auto value = ctx->createSymbol(key);
-  ctx->Symbol()->getStore()->appendChild(value->getStore());
-  symbols[key] = value->getStore();
+  registry->setPropertyDescriptor(ctx, key, value);
   return value;
 }
 
@@ -68,12 +70,11 @@ JS_FUNC(JSSymbolConstructor::forKey) {
   } else {
     key = args[0]->toString(ctx)->getString().value();
   }
-  auto &symbols =
-      ctx->Symbol()->getOpaque<common::AutoPtr<JSSymbolOpaque>>()->symbols;
-  for (auto &[k, v] : symbols) {
-    if (k == key) {
-      return ctx->createValue(v);
-    }
+  auto &symbols = ctx->getIntrinsic(JSIntrinsic::SYMBOL_REGISTRY)
+                      ->getEntity<JSObjectEntity>()
+                      ->getProperties();
+  if (symbols.contains(key)) {
+    return ctx->createValue(symbols.at(key).value);
   }
   return ctx->undefined();
 }
@@ -96,7 +97,8 @@ JS_FUNC(JSSymbolConstructor::toPrimitive) {
     throw error::JSTypeError(
         L"Symbol.prototype [ @@toPrimitive ] requires that 'this' be a Symbol");
   }
-  auto symbol = self->getProperty(ctx, ctx->internalSymbol(L"value"));
+  auto symbol =
+      self->getProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_VALUE));
   if (symbol->getType() != JSValueType::JS_SYMBOL) {
     throw error::JSTypeError(
         L"Symbol.prototype [ @@toPrimitive ] requires that 'this' be a Symbol");
@@ -108,44 +110,28 @@ void JSSymbolConstructor::initialize(common::AutoPtr<JSContext> ctx,
                                      common::AutoPtr<JSValue> Symbol,
                                      common::AutoPtr<JSValue> prototype) {
 
-  Symbol->setPropertyDescriptor(ctx, L"asyncIterator",
-                                ctx->createSymbol(L"Symbol.asyncIterator"));
-
-  Symbol->setPropertyDescriptor(ctx, L"hasInstance",
-                                ctx->createSymbol(L"Symbol.hasInstance"));
-
-  Symbol->setPropertyDescriptor(
-      ctx, L"isConcatSpreadable",
-      ctx->createSymbol(L"Symbol.isConcatSpreadable"));
-
-  Symbol->setPropertyDescriptor(ctx, L"iterator",
-                                ctx->createSymbol(L"Symbol.iterator"));
-
-  Symbol->setPropertyDescriptor(ctx, L"match",
-                                ctx->createSymbol(L"Symbol.matchAll"));
-
-  Symbol->setPropertyDescriptor(ctx, L"replace",
-                                ctx->createSymbol(L"Symbol.replace"));
-
-  Symbol->setPropertyDescriptor(ctx, L"search",
-                                ctx->createSymbol(L"Symbol.search"));
-
-  Symbol->setPropertyDescriptor(ctx, L"species",
-                                ctx->createSymbol(L"Symbol.species"));
-
-  Symbol->setPropertyDescriptor(ctx, L"split",
-                                ctx->createSymbol(L"Symbol.split"));
-
   auto toPrimitive = ctx->createSymbol(L"Symbol.toPrimitive");
 
-  Symbol->setPropertyDescriptor(ctx, L"toPrimitive", toPrimitive);
-
   auto toStringTag = ctx->createSymbol(L"Symbol.toStringTag");
 
-  Symbol->setPropertyDescriptor(ctx, L"toStringTag", toStringTag);
-
-  Symbol->setPropertyDescriptor(ctx, L"unscopables",
-                                ctx->createSymbol(L"Symbol.unscopables"));
+  std::pair<const wchar_t *, common::AutoPtr<JSValue>> symbols[] = {
+      {L"asyncIterator", ctx->createSymbol(L"Symbol.asyncIterator")},
+      {L"hasInstance", ctx->createSymbol(L"Symbol.hasInstance")},
+      {L"isConcatSpreadable", ctx->createSymbol(L"Symbol.isConcatSpreadable")},
+      {L"iterator", ctx->createSymbol(L"Symbol.iterator")},
+      {L"match", ctx->createSymbol(L"Symbol.match")},
+      {L"replace", ctx->createSymbol(L"Symbol.replace")},
+      {L"search", ctx->createSymbol(L"Symbol.search")},
+      {L"species", ctx->createSymbol(L"Symbol.species")},
+      {L"split", ctx->createSymbol(L"Symbol.split")},
+      {L"toPrimitive", toPrimitive},
+      {L"toStringTag", toStringTag},
+      {L"unscopables", ctx->createSymbol(L"Symbol.unscopables")},
+  };
+
+  for (auto &[name, symbol] : symbols) {
+    Symbol->setPropertyDescriptor(ctx, name, symbol, false, false, false);
+  }
 
   prototype->setPropertyDescriptor(
       ctx, L"toString",
@@ -174,6 +160,4 @@ void JSSymbolConstructor::initialize(common::AutoPtr<JSContext> ctx,
 
   prototype->setPropertyDescriptor(ctx, toStringTag,
                                    ctx->createString(L"Symbol"));
-
-  Symbol->setOpaque<common::AutoPtr<JSSymbolOpaque>>(new JSSymbolOpaque);
 }
\ No newline at end of file
@@ -0,0 +1,438 @@
+#include "engine/lib/JSTypedArrayConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSArrayEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSRangeError.hpp"
+#include "error/JSTypeError.hpp"
+#include <cmath>
+#include <cstring>
+#include <fmt/xchar.h>
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+using Type = JSTypedArray::Type;
+
+static bool isCompatible(Type a, Type b) {
+  return JSTypedArray::isBigInt(a) == JSTypedArray::isBigInt(b);
+}
+
+static void copy(const JSTypedArray &source, JSTypedArray &target,
+                 size_t offset) {
+  auto size = JSTypedArray::getElementSize(target.type);
+  auto data = target.getData() + offset * size;
+  if (JSTypedArray::getElementSize(source.type) == size &&
+      (source.type == target.type ||
+       (JSTypedArray::isBigInt(source.type) &&
+        JSTypedArray::isBigInt(target.type)))) {
+    std::memmove(data, source.getData(), source.getByteLength());
+    return;
+  }
+  std::vector<uint8_t> bytes(source.getData(),
+                             source.getData() + source.getByteLength());
+  auto step = JSTypedArray::getElementSize(source.type);
+  for (size_t index = 0; index < source.length; index++) {
+    JSTypedArray::store(target.type, data + index * size,
+                        JSTypedArray::load(source.type,
+                                           bytes.data() + index * step));
+  }
+}
+
+common::AutoPtr<JSValue> JSTypedArrayConstructor::create(
+    common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self, Type type,
+    const std::vector<common::AutoPtr<JSValue>> &args) {
+  auto size = JSTypedArray::getElementSize(type);
+  auto name = JSTypedArray::getName(type);
+  JSTypedArray array = {
+      .buffer = nullptr,
+      .object = nullptr,
+      .type = type,
+      .offset = 0,
+      .length = 0,
+  };
+  auto source = args.empty() ? ctx->undefined() : args[0];
+  if (source->getType() != JSValueType::JS_OBJECT &&
+      source->getType() != JSValueType::JS_ARRAY) {
+    array.length = JSArrayBuffer::toIndex(ctx, source, L"typed array length");
+    array.buffer = new JSArrayBuffer(array.length * size);
+  } else if (source->hasOpaque<common::AutoPtr<JSArrayBuffer>>()) {
+    array.buffer = source->getOpaque<common::AutoPtr<JSArrayBuffer>>();
+    if (array.buffer->isDetached()) {
+      throw error::JSTypeError(fmt::format(
+          L"Cannot construct {} on a detached ArrayBuffer", name));
+    }
+    array.offset = JSArrayBuffer::toIndex(
+        ctx, args.size() > 1 ? args[1] : nullptr, L"typed array offset");
+    auto byteLength = array.buffer->getLength();
+    if (array.offset % size != 0) {
+      throw error::JSRangeError(fmt::format(
+          L"start offset of {} should be a multiple of {}", name, size));
+    }
+    if (args.size() > 2 && !args[2]->isUndefined()) {
+      array.length =
+          JSArrayBuffer::toIndex(ctx, args[2], L"typed array length");
+      if (array.offset + array.length * size > byteLength) {
+        throw error::JSRangeError(
+            fmt::format(L"Invalid typed array length: {}", array.length));
+      }
+    } else {
+      if (byteLength % size != 0) {
+        throw error::JSRangeError(fmt::format(
+            L"byte length of {} should be a multiple of {}", name, size));
+      }
+      if (array.offset > byteLength) {
+        throw error::JSRangeError(
+            fmt::format(L"Start offset {} is outside the bounds of the buffer",
+                        array.offset));
+      }
+      array.length = (byteLength - array.offset) / size;
+    }
+    array.object = source->getStore();
+    self->getStore()->appendChild(source->getStore());
+  } else if (source->hasOpaque<JSTypedArray>()) {
+    auto &another = source->getOpaque<JSTypedArray>();
+    if (another.buffer->isDetached()) {
+      throw error::JSTypeError(fmt::format(
+          L"Cannot construct {} on a detached ArrayBuffer", name));
+    }
+    if (!isCompatible(another.type, type)) {
+      throw error::JSTypeError(
+          fmt::format(L"Cannot mix BigInt and other types, use explicit "
+                      L"conversions to create {}",
+                      name));
+    }
+    array.length = another.length;
+    array.buffer = new JSArrayBuffer(array.length * size);
+    copy(another, array, 0);
+  } else {
+    std::vector<common::AutoPtr<JSValue>> items;
+    auto iterator = source->getProperty(
+        ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR));
+    if (iterator->isFunction()) {
+      auto err = JSCollection::iterate(
+          ctx, source, [&](common::AutoPtr<JSValue> item) -> void {
+            items.push_back(item);
+          });
+      if (err != nullptr) {
+        return err;
+      }
+    } else {
+      auto length = JSArrayBuffer::toIndex(
+          ctx, source->getProperty(ctx, L"length"), L"typed array length");
+      for (size_t index = 0; index < length; index++) {
+        items.push_back(source->getProperty(ctx, ctx->createNumber(index)));
+      }
+    }
+    array.length = items.size();
+    array.buffer = new JSArrayBuffer(array.length * size);
+    for (size_t index = 0; index < items.size(); index++) {
+      array.set(ctx, index, items[index]);
+    }
+  }
+  self->setOpaque(array);
+  return ctx->undefined();
+}
+
+template <Type TYPE>
+void JSTypedArrayConstructor::initializeType(
+    common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> prototype) {
+  auto name = JSTypedArray::getName(TYPE);
+  auto TypedArray = ctx->createNativeFunction(construct<TYPE>, name, name);
+  ctx->pushScope();
+  auto size = ctx->createNumber(JSTypedArray::getElementSize(TYPE));
+  auto typedPrototype = ctx->createObject(prototype);
+  typedPrototype->setPropertyDescriptor(ctx, L"constructor", TypedArray, true,
+                                        false);
+  typedPrototype->setPropertyDescriptor(ctx, L"BYTES_PER_ELEMENT", size,
+                                        false, false, false);
+  TypedArray->setPropertyDescriptor(ctx, L"prototype", typedPrototype, true,
+                                    false);
+  TypedArray->setPropertyDescriptor(ctx, L"BYTES_PER_ELEMENT", size, false,
+                                    false, false);
+  ctx->popScope();
+}
+
+JS_FUNC(JSTypedArrayConstructor::constructor) {
+  throw error::JSTypeError(
+      L"Abstract class TypedArray not directly constructable");
+}
+
+JS_FUNC(JSTypedArrayConstructor::getBuffer) {
+  JSTypedArray::unwrap(self, L"get TypedArray.prototype.buffer", true);
+  return JSTypedArray::getBuffer(ctx, self);
+}
+
+JS_FUNC(JSTypedArrayConstructor::getByteLength) {
+  auto &array = JSTypedArray::unwrap(
+      self, L"get TypedArray.prototype.byteLength", true);
+  return ctx->createNumber(
+      array.buffer->isDetached() ? 0 : array.getByteLength());
+}
+
+JS_FUNC(JSTypedArrayConstructor::getByteOffset) {
+  auto &array = JSTypedArray::unwrap(
+      self, L"get TypedArray.prototype.byteOffset", true);
+  return ctx->createNumber(array.buffer->isDetached() ? 0 : array.offset);
+}
+
+JS_FUNC(JSTypedArrayConstructor::getLength) {
+  auto &array =
+      JSTypedArray::unwrap(self, L"get TypedArray.prototype.length", true);
+  return ctx->createNumber(array.buffer->isDetached() ? 0 : array.length);
+}
+
+JS_FUNC(JSTypedArrayConstructor::toStringTag) {
+  if (self->getType() != JSValueType::JS_OBJECT ||
+      !self->hasOpaque<JSTypedArray>()) {
+    return ctx->undefined();
+  }
+  return ctx->createString(
+      JSTypedArray::getName(self->getOpaque<JSTypedArray>().type));
+}
+
+JS_FUNC(JSTypedArrayConstructor::at) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.at");
+  auto index = 0.0;
+  if (!args.empty()) {
+    index = std::trunc(args[0]->toNumber(ctx)->getNumber().value_or(0));
+  }
+  if (index < 0) {
+    index += array.length;
+  }
+  if (index < 0 || index >= array.length) {
+    return ctx->undefined();
+  }
+  return array.get(ctx, (size_t)index);
+}
+
+JS_FUNC(JSTypedArrayConstructor::fill) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.fill");
+  auto size = JSTypedArray::getElementSize(array.type);
+  uint8_t bytes[8];
+  JSTypedArray::write(ctx, array.type, bytes,
+                      args.empty() ? ctx->undefined() : args[0]);
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, array.length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 2 ? args[2] : nullptr, array.length, array.length);
+  auto data = array.getData();
+  if (size == 1 && begin < end) {
+    std::memset(data + begin, bytes[0], end - begin);
+  } else {
+    for (auto index = begin; index < end; index++) {
+      std::memcpy(data + index * size, bytes, size);
+    }
+  }
+  return self;
+}
+
+JS_FUNC(JSTypedArrayConstructor::includes) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.includes");
+  auto search = args.empty() ? ctx->undefined() : args[0];
+  auto from = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, array.length, 0);
+  if (!JSTypedArray::isBigInt(array.type) &&
+      search->getType() == JSValueType::JS_NAN) {
+    auto size = JSTypedArray::getElementSize(array.type);
+    for (auto index = from; index < array.length; index++) {
+      if (std::isnan(JSTypedArray::load(array.type,
+                                        array.getData() + index * size))) {
+        return ctx->truly();
+      }
+    }
+    return ctx->falsely();
+  }
+  auto res = indexOf(ctx, self, args);
+  return ctx->createBoolean(res->getNumber().value() >= 0);
+}
+
+JS_FUNC(JSTypedArrayConstructor::indexOf) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.indexOf");
+  auto search = args.empty() ? ctx->undefined() : args[0];
+  auto from = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, array.length, 0);
+  auto size = JSTypedArray::getElementSize(array.type);
+  if (JSTypedArray::isBigInt(array.type)) {
+    if (search->getType() == JSValueType::JS_BIGINT) {
+      for (auto index = from; index < array.length; index++) {
+        if (array.get(ctx, index)->getBigInt() == search->getBigInt()) {
+          return ctx->createNumber(index);
+        }
+      }
+    }
+  } else if (search->getType() == JSValueType::JS_NUMBER ||
+             search->getType() == JSValueType::JS_INFINITY) {
+    double target = INFINITY;
+    if (search->getType() == JSValueType::JS_NUMBER) {
+      target = search->getNumber().value();
+    } else if (search->getEntity<JSInfinityEntity>()->isNegative()) {
+      target = -INFINITY;
+    }
+    for (auto index = from; index < array.length; index++) {
+      if (JSTypedArray::load(array.type, array.getData() + index * size) ==
+          target) {
+        return ctx->createNumber(index);
+      }
+    }
+  }
+  return ctx->createNumber(-1);
+}
+
+JS_FUNC(JSTypedArrayConstructor::set) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.set");
+  auto source = args.empty() ? ctx->undefined() : args[0];
+  auto offset = 0.0;
+  if (args.size() > 1) {
+    offset = std::trunc(args[1]->toNumber(ctx)->getNumber().value_or(0));
+  }
+  if (offset < 0) {
+    throw error::JSRangeError(L"offset is out of bounds");
+  }
+  if (source->getType() == JSValueType::JS_OBJECT &&
+      source->hasOpaque<JSTypedArray>()) {
+    auto &another = source->getOpaque<JSTypedArray>();
+    if (another.buffer->isDetached()) {
+      throw error::JSTypeError(L"Cannot perform TypedArray.prototype.set "
+                               L"on a detached ArrayBuffer");
+    }
+    if (another.length + offset > array.length) {
+      throw error::JSRangeError(L"offset is out of bounds");
+    }
+    if (!isCompatible(another.type, array.type)) {
+      throw error::JSTypeError(L"Cannot mix BigInt and other types, use "
+                               L"explicit conversions");
+    }
+    copy(another, array, (size_t)offset);
+    return ctx->undefined();
+  }
+  auto length = JSArrayBuffer::toIndex(ctx, source->getProperty(ctx, L"length"),
+                                       L"source length");
+  if (length + offset > array.length) {
+    throw error::JSRangeError(L"offset is out of bounds");
+  }
+  for (size_t index = 0; index < length; index++) {
+    auto item = source->getType() == JSValueType::JS_ARRAY
+                    ? source->getIndex(ctx, index)
+                    : source->getProperty(ctx, ctx->createNumber(index));
+    array.set(ctx, (size_t)offset + index, item);
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSTypedArrayConstructor::slice) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.slice");
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 0 ? args[0] : nullptr, array.length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, array.length, array.length);
+  auto size = JSTypedArray::getElementSize(array.type);
+  JSTypedArray result = {
+      .buffer = nullptr,
+      .object = nullptr,
+      .type = array.type,
+      .offset = 0,
+      .length = end > begin ? end - begin : 0,
+  };
+  if (array.buffer->isDetached()) {
+    throw error::JSTypeError(L"Cannot perform TypedArray.prototype.slice "
+                             L"on a detached ArrayBuffer");
+  }
+  result.buffer = new JSArrayBuffer(result.length * size);
+  std::memcpy(result.getData(), array.getData() + begin * size,
+              result.getByteLength());
+  auto object = ctx->createObject(self->getPrototype(ctx));
+  object->setOpaque(result);
+  return object;
+}
+
+JS_FUNC(JSTypedArrayConstructor::subarray) {
+  auto &array = JSTypedArray::unwrap(self, L"TypedArray.prototype.subarray");
+  auto begin = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 0 ? args[0] : nullptr, array.length, 0);
+  auto end = JSArrayBuffer::toRelativeIndex(
+      ctx, args.size() > 1 ? args[1] : nullptr, array.length, array.length);
+  auto buffer = JSTypedArray::getBuffer(ctx, self);
+  auto object = ctx->createObject(self->getPrototype(ctx));
+  object->setOpaque(JSTypedArray{
+      .buffer = array.buffer,
+      .object = buffer->getStore(),
+      .type = array.type,
+      .offset = array.offset + begin * JSTypedArray::getElementSize(array.type),
+      .length = end > begin ? end - begin : 0,
+  });
+  object->getStore()->appendChild(buffer->getStore());
+  return object;
+}
+
+common::AutoPtr<JSValue>
+JSTypedArrayConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto TypedArray = ctx->createNativeFunction(constructor, L"TypedArray");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  auto arrayPrototype = ctx->getIntrinsic(JSIntrinsic::ARRAY_PROTOTYPE);
+  prototype->setPropertyDescriptor(ctx, L"constructor", TypedArray, true,
+                                   false);
+  TypedArray->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"buffer", ctx->createNativeFunction(getBuffer, L"buffer"), nullptr,
+      true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"byteLength",
+      ctx->createNativeFunction(getByteLength, L"byteLength"), nullptr, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"byteOffset",
+      ctx->createNativeFunction(getByteOffset, L"byteOffset"), nullptr, true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"length", ctx->createNativeFunction(getLength, L"length"), nullptr,
+      true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"at", ctx->createNativeFunction(at, L"at"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"fill", ctx->createNativeFunction(fill, L"fill"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"includes", ctx->createNativeFunction(includes, L"includes"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"indexOf", ctx->createNativeFunction(indexOf, L"indexOf"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"set", ctx->createNativeFunction(set, L"set"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"slice", ctx->createNativeFunction(slice, L"slice"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"subarray", ctx->createNativeFunction(subarray, L"subarray"), true,
+      false);
+  for (auto name : {L"forEach", L"join", L"toString"}) {
+    prototype->setPropertyDescriptor(
+        ctx, name, arrayPrototype->getProperty(ctx, name), true, false);
+  }
+  auto values = ctx->getIntrinsic(JSIntrinsic::ARRAY_VALUES);
+  prototype->setPropertyDescriptor(ctx, L"values", values, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR), values, true,
+      false);
+  ctx->popScope();
+  prototype = TypedArray->getProperty(ctx, L"prototype");
+  initializeType<Type::INT8>(ctx, prototype);
+  initializeType<Type::UINT8>(ctx, prototype);
+  initializeType<Type::UINT8_CLAMPED>(ctx, prototype);
+  initializeType<Type::INT16>(ctx, prototype);
+  initializeType<Type::UINT16>(ctx, prototype);
+  initializeType<Type::INT32>(ctx, prototype);
+  initializeType<Type::UINT32>(ctx, prototype);
+  initializeType<Type::FLOAT32>(ctx, prototype);
+  initializeType<Type::FLOAT64>(ctx, prototype);
+  initializeType<Type::BIGINT64>(ctx, prototype);
+  initializeType<Type::BIGUINT64>(ctx, prototype);
+  return TypedArray;
+}
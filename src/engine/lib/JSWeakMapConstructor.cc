@@ -0,0 +1,107 @@
+#include "engine/lib/JSWeakMapConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
+#include <fmt/xchar.h>
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+JS_FUNC(JSWeakMapConstructor::constructor) {
+  auto collection =
+      JSCollection::create(ctx, self, JSCollection::Type::WEAK_MAP);
+  if (args.empty()) {
+    return ctx->undefined();
+  }
+  auto err = JSCollection::iterate(
+      ctx, args[0], [&](common::AutoPtr<JSValue> item) -> void {
+        if (item->getType() != JSValueType::JS_OBJECT &&
+            item->getType() != JSValueType::JS_ARRAY) {
+          throw error::JSTypeError(
+              fmt::format(L"Iterator value {} is not an entry object",
+                          item->toString(ctx)->getString().value()));
+        }
+        auto key = item->getIndex(ctx, 0);
+        if (!JSCollection::canBeHeldWeakly(key)) {
+          throw error::JSTypeError(L"Invalid value used as weak map key");
+        }
+        collection->set(ctx, key, item->getIndex(ctx, 1));
+      });
+  if (err != nullptr) {
+    return err;
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSWeakMapConstructor::get) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_MAP,
+                                         L"WeakMap.prototype.get");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->undefined();
+  }
+  auto entry = collection->get(args[0]);
+  if (!entry) {
+    return ctx->undefined();
+  }
+  return ctx->createValue(entry->value);
+}
+
+JS_FUNC(JSWeakMapConstructor::set) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_MAP,
+                                         L"WeakMap.prototype.set");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->createException(
+        error::JSTypeError(L"Invalid value used as weak map key"));
+  }
+  collection->set(ctx, args[0], args.size() > 1 ? args[1] : ctx->undefined());
+  return self;
+}
+
+JS_FUNC(JSWeakMapConstructor::has) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_MAP,
+                                         L"WeakMap.prototype.has");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->falsely();
+  }
+  return ctx->createBoolean(collection->get(args[0]) != nullptr);
+}
+
+JS_FUNC(JSWeakMapConstructor::remove) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_MAP,
+                                         L"WeakMap.prototype.delete");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->falsely();
+  }
+  return ctx->createBoolean(collection->remove(ctx, args[0]));
+}
+
+JS_FUNC(JSWeakMapConstructor::toStringTag) {
+  return ctx->createString(L"WeakMap");
+}
+
+common::AutoPtr<JSValue>
+JSWeakMapConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto WeakMap = ctx->createNativeFunction(constructor, L"WeakMap", L"WeakMap");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", WeakMap, true, false);
+  WeakMap->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"get", ctx->createNativeFunction(get, L"get"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"set", ctx->createNativeFunction(set, L"set"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"has", ctx->createNativeFunction(has, L"has"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"delete", ctx->createNativeFunction(remove, L"delete"), true,
+      false);
+  ctx->popScope();
+  return WeakMap;
+}
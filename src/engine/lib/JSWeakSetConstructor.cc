@@ -0,0 +1,83 @@
+#include "engine/lib/JSWeakSetConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
+#include <string>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+JS_FUNC(JSWeakSetConstructor::constructor) {
+  auto collection =
+      JSCollection::create(ctx, self, JSCollection::Type::WEAK_SET);
+  if (args.empty()) {
+    return ctx->undefined();
+  }
+  auto err = JSCollection::iterate(
+      ctx, args[0], [&](common::AutoPtr<JSValue> item) -> void {
+        if (!JSCollection::canBeHeldWeakly(item)) {
+          throw error::JSTypeError(L"Invalid value used in weak set");
+        }
+        collection->set(ctx, item);
+      });
+  if (err != nullptr) {
+    return err;
+  }
+  return ctx->undefined();
+}
+
+JS_FUNC(JSWeakSetConstructor::add) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_SET,
+                                         L"WeakSet.prototype.add");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->createException(
+        error::JSTypeError(L"Invalid value used in weak set"));
+  }
+  collection->set(ctx, args[0]);
+  return self;
+}
+
+JS_FUNC(JSWeakSetConstructor::has) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_SET,
+                                         L"WeakSet.prototype.has");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->falsely();
+  }
+  return ctx->createBoolean(collection->get(args[0]) != nullptr);
+}
+
+JS_FUNC(JSWeakSetConstructor::remove) {
+  auto collection = JSCollection::unwrap(self, JSCollection::Type::WEAK_SET,
+                                         L"WeakSet.prototype.delete");
+  if (args.empty() || !JSCollection::canBeHeldWeakly(args[0])) {
+    return ctx->falsely();
+  }
+  return ctx->createBoolean(collection->remove(ctx, args[0]));
+}
+
+JS_FUNC(JSWeakSetConstructor::toStringTag) {
+  return ctx->createString(L"WeakSet");
+}
+
+common::AutoPtr<JSValue>
+JSWeakSetConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto WeakSet = ctx->createNativeFunction(constructor, L"WeakSet", L"WeakSet");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", WeakSet, true, false);
+  WeakSet->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"add", ctx->createNativeFunction(add, L"add"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"has", ctx->createNativeFunction(has, L"has"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"delete", ctx->createNativeFunction(remove, L"delete"), true,
+      false);
+  ctx->popScope();
+  return WeakSet;
+}
@@ -0,0 +1,159 @@
+#include "engine/lib/JSWorkerConstructor.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSEvalType.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/runtime/JSStructuredClone.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "engine/runtime/JSWorker.hpp"
+#include "error/JSError.hpp"
+#include "error/JSTypeError.hpp"
+#include <string>
+#include <utility>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+static common::AutoPtr<JSWorker> unwrap(common::AutoPtr<JSValue> self,
+                                        const std::wstring &method) {
+  if (self->getType() != JSValueType::JS_OBJECT ||
+      !self->hasOpaque<common::AutoPtr<JSWorker>>()) {
+    throw error::JSTypeError(fmt::format(
+        L"Method {} called on incompatible receiver", method));
+  }
+  return self->getOpaque<common::AutoPtr<JSWorker>>();
+}
+
+// the transfer list comes either as is or in the transfer field of an
+// options object
+static common::AutoPtr<JSValue>
+serialize(common::AutoPtr<JSContext> ctx,
+          const std::vector<common::AutoPtr<JSValue>> &args,
+          JSCloneRecord &record) {
+  auto transfer = args.size() > 1 ? args[1] : ctx->undefined();
+  if (transfer->getType() == JSValueType::JS_OBJECT) {
+    transfer = transfer->getProperty(ctx, L"transfer");
+    if (transfer->isException()) {
+      return transfer;
+    }
+  }
+  return JSStructuredClone::serialize(
+      ctx, args.empty() ? ctx->undefined() : args[0], record, transfer);
+}
+
+JS_FUNC(JSWorkerConstructor::constructor) {
+  if (args.empty()) {
+    throw error::JSTypeError(
+        L"The 'filename' argument must be of type string.");
+  }
+  auto source = args[0]->toString(ctx)->getString().value();
+  auto [filename, type] = ctx->getRuntime()->resolveModule(
+      ctx->getCurrentModule().first, source);
+  if (filename.empty() || type != JSEvalType::MODULE) {
+    throw error::JSError(fmt::format(L"Cannot find module '{}'", source));
+  }
+  self->setOpaque(ctx->createWorker(filename, self));
+  return ctx->undefined();
+}
+
+JS_FUNC(JSWorkerConstructor::postMessage) {
+  auto worker = unwrap(self, L"Worker.prototype.postMessage");
+  JSCloneRecord record;
+  auto err = serialize(ctx, args, record);
+  if (err != nullptr) {
+    return err;
+  }
+  worker->postMessage(std::move(record));
+  return ctx->undefined();
+}
+
+JS_FUNC(JSWorkerConstructor::terminate) {
+  unwrap(self, L"Worker.prototype.terminate")->terminate();
+  return ctx->undefined();
+}
+
+JS_FUNC(JSWorkerConstructor::toStringTag) {
+  return ctx->createString(L"Worker");
+}
+
+JS_FUNC(JSWorkerConstructor::postToParent) {
+  JSCloneRecord record;
+  auto err = serialize(ctx, args, record);
+  if (err != nullptr) {
+    return err;
+  }
+  ctx->getWorker()->postParent(JSMessageQueue::JSMessageType::MESSAGE,
+                               std::move(record));
+  return ctx->undefined();
+}
+
+JS_FUNC(JSWorkerConstructor::close) {
+  ctx->getWorker()->close();
+  return ctx->undefined();
+}
+
+// target is the Worker object in the parent and undefined in the worker,
+// whose handler is the global onmessage
+common::AutoPtr<JSValue>
+JSWorkerConstructor::onMessage(common::AutoPtr<JSContext> ctx,
+                               common::AutoPtr<JSValue> target,
+                               common::AutoPtr<JSValue> handler,
+                               common::AutoPtr<JSValue> data) {
+  auto callback = target->isUndefined()
+                      ? ctx->load(L"onmessage")
+                      : target->getProperty(ctx, L"onmessage");
+  if (callback->isException() || !callback->isFunction()) {
+    return callback;
+  }
+  auto event = ctx->createObject();
+  event->setProperty(ctx, L"data", data);
+  return callback->apply(ctx, target, {event});
+}
+
+// an error nobody listens for is rethrown in the parent
+common::AutoPtr<JSValue>
+JSWorkerConstructor::onError(common::AutoPtr<JSContext> ctx,
+                             common::AutoPtr<JSValue> target,
+                             common::AutoPtr<JSValue> handler,
+                             common::AutoPtr<JSValue> message) {
+  auto callback = target->getProperty(ctx, L"onerror");
+  if (callback->isException()) {
+    return callback;
+  }
+  if (!callback->isFunction()) {
+    return ctx->createException(L"Error", message->getString().value());
+  }
+  auto event = ctx->createObject();
+  event->setProperty(ctx, L"message", message);
+  return callback->apply(ctx, target, {event});
+}
+
+common::AutoPtr<JSValue>
+JSWorkerConstructor::initialize(common::AutoPtr<JSContext> ctx) {
+  auto Worker = ctx->createNativeFunction(constructor, L"Worker", L"Worker");
+  ctx->pushScope();
+  auto prototype = ctx->createObject();
+  prototype->setPropertyDescriptor(ctx, L"constructor", Worker, true, false);
+  Worker->setPropertyDescriptor(ctx, L"prototype", prototype, true, false);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_STRING_TAG),
+      ctx->createNativeFunction(toStringTag, L"[Symbol.toStringTag]"), true,
+      false);
+  prototype->setPropertyDescriptor(
+      ctx, L"postMessage",
+      ctx->createNativeFunction(postMessage, L"postMessage"), true, false);
+  prototype->setPropertyDescriptor(
+      ctx, L"terminate", ctx->createNativeFunction(terminate, L"terminate"),
+      true, false);
+  ctx->popScope();
+  return Worker;
+}
+
+void JSWorkerConstructor::initializeWorker(common::AutoPtr<JSContext> ctx) {
+  auto root = ctx->getRoot();
+  root->createValue(ctx->null()->getStore(), L"onmessage");
+  root->createValue(
+      ctx->createNativeFunction(postToParent, L"postMessage")->getStore(),
+      L"postMessage");
+  root->createValue(ctx->createNativeFunction(close, L"close")->getStore(),
+                    L"close");
+}
@@ -0,0 +1,448 @@
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "common/BigInt.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSBooleanEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/runtime/JSContext.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSRangeError.hpp"
+#include "error/JSTypeError.hpp"
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fmt/xchar.h>
+#include <limits>
+#include <new>
+#include <utility>
+using namespace spark;
+using namespace spark::engine;
+
+static double toDouble(common::AutoPtr<JSContext> ctx,
+                       common::AutoPtr<JSValue> value) {
+  if (value->getType() != JSValueType::JS_NUMBER) {
+    value = value->toNumber(ctx);
+  }
+  switch (value->getType()) {
+  case JSValueType::JS_NUMBER:
+    return value->getNumber().value();
+  case JSValueType::JS_INFINITY:
+    return value->getEntity<JSInfinityEntity>()->isNegative()
+               ? -std::numeric_limits<double>::infinity()
+               : std::numeric_limits<double>::infinity();
+  default:
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+static common::AutoPtr<JSValue> toValue(common::AutoPtr<JSContext> ctx,
+                                        double value) {
+  if (std::isnan(value)) {
+    return ctx->NaN();
+  }
+  if (std::isinf(value)) {
+    return ctx->createInfinity(value < 0);
+  }
+  return ctx->createNumber(value);
+}
+
+static uint64_t toBigInt64(common::AutoPtr<JSContext> ctx,
+                           common::AutoPtr<JSValue> value) {
+  auto primitive = value->toPrimitive(ctx, L"number");
+  switch (primitive->getType()) {
+  case JSValueType::JS_BIGINT:
+    return primitive->getBigInt().value().toUint64();
+  case JSValueType::JS_BOOLEAN:
+    return primitive->getBoolean().value() ? 1 : 0;
+  default:
+    throw error::JSTypeError(
+        fmt::format(L"Cannot convert {} to a BigInt",
+                    primitive->toString(ctx)->getString().value()));
+  }
+}
+
+static uint32_t toUint32(double value) {
+  if (value >= 0 && value < 4294967296.0) {
+    return (uint32_t)value;
+  }
+  if (value < 0 && value > -2147483649.0) {
+    return (uint32_t)(int32_t)value;
+  }
+  if (!std::isfinite(value)) {
+    return 0;
+  }
+  auto result = std::fmod(std::trunc(value), 4294967296.0);
+  if (result < 0) {
+    result += 4294967296.0;
+  }
+  return (uint32_t)result;
+}
+
+static uint8_t toUint8Clamp(double value) {
+  if (!(value > 0)) {
+    return 0;
+  }
+  if (value >= 255) {
+    return 255;
+  }
+  return (uint8_t)std::nearbyint(value);
+}
+
+template <class T> static T loadAs(const uint8_t *data) {
+  T value;
+  std::memcpy(&value, data, sizeof(T));
+  return value;
+}
+
+template <class T> static void storeAs(uint8_t *data, T value) {
+  std::memcpy(data, &value, sizeof(T));
+}
+
+JSArrayBuffer::JSArrayBuffer(size_t length, bool shared)
+    : _data(nullptr), _length(length), _shared(shared), _detached(false) {
+  if (shared) {
+    _waitList = std::make_unique<JSWaitList>();
+  }
+  try {
+    _data = (uint8_t *)::operator new[](std::max(length, (size_t)1),
+                                        std::align_val_t(ALIGNMENT));
+  } catch (std::bad_alloc &) {
+    throw error::JSRangeError(L"Array buffer allocation failed");
+  }
+  std::memset(_data, 0, length);
+}
+
+JSArrayBuffer::~JSArrayBuffer() {
+  ::operator delete[](_data, std::align_val_t(ALIGNMENT));
+}
+
+common::AutoPtr<JSValue>
+JSArrayBuffer::create(common::AutoPtr<JSContext> ctx,
+                      common::AutoPtr<JSArrayBuffer> buffer) {
+  auto constructor =
+      buffer->isShared() ? ctx->SharedArrayBuffer() : ctx->ArrayBuffer();
+  auto object =
+      ctx->createObject(constructor->getProperty(ctx, L"prototype"));
+  object->setOpaque(buffer);
+  return object;
+}
+
+common::AutoPtr<JSArrayBuffer>
+JSArrayBuffer::unwrap(common::AutoPtr<JSValue> self,
+                      const std::wstring &method, bool shared) {
+  if (self->getType() != JSValueType::JS_OBJECT ||
+      !self->hasOpaque<common::AutoPtr<JSArrayBuffer>>() ||
+      self->getOpaque<common::AutoPtr<JSArrayBuffer>>()->isShared() !=
+          shared) {
+    throw error::JSTypeError(fmt::format(
+        L"Method {} called on incompatible receiver", method));
+  }
+  return self->getOpaque<common::AutoPtr<JSArrayBuffer>>();
+}
+
+size_t JSArrayBuffer::toIndex(common::AutoPtr<JSContext> ctx,
+                              common::AutoPtr<JSValue> value,
+                              const std::wstring &name) {
+  if (value == nullptr || value->isUndefined()) {
+    return 0;
+  }
+  auto number = toDouble(ctx, value);
+  if (std::isnan(number)) {
+    return 0;
+  }
+  number = std::trunc(number);
+  if (number < 0 || number > 9007199254740991.0) {
+    throw error::JSRangeError(fmt::format(L"Invalid {}", name));
+  }
+  return (size_t)number;
+}
+
+size_t JSArrayBuffer::toRelativeIndex(common::AutoPtr<JSContext> ctx,
+                                      common::AutoPtr<JSValue> value,
+                                      size_t length, size_t fallback) {
+  if (value == nullptr || value->isUndefined()) {
+    return fallback;
+  }
+  auto number = toDouble(ctx, value);
+  if (std::isnan(number)) {
+    return 0;
+  }
+  number = std::trunc(number);
+  if (number < 0) {
+    return (size_t)std::max(number + (double)length, 0.0);
+  }
+  return (size_t)std::min(number, (double)length);
+}
+
+uint8_t *JSArrayBuffer::getData() const { return _data; }
+
+size_t JSArrayBuffer::getLength() const { return _length; }
+
+bool JSArrayBuffer::isShared() const { return _shared; }
+
+bool JSArrayBuffer::isDetached() const { return _detached; }
+
+common::AutoPtr<JSArrayBuffer> JSArrayBuffer::transfer() {
+  common::AutoPtr<JSArrayBuffer> result = new JSArrayBuffer(0);
+  std::swap(result->_data, _data);
+  std::swap(result->_length, _length);
+  _detached = true;
+  return result;
+}
+
+JSArrayBuffer::WaitResult JSArrayBuffer::wait(size_t offset, int64_t expected,
+                                              size_t size, double timeout) {
+  std::unique_lock lock(_waitList->mutex);
+  auto current =
+      size == 4
+          ? (int64_t)std::atomic_ref<int32_t>(*(int32_t *)(_data + offset))
+                .load()
+          : std::atomic_ref<int64_t>(*(int64_t *)(_data + offset)).load();
+  if (current != expected) {
+    return WaitResult::NOT_EQUAL;
+  }
+  JSWaiter waiter = {.offset = offset, .notified = false};
+  _waitList->waiters.push_back(&waiter);
+  auto notified = [&]() -> bool { return waiter.notified; };
+  if (std::isinf(timeout)) {
+    _waitList->condition.wait(lock, notified);
+  } else {
+    _waitList->condition.wait_for(
+        lock, std::chrono::duration<double, std::milli>(timeout), notified);
+  }
+  _waitList->waiters.remove(&waiter);
+  return waiter.notified ? WaitResult::OK : WaitResult::TIMED_OUT;
+}
+
+uint32_t JSArrayBuffer::notify(size_t offset, uint32_t count) {
+  if (_waitList == nullptr) {
+    return 0;
+  }
+  std::lock_guard lock(_waitList->mutex);
+  uint32_t woken = 0;
+  for (auto waiter : _waitList->waiters) {
+    if (woken == count) {
+      break;
+    }
+    if (waiter->offset == offset && !waiter->notified) {
+      waiter->notified = true;
+      woken++;
+    }
+  }
+  if (woken != 0) {
+    _waitList->condition.notify_all();
+  }
+  return woken;
+}
+
+size_t JSTypedArray::getElementSize(Type type) {
+  switch (type) {
+  case Type::INT8:
+  case Type::UINT8:
+  case Type::UINT8_CLAMPED:
+    return 1;
+  case Type::INT16:
+  case Type::UINT16:
+    return 2;
+  case Type::INT32:
+  case Type::UINT32:
+  case Type::FLOAT32:
+    return 4;
+  case Type::FLOAT64:
+  case Type::BIGINT64:
+  case Type::BIGUINT64:
+    return 8;
+  }
+  return 1;
+}
+
+const wchar_t *JSTypedArray::getName(Type type) {
+  switch (type) {
+  case Type::INT8:
+    return L"Int8Array";
+  case Type::UINT8:
+    return L"Uint8Array";
+  case Type::UINT8_CLAMPED:
+    return L"Uint8ClampedArray";
+  case Type::INT16:
+    return L"Int16Array";
+  case Type::UINT16:
+    return L"Uint16Array";
+  case Type::INT32:
+    return L"Int32Array";
+  case Type::UINT32:
+    return L"Uint32Array";
+  case Type::FLOAT32:
+    return L"Float32Array";
+  case Type::FLOAT64:
+    return L"Float64Array";
+  case Type::BIGINT64:
+    return L"BigInt64Array";
+  case Type::BIGUINT64:
+    return L"BigUint64Array";
+  }
+  return L"TypedArray";
+}
+
+bool JSTypedArray::isBigInt(Type type) {
+  return type == Type::BIGINT64 || type == Type::BIGUINT64;
+}
+
+double JSTypedArray::load(Type type, const uint8_t *data) {
+  switch (type) {
+  case Type::INT8:
+    return loadAs<int8_t>(data);
+  case Type::UINT8:
+  case Type::UINT8_CLAMPED:
+    return loadAs<uint8_t>(data);
+  case Type::INT16:
+    return loadAs<int16_t>(data);
+  case Type::UINT16:
+    return loadAs<uint16_t>(data);
+  case Type::INT32:
+    return loadAs<int32_t>(data);
+  case Type::UINT32:
+    return loadAs<uint32_t>(data);
+  case Type::FLOAT32:
+    return loadAs<float>(data);
+  case Type::FLOAT64:
+    return loadAs<double>(data);
+  case Type::BIGINT64:
+    return (double)loadAs<int64_t>(data);
+  case Type::BIGUINT64:
+    return (double)loadAs<uint64_t>(data);
+  }
+  return 0;
+}
+
+void JSTypedArray::store(Type type, uint8_t *data, double value) {
+  switch (type) {
+  case Type::INT8:
+  case Type::UINT8:
+    storeAs<uint8_t>(data, (uint8_t)toUint32(value));
+    break;
+  case Type::UINT8_CLAMPED:
+    storeAs<uint8_t>(data, toUint8Clamp(value));
+    break;
+  case Type::INT16:
+  case Type::UINT16:
+    storeAs<uint16_t>(data, (uint16_t)toUint32(value));
+    break;
+  case Type::INT32:
+  case Type::UINT32:
+    storeAs<uint32_t>(data, toUint32(value));
+    break;
+  case Type::FLOAT32:
+    storeAs<float>(data, (float)value);
+    break;
+  case Type::FLOAT64:
+    storeAs<double>(data, value);
+    break;
+  case Type::BIGINT64:
+  case Type::BIGUINT64:
+    break;
+  }
+}
+
+common::AutoPtr<JSValue> JSTypedArray::read(common::AutoPtr<JSContext> ctx,
+                                            Type type, const uint8_t *data,
+                                            bool littleEndian) {
+  uint8_t bytes[8];
+  auto size = getElementSize(type);
+  if (littleEndian != (std::endian::native == std::endian::little)) {
+    std::reverse_copy(data, data + size, bytes);
+    data = bytes;
+  }
+  switch (type) {
+  case Type::BIGINT64:
+    return ctx->createBigInt(common::BigInt<>(loadAs<int64_t>(data)));
+  case Type::BIGUINT64:
+    return ctx->createBigInt(
+        common::BigInt<>::fromUint64(loadAs<uint64_t>(data)));
+  case Type::FLOAT32:
+  case Type::FLOAT64:
+    return toValue(ctx, load(type, data));
+  default:
+    return ctx->createNumber(load(type, data));
+  }
+}
+
+void JSTypedArray::write(common::AutoPtr<JSContext> ctx, Type type,
+                         uint8_t *data, common::AutoPtr<JSValue> value,
+                         bool littleEndian) {
+  uint8_t bytes[8];
+  auto size = getElementSize(type);
+  if (isBigInt(type)) {
+    storeAs<uint64_t>(bytes, toBigInt64(ctx, value));
+  } else {
+    store(type, bytes, toDouble(ctx, value));
+  }
+  if (littleEndian != (std::endian::native == std::endian::little)) {
+    std::reverse_copy(bytes, bytes + size, data);
+  } else {
+    std::memcpy(data, bytes, size);
+  }
+}
+
+JSTypedArray &JSTypedArray::unwrap(common::AutoPtr<JSValue> self,
+                                   const std::wstring &method,
+                                   bool detached) {
+  if (self->getType() != JSValueType::JS_OBJECT ||
+      !self->hasOpaque<JSTypedArray>()) {
+    throw error::JSTypeError(
+        fmt::format(L"Method {} called on incompatible receiver", method));
+  }
+  auto &array = self->getOpaque<JSTypedArray>();
+  if (!detached && array.buffer->isDetached()) {
+    throw error::JSTypeError(fmt::format(
+        L"Cannot perform {} on a detached ArrayBuffer", method));
+  }
+  return array;
+}
+
+common::AutoPtr<JSValue>
+JSTypedArray::getBuffer(common::AutoPtr<JSContext> ctx,
+                        common::AutoPtr<JSValue> self) {
+  auto &array = self->getOpaque<JSTypedArray>();
+  if (array.object == nullptr) {
+    auto object = JSArrayBuffer::create(ctx, array.buffer);
+    self->getStore()->appendChild(object->getStore());
+    array.object = object->getStore();
+  }
+  return ctx->createValue(array.object);
+}
+
+uint8_t *JSTypedArray::getData() const { return buffer->getData() + offset; }
+
+size_t JSTypedArray::getByteLength() const {
+  return length * getElementSize(type);
+}
+
+common::AutoPtr<JSValue> JSTypedArray::get(common::AutoPtr<JSContext> ctx,
+                                           size_t index) const {
+  if (index >= length || buffer->isDetached()) {
+    return ctx->undefined();
+  }
+  auto data = getData() + index * getElementSize(type);
+  if (type == Type::FLOAT64) {
+    return toValue(ctx, loadAs<double>(data));
+  }
+  return read(ctx, type, data);
+}
+
+void JSTypedArray::set(common::AutoPtr<JSContext> ctx, size_t index,
+                       common::AutoPtr<JSValue> value) {
+  if (isBigInt(type)) {
+    auto bits = toBigInt64(ctx, value);
+    if (index < length && !buffer->isDetached()) {
+      storeAs<uint64_t>(getData() + index * 8, bits);
+    }
+    return;
+  }
+  auto number = toDouble(ctx, value);
+  if (index < length && !buffer->isDetached()) {
+    store(type, getData() + index * getElementSize(type), number);
+  }
+}
@@ -0,0 +1,487 @@
+#include "engine/runtime/JSCollection.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSArrayEntity.hpp"
+#include "engine/entity/JSBigIntEntity.hpp"
+#include "engine/entity/JSBooleanEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/entity/JSNumberEntity.hpp"
+#include "engine/entity/JSStringEntity.hpp"
+#include "engine/runtime/JSContext.hpp"
+#include "engine/runtime/JSValue.hpp"
+#include "error/JSTypeError.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fmt/xchar.h>
+#include <limits>
+using namespace spark;
+using namespace spark::engine;
+
+static size_t mix(uint64_t value) {
+  value ^= value >> 30;
+  value *= 0xbf58476d1ce4e5b9ULL;
+  value ^= value >> 27;
+  value *= 0x94d049bb133111ebULL;
+  value ^= value >> 31;
+  return (size_t)value;
+}
+
+static bool isNumeric(JSValueType type) {
+  return type == JSValueType::JS_NUMBER || type == JSValueType::JS_NAN ||
+         type == JSValueType::JS_INFINITY;
+}
+
+static double toDouble(const common::AutoPtr<JSEntity> &entity) {
+  switch (entity->getType()) {
+  case JSValueType::JS_NUMBER:
+    return entity.cast<JSNumberEntity>()->getValue();
+  case JSValueType::JS_INFINITY:
+    return entity.cast<JSInfinityEntity>()->isNegative()
+               ? -std::numeric_limits<double>::infinity()
+               : std::numeric_limits<double>::infinity();
+  default:
+    return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+JSCollection::JSCollection(Type type, JSStore *holder)
+    : _type(type), _holder(holder), _size(0), _used(0), _deleted(0) {}
+
+size_t JSCollection::hashOf(const common::AutoPtr<JSEntity> &entity) {
+  auto type = entity->getType();
+  if (isNumeric(type)) {
+    auto value = toDouble(entity);
+    if (std::isnan(value)) {
+      return mix(0x7ff8000000000000ULL);
+    }
+    if (value == 0) {
+      value = 0;
+    }
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return mix(bits);
+  }
+  switch (type) {
+  case JSValueType::JS_STRING:
+    return mix(std::hash<std::wstring>{}(
+        entity.cast<JSStringEntity>()->getValue()));
+  case JSValueType::JS_BIGINT: {
+    auto &value = entity.cast<JSBigIntEntity>()->getValue();
+    auto small = value.toInt64();
+    if (small.has_value()) {
+      return mix((uint64_t)small.value() ^ 0x5bd1e995ULL);
+    }
+    return mix(std::hash<std::wstring>{}(value.toString()));
+  }
+  case JSValueType::JS_BOOLEAN:
+    return mix(entity.cast<JSBooleanEntity>()->getValue() ? 3 : 2);
+  case JSValueType::JS_UNINITIALIZED:
+  case JSValueType::JS_UNDEFINED:
+  case JSValueType::JS_NULL:
+    return mix((uint64_t)type);
+  default:
+    return mix((uintptr_t)entity.getRawPointer());
+  }
+}
+
+bool JSCollection::isSame(const common::AutoPtr<JSEntity> &a,
+                          const common::AutoPtr<JSEntity> &b) {
+  auto ta = a->getType();
+  auto tb = b->getType();
+  if (isNumeric(ta) && isNumeric(tb)) {
+    auto va = toDouble(a);
+    auto vb = toDouble(b);
+    return va == vb || (std::isnan(va) && std::isnan(vb));
+  }
+  if (ta != tb) {
+    return false;
+  }
+  switch (ta) {
+  case JSValueType::JS_STRING:
+    return a.cast<JSStringEntity>()->getValue() ==
+           b.cast<JSStringEntity>()->getValue();
+  case JSValueType::JS_BIGINT:
+    return a.cast<JSBigIntEntity>()->getValue() ==
+           b.cast<JSBigIntEntity>()->getValue();
+  case JSValueType::JS_BOOLEAN:
+    return a.cast<JSBooleanEntity>()->getValue() ==
+           b.cast<JSBooleanEntity>()->getValue();
+  case JSValueType::JS_UNINITIALIZED:
+  case JSValueType::JS_UNDEFINED:
+  case JSValueType::JS_NULL:
+    return true;
+  default:
+    return a.getRawPointer() == b.getRawPointer();
+  }
+}
+
+size_t JSCollection::find(const common::AutoPtr<JSEntity> &identity,
+                          size_t hash) const {
+  if (_slots.empty()) {
+    return NPOS;
+  }
+  auto mask = _slots.size() - 1;
+  for (auto index = hash & mask;; index = (index + 1) & mask) {
+    auto slot = _slots[index];
+    if (slot == EMPTY) {
+      return NPOS;
+    }
+    if (slot != TOMBSTONE) {
+      auto &entry = _entries[slot - 1];
+      if (entry.hash == hash && isSame(entry.identity, identity)) {
+        return index;
+      }
+    }
+  }
+}
+
+void JSCollection::rehash(size_t capacity) {
+  _slots.assign(capacity, EMPTY);
+  auto mask = capacity - 1;
+  for (size_t index = 0; index < _entries.size(); index++) {
+    auto &entry = _entries[index];
+    if (entry.deleted) {
+      continue;
+    }
+    auto pos = entry.hash & mask;
+    while (_slots[pos] != EMPTY) {
+      pos = (pos + 1) & mask;
+    }
+    _slots[pos] = (uint32_t)index + 1;
+  }
+  _used = _size;
+}
+
+void JSCollection::release(size_t slot) {
+  auto &entry = _entries[_slots[slot] - 1];
+  if (entry.key) {
+    _garbage.push_back(entry.key);
+  }
+  if (entry.value) {
+    _garbage.push_back(entry.value);
+  }
+  entry.identity = nullptr;
+  entry.key = nullptr;
+  entry.value = nullptr;
+  entry.deleted = true;
+  _slots[slot] = TOMBSTONE;
+  _size--;
+  _deleted++;
+}
+
+void JSCollection::collect(common::AutoPtr<JSContext> ctx) {
+  if (_deleted + _garbage.size() > std::max<size_t>(_size, 16)) {
+    compact(ctx);
+  }
+}
+
+void JSCollection::compact(common::AutoPtr<JSContext> ctx) {
+  std::erase_if(_cursors, [](auto &cursor) { return cursor->ref() == 1; });
+  if (!_cursors.empty()) {
+    std::vector<size_t> offsets(_entries.size() + 1, 0);
+    for (size_t index = 0; index < _entries.size(); index++) {
+      offsets[index + 1] = offsets[index] + (_entries[index].deleted ? 0 : 1);
+    }
+    for (auto &cursor : _cursors) {
+      cursor->index = offsets[std::min(cursor->index, _entries.size())];
+    }
+  }
+  std::erase_if(_entries, [](auto &entry) { return entry.deleted; });
+  _deleted = 0;
+  size_t capacity = 8;
+  while (capacity < _size * 4) {
+    capacity <<= 1;
+  }
+  rehash(capacity);
+  auto root = ctx->getScope()->getRoot();
+  for (auto &store : _garbage) {
+    auto &parents = store->getParent();
+    auto it = std::find(parents.begin(), parents.end(), _holder);
+    if (it != parents.end()) {
+      parents.erase(it);
+    }
+    root->appendChild(store);
+  }
+  _garbage.clear();
+  auto &children = _holder->getChildren();
+  children.clear();
+  for (auto &entry : _entries) {
+    if (entry.key) {
+      children.push_back(entry.key);
+    }
+    if (entry.value) {
+      children.push_back(entry.value);
+    }
+  }
+}
+
+JSStore *JSCollection::store(common::AutoPtr<JSContext> ctx,
+                             common::AutoPtr<JSValue> value) {
+  auto store = ctx->createValue(value)->getStore();
+  _holder->appendChild(store);
+  return store;
+}
+
+common::AutoPtr<JSCollection>
+JSCollection::create(common::AutoPtr<JSContext> ctx,
+                     common::AutoPtr<JSValue> self, Type type) {
+  auto holder =
+      ctx->createValue(new JSStore(new JSEntity(JSValueType::JS_OBJECT)));
+  self->getStore()->appendChild(holder->getStore());
+  common::AutoPtr<JSCollection> collection =
+      new JSCollection(type, holder->getStore());
+  self->setOpaque(collection);
+  if (collection->isWeak()) {
+    ctx->registerWeakCollection(collection);
+  }
+  return collection;
+}
+
+common::AutoPtr<JSCollection>
+JSCollection::unwrap(common::AutoPtr<JSValue> self, Type type,
+                     const std::wstring &method) {
+  if (self->getType() == JSValueType::JS_OBJECT &&
+      self->hasOpaque<common::AutoPtr<JSCollection>>()) {
+    auto collection = self->getOpaque<common::AutoPtr<JSCollection>>();
+    if (collection->getType() == type) {
+      return collection;
+    }
+  }
+  throw error::JSTypeError(fmt::format(
+      L"Method {} called on incompatible receiver {}", method,
+      self->getType() == JSValueType::JS_OBJECT ? L"#<Object>" : L"value"));
+}
+
+common::AutoPtr<JSValue> JSCollection::iterate(
+    common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> iterable,
+    const std::function<void(common::AutoPtr<JSValue>)> &callback) {
+  if (iterable->isUndefined() || iterable->isNull()) {
+    return nullptr;
+  }
+  auto iterator = iterable->getProperty(
+      ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_ITERATOR));
+  if (!iterator->isFunction()) {
+    throw error::JSTypeError(fmt::format(
+        L"{} is not iterable", iterable->toString(ctx)->getString().value()));
+  }
+  if (iterable->getType() == JSValueType::JS_ARRAY &&
+      iterator->getStore() ==
+          ctx->getIntrinsic(JSIntrinsic::ARRAY_VALUES)->getStore()) {
+    auto entity = iterable->getEntity<JSArrayEntity>();
+    for (size_t index = 0; index < entity->getItems().size(); index++) {
+      callback(iterable->getIndex(ctx, index));
+    }
+    return nullptr;
+  }
+  auto gen = iterator->apply(ctx, iterable);
+  if (gen->isException()) {
+    return gen;
+  }
+  if (gen->hasOpaque<Iterator>()) {
+    auto &it = gen->getOpaque<Iterator>();
+    for (auto value = it.collection->next(ctx, it); value != nullptr;
+         value = it.collection->next(ctx, it)) {
+      callback(value);
+    }
+    return nullptr;
+  }
+  auto next = gen->getProperty(ctx, L"next");
+  for (;;) {
+    auto res = next->apply(ctx, gen);
+    if (res->isException()) {
+      return res;
+    }
+    if (res->getType() != JSValueType::JS_OBJECT) {
+      throw error::JSTypeError(
+          fmt::format(L"Iterator result '{}' is not an object",
+                      res->toString(ctx)->getString().value()));
+    }
+    if (res->getProperty(ctx, L"done")->toBoolean(ctx)->getBoolean().value()) {
+      break;
+    }
+    callback(res->getProperty(ctx, L"value"));
+  }
+  return nullptr;
+}
+
+bool JSCollection::canBeHeldWeakly(common::AutoPtr<JSValue> value) {
+  switch (value->getType()) {
+  case JSValueType::JS_SYMBOL:
+  case JSValueType::JS_OBJECT:
+  case JSValueType::JS_ARRAY:
+  case JSValueType::JS_REGEXP:
+  case JSValueType::JS_NATIVE_FUNCTION:
+  case JSValueType::JS_FUNCTION:
+  case JSValueType::JS_CLASS:
+    return true;
+  default:
+    return false;
+  }
+}
+
+JSCollection::Type JSCollection::getType() const { return _type; }
+
+bool JSCollection::isWeak() const {
+  return _type == Type::WEAK_MAP || _type == Type::WEAK_SET;
+}
+
+size_t JSCollection::getSize() const { return _size; }
+
+const JSCollection::Entry *
+JSCollection::get(common::AutoPtr<JSValue> key) const {
+  auto identity = key->getEntity();
+  auto slot = find(identity, hashOf(identity));
+  if (slot == NPOS) {
+    return nullptr;
+  }
+  return &_entries[_slots[slot] - 1];
+}
+
+void JSCollection::set(common::AutoPtr<JSContext> ctx,
+                       common::AutoPtr<JSValue> key,
+                       common::AutoPtr<JSValue> value) {
+  auto identity = key->getEntity();
+  auto hash = hashOf(identity);
+  auto slot = find(identity, hash);
+  if (slot != NPOS) {
+    if (value != nullptr) {
+      auto &entry = _entries[_slots[slot] - 1];
+      _garbage.push_back(entry.value);
+      entry.value = store(ctx, value);
+      collect(ctx);
+    }
+    return;
+  }
+  if (_entries.size() >= TOMBSTONE - 1) {
+    compact(ctx);
+  }
+  if ((_used + 1) * 2 > _slots.size()) {
+    size_t capacity = 8;
+    while (capacity < (_size + 1) * 4) {
+      capacity <<= 1;
+    }
+    rehash(capacity);
+  }
+  Entry entry = {.identity = identity,
+                 .key = nullptr,
+                 .value = nullptr,
+                 .hash = hash,
+                 .deleted = false};
+  if (!isWeak()) {
+    if (key->getType() == JSValueType::JS_NUMBER &&
+        key->getNumber().value() == 0) {
+      key = ctx->createNumber(0);
+    }
+    entry.key = store(ctx, key);
+    entry.identity = entry.key->getEntity();
+  }
+  if (value != nullptr) {
+    entry.value = store(ctx, value);
+  }
+  auto mask = _slots.size() - 1;
+  auto pos = hash & mask;
+  while (_slots[pos] != EMPTY && _slots[pos] != TOMBSTONE) {
+    pos = (pos + 1) & mask;
+  }
+  if (_slots[pos] == EMPTY) {
+    _used++;
+  }
+  _entries.push_back(entry);
+  _slots[pos] = (uint32_t)_entries.size();
+  _size++;
+}
+
+bool JSCollection::remove(common::AutoPtr<JSContext> ctx,
+                          common::AutoPtr<JSValue> key) {
+  auto identity = key->getEntity();
+  auto slot = find(identity, hashOf(identity));
+  if (slot == NPOS) {
+    return false;
+  }
+  release(slot);
+  collect(ctx);
+  return true;
+}
+
+void JSCollection::clear(common::AutoPtr<JSContext> ctx) {
+  for (size_t slot = 0; slot < _slots.size(); slot++) {
+    if (_slots[slot] != EMPTY && _slots[slot] != TOMBSTONE) {
+      release(slot);
+    }
+  }
+  compact(ctx);
+}
+
+void JSCollection::sweep(common::AutoPtr<JSContext> ctx) {
+  auto size = _size;
+  for (size_t slot = 0; slot < _slots.size(); slot++) {
+    if (_slots[slot] != EMPTY && _slots[slot] != TOMBSTONE &&
+        _entries[_slots[slot] - 1].identity->ref() == 1) {
+      release(slot);
+    }
+  }
+  if (_size != size) {
+    collect(ctx);
+  }
+}
+
+common::AutoPtr<JSCollection::Cursor> JSCollection::createCursor() {
+  if (_cursors.size() >= 8) {
+    std::erase_if(_cursors, [](auto &cursor) { return cursor->ref() == 1; });
+  }
+  common::AutoPtr<Cursor> cursor = new Cursor();
+  _cursors.push_back(cursor);
+  return cursor;
+}
+
+const JSCollection::Entry *
+JSCollection::next(common::AutoPtr<Cursor> cursor) const {
+  if (cursor->done) {
+    return nullptr;
+  }
+  while (cursor->index < _entries.size()) {
+    auto &entry = _entries[cursor->index++];
+    if (!entry.deleted) {
+      return &entry;
+    }
+  }
+  cursor->done = true;
+  return nullptr;
+}
+
+common::AutoPtr<JSValue> JSCollection::next(common::AutoPtr<JSContext> ctx,
+                                            Iterator &iterator) {
+  auto entry = next(iterator.cursor);
+  if (!entry) {
+    return nullptr;
+  }
+  auto key = ctx->createValue(entry->key);
+  auto value = entry->value ? ctx->createValue(entry->value) : key;
+  switch (iterator.kind) {
+  case Kind::KEYS:
+    return key;
+  case Kind::VALUES:
+    return value;
+  case Kind::ENTRIES: {
+    auto item = ctx->createArray();
+    item->setIndex(ctx, 0, ctx->createValue(key));
+    item->setIndex(ctx, 1, ctx->createValue(value));
+    return item;
+  }
+  }
+  return nullptr;
+}
+
+common::AutoPtr<JSValue>
+JSCollection::createIterator(common::AutoPtr<JSContext> ctx, Kind kind) {
+  auto prototype =
+      _type == Type::MAP ? ctx->MapIterator() : ctx->SetIterator();
+  auto obj = ctx->createObject(prototype);
+  obj->setOpaque(Iterator{
+      .collection = this,
+      .cursor = createCursor(),
+      .kind = kind,
+  });
+  obj->getStore()->appendChild(_holder);
+  return obj;
+}
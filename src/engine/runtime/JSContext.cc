@@ -19,47 +19,73 @@
 #include "engine/entity/JSSymbolEntity.hpp"
 #include "engine/entity/JSUndefinedEntity.hpp"
 #include "engine/lib/JSAggregateErrorConstructor.hpp"
+#include "engine/lib/JSArrayBufferConstructor.hpp"
+#include "engine/lib/JSAtomicsConstructor.hpp"
 #include "engine/lib/JSArrayConstructor.hpp"
 #include "engine/lib/JSAsyncFunctionConstructor.hpp"
 #include "engine/lib/JSAsyncGeneratorConstructor.hpp"
 #include "engine/lib/JSAsyncGeneratorFunctionConstructor.hpp"
 #include "engine/lib/JSAsyncIteratorConstructor.hpp"
+#include "engine/lib/JSDataViewConstructor.hpp"
 #include "engine/lib/JSErrorConstructor.hpp"
 #include "engine/lib/JSFunctionConstructor.hpp"
 #include "engine/lib/JSGeneratorConstructor.hpp"
 #include "engine/lib/JSGeneratorFunctionConstructor.hpp"
 #include "engine/lib/JSInternalErrorConstructor.hpp"
 #include "engine/lib/JSIteratorConstructor.hpp"
+#include "engine/lib/JSJSONConstructor.hpp"
+#include "engine/lib/JSMapConstructor.hpp"
 #include "engine/lib/JSObjectConstructor.hpp"
 #include "engine/lib/JSPromiseConstructor.hpp"
 #include "engine/lib/JSRangeErrorConstructor.hpp"
 #include "engine/lib/JSReferenceErrorConstructor.hpp"
 #include "engine/lib/JSRegexConstructor.hpp"
+#include "engine/lib/JSSetConstructor.hpp"
+#include "engine/lib/JSSharedArrayBufferConstructor.hpp"
 #include "engine/lib/JSSymbolConstructor.hpp"
 #include "engine/lib/JSSyntaxErrorConstructor.hpp"
 #include "engine/lib/JSTypeErrorConstructor.hpp"
+#include "engine/lib/JSTypedArrayConstructor.hpp"
 #include "engine/lib/JSURIErrorConstructor.hpp"
+#include "engine/lib/JSWeakMapConstructor.hpp"
+#include "engine/lib/JSWeakSetConstructor.hpp"
+#include "engine/lib/JSWorkerConstructor.hpp"
 #include "engine/runtime/JSRuntime.hpp"
 #include "engine/runtime/JSScope.hpp"
+#include "engine/runtime/JSSnapshot.hpp"
 #include "engine/runtime/JSStore.hpp"
+#include "engine/runtime/JSStructuredClone.hpp"
 #include "engine/runtime/JSValue.hpp"
+#include "engine/runtime/JSWorker.hpp"
 #include "error/JSInternalError.hpp"
 #include "error/JSSyntaxError.hpp"
 #include "error/JSTypeError.hpp"
 #include "vm/JSCoroutineContext.hpp"
+#include <atomic>
 #include <chrono>
-#include <codecvt>
 #include <cstdint>
-#include <fstream>
 #include <locale>
-#include <set>
 #include <string>
-#include <thread>
 #include <vector>
 
 using namespace spark;
 using namespace spark::engine;
 
+static const std::pair<JSIntrinsic, const wchar_t *> WELL_KNOWN_SYMBOLS[] = {
+    {JSIntrinsic::SYMBOL_ASYNC_ITERATOR, L"asyncIterator"},
+    {JSIntrinsic::SYMBOL_HAS_INSTANCE, L"hasInstance"},
+    {JSIntrinsic::SYMBOL_IS_CONCAT_SPREADABLE, L"isConcatSpreadable"},
+    {JSIntrinsic::SYMBOL_ITERATOR, L"iterator"},
+    {JSIntrinsic::SYMBOL_MATCH, L"match"},
+    {JSIntrinsic::SYMBOL_REPLACE, L"replace"},
+    {JSIntrinsic::SYMBOL_SEARCH, L"search"},
+    {JSIntrinsic::SYMBOL_SPECIES, L"species"},
+    {JSIntrinsic::SYMBOL_SPLIT, L"split"},
+    {JSIntrinsic::SYMBOL_TO_PRIMITIVE, L"toPrimitive"},
+    {JSIntrinsic::SYMBOL_TO_STRING_TAG, L"toStringTag"},
+    {JSIntrinsic::SYMBOL_UNSCOPABLES, L"unscopables"},
+};
+
 JSContext::JSContext(const common::AutoPtr<JSRuntime> &runtime)
     : _runtime(runtime) {
   _gcRoot = new JSStore();
@@ -67,13 +93,28 @@ JSContext::JSContext(const common::AutoPtr<JSRuntime> &runtime)
   _root = _scope;
   _callStack = new JSCallFrame();
   _currentModule = {_runtime->getCurrentPath().append(L"/spark.js"), nullptr};
-  initialize();
+  _inbox = new JSMessageQueue();
+  auto snapshot = _runtime->getSnapshot();
+  if (snapshot != nullptr) {
+    restore(snapshot);
+  } else {
+    initialize();
+    _runtime->setSnapshot(createSnapshot());
+  }
 }
 
 JSContext::~JSContext() {
+  for (auto &[_, worker] : _workers) {
+    worker.first->terminate();
+  }
+  for (auto &[_, worker] : _workers) {
+    worker.first->join();
+  }
+  _workers.clear();
   while (_callStack) {
     popCallStack();
   }
+  _weakCollections.clear();
   _scope = nullptr;
   _root = nullptr;
   gc();
@@ -99,6 +140,7 @@ void JSContext::initialize() {
   ObjectConstructorEntity->appendChild(functionPrototype->getStore());
   _Object = _scope->createValue(ObjectConstructorEntity, L"Object");
   _Object->setPropertyDescriptor(this, L"prototype", objectPrototype);
+  _intrinsics[(size_t)JSIntrinsic::OBJECT_PROTOTYPE] = objectPrototype;
   objectPrototype->setPropertyDescriptor(this, L"constructor", _Object);
 
   JSStore *FunctionConstructorEntity = new JSStore(
@@ -107,6 +149,7 @@ void JSContext::initialize() {
   FunctionConstructorEntity->appendChild(functionPrototype->getStore());
   _Function = _scope->createValue(FunctionConstructorEntity, L"Function");
   _Function->setPropertyDescriptor(this, L"prototype", functionPrototype);
+  _intrinsics[(size_t)JSIntrinsic::FUNCTION_PROTOTYPE] = functionPrototype;
   functionPrototype->setPropertyDescriptor(this, L"constructor", _Function);
 
   auto symbolPrototype = createObject();
@@ -114,25 +157,54 @@ void JSContext::initialize() {
                                  L"Symbol");
   _Symbol->setPropertyDescriptor(this, L"prototype", symbolPrototype);
   symbolPrototype->setPropertyDescriptor(this, L"constructor", _Symbol);
-
-  _symbols[L"value"] = createSymbol();
-  _symbols[L"pack"] = createSymbol();
-  _symbols[L"identify"] = createSymbol();
+  _intrinsics[(size_t)JSIntrinsic::SYMBOL_PROTOTYPE] = symbolPrototype;
+
+  _intrinsics[(size_t)JSIntrinsic::INTERNAL_VALUE] = createSymbol();
+  _intrinsics[(size_t)JSIntrinsic::INTERNAL_PACK] = createSymbol();
+  _intrinsics[(size_t)JSIntrinsic::INTERNAL_IDENTIFY] = createSymbol();
+  _intrinsics[(size_t)JSIntrinsic::INTERNAL_REGEX_VALUE] =
+      createSymbol(L"regex_value");
+  _intrinsics[(size_t)JSIntrinsic::INTERNAL_REGEX_FLAG] =
+      createSymbol(L"regex_flag");
+  _intrinsics[(size_t)JSIntrinsic::INTERNAL_LAST_INDEX] =
+      createSymbol(L"lastIndex");
+  _intrinsics[(size_t)JSIntrinsic::SYMBOL_REGISTRY] = createObject(null);
 
   JSSymbolConstructor::initialize(this, _Symbol, symbolPrototype);
+  for (auto &[intrinsic, name] : WELL_KNOWN_SYMBOLS) {
+    _intrinsics[(size_t)intrinsic] = _Symbol->getProperty(this, name);
+  }
   JSObjectConstructor::initialize(this, _Object, objectPrototype);
   JSFunctionConstructor::initialize(this, _Function, functionPrototype);
   _AsyncFunction = JSAsyncFunctionConstructor::initialize(this);
   _Array = JSArrayConstructor::initialize(this);
+  _intrinsics[(size_t)JSIntrinsic::ARRAY_PROTOTYPE] =
+      _Array->getProperty(this, L"prototype");
+  _intrinsics[(size_t)JSIntrinsic::ARRAY_VALUES] =
+      getIntrinsic(JSIntrinsic::ARRAY_PROTOTYPE)->getProperty(this, L"values");
   _GeneratorFunction = JSGeneratorFunctionConstructor::initialize(this);
   _AsyncGeneratorFunction =
       JSAsyncGeneratorFunctionConstructor::initialize(this);
   _Iterator = JSIteratorConstructor::initialize(this);
   _AsyncIterator = JSAsyncIteratorConstructor::initialize(this);
+  _intrinsics[(size_t)JSIntrinsic::ASYNC_FUNCTION_PROTOTYPE] =
+      _AsyncFunction->getProperty(this, L"prototype");
+  _intrinsics[(size_t)JSIntrinsic::GENERATOR_FUNCTION_PROTOTYPE] =
+      _GeneratorFunction->getProperty(this, L"prototype");
+  _intrinsics[(size_t)JSIntrinsic::ITERATOR_PROTOTYPE] =
+      _Iterator->getProperty(this, L"prototype");
+  _intrinsics[(size_t)JSIntrinsic::ASYNC_ITERATOR_PROTOTYPE] =
+      _AsyncIterator->getProperty(this, L"prototype");
   _Generator = JSGeneratorConstructor::initialize(this);
   _AsyncGenerator = JSAsyncGeneratorConstructor::initialize(this);
   _Promise = JSPromiseConstructor::initialize(this);
+  _intrinsics[(size_t)JSIntrinsic::PROMISE_PROTOTYPE] =
+      _Promise->getProperty(this, L"prototype");
+  _intrinsics[(size_t)JSIntrinsic::PROMISE_THEN] =
+      getIntrinsic(JSIntrinsic::PROMISE_PROTOTYPE)->getProperty(this, L"then");
   _Error = JSErrorConstructor::initialize(this);
+  _intrinsics[(size_t)JSIntrinsic::ERROR_PROTOTYPE] =
+      _Error->getProperty(this, L"prototype");
   _AggregateError = JSAggregateErrorConstructor::initialize(this);
   _RangeError = JSRangeErrorConstructor::initialize(this);
   _ReferenceError = JSReferenceErrorConstructor::initialize(this);
@@ -141,9 +213,122 @@ void JSContext::initialize() {
   _URIError = JSURIErrorConstructor::initialize(this);
   _InternalError = JSInternalErrorConstructor::initialize(this);
   _RegExp = JSRegexConstructor::initialize(this);
+  _Map = JSMapConstructor::initialize(this);
+  _Set = JSSetConstructor::initialize(this);
+  _WeakMap = JSWeakMapConstructor::initialize(this);
+  _WeakSet = JSWeakSetConstructor::initialize(this);
+  _MapIterator = JSMapConstructor::initializeIterator(this);
+  _SetIterator = JSSetConstructor::initializeIterator(this);
+  _ArrayBuffer = JSArrayBufferConstructor::initialize(this);
+  _SharedArrayBuffer = JSSharedArrayBufferConstructor::initialize(this);
+  _TypedArray = JSTypedArrayConstructor::initialize(this);
+  _DataView = JSDataViewConstructor::initialize(this);
+  _JSON = JSJSONConstructor::initialize(this);
+  _Atomics = JSAtomicsConstructor::initialize(this);
+  JSWorkerConstructor::initialize(this);
+  std::pair<common::AutoPtr<JSValue>, JSIntrinsic> prototypes[] = {
+      {_Object, JSIntrinsic::OBJECT_PROTOTYPE},
+      {_Function, JSIntrinsic::FUNCTION_PROTOTYPE},
+      {_AsyncFunction, JSIntrinsic::ASYNC_FUNCTION_PROTOTYPE},
+      {_GeneratorFunction, JSIntrinsic::GENERATOR_FUNCTION_PROTOTYPE},
+      {_Symbol, JSIntrinsic::SYMBOL_PROTOTYPE},
+      {_Array, JSIntrinsic::ARRAY_PROTOTYPE},
+      {_Iterator, JSIntrinsic::ITERATOR_PROTOTYPE},
+      {_AsyncIterator, JSIntrinsic::ASYNC_ITERATOR_PROTOTYPE},
+      {_Error, JSIntrinsic::ERROR_PROTOTYPE},
+      {_Promise, JSIntrinsic::PROMISE_PROTOTYPE},
+  };
+  for (auto &[constructor, intrinsic] : prototypes) {
+    constructor->setPropertyDescriptor(this, L"prototype",
+                                       getIntrinsic(intrinsic), false, false,
+                                       false);
+  }
   subRef();
 }
 
+std::vector<common::AutoPtr<JSValue> *> JSContext::getBuiltins() {
+  std::vector<common::AutoPtr<JSValue> *> builtins = {
+      &_Object,
+      &_Function,
+      &_GeneratorFunction,
+      &_AsyncFunction,
+      &_AsyncGeneratorFunction,
+      &_Generator,
+      &_AsyncGenerator,
+      &_Iterator,
+      &_AsyncIterator,
+      &_ArrayIterator,
+      &_Array,
+      &_Symbol,
+      &_Number,
+      &_String,
+      &_Boolean,
+      &_BigInt,
+      &_RegExp,
+      &_Map,
+      &_Set,
+      &_WeakMap,
+      &_WeakSet,
+      &_MapIterator,
+      &_SetIterator,
+      &_ArrayBuffer,
+      &_SharedArrayBuffer,
+      &_TypedArray,
+      &_DataView,
+      &_JSON,
+      &_Atomics,
+      &_Promise,
+      &_Error,
+      &_AggregateError,
+      &_InternalError,
+      &_RangeError,
+      &_ReferenceError,
+      &_TypeError,
+      &_SyntaxError,
+      &_URIError,
+  };
+  for (auto &intrinsic : _intrinsics) {
+    builtins.push_back(&intrinsic);
+  }
+  return builtins;
+}
+
+void JSContext::restore(const common::AutoPtr<JSSnapshot> &snapshot) {
+  auto stores = snapshot->restore();
+  for (auto &[name, store, isConst] : snapshot->getGlobals()) {
+    auto value = _root->createValue(stores[store], snapshot->getString(name));
+    if (isConst) {
+      value->setConst();
+    }
+  }
+  auto builtins = getBuiltins();
+  auto &indices = snapshot->getBuiltins();
+  for (size_t index = 0; index < builtins.size(); index++) {
+    if (indices[index] != JSSnapshot::NONE) {
+      *builtins[index] = _root->createValue(stores[indices[index]]);
+    }
+  }
+  for (auto &[name, store, _] : snapshot->getModules()) {
+    _modules[snapshot->getString(name)] = _root->createValue(stores[store]);
+  }
+}
+
+common::AutoPtr<JSSnapshot> JSContext::createSnapshot() {
+  std::vector<JSStore *> builtins;
+  for (auto builtin : getBuiltins()) {
+    builtins.push_back(*builtin != nullptr ? (*builtin)->getStore() : nullptr);
+  }
+  std::vector<JSSnapshot::JSRoot> globals;
+  for (auto &[name, value] : _root->getValues()) {
+    globals.push_back({name, (JSStore *)value->getStore(), value->isConst()});
+  }
+  std::vector<JSSnapshot::JSRoot> modules;
+  for (auto &[name, value] : _modules) {
+    modules.push_back({name, value->getStore(), false});
+  }
+  return new JSSnapshot(builtins, globals, modules);
+}
+
 common::AutoPtr<JSRuntime> &JSContext::getRuntime() { return _runtime; }
 
 const std::pair<std::wstring, common::AutoPtr<JSValue>> &
@@ -157,25 +342,11 @@ JSContext::getCurrentModule() {
 }
 common::AutoPtr<JSValue> JSContext::eval(const std::wstring &filename,
                                          const JSEvalType &type) {
-  std::string fn;
-  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
-  fn = converter.to_bytes(filename);
-  std::wifstream in(fn, std::ios::binary);
-  if (in.is_open()) {
-    in.seekg(0, std::ios::end);
-    size_t len = in.tellg();
-    in.seekg(0, std::ios::beg);
-    wchar_t *buf = new wchar_t[len + 1];
-    buf[len] = 0;
-    in.read(buf, len);
-    in.close();
-    std::wstring source = buf;
-    delete[] buf;
-    return eval(source, filename, type);
-  } else {
-    throw error::JSError(
-        fmt::format(L"Cannot find source file '{}'", filename));
+  if (type == JSEvalType::MODULE &&
+      _runtime->getCompiledModule(filename) != nullptr) {
+    return eval(L"", filename, type);
   }
+  return eval(JSRuntime::readSource(filename), filename, type);
 }
 
 common::AutoPtr<JSValue> JSContext::eval(const std::wstring &source,
@@ -203,26 +374,46 @@ common::AutoPtr<JSValue> JSContext::eval(const std::wstring &source,
 common::AutoPtr<compiler::JSModule>
 JSContext::compile(const std::wstring &source, const std::wstring &filename,
                    const JSEvalType &type) {
+  if (type == JSEvalType::MODULE) {
+    auto module = _runtime->getCompiledModule(filename);
+    if (module != nullptr) {
+      return module;
+    }
+  }
   auto parser = _runtime->getParser();
   auto generator = _runtime->getGenerator();
   auto ast = parser->parse(filename, source);
-  return generator->resolve(filename, source, ast, type);
+  if (type == JSEvalType::MODULE) {
+    _runtime->compileImports(filename, ast);
+  }
+  auto module = generator->resolve(filename, source, ast, type);
+  if (_runtime->isOptimize()) {
+    _runtime->getOptimizer()->optimize(module);
+  }
+  return module;
 }
 
 void JSContext::gc() {
   auto &children = _gcRoot->getChildren();
-  std::set<uintptr_t> cache;
   while (!children.empty()) {
     auto item = *children.rbegin();
-    children.pop_back();
-    if (!cache.contains((uintptr_t)item)) {
-      delete item;
-    } else {
-      cache.insert((uintptr_t)item);
+    _gcRoot->removeChild(item);
+    delete item;
+  }
+  if (_scope != nullptr) {
+    std::erase_if(_weakCollections,
+                  [](auto &collection) { return collection->ref() == 1; });
+    for (auto &collection : _weakCollections) {
+      collection->sweep(this);
     }
   }
 }
 
+void JSContext::registerWeakCollection(
+    common::AutoPtr<JSCollection> collection) {
+  _weakCollections.push_back(collection);
+}
+
 void JSContext::pushScope() { _scope = new JSScope(_gcRoot, _scope); }
 
 void JSContext::popScope() {
@@ -282,17 +473,31 @@ std::vector<JSLocation> JSContext::trace(const JSLocation &location) {
   return stack;
 }
 uint32_t JSContext::createMicroTask(common::AutoPtr<JSValue> exec) {
-  static uint32_t index = 0;
+  return createMicroTask(nullptr, exec, nullptr, nullptr);
+}
+
+uint32_t JSContext::createMicroTask(JSJob *job,
+                                    common::AutoPtr<JSValue> target,
+                                    common::AutoPtr<JSValue> handler,
+                                    common::AutoPtr<JSValue> argument) {
+  static std::atomic<uint32_t> index = 0;
+  auto root = getRoot();
   _microTasks.push_back({
       .identifier = index++,
-      .exec = getRoot()->createValue(exec->getStore()),
+      .exec = root->createValue(target->getStore()),
+      .job = job,
+      .handler = handler != nullptr ? root->createValue(handler->getStore())
+                                    : nullptr,
+      .argument = argument != nullptr
+                      ? root->createValue(argument->getStore())
+                      : nullptr,
   });
   return _microTasks.rbegin()->identifier;
 }
 
 uint32_t JSContext::createMacroTask(common::AutoPtr<JSValue> exec,
                                     int64_t timeout) {
-  static uint32_t index = 0;
+  static std::atomic<uint32_t> index = 0;
   _macroTasks.push_back({
       .identifier = index++,
       .exec = getRoot()->createValue(exec->getStore()),
@@ -301,13 +506,78 @@ uint32_t JSContext::createMacroTask(common::AutoPtr<JSValue> exec,
   });
   return _macroTasks.rbegin()->identifier;
 }
+
+uint32_t JSContext::createMacroTask(JSJob *job,
+                                    common::AutoPtr<JSValue> target,
+                                    common::AutoPtr<JSValue> handler,
+                                    common::AutoPtr<JSValue> argument) {
+  auto id = createMacroTask(target);
+  auto &task = *_macroTasks.rbegin();
+  auto root = getRoot();
+  task.job = job;
+  task.handler =
+      handler != nullptr ? root->createValue(handler->getStore()) : nullptr;
+  task.argument =
+      argument != nullptr ? root->createValue(argument->getStore()) : nullptr;
+  return id;
+}
+
+// Messages become macro tasks of this loop; exits are settled right away so
+// that a finished worker no longer holds the loop open.
+void JSContext::receive() {
+  using JSMessageType = JSMessageQueue::JSMessageType;
+  JSMessageQueue::JSMessage message;
+  while (_inbox->receive(message)) {
+    if (message.port == JSWorker::PARENT) {
+      if (message.type == JSMessageType::MESSAGE) {
+        createMacroTask(&JSWorkerConstructor::onMessage, undefined(),
+                        nullptr,
+                        JSStructuredClone::deserialize(this, message.record));
+      }
+      continue;
+    }
+    auto it = _workers.find(message.port);
+    if (it == _workers.end()) {
+      continue;
+    }
+    auto &[worker, object] = it->second;
+    switch (message.type) {
+    case JSMessageType::MESSAGE:
+      createMacroTask(&JSWorkerConstructor::onMessage, object, nullptr,
+                      JSStructuredClone::deserialize(this, message.record));
+      break;
+    case JSMessageType::EXCEPTION:
+      createMacroTask(&JSWorkerConstructor::onError, object, nullptr,
+                      JSStructuredClone::deserialize(this, message.record));
+      break;
+    case JSMessageType::EXIT:
+      worker->join();
+      _workers.erase(it);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
 common::AutoPtr<JSValue> JSContext::nextTick() {
   using namespace std::chrono;
   pushScope();
+  receive();
+  if (_microTasks.empty() && _macroTasks.empty() &&
+      (_worker != nullptr || !_workers.empty())) {
+    _inbox->wait();
+    if (_runtime->getProfiler() != nullptr) {
+      _runtime->getProfiler()->skip();
+    }
+    receive();
+  }
   while (!_microTasks.empty()) {
     auto task = *_microTasks.begin();
     _microTasks.erase(_microTasks.begin());
-    auto err = task.exec->apply(this, undefined());
+    auto err = task.job != nullptr
+                   ? task.job(this, task.exec, task.handler, task.argument)
+                   : task.exec->apply(this, undefined());
     if (err->isException()) {
       return err;
     }
@@ -316,13 +586,18 @@ common::AutoPtr<JSValue> JSContext::nextTick() {
     auto task = *_macroTasks.begin();
     _macroTasks.erase(_macroTasks.begin());
     if (std::chrono::system_clock::now() - task.start > task.timeout * 1ms) {
-      auto err = task.exec->apply(this, undefined());
+      auto err = task.job != nullptr
+                     ? task.job(this, task.exec, task.handler, task.argument)
+                     : task.exec->apply(this, undefined());
       if (err->isException()) {
         return err;
       }
     } else {
       _macroTasks.push_back(task);
-      std::this_thread::sleep_for(10ms);
+      _inbox->wait(10ms);
+      if (_runtime->getProfiler() != nullptr) {
+        _runtime->getProfiler()->skip();
+      }
     }
   }
   popScope();
@@ -330,7 +605,7 @@ common::AutoPtr<JSValue> JSContext::nextTick() {
 }
 
 bool JSContext::isTaskComplete() const {
-  return _macroTasks.empty() && _microTasks.empty();
+  return _macroTasks.empty() && _microTasks.empty() && _workers.empty();
 }
 
 void JSContext::removeMacroTask(uint32_t id) {
@@ -342,6 +617,24 @@ void JSContext::removeMacroTask(uint32_t id) {
   }
 }
 
+common::AutoPtr<JSWorker>
+JSContext::createWorker(const std::wstring &filename,
+                        common::AutoPtr<JSValue> object) {
+  common::AutoPtr<JSWorker> worker =
+      new JSWorker(filename, _runtime->createIsolate(), _inbox);
+  _workers[worker->getPort()] = {worker,
+                                 getRoot()->createValue(object->getStore())};
+  worker->start();
+  return worker;
+}
+
+void JSContext::setWorker(const common::AutoPtr<JSWorker> &worker) {
+  _worker = worker;
+  _inbox = worker->getInbox();
+}
+
+common::AutoPtr<JSWorker> &JSContext::getWorker() { return _worker; }
+
 common::AutoPtr<JSValue>
 JSContext::applyGenerator(common::AutoPtr<JSValue> func,
                           common::AutoPtr<JSValue> arguments,
@@ -356,7 +649,7 @@ JSContext::applyGenerator(common::AutoPtr<JSValue> func,
   scope->createValue(self->getStore(), L"this");
   scope->createValue(arguments->getStore(), L"arguments");
   result->setOpaque(vm::JSCoroutineContext{
-      .eval = new vm::JSEvalContext,
+      .eval = new vm::JSEvalContext(scope->getDepth()),
       .scope = scope,
       .module = entity->getModule(),
       .done = false,
@@ -380,7 +673,7 @@ JSContext::applyAsyncGenerator(common::AutoPtr<JSValue> func,
   scope->createValue(self->getStore(), L"this");
   scope->createValue(arguments->getStore(), L"arguments");
   result->setOpaque(vm::JSCoroutineContext{
-      .eval = new vm::JSEvalContext,
+      .eval = new vm::JSEvalContext(scope->getDepth()),
       .scope = scope,
       .module = entity->getModule(),
       .done = false,
@@ -395,90 +688,34 @@ common::AutoPtr<JSValue>
 JSContext::applyAsync(common::AutoPtr<JSValue> func,
                       common::AutoPtr<JSValue> arguments,
                       common::AutoPtr<JSValue> self) {
-  auto generator = applyGenerator(func, arguments, self);
-  common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-  closure[L"#generator"] = generator;
-  std::function callback = [](common::AutoPtr<JSContext> ctx,
-                              common::AutoPtr<JSValue> self,
-                              std::vector<common::AutoPtr<JSValue>> args)
-      -> common::AutoPtr<JSValue> {
-    auto resolve = args[0];
-    auto reject = args[1];
-    auto next = [](common::AutoPtr<JSContext> ctx,
-                   common::AutoPtr<JSValue> self,
-                   std::vector<common::AutoPtr<JSValue>> args)
-        -> common::AutoPtr<JSValue> {
-      auto arg = ctx->undefined();
-      if (!args.empty()) {
-        arg = args[0];
-      }
-      auto resolve = ctx->load(L"#resolve");
-      auto reject = ctx->load(L"#reject");
-      auto next = ctx->load(L"#next");
-      auto generator = ctx->load(L"#generator");
-      auto gnext = generator->getProperty(ctx, L"next");
-      auto res = gnext->apply(ctx, generator, {arg});
-      if (res->isException()) {
-        reject->apply(ctx, ctx->undefined(), {res});
-        return ctx->undefined();
-      }
-      auto value = res->getProperty(ctx, L"value");
-      auto done = res->getProperty(ctx, L"done");
-      if (done->toBoolean(ctx)->getBoolean().value()) {
-        resolve->apply(ctx, ctx->undefined(), {value});
-      } else {
-        auto promiseValue = ctx->Promise()
-                                ->getProperty(ctx, L"resolve")
-                                ->apply(ctx, ctx->Promise(), {value});
-        if (promiseValue->isException()) {
-          return promiseValue;
-        }
-        auto onerror = [](common::AutoPtr<JSContext> ctx,
-                          common::AutoPtr<JSValue> self,
-                          std::vector<common::AutoPtr<JSValue>> args)
-            -> common::AutoPtr<JSValue> {
-          auto generator = ctx->load(L"#generator");
-          auto reject = ctx->load(L"#reject");
-          auto err = generator->getProperty(ctx, L"throw")
-                         ->apply(ctx, generator, {args[0]});
-          if (err->isException()) {
-            return reject->apply(ctx, ctx->undefined(), {err});
-          }
-          reject->apply(ctx, ctx->undefined(), {args[0]});
-          return ctx->undefined();
-        };
-        common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-        closure[L"#generator"] = generator;
-        closure[L"#reject"] = reject;
-        promiseValue =
-            promiseValue->getProperty(ctx, L"then")
-                ->apply(ctx, promiseValue,
-                        {next, ctx->createNativeFunction(onerror, closure)});
-        if (promiseValue->isException()) {
-          return promiseValue;
-        }
-      }
-      return ctx->undefined();
-    };
-    common::Map<std::wstring, common::AutoPtr<JSValue>> closure;
-    closure[L"#resolve"] = resolve;
-    closure[L"#reject"] = reject;
-    closure[L"#generator"] = ctx->load(L"#generator");
-    auto nextFunc = ctx->createNativeFunction(next, closure);
-    nextFunc->getEntity<JSNativeFunctionEntity>()->getClosure()[L"#next"] =
-        nextFunc->getStore();
-    auto err = nextFunc->apply(ctx, self, {});
-    if (err->isException()) {
-      reject->apply(ctx, ctx->undefined(), {ctx->createError(err)});
-    }
-    return ctx->undefined();
-  };
-  auto callbackFunc = createNativeFunction(callback, closure);
-  return constructObject(_Promise, {callbackFunc});
+  auto entity = func->getEntity<JSFunctionEntity>();
+  auto closure = entity->getClosure();
+  auto promise = JSPromiseConstructor::createPromise(this);
+  auto frame = createObject();
+  common::AutoPtr scope = new engine::JSScope(_gcRoot, getRoot());
+  for (auto &[name, value] : closure) {
+    scope->createValue(value, name);
+  }
+  scope->createValue(self->getStore(), L"this");
+  scope->createValue(arguments->getStore(), L"arguments");
+  frame->setOpaque(vm::JSCoroutineContext{
+      .eval = new vm::JSEvalContext(scope->getDepth()),
+      .scope = scope,
+      .module = entity->getModule(),
+      .done = false,
+      .funcname = func->getName(),
+      .pc = entity->getAddress(),
+      .promise = promise->getStore(),
+  });
+  frame->getStore()->appendChild(func->getStore());
+  frame->getStore()->appendChild(promise->getStore());
+  JSAsyncFunctionConstructor::resume(this, frame, undefined());
+  return promise;
 }
 
 void JSContext::setModule(const std::wstring &name,
                           common::AutoPtr<JSValue> module) {
+  module->setOpaque(name);
   _modules[name] = module;
 }
 
@@ -549,7 +786,7 @@ JSContext::createObject(common::AutoPtr<JSValue> prototype,
   if (prototype != nullptr) {
     proto = prototype->getStore();
   } else {
-    proto = _Object->getProperty(this, L"prototype")->getStore();
+    proto = getIntrinsic(JSIntrinsic::OBJECT_PROTOTYPE)->getStore();
   }
   auto res = _scope->createValue(new JSStore(new JSObjectEntity(proto)), name);
   res->getStore()->appendChild(proto);
@@ -564,6 +801,30 @@ common::AutoPtr<JSValue> JSContext::createArray(const std::wstring &name) {
   return constructObject(_Array);
 }
 
+// Iterator results always carry the same two data fields, so they are
+// written into the entity directly instead of through setProperty.
+common::AutoPtr<JSValue>
+JSContext::createIteratorResult(common::AutoPtr<JSValue> value, bool done) {
+  auto result = createObject();
+  auto store = result->getStore();
+  auto &fields = result->getEntity<JSObjectEntity>()->getProperties();
+  auto flag = done ? truly() : falsely();
+  fields.reserve(2);
+  for (auto &[name, field] : {std::pair{L"value", value->getStore()},
+                              std::pair{L"done", flag->getStore()}}) {
+    fields[name] = {
+        .configurable = true,
+        .enumable = true,
+        .value = field,
+        .writable = true,
+        .get = nullptr,
+        .set = nullptr,
+    };
+    store->appendChild(field);
+  }
+  return result;
+}
+
 common::AutoPtr<JSValue>
 JSContext::constructObject(common::AutoPtr<JSValue> constructor,
                            const std::vector<common::AutoPtr<JSValue>> &args,
@@ -630,6 +891,8 @@ JSContext::createError(common::AutoPtr<JSValue> exception,
     error = _ReferenceError;
   } else if (e->getExceptionType() == L"SyntaxError") {
     error = _SyntaxError;
+  } else if (e->getExceptionType() == L"TypeError") {
+    error = _TypeError;
   } else if (e->getExceptionType() == L"URIError") {
     error = _URIError;
   } else {
@@ -654,7 +917,7 @@ common::AutoPtr<JSValue>
 JSContext::createNativeFunction(const std::function<JSFunction> &value,
                                 const std::wstring &funcname,
                                 const std::wstring &name) {
-  auto prop = _Function->getProperty(this, L"prototype")->getStore();
+  auto prop = getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE)->getStore();
   auto store =
       new JSStore(new JSNativeFunctionEntity(prop, funcname, value, {}));
   store->appendChild(prop);
@@ -667,7 +930,7 @@ common::AutoPtr<JSValue> JSContext::createNativeFunction(
     const std::function<JSFunction> &value,
     const common::Map<std::wstring, common::AutoPtr<JSValue>> closure,
     const std::wstring &funcname, const std::wstring &name) {
-  auto prop = _Function->getProperty(this, L"prototype")->getStore();
+  auto prop = getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE)->getStore();
   common::Map<std::wstring, JSStore *> clo;
   for (auto &[k, v] : closure) {
     clo[k] = (JSStore *)v->getStore();
@@ -687,7 +950,7 @@ common::AutoPtr<JSValue> JSContext::createNativeFunction(
     const std::function<JSFunction> &value,
     const common::Map<std::wstring, JSStore *> closure,
     const std::wstring &funcname, const std::wstring &name) {
-  auto prop = _Function->getProperty(this, L"prototype")->getStore();
+  auto prop = getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE)->getStore();
 
   auto res = _scope->createValue(
       new JSStore(new JSNativeFunctionEntity(prop, funcname, value, closure)),
@@ -700,7 +963,7 @@ common::AutoPtr<JSValue> JSContext::createNativeFunction(
 common::AutoPtr<JSValue>
 JSContext::createFunction(const common::AutoPtr<compiler::JSModule> &module,
                           const std::wstring &name) {
-  auto prop = _Function->getProperty(this, L"prototype")->getStore();
+  auto prop = getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE)->getStore();
   auto res = _scope->createValue(
       new JSStore(new JSFunctionEntity(prop, module)), name);
   res->getStore()->appendChild(prop);
@@ -710,7 +973,8 @@ JSContext::createFunction(const common::AutoPtr<compiler::JSModule> &module,
 common::AutoPtr<JSValue>
 JSContext::createGenerator(const common::AutoPtr<compiler::JSModule> &module,
                            const std::wstring &name) {
-  auto prop = _GeneratorFunction->getProperty(this, L"prototype")->getStore();
+  auto prop =
+      getIntrinsic(JSIntrinsic::GENERATOR_FUNCTION_PROTOTYPE)->getStore();
   auto store = new JSStore(new JSFunctionEntity(prop, module));
   auto res = _scope->createValue(store, name);
   res->getEntity<JSFunctionEntity>()->setGenerator(true);
@@ -722,7 +986,7 @@ JSContext::createGenerator(const common::AutoPtr<compiler::JSModule> &module,
 common::AutoPtr<JSValue>
 JSContext::createArrow(const common::AutoPtr<compiler::JSModule> &module,
                        const std::wstring &name) {
-  auto prop = _Function->getProperty(this, L"prototype")->getStore();
+  auto prop = getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE)->getStore();
   auto store = new JSStore(new JSFunctionEntity(prop, module));
   auto res = _scope->createValue(store, name);
   auto self = getScope()->getValue(L"this");
@@ -739,7 +1003,7 @@ JSContext::createArrow(const common::AutoPtr<compiler::JSModule> &module,
 common::AutoPtr<JSValue> JSContext::createAsyncFunction(
     const common::AutoPtr<compiler::JSModule> &module,
     const std::wstring &name) {
-  auto prop = _Function->getProperty(this, L"prototype")->getStore();
+  auto prop = getIntrinsic(JSIntrinsic::FUNCTION_PROTOTYPE)->getStore();
   auto store = new JSStore(new JSFunctionEntity(prop, module));
   auto res = _scope->createValue(store, name);
   res->getEntity<JSFunctionEntity>()->setAsync(true);
@@ -751,7 +1015,8 @@ common::AutoPtr<JSValue> JSContext::createAsyncFunction(
 common::AutoPtr<JSValue> JSContext::createAsyncGenerator(
     const common::AutoPtr<compiler::JSModule> &module,
     const std::wstring &name) {
-  auto prop = _GeneratorFunction->getProperty(this, L"prototype")->getStore();
+  auto prop =
+      getIntrinsic(JSIntrinsic::GENERATOR_FUNCTION_PROTOTYPE)->getStore();
   auto store = new JSStore(new JSFunctionEntity(prop, module));
   auto res = _scope->createValue(store, name);
   res->getEntity<JSFunctionEntity>()->setGenerator(true);
@@ -764,7 +1029,8 @@ common::AutoPtr<JSValue> JSContext::createAsyncGenerator(
 common::AutoPtr<JSValue>
 JSContext::createAsyncArrow(const common::AutoPtr<compiler::JSModule> &module,
                             const std::wstring &name) {
-  auto prop = _AsyncFunction->getProperty(this, L"prototype")->getStore();
+  auto prop =
+      getIntrinsic(JSIntrinsic::ASYNC_FUNCTION_PROTOTYPE)->getStore();
   auto store = new JSStore(new JSFunctionEntity(prop, module));
   auto res = _scope->createValue(store, name);
   auto self = getScope()->getValue(L"this");
@@ -794,6 +1060,14 @@ JSContext::createException(common::AutoPtr<JSValue> target) {
   return res;
 }
 
+// Lets natives report an error by returning it instead of unwinding the
+// C++ stack, e.g. return ctx->createException(error::JSTypeError(...)).
+common::AutoPtr<JSValue>
+JSContext::createException(const error::JSError &error) {
+  return createException(error.getType(), error.getMessage(),
+                         error.getLocation());
+}
+
 common::AutoPtr<JSValue> JSContext::undefined() {
   return createValue(new JSStore(new JSUndefinedEntity()));
 }
@@ -814,6 +1088,32 @@ common::AutoPtr<JSValue> JSContext::Symbol() { return _Symbol; }
 
 common::AutoPtr<JSValue> JSContext::RegExp() { return _RegExp; }
 
+common::AutoPtr<JSValue> JSContext::Map() { return _Map; }
+
+common::AutoPtr<JSValue> JSContext::Set() { return _Set; }
+
+common::AutoPtr<JSValue> JSContext::WeakMap() { return _WeakMap; }
+
+common::AutoPtr<JSValue> JSContext::WeakSet() { return _WeakSet; }
+
+common::AutoPtr<JSValue> JSContext::MapIterator() { return _MapIterator; }
+
+common::AutoPtr<JSValue> JSContext::SetIterator() { return _SetIterator; }
+
+common::AutoPtr<JSValue> JSContext::ArrayBuffer() { return _ArrayBuffer; }
+
+common::AutoPtr<JSValue> JSContext::SharedArrayBuffer() {
+  return _SharedArrayBuffer;
+}
+
+common::AutoPtr<JSValue> JSContext::TypedArray() { return _TypedArray; }
+
+common::AutoPtr<JSValue> JSContext::DataView() { return _DataView; }
+
+common::AutoPtr<JSValue> JSContext::JSON() { return _JSON; }
+
+common::AutoPtr<JSValue> JSContext::Atomics() { return _Atomics; }
+
 common::AutoPtr<JSValue> JSContext::Function() { return _Function; }
 
 common::AutoPtr<JSValue> JSContext::AsyncFunction() { return _AsyncFunction; }
@@ -858,13 +1158,8 @@ common::AutoPtr<JSValue> JSContext::AsyncGenerator() { return _AsyncGenerator; }
 
 common::AutoPtr<JSValue> JSContext::Promise() { return _Promise; }
 
-common::AutoPtr<JSValue> JSContext::internalSymbol(const std::wstring &name) {
-  if (_symbols.contains(name)) {
-    return _symbols.at(name);
-  }
-  auto val = createSymbol(name);
-  _symbols[name] = _root->createValue(val->getStore());
-  return _symbols[name];
+common::AutoPtr<JSValue> JSContext::getIntrinsic(JSIntrinsic intrinsic) {
+  return _intrinsics[(size_t)intrinsic];
 }
 
 common::AutoPtr<JSValue> JSContext::uninitialized() {
@@ -0,0 +1,50 @@
+#include "engine/runtime/JSMessageQueue.hpp"
+#include <utility>
+using namespace spark;
+using namespace spark::engine;
+
+JSMessageQueue::JSMessageQueue() {
+  _tail = new JSNode{.next = nullptr, .message = {}};
+  _head = _tail;
+}
+
+JSMessageQueue::~JSMessageQueue() {
+  while (_tail != nullptr) {
+    auto next = _tail->next.load(std::memory_order_relaxed);
+    delete _tail;
+    _tail = next;
+  }
+}
+
+void JSMessageQueue::post(JSMessage &&message) {
+  auto node = new JSNode{.next = nullptr, .message = std::move(message)};
+  auto prev = _head.exchange(node, std::memory_order_acq_rel);
+  prev->next.store(node, std::memory_order_release);
+  std::lock_guard lock(_mutex);
+  _condition.notify_one();
+}
+
+bool JSMessageQueue::receive(JSMessage &message) {
+  auto next = _tail->next.load(std::memory_order_acquire);
+  if (next == nullptr) {
+    return false;
+  }
+  message = std::move(next->message);
+  delete _tail;
+  _tail = next;
+  return true;
+}
+
+bool JSMessageQueue::empty() const {
+  return _tail->next.load(std::memory_order_acquire) == nullptr;
+}
+
+void JSMessageQueue::wait() {
+  std::unique_lock lock(_mutex);
+  _condition.wait(lock, [this] { return !empty(); });
+}
+
+void JSMessageQueue::wait(std::chrono::milliseconds timeout) {
+  std::unique_lock lock(_mutex);
+  _condition.wait_for(lock, timeout, [this] { return !empty(); });
+}
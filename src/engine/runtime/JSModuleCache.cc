@@ -0,0 +1,29 @@
+#include "engine/runtime/JSModuleCache.hpp"
+#include "common/AutoPtr.hpp"
+#include "compiler/base/JSModule.hpp"
+#include <mutex>
+#include <string>
+
+using namespace spark;
+using namespace spark::engine;
+
+bool JSModuleCache::contains(const std::wstring &filename) const {
+  std::lock_guard lock(_mutex);
+  return _modules.contains(filename);
+}
+
+common::AutoPtr<compiler::JSModule>
+JSModuleCache::get(const std::wstring &filename) const {
+  std::lock_guard lock(_mutex);
+  auto it = _modules.find(filename);
+  if (it == _modules.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+void JSModuleCache::set(const std::wstring &filename,
+                        const common::AutoPtr<compiler::JSModule> &module) {
+  std::lock_guard lock(_mutex);
+  _modules[filename] = module;
+}
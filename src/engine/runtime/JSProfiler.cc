@@ -0,0 +1,264 @@
+#include "engine/runtime/JSProfiler.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/runtime/JSContext.hpp"
+#include <algorithm>
+#include <fmt/xchar.h>
+#include <iterator>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+namespace {
+struct JSProfileNode {
+  // index in the frames of the profiler, none for the root
+  int64_t frame;
+  std::vector<uint32_t> children;
+  std::unordered_map<uint32_t, uint32_t> childIndices;
+  uint64_t hitCount;
+};
+} // namespace
+
+static std::wstring quote(const std::wstring &value) {
+  std::wstring result = L"\"";
+  for (auto ch : value) {
+    switch (ch) {
+    case L'"':
+      result += L"\\\"";
+      break;
+    case L'\\':
+      result += L"\\\\";
+      break;
+    case L'\n':
+      result += L"\\n";
+      break;
+    case L'\r':
+      result += L"\\r";
+      break;
+    case L'\t':
+      result += L"\\t";
+      break;
+    default:
+      if (ch < 0x20) {
+        result += fmt::format(L"\\u{:04x}", (uint32_t)ch);
+      } else {
+        result += ch;
+      }
+    }
+  }
+  result += L'"';
+  return result;
+}
+
+JSProfiler::JSProfiler(std::chrono::microseconds interval)
+    : _interval(interval), _ticks(0), _sampled(0), _running(false),
+      _startTime(0), _endTime(0) {}
+
+JSProfiler::~JSProfiler() { stop(); }
+
+int64_t JSProfiler::now() {
+  return std::chrono::duration_cast<std::chrono::microseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+void JSProfiler::start() {
+  if (_thread.joinable()) {
+    return;
+  }
+  _running = true;
+  _startTime = now();
+  _thread = std::thread([this]() {
+    std::unique_lock lock(_mutex);
+    while (!_condition.wait_for(lock, _interval,
+                                [this]() { return !_running; })) {
+      _ticks.fetch_add(1, std::memory_order_relaxed);
+    }
+  });
+}
+
+void JSProfiler::stop() {
+  if (!_thread.joinable()) {
+    return;
+  }
+  {
+    std::lock_guard lock(_mutex);
+    _running = false;
+  }
+  _condition.notify_one();
+  _thread.join();
+  _endTime = now();
+}
+
+// the nearest mapped instruction at or before offset
+compiler::JSSourceLocation::Position
+JSProfiler::locate(const common::AutoPtr<compiler::JSModule> &module,
+                   size_t offset) {
+  auto it = _sourceMaps.find(module.getRawPointer());
+  if (it == _sourceMaps.end()) {
+    JSSourceMap sourceMap(module->sourceMap.begin(), module->sourceMap.end());
+    std::sort(sourceMap.begin(), sourceMap.end(),
+              [](auto &a, auto &b) { return a.first < b.first; });
+    it = _sourceMaps
+             .insert({module.getRawPointer(), {module, std::move(sourceMap)}})
+             .first;
+  }
+  auto &sourceMap = it->second.second;
+  auto next = std::upper_bound(
+      sourceMap.begin(), sourceMap.end(), offset,
+      [](size_t offset, auto &item) { return offset < item.first; });
+  if (next == sourceMap.begin()) {
+    return {0, 0, 0};
+  }
+  return std::prev(next)->second;
+}
+
+uint32_t JSProfiler::intern(const std::wstring &funcname,
+                            const std::wstring &filename, uint32_t line,
+                            uint32_t column) {
+  auto name = funcname.empty() ? L"anonymous" : funcname;
+  auto key = fmt::format(L"{}\n{}\n{}\n{}", name, filename, line, column);
+  auto it = _frameIndices.find(key);
+  if (it != _frameIndices.end()) {
+    return it->second;
+  }
+  auto index = (uint32_t)_frames.size();
+  _frames.push_back({
+      .funcname = name,
+      .filename = filename,
+      .line = line,
+      .column = column,
+  });
+  _frameIndices[key] = index;
+  return index;
+}
+
+void JSProfiler::skip() { _sampled = _ticks.load(std::memory_order_relaxed); }
+
+void JSProfiler::sample(common::AutoPtr<JSContext> ctx,
+                        const common::AutoPtr<compiler::JSModule> &module,
+                        size_t offset) {
+  auto ticks = _ticks.load(std::memory_order_relaxed);
+  JSSample sample = {
+      .stack = {},
+      .timestamp = now(),
+      .weight = ticks - _sampled,
+  };
+  _sampled = ticks;
+  // the innermost frame only learns its position when it calls further,
+  // so it is taken from the pc instead
+  auto frame = ctx->getCallStack();
+  auto position = locate(module, offset);
+  sample.stack.push_back(intern(frame->location.funcname, module->filename,
+                                position.line + 1, position.column + 1));
+  for (frame = frame->parent; frame != nullptr; frame = frame->parent) {
+    auto &[filename, line, column, funcname] = frame->location;
+    sample.stack.push_back(intern(funcname, filename, line, column));
+  }
+  std::reverse(sample.stack.begin(), sample.stack.end());
+  _samples.push_back(std::move(sample));
+}
+
+std::wstring JSProfiler::getCollapsedStacks() const {
+  std::map<std::wstring, uint64_t> stacks;
+  for (auto &sample : _samples) {
+    std::wstring stack;
+    for (auto index : sample.stack) {
+      auto &frame = _frames[index];
+      if (!stack.empty()) {
+        stack += L';';
+      }
+      stack += frame.filename.empty()
+                   ? frame.funcname
+                   : fmt::format(L"{} ({}:{})", frame.funcname,
+                                 frame.filename, frame.line);
+    }
+    stacks[stack] += sample.weight;
+  }
+  std::wstring result;
+  for (auto &[stack, weight] : stacks) {
+    result += fmt::format(L"{} {}\n", stack, weight);
+  }
+  return result;
+}
+
+std::wstring JSProfiler::getCpuProfile() const {
+  std::vector<JSProfileNode> nodes = {{.frame = -1, .hitCount = 0}};
+  std::vector<uint32_t> samples;
+  for (auto &sample : _samples) {
+    uint32_t current = 0;
+    for (auto index : sample.stack) {
+      auto it = nodes[current].childIndices.find(index);
+      if (it != nodes[current].childIndices.end()) {
+        current = it->second;
+        continue;
+      }
+      auto child = (uint32_t)nodes.size();
+      nodes.push_back({.frame = index, .hitCount = 0});
+      nodes[current].children.push_back(child);
+      nodes[current].childIndices[index] = child;
+      current = child;
+    }
+    nodes[current].hitCount++;
+    samples.push_back(current);
+  }
+  std::unordered_map<std::wstring, uint32_t> scripts;
+  std::wstring result = L"{\"nodes\":[";
+  for (size_t id = 0; id < nodes.size(); id++) {
+    auto &node = nodes[id];
+    std::wstring funcname = L"(root)";
+    std::wstring filename;
+    int64_t line = -1;
+    int64_t column = -1;
+    uint32_t script = 0;
+    if (node.frame >= 0) {
+      auto &frame = _frames[node.frame];
+      funcname = frame.funcname;
+      filename = frame.filename;
+      line = (int64_t)frame.line - 1;
+      column = (int64_t)frame.column - 1;
+      if (!filename.empty()) {
+        script = scripts.insert({filename, (uint32_t)scripts.size() + 1})
+                     .first->second;
+      }
+    }
+    std::wstring children;
+    for (auto child : node.children) {
+      if (!children.empty()) {
+        children += L',';
+      }
+      children += fmt::format(L"{}", child + 1);
+    }
+    if (id != 0) {
+      result += L',';
+    }
+    result += fmt::format(
+        L"{{\"id\":{},\"callFrame\":{{\"functionName\":{},"
+        L"\"scriptId\":\"{}\",\"url\":{},\"lineNumber\":{},"
+        L"\"columnNumber\":{}}},\"hitCount\":{},\"children\":[{}]}}",
+        id + 1, quote(funcname), script, quote(filename), line, column,
+        node.hitCount, children);
+  }
+  auto endTime = _thread.joinable() ? now() : _endTime;
+  result += fmt::format(L"],\"startTime\":{},\"endTime\":{},\"samples\":[",
+                        _startTime, endTime);
+  for (size_t index = 0; index < samples.size(); index++) {
+    if (index != 0) {
+      result += L',';
+    }
+    result += fmt::format(L"{}", samples[index] + 1);
+  }
+  result += L"],\"timeDeltas\":[";
+  auto previous = _startTime;
+  for (size_t index = 0; index < _samples.size(); index++) {
+    if (index != 0) {
+      result += L',';
+    }
+    result += fmt::format(L"{}", _samples[index].timestamp - previous);
+    previous = _samples[index].timestamp;
+  }
+  result += L"]}";
+  return result;
+}
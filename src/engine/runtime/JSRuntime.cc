@@ -1,12 +1,23 @@
 #include "engine/runtime/JSRuntime.hpp"
 #include "compiler/JSGenerator.hpp"
+#include "compiler/JSOptimizer.hpp"
 #include "compiler/JSParser.hpp"
+#include "compiler/base/JSNodeType.hpp"
+#include "error/JSError.hpp"
 #include "vm/JSVirtualMachine.hpp"
+#include <algorithm>
 #include <codecvt>
+#include <condition_variable>
 #include <cstdlib>
+#include <deque>
 #include <filesystem>
+#include <fmt/xchar.h>
+#include <fstream>
 #include <locale>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
 using namespace spark;
@@ -16,7 +27,10 @@ JSRuntime::JSRuntime(int argc, char **argv) {
   std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
   _parser = new compiler::JSParser();
   _generator = new compiler::JSGenerator();
+  _optimizer = new compiler::JSOptimizer();
+  _optimize = false;
   _vm = new vm::JSVirtualMachine();
+  _modules = new JSModuleCache();
   for (int i = 0; i < argc; i++) {
     _argv.push_back(converter.from_bytes(argv[i]));
   }
@@ -67,11 +81,44 @@ std::wstring JSRuntime::defaultPathResolver(const std::wstring &current,
 
 JSRuntime::~JSRuntime(){};
 
+common::AutoPtr<JSRuntime> JSRuntime::createIsolate() const {
+  common::AutoPtr<JSRuntime> isolate = new JSRuntime(0, nullptr);
+  isolate->_argv = _argv;
+  isolate->_optimize = _optimize;
+  isolate->_pathResolver = _pathResolver;
+  isolate->_directives = _directives;
+  isolate->_modules = _modules;
+  isolate->_snapshot = _snapshot;
+  isolate->_workerCallback = _workerCallback;
+  return isolate;
+}
+
 std::wstring JSRuntime::getCurrentPath() {
   auto current = std::filesystem::current_path().wstring();
   return normalizePath(current);
 }
 
+void JSRuntime::startProfiling(std::chrono::microseconds interval) {
+  if (_profiler != nullptr) {
+    return;
+  }
+  _profiler = new JSProfiler(interval);
+  _vm->setProfiler(_profiler.getRawPointer());
+  _profiler->start();
+}
+
+common::AutoPtr<JSProfiler> JSRuntime::stopProfiling() {
+  auto profiler = _profiler;
+  if (profiler != nullptr) {
+    profiler->stop();
+    _vm->setProfiler(nullptr);
+    _profiler = nullptr;
+  }
+  return profiler;
+}
+
+common::AutoPtr<JSProfiler> &JSRuntime::getProfiler() { return _profiler; }
+
 void JSRuntime::setPathResolver(const PathResolveFunc &resolver) {
   _pathResolver = resolver;
 }
@@ -80,13 +127,195 @@ const JSRuntime::PathResolveFunc &JSRuntime::getPathResolver() const {
   return _pathResolver;
 }
 
+std::wstring JSRuntime::readSource(const std::wstring &filename) {
+  std::wstring_convert<std::codecvt_utf8<wchar_t>> converter;
+  std::wifstream in(converter.to_bytes(filename), std::ios::binary);
+  if (!in.is_open()) {
+    throw error::JSError(
+        fmt::format(L"Cannot find source file '{}'", filename));
+  }
+  in.seekg(0, std::ios::end);
+  size_t len = in.tellg();
+  in.seekg(0, std::ios::beg);
+  wchar_t *buf = new wchar_t[len + 1];
+  buf[len] = 0;
+  in.read(buf, len);
+  in.close();
+  std::wstring source = buf;
+  delete[] buf;
+  return source;
+}
+
+std::pair<std::wstring, JSEvalType>
+JSRuntime::resolveModule(const std::wstring &current,
+                         const std::wstring &source) const {
+  using namespace std::filesystem;
+  auto next = _pathResolver(current, source);
+  if (exists(next) && !is_directory(next)) {
+    return {next, JSEvalType::MODULE};
+  } else if (exists(next + L".js") && !is_directory(next + L".js")) {
+    return {next + L".js", JSEvalType::MODULE};
+  } else if (exists(next + L"/index.js") &&
+             !is_directory(next + L"/index.js")) {
+    return {next + L"/index.js", JSEvalType::MODULE};
+  } else if (exists(next + L"/index.module") &&
+             !is_directory(next + L"/index.module")) {
+    return {next + L"/index.module", JSEvalType::BINARY};
+  } else if (exists(next + L".module") && !is_directory(next + L".module")) {
+    return {next + L".module", JSEvalType::BINARY};
+  }
+  return {L"", JSEvalType::MODULE};
+}
+
+std::vector<std::wstring>
+JSRuntime::getImportSources(const common::AutoPtr<compiler::JSNode> &root) {
+  using namespace compiler;
+  std::vector<std::wstring> sources;
+  auto program = root.cast<JSProgram>();
+  if (program == nullptr) {
+    return sources;
+  }
+  for (auto &item : program->body) {
+    common::AutoPtr<JSNode> source;
+    if (item->type == JSNodeType::IMPORT_DECLARATION) {
+      source = item.cast<JSImportDeclaration>()->source;
+    } else if (item->type == JSNodeType::EXPORT_DECLARATION) {
+      source = item.cast<JSExportDeclaration>()->source;
+    }
+    if (source != nullptr && source->type == JSNodeType::LITERAL_STRING) {
+      sources.push_back(source.cast<JSStringLiteral>()->value);
+    }
+  }
+  return sources;
+}
+
+void JSRuntime::compileImports(const std::wstring &filename,
+                               const common::AutoPtr<compiler::JSNode> &root) {
+  std::mutex mutex;
+  std::condition_variable cond;
+  std::deque<std::wstring> pending;
+  std::unordered_set<std::wstring> visited;
+  std::vector<std::pair<std::wstring, common::AutoPtr<compiler::JSModule>>>
+      compiled;
+  size_t running = 0;
+  auto enqueue = [&](const std::wstring &current,
+                     const std::vector<std::wstring> &sources) {
+    for (auto &source : sources) {
+      auto [path, type] = resolveModule(current, source);
+      if (path.empty() || type != JSEvalType::MODULE ||
+          _modules->contains(path) || visited.contains(path)) {
+        continue;
+      }
+      visited.insert(path);
+      pending.push_back(path);
+    }
+  };
+  visited.insert(filename);
+  enqueue(filename, getImportSources(root));
+  if (pending.empty()) {
+    return;
+  }
+  auto worker = [&]() {
+    common::AutoPtr<compiler::JSParser> parser = new compiler::JSParser();
+    common::AutoPtr<compiler::JSGenerator> generator =
+        new compiler::JSGenerator();
+    common::AutoPtr<compiler::JSOptimizer> optimizer =
+        new compiler::JSOptimizer();
+    std::unique_lock lock(mutex);
+    for (;;) {
+      cond.wait(lock, [&] { return !pending.empty() || running == 0; });
+      if (pending.empty()) {
+        break;
+      }
+      auto path = pending.front();
+      pending.pop_front();
+      running++;
+      lock.unlock();
+      common::AutoPtr<compiler::JSModule> module;
+      try {
+        auto source = readSource(path);
+        auto ast = parser->parse(path, source);
+        auto sources = getImportSources(ast);
+        lock.lock();
+        enqueue(path, sources);
+        cond.notify_all();
+        lock.unlock();
+        module = generator->resolve(path, source, ast, JSEvalType::MODULE);
+        if (_optimize) {
+          optimizer->optimize(module);
+        }
+      } catch (...) {
+        // leave it to the main thread, which reports the error in order
+        module = nullptr;
+      }
+      lock.lock();
+      if (module != nullptr) {
+        compiled.push_back({path, module});
+      }
+      running--;
+      cond.notify_all();
+    }
+  };
+  auto count = std::max(std::thread::hardware_concurrency(), 1U);
+  std::vector<std::thread> workers;
+  for (uint32_t index = 0; index < count; index++) {
+    workers.emplace_back(worker);
+  }
+  for (auto &item : workers) {
+    item.join();
+  }
+  for (auto &[path, module] : compiled) {
+    _modules->set(path, module);
+  }
+}
+
+common::AutoPtr<compiler::JSModule>
+JSRuntime::getCompiledModule(const std::wstring &filename) {
+  return _modules->get(filename);
+}
+
+common::AutoPtr<common::Regex>
+JSRuntime::compileRegex(const std::wstring &source, uint32_t flags) {
+  auto key = fmt::format(L"{}/{}", flags, source);
+  auto it = _regexes.find(key);
+  if (it != _regexes.end()) {
+    return it->second;
+  }
+  if (_regexes.size() >= 1024) {
+    _regexes.clear();
+  }
+  common::AutoPtr<common::Regex> regex = new common::Regex(source, flags);
+  _regexes[key] = regex;
+  return regex;
+}
+
 common::AutoPtr<compiler::JSParser> &JSRuntime::getParser() { return _parser; }
 common::AutoPtr<compiler::JSGenerator> &JSRuntime::getGenerator() {
   return _generator;
 }
+common::AutoPtr<compiler::JSOptimizer> &JSRuntime::getOptimizer() {
+  return _optimizer;
+}
+void JSRuntime::setOptimize(bool optimize) { _optimize = optimize; }
+bool JSRuntime::isOptimize() const { return _optimize; }
 common::AutoPtr<vm::JSVirtualMachine> &JSRuntime::getVirtualMachine() {
   return _vm;
 }
+
+void JSRuntime::setSnapshot(const common::AutoPtr<JSSnapshot> &snapshot) {
+  _snapshot = snapshot;
+}
+
+common::AutoPtr<JSSnapshot> &JSRuntime::getSnapshot() { return _snapshot; }
+
+void JSRuntime::setWorkerCallback(const JSHook &setup) {
+  _workerCallback = setup;
+}
+
+const JSRuntime::JSHook &JSRuntime::getWorkerCallback() const {
+  return _workerCallback;
+}
+
 void JSRuntime::setDirectiveCallback(const std::wstring &name,
                                      const JSHook &setup,
                                      const JSHook &cleanup) {
@@ -9,10 +9,11 @@
 using namespace spark;
 using namespace spark::engine;
 JSScope::JSScope(JSStore *gcRoot, const common::AutoPtr<JSScope> &parent)
-    : _gcRoot(gcRoot) {
+    : _gcRoot(gcRoot), _depth(0) {
   _parent = (JSScope *)parent.getRawPointer();
   _root = new JSStore(new JSEntity(JSValueType::JS_INTERNAL));
   if (_parent) {
+    _depth = _parent->_depth + 1;
     _parent->_root->appendChild(_root);
     _parent->_children.push_back(this);
   }
@@ -25,11 +26,9 @@ JSScope::~JSScope() {
   _children.clear();
   _values.clear();
   _anonymousValues.clear();
-  std::vector<JSStore *> workflow;
+  std::vector<JSStore *> workflow = _root->getChildren();
   while (_root->getChildren().size()) {
-    auto store = *_root->getChildren().begin();
-    workflow.push_back(store);
-    _root->removeChild(store);
+    _root->removeChild(*_root->getChildren().rbegin());
   }
   if (_parent) {
     auto it =
@@ -47,10 +46,11 @@ JSScope::~JSScope() {
     workflow.erase(workflow.begin());
     if (!cache.contains(store)) {
       bool isAlived = isEntityAlived(store, cache);
-      if (!isAlived) {
-        destroyed.push_back(store);
-      }
       cache[store] = isAlived;
+      if (isAlived) {
+        continue;
+      }
+      destroyed.push_back(store);
       for (auto &child : store->getChildren()) {
         if (!cache.contains(child)) {
           auto it = std::find(workflow.begin(), workflow.end(), child);
@@ -104,6 +104,8 @@ common::AutoPtr<JSScope> JSScope::getRootScope() {
 }
 common::AutoPtr<JSScope> JSScope::getParent() { return _parent; }
 
+uint32_t JSScope::getDepth() const { return _depth; }
+
 void JSScope::removeChild(const common::AutoPtr<JSScope> &child) {
   auto it = std::find(_children.begin(), _children.end(), child);
   if (it != _children.end()) {
@@ -0,0 +1,405 @@
+#include "engine/runtime/JSSnapshot.hpp"
+#include "common/AutoPtr.hpp"
+#include "common/Map.hpp"
+#include "engine/base/JSElementsKind.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSArrayEntity.hpp"
+#include "engine/entity/JSBigIntEntity.hpp"
+#include "engine/entity/JSBooleanEntity.hpp"
+#include "engine/entity/JSEntity.hpp"
+#include "engine/entity/JSFunctionEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/entity/JSNaNEntity.hpp"
+#include "engine/entity/JSNativeFunctionEntity.hpp"
+#include "engine/entity/JSNullEntity.hpp"
+#include "engine/entity/JSNumberEntity.hpp"
+#include "engine/entity/JSObjectEntity.hpp"
+#include "engine/entity/JSStringEntity.hpp"
+#include "engine/entity/JSSymbolEntity.hpp"
+#include "engine/entity/JSUndefinedEntity.hpp"
+#include "engine/runtime/JSStore.hpp"
+#include "error/JSInternalError.hpp"
+#include <fmt/xchar.h>
+#include <typeinfo>
+
+using namespace spark;
+using namespace spark::engine;
+
+// Only entities whose whole state is known here can be imaged; host objects
+// keep native state in opaques that cannot be copied into another context.
+static bool isSnapshotable(const common::AutoPtr<JSEntity> &entity) {
+  auto &type = typeid(*entity);
+  switch (entity->getType()) {
+  case JSValueType::JS_UNDEFINED:
+  case JSValueType::JS_NULL:
+  case JSValueType::JS_NAN:
+  case JSValueType::JS_INFINITY:
+  case JSValueType::JS_NUMBER:
+  case JSValueType::JS_BIGINT:
+  case JSValueType::JS_STRING:
+  case JSValueType::JS_BOOLEAN:
+  case JSValueType::JS_SYMBOL:
+  case JSValueType::JS_NATIVE_FUNCTION:
+  case JSValueType::JS_FUNCTION:
+    return true;
+  case JSValueType::JS_OBJECT:
+    return type == typeid(JSObjectEntity);
+  case JSValueType::JS_ARRAY:
+    return type == typeid(JSArrayEntity);
+  default:
+    return false;
+  }
+}
+
+JSSnapshot::JSSnapshot(const std::vector<JSStore *> &builtins,
+                       const std::vector<JSRoot> &globals,
+                       const std::vector<JSRoot> &modules) {
+  JSCapture state;
+  for (auto store : builtins) {
+    _builtins.push_back(capture(state, store));
+  }
+  for (auto &[name, store, isConst] : globals) {
+    _globals.push_back({intern(state, name), capture(state, store), isConst});
+  }
+  for (auto &[name, store, isConst] : modules) {
+    _exports.push_back({intern(state, name), capture(state, store), isConst});
+  }
+  for (size_t index = 0; index < state.pending.size(); index++) {
+    auto store = state.pending[index];
+    auto entity = encode(state, store->getEntity());
+    auto children = (uint32_t)_children.size();
+    for (auto child : store->getChildren()) {
+      _children.push_back(capture(state, child));
+    }
+    _stores[index] = {entity, children, (uint32_t)_children.size()};
+  }
+}
+
+uint32_t JSSnapshot::capture(JSCapture &state, JSStore *store) {
+  if (store == nullptr) {
+    return NONE;
+  }
+  auto it = state.stores.find(store);
+  if (it != state.stores.end()) {
+    return it->second;
+  }
+  auto index = (uint32_t)_stores.size();
+  state.stores[store] = index;
+  state.pending.push_back(store);
+  _stores.push_back({});
+  return index;
+}
+
+uint32_t JSSnapshot::intern(JSCapture &state, const std::wstring &value) {
+  auto it = state.strings.find(value);
+  if (it != state.strings.end()) {
+    return it->second;
+  }
+  auto index = (uint32_t)_strings.size();
+  state.strings[value] = index;
+  _strings.push_back(value);
+  return index;
+}
+
+uint32_t JSSnapshot::encode(JSCapture &state,
+                            common::AutoPtr<JSEntity> entity) {
+  auto it = state.entities.find(entity.getRawPointer());
+  if (it != state.entities.end()) {
+    return it->second;
+  }
+  if (entity == nullptr || !isSnapshotable(entity) ||
+      (entity->hasOpaque() && !entity->hasOpaque<std::wstring>())) {
+    throw error::JSInternalError(
+        fmt::format(L"Cannot snapshot {}", entity == nullptr
+                                                ? L"empty store"
+                                                : L"host object"));
+  }
+  auto index = (uint32_t)_entities.size();
+  state.entities[entity.getRawPointer()] = index;
+  JSEntityRecord record = {
+      .type = entity->getType(),
+      .flags = 0,
+      .payload = NONE,
+      .name = NONE,
+      .prototype = NONE,
+      .bind = NONE,
+      .opaque = NONE,
+      .fields = (uint32_t)_fields.size(),
+      .fieldsEnd = (uint32_t)_fields.size(),
+      .items = 0,
+      .itemsEnd = 0,
+  };
+  if (entity->hasOpaque<std::wstring>()) {
+    record.opaque = intern(state, entity->getOpaque<std::wstring>());
+  }
+  switch (record.type) {
+  case JSValueType::JS_INFINITY:
+    if (entity.cast<JSInfinityEntity>()->isNegative()) {
+      record.flags |= VALUE;
+    }
+    break;
+  case JSValueType::JS_NUMBER:
+    record.payload = (uint32_t)_numbers.size();
+    _numbers.push_back(entity.cast<JSNumberEntity>()->getValue());
+    break;
+  case JSValueType::JS_BIGINT:
+    record.payload = (uint32_t)_bigints.size();
+    _bigints.push_back(entity.cast<JSBigIntEntity>()->getValue());
+    break;
+  case JSValueType::JS_STRING:
+    record.payload = intern(state, entity.cast<JSStringEntity>()->getValue());
+    break;
+  case JSValueType::JS_BOOLEAN:
+    if (entity.cast<JSBooleanEntity>()->getValue()) {
+      record.flags |= VALUE;
+    }
+    break;
+  case JSValueType::JS_SYMBOL:
+    record.payload =
+        intern(state, entity.cast<JSSymbolEntity>()->getDescription());
+    break;
+  default:
+    break;
+  }
+  auto object = entity.cast<JSObjectEntity>();
+  if (object != nullptr) {
+    record.prototype = capture(state, object->getPrototype());
+    record.flags |= (object->isExtensible() ? 0 : NOT_EXTENSIBLE) |
+                    (object->isSealed() ? SEALED : 0) |
+                    (object->isFrozen() ? FROZEN : 0);
+    auto field = [&](uint32_t key, const JSObjectEntity::JSField &value,
+                     uint8_t flags) {
+      _fields.push_back({
+          .key = key,
+          .value = capture(state, value.value),
+          .get = capture(state, value.get),
+          .set = capture(state, value.set),
+          .flags = (uint8_t)(flags | (value.configurable ? CONFIGURABLE : 0) |
+                             (value.enumable ? ENUMABLE : 0) |
+                             (value.writable ? WRITABLE : 0)),
+      });
+    };
+    for (auto &[key, value] : object->getProperties()) {
+      field(intern(state, key), value, 0);
+    }
+    for (auto &[key, value] : object->getSymbolProperties()) {
+      field(capture(state, key), value, SYMBOL);
+    }
+    for (auto &[key, value] : object->getPrivateProperties()) {
+      field(intern(state, key), value, PRIVATE);
+    }
+    record.fieldsEnd = (uint32_t)_fields.size();
+  }
+  if (record.type == JSValueType::JS_ARRAY) {
+    auto array = entity.cast<JSArrayEntity>();
+    record.payload = (uint32_t)array->getKind();
+    record.items = (uint32_t)_items.size();
+    for (auto item : array->getItems()) {
+      _items.push_back(capture(state, item));
+    }
+    record.itemsEnd = (uint32_t)_items.size();
+  } else if (record.type == JSValueType::JS_NATIVE_FUNCTION) {
+    auto func = entity.cast<JSNativeFunctionEntity>();
+    auto &callee = func->getCallee();
+    auto pointer = callee.target<JSFunction *>();
+    if (pointer != nullptr && state.natives.contains(*pointer)) {
+      record.payload = state.natives.at(*pointer);
+    } else {
+      record.payload = (uint32_t)_natives.size();
+      _natives.push_back(callee);
+      if (pointer != nullptr) {
+        state.natives[*pointer] = record.payload;
+      }
+    }
+    record.name = intern(state, func->getFunctionName());
+    record.bind = capture(state, func->getBind());
+    record.items = (uint32_t)_closures.size();
+    for (auto &[name, store] : func->getClosure()) {
+      _closures.push_back({intern(state, name), capture(state, store)});
+    }
+    record.itemsEnd = (uint32_t)_closures.size();
+  } else if (record.type == JSValueType::JS_FUNCTION) {
+    auto func = entity.cast<JSFunctionEntity>();
+    auto &module = func->getModule();
+    auto it = state.modules.find(module.getRawPointer());
+    uint32_t moduleIndex = 0;
+    if (it != state.modules.end()) {
+      moduleIndex = it->second;
+    } else {
+      moduleIndex = (uint32_t)_modules.size();
+      state.modules[module.getRawPointer()] = moduleIndex;
+      _modules.push_back(module);
+    }
+    record.payload = (uint32_t)_functions.size();
+    _functions.push_back({moduleIndex, func->getAddress(), func->getLength()});
+    record.flags |=
+        (func->isAsync() ? ASYNC : 0) | (func->isGenerator() ? GENERATOR : 0);
+    record.name = intern(state, func->getFunctionSource());
+    record.bind = capture(state, func->getBind());
+    record.items = (uint32_t)_closures.size();
+    for (auto &[name, store] : func->getClosure()) {
+      _closures.push_back({intern(state, name), capture(state, store)});
+    }
+    record.itemsEnd = (uint32_t)_closures.size();
+  }
+  _entities.push_back(record);
+  return index;
+}
+
+common::AutoPtr<JSEntity>
+JSSnapshot::decode(const JSEntityRecord &record,
+                   const std::vector<JSStore *> &stores) const {
+  auto resolve = [&](uint32_t index) -> JSStore * {
+    return index == NONE ? nullptr : stores[index];
+  };
+  common::AutoPtr<JSEntity> entity;
+  switch (record.type) {
+  case JSValueType::JS_UNDEFINED:
+    entity = new JSUndefinedEntity();
+    break;
+  case JSValueType::JS_NULL:
+    entity = new JSNullEntity();
+    break;
+  case JSValueType::JS_NAN:
+    entity = new JSNaNEntity();
+    break;
+  case JSValueType::JS_INFINITY:
+    entity = new JSInfinityEntity(record.flags & VALUE);
+    break;
+  case JSValueType::JS_NUMBER:
+    entity = new JSNumberEntity(_numbers[record.payload]);
+    break;
+  case JSValueType::JS_BIGINT:
+    entity = new JSBigIntEntity(_bigints[record.payload]);
+    break;
+  case JSValueType::JS_STRING:
+    entity = new JSStringEntity(_strings[record.payload]);
+    break;
+  case JSValueType::JS_BOOLEAN:
+    entity = new JSBooleanEntity(record.flags & VALUE);
+    break;
+  case JSValueType::JS_SYMBOL:
+    entity = new JSSymbolEntity(_strings[record.payload]);
+    break;
+  case JSValueType::JS_OBJECT:
+    entity = new JSObjectEntity(resolve(record.prototype));
+    break;
+  case JSValueType::JS_ARRAY: {
+    auto array = new JSArrayEntity(resolve(record.prototype));
+    auto &items = array->getItems();
+    items.reserve(record.itemsEnd - record.items);
+    for (auto index = record.items; index < record.itemsEnd; index++) {
+      items.push_back(resolve(_items[index]));
+    }
+    array->transition((JSElementsKind)record.payload);
+    entity = array;
+    break;
+  }
+  case JSValueType::JS_NATIVE_FUNCTION: {
+    common::Map<std::wstring, JSStore *> closure;
+    for (auto index = record.items; index < record.itemsEnd; index++) {
+      auto &[name, store] = _closures[index];
+      closure[_strings[name]] = stores[store];
+    }
+    auto func = new JSNativeFunctionEntity(resolve(record.prototype),
+                                           _strings[record.name],
+                                           _natives[record.payload], closure);
+    func->bind(resolve(record.bind));
+    entity = func;
+    break;
+  }
+  case JSValueType::JS_FUNCTION: {
+    auto &info = _functions[record.payload];
+    auto func = new JSFunctionEntity(resolve(record.prototype),
+                                     _modules[info.module]);
+    func->setAsync(record.flags & ASYNC);
+    func->setGenerator(record.flags & GENERATOR);
+    func->setAddress(info.address);
+    func->setLength(info.length);
+    func->setSource(_strings[record.name]);
+    func->bind(resolve(record.bind));
+    for (auto index = record.items; index < record.itemsEnd; index++) {
+      auto &[name, store] = _closures[index];
+      func->setClosure(_strings[name], stores[store]);
+    }
+    entity = func;
+    break;
+  }
+  default:
+    return nullptr;
+  }
+  auto object = entity.cast<JSObjectEntity>();
+  if (object != nullptr) {
+    auto &properties = object->getProperties();
+    properties.reserve(record.fieldsEnd - record.fields);
+    for (auto index = record.fields; index < record.fieldsEnd; index++) {
+      auto &field = _fields[index];
+      JSObjectEntity::JSField value = {
+          .configurable = (field.flags & CONFIGURABLE) != 0,
+          .enumable = (field.flags & ENUMABLE) != 0,
+          .value = resolve(field.value),
+          .writable = (field.flags & WRITABLE) != 0,
+          .get = resolve(field.get),
+          .set = resolve(field.set),
+      };
+      if (field.flags & SYMBOL) {
+        object->getSymbolProperties()[stores[field.key]] = value;
+      } else if (field.flags & PRIVATE) {
+        object->getPrivateProperties()[_strings[field.key]] = value;
+      } else {
+        properties[_strings[field.key]] = value;
+      }
+    }
+    if (record.flags & NOT_EXTENSIBLE) {
+      object->preventExtensions();
+    }
+    if (record.flags & SEALED) {
+      object->seal();
+    }
+    if (record.flags & FROZEN) {
+      object->freeze();
+    }
+  }
+  if (record.opaque != NONE) {
+    entity->setOpaque(std::wstring(_strings[record.opaque]));
+  }
+  return entity;
+}
+
+std::vector<JSStore *> JSSnapshot::restore() const {
+  std::vector<JSStore *> stores(_stores.size());
+  for (auto &store : stores) {
+    store = new JSStore();
+  }
+  std::vector<common::AutoPtr<JSEntity>> entities;
+  entities.reserve(_entities.size());
+  for (auto &record : _entities) {
+    entities.push_back(decode(record, stores));
+  }
+  for (size_t index = 0; index < stores.size(); index++) {
+    auto &[entity, children, childrenEnd] = _stores[index];
+    auto store = stores[index];
+    store->setEntity(entities[entity]);
+    store->getChildren().reserve(childrenEnd - children);
+    for (auto child = children; child < childrenEnd; child++) {
+      store->appendChild(stores[_children[child]]);
+    }
+  }
+  return stores;
+}
+
+const std::vector<uint32_t> &JSSnapshot::getBuiltins() const {
+  return _builtins;
+}
+
+const std::vector<JSSnapshot::JSRootRecord> &JSSnapshot::getGlobals() const {
+  return _globals;
+}
+
+const std::vector<JSSnapshot::JSRootRecord> &JSSnapshot::getModules() const {
+  return _exports;
+}
+
+const std::wstring &JSSnapshot::getString(uint32_t index) const {
+  return _strings[index];
+}
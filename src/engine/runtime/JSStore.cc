@@ -4,20 +4,20 @@
 using namespace spark;
 using namespace spark::engine;
 JSStore::JSStore(const common::AutoPtr<JSEntity> &entity) : _entity(entity) {}
+static void removeLast(std::vector<JSStore *> &stores, JSStore *store) {
+  auto it = std::find(stores.rbegin(), stores.rend(), store);
+  if (it != stores.rend()) {
+    stores.erase(std::next(it).base());
+  }
+}
+
 JSStore::~JSStore() {
   for (auto &child : _children) {
-    auto it = std::find(child->_parents.begin(), child->_parents.end(), this);
-    if (it != child->_parents.end()) {
-      child->_parents.erase(it);
-    }
+    removeLast(child->_parents, this);
   }
   _children.clear();
   for (auto &parent : _parents) {
-    auto it =
-        std::find(parent->_children.begin(), parent->_children.end(), this);
-    if (it != parent->_children.end()) {
-      parent->_children.erase(it);
-    }
+    removeLast(parent->_children, this);
   }
   _parents.clear();
 }
@@ -27,14 +27,8 @@ void JSStore::appendChild(JSStore *store) {
 }
 
 void JSStore::removeChild(JSStore *store) {
-  auto it = std::find(store->_parents.begin(), store->_parents.end(), this);
-  if (it != store->_parents.end()) {
-    store->_parents.erase(it);
-  }
-  it = std::find(_children.begin(), _children.end(), store);
-  if (it != _children.end()) {
-    _children.erase(it);
-  }
+  removeLast(store->_parents, this);
+  removeLast(_children, store);
 }
 
 common::AutoPtr<JSEntity> JSStore::getEntity() { return _entity; }
@@ -0,0 +1,464 @@
+#include "engine/runtime/JSStructuredClone.hpp"
+#include "common/AutoPtr.hpp"
+#include "common/BigInt.hpp"
+#include "engine/base/JSValueType.hpp"
+#include "engine/entity/JSArrayEntity.hpp"
+#include "engine/entity/JSInfinityEntity.hpp"
+#include "engine/entity/JSObjectEntity.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSContext.hpp"
+#include "error/JSTypeError.hpp"
+#include <cstring>
+#include <fmt/xchar.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+using namespace spark;
+using namespace spark::engine;
+
+namespace {
+enum class JSCloneTag : uint8_t {
+  UNDEFINED,
+  NULL_VALUE,
+  FALSE_VALUE,
+  TRUE_VALUE,
+  NUMBER,
+  NOT_A_NUMBER,
+  POSITIVE_INFINITY,
+  NEGATIVE_INFINITY,
+  STRING,
+  BIGINT,
+  OBJECT,
+  ARRAY,
+  HOLE,
+  ARRAY_BUFFER,
+  TYPED_ARRAY,
+  DATA_VIEW,
+  REFERENCE,
+  BUFFER_HANDLE,
+};
+
+class JSCloneWriter {
+private:
+  common::AutoPtr<JSContext> _ctx;
+  JSCloneRecord &_record;
+  std::vector<uint8_t> &_output;
+  // objects and buffers share one numbering, in the order they are written
+  std::unordered_map<JSStore *, uint32_t> _objects;
+  std::unordered_map<const JSArrayBuffer *, uint32_t> _buffers;
+  // index of a buffer passed by handle in the buffers of the record
+  std::unordered_map<const JSArrayBuffer *, uint32_t> _handles;
+  size_t _transferred;
+  uint32_t _count;
+  common::AutoPtr<JSValue> _exception;
+
+  void tag(JSCloneTag tag) { _output.push_back((uint8_t)tag); }
+
+  template <class T> void write(const T &value) {
+    auto offset = _output.size();
+    _output.resize(offset + sizeof(T));
+    std::memcpy(_output.data() + offset, &value, sizeof(T));
+  }
+
+  void write(const std::wstring &value) {
+    write((uint32_t)value.size());
+    auto offset = _output.size();
+    _output.resize(offset + value.size() * sizeof(wchar_t));
+    std::memcpy(_output.data() + offset, value.data(),
+                value.size() * sizeof(wchar_t));
+  }
+
+  bool reference(JSStore *store) {
+    auto it = _objects.find(store);
+    if (it != _objects.end()) {
+      tag(JSCloneTag::REFERENCE);
+      write(it->second);
+      return true;
+    }
+    _objects[store] = _count++;
+    return false;
+  }
+
+  void writeBuffer(const common::AutoPtr<JSArrayBuffer> &buffer) {
+    auto it = _buffers.find(buffer.getRawPointer());
+    if (it != _buffers.end()) {
+      tag(JSCloneTag::REFERENCE);
+      write(it->second);
+      return;
+    }
+    if (buffer->isDetached()) {
+      throw error::JSTypeError(L"An ArrayBuffer is detached and could not "
+                               L"be cloned");
+    }
+    _buffers[buffer.getRawPointer()] = _count++;
+    auto handle = _handles.find(buffer.getRawPointer());
+    if (handle == _handles.end() && buffer->isShared()) {
+      handle = _handles
+                   .insert({buffer.getRawPointer(),
+                            (uint32_t)_record.buffers.size()})
+                   .first;
+      _record.buffers.push_back(buffer);
+    }
+    if (handle != _handles.end()) {
+      tag(JSCloneTag::BUFFER_HANDLE);
+      write(handle->second);
+      return;
+    }
+    tag(JSCloneTag::ARRAY_BUFFER);
+    write((uint64_t)buffer->getLength());
+    auto offset = _output.size();
+    _output.resize(offset + buffer->getLength());
+    std::memcpy(_output.data() + offset, buffer->getData(),
+                buffer->getLength());
+  }
+
+  bool writeFields(common::AutoPtr<JSValue> value) {
+    std::vector<std::wstring> keys;
+    for (auto &[key, field] :
+         value->getEntity<JSObjectEntity>()->getProperties()) {
+      if (field.enumable) {
+        keys.push_back(key);
+      }
+    }
+    write((uint32_t)keys.size());
+    for (auto &key : keys) {
+      auto field = value->getProperty(_ctx, key);
+      if (field->isException()) {
+        _exception = field;
+        return false;
+      }
+      write(key);
+      if (!serialize(field)) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool writeArray(common::AutoPtr<JSValue> value) {
+    tag(JSCloneTag::ARRAY);
+    // a getter may grow or shrink the array while it is written
+    auto items = value->getEntity<JSArrayEntity>()->getItems();
+    write((uint32_t)items.size());
+    for (auto item : items) {
+      if (item == nullptr) {
+        tag(JSCloneTag::HOLE);
+      } else if (!serialize(_ctx->createValue(item))) {
+        return false;
+      }
+    }
+    return writeFields(value);
+  }
+
+  bool writeObject(common::AutoPtr<JSValue> value) {
+    if (value->hasOpaque<common::AutoPtr<JSArrayBuffer>>()) {
+      writeBuffer(value->getOpaque<common::AutoPtr<JSArrayBuffer>>());
+      return true;
+    }
+    if (reference(value->getStore())) {
+      return true;
+    }
+    if (value->hasOpaque<JSTypedArray>()) {
+      auto &array = value->getOpaque<JSTypedArray>();
+      tag(JSCloneTag::TYPED_ARRAY);
+      write((uint8_t)array.type);
+      write((uint64_t)array.offset);
+      write((uint64_t)array.length);
+      writeBuffer(array.buffer);
+      return true;
+    }
+    if (value->hasOpaque<JSDataView>()) {
+      auto &view = value->getOpaque<JSDataView>();
+      tag(JSCloneTag::DATA_VIEW);
+      write((uint64_t)view.offset);
+      write((uint64_t)view.length);
+      writeBuffer(view.buffer);
+      return true;
+    }
+    if (value->getEntity()->hasOpaque()) {
+      throw error::JSTypeError(L"#<Object> could not be cloned");
+    }
+    tag(JSCloneTag::OBJECT);
+    return writeFields(value);
+  }
+
+public:
+  JSCloneWriter(common::AutoPtr<JSContext> ctx, JSCloneRecord &record)
+      : _ctx(ctx), _record(record), _output(record.data), _transferred(0),
+        _count(0) {}
+
+  void reserve(common::AutoPtr<JSValue> transfer) {
+    if (transfer == nullptr || transfer->isUndefined()) {
+      return;
+    }
+    if (transfer->getType() != JSValueType::JS_ARRAY) {
+      throw error::JSTypeError(L"Transfer list must be an array");
+    }
+    auto items = transfer->getEntity<JSArrayEntity>()->getItems();
+    for (size_t index = 0; index < items.size(); index++) {
+      auto item = items[index] != nullptr ? _ctx->createValue(items[index])
+                                          : _ctx->undefined();
+      if (item->getType() != JSValueType::JS_OBJECT ||
+          !item->hasOpaque<common::AutoPtr<JSArrayBuffer>>() ||
+          item->getOpaque<common::AutoPtr<JSArrayBuffer>>()->isShared()) {
+        throw error::JSTypeError(fmt::format(
+            L"Value at index {} of the transfer list could not be "
+            L"transferred",
+            index));
+      }
+      auto &buffer = item->getOpaque<common::AutoPtr<JSArrayBuffer>>();
+      if (buffer->isDetached()) {
+        throw error::JSTypeError(fmt::format(
+            L"ArrayBuffer at index {} of the transfer list is detached",
+            index));
+      }
+      if (!_handles
+               .insert({buffer.getRawPointer(),
+                        (uint32_t)_record.buffers.size()})
+               .second) {
+        throw error::JSTypeError(fmt::format(
+            L"ArrayBuffer at index {} of the transfer list is a duplicate",
+            index));
+      }
+      _record.buffers.push_back(buffer);
+    }
+    _transferred = _record.buffers.size();
+  }
+
+  // the bytes change owner once nothing can fail anymore
+  void transfer() {
+    for (size_t index = 0; index < _transferred; index++) {
+      _record.buffers[index] = _record.buffers[index]->transfer();
+    }
+  }
+
+  bool serialize(common::AutoPtr<JSValue> value) {
+    switch (value->getType()) {
+    case JSValueType::JS_UNDEFINED:
+      tag(JSCloneTag::UNDEFINED);
+      return true;
+    case JSValueType::JS_NULL:
+      tag(JSCloneTag::NULL_VALUE);
+      return true;
+    case JSValueType::JS_BOOLEAN:
+      tag(value->getBoolean().value() ? JSCloneTag::TRUE_VALUE
+                                      : JSCloneTag::FALSE_VALUE);
+      return true;
+    case JSValueType::JS_NAN:
+      tag(JSCloneTag::NOT_A_NUMBER);
+      return true;
+    case JSValueType::JS_INFINITY:
+      tag(value->getEntity<JSInfinityEntity>()->isNegative()
+              ? JSCloneTag::NEGATIVE_INFINITY
+              : JSCloneTag::POSITIVE_INFINITY);
+      return true;
+    case JSValueType::JS_NUMBER:
+      tag(JSCloneTag::NUMBER);
+      write(value->getNumber().value());
+      return true;
+    case JSValueType::JS_STRING:
+      tag(JSCloneTag::STRING);
+      write(value->getString().value());
+      return true;
+    case JSValueType::JS_BIGINT:
+      tag(JSCloneTag::BIGINT);
+      write(value->getBigInt().value().toString());
+      return true;
+    case JSValueType::JS_ARRAY:
+      if (reference(value->getStore())) {
+        return true;
+      }
+      return writeArray(value);
+    case JSValueType::JS_OBJECT:
+      return writeObject(value);
+    default:
+      throw error::JSTypeError(
+          fmt::format(L"{} could not be cloned", value->getTypeName()));
+    }
+  }
+
+  common::AutoPtr<JSValue> getException() { return _exception; }
+};
+
+class JSCloneReader {
+private:
+  common::AutoPtr<JSContext> _ctx;
+  const JSCloneRecord &_record;
+  const std::vector<uint8_t> &_input;
+  size_t _offset;
+  std::vector<common::AutoPtr<JSValue>> _objects;
+
+  template <class T> T read() {
+    T value;
+    std::memcpy(&value, _input.data() + _offset, sizeof(T));
+    _offset += sizeof(T);
+    return value;
+  }
+
+  std::wstring readString() {
+    auto length = read<uint32_t>();
+    std::wstring value(length, L'\0');
+    std::memcpy(value.data(), _input.data() + _offset,
+                length * sizeof(wchar_t));
+    _offset += length * sizeof(wchar_t);
+    return value;
+  }
+
+  void readFields(common::AutoPtr<JSValue> value) {
+    auto count = read<uint32_t>();
+    for (uint32_t index = 0; index < count; index++) {
+      auto key = readString();
+      value->setProperty(_ctx, key, deserialize());
+    }
+  }
+
+  common::AutoPtr<JSValue> readArray() {
+    auto value = _ctx->createArray();
+    _objects.push_back(value);
+    auto length = read<uint32_t>();
+    for (uint32_t index = 0; index < length; index++) {
+      if (_input[_offset] == (uint8_t)JSCloneTag::HOLE) {
+        _offset++;
+      } else {
+        value->setIndex(_ctx, index, deserialize());
+      }
+    }
+    if (value->getEntity<JSArrayEntity>()->getItems().size() != length) {
+      value->setProperty(_ctx, L"length", _ctx->createNumber(length));
+    }
+    readFields(value);
+    return value;
+  }
+
+  common::AutoPtr<JSValue> readBuffer() {
+    auto length = (size_t)read<uint64_t>();
+    common::AutoPtr<JSArrayBuffer> buffer = new JSArrayBuffer(length);
+    std::memcpy(buffer->getData(), _input.data() + _offset, length);
+    _offset += length;
+    auto value = JSArrayBuffer::create(_ctx, buffer);
+    _objects.push_back(value);
+    return value;
+  }
+
+  common::AutoPtr<JSValue> readHandle() {
+    auto value =
+        JSArrayBuffer::create(_ctx, _record.buffers[read<uint32_t>()]);
+    _objects.push_back(value);
+    return value;
+  }
+
+  common::AutoPtr<JSValue> readTypedArray() {
+    auto type = (JSTypedArray::Type)read<uint8_t>();
+    auto offset = (size_t)read<uint64_t>();
+    auto length = (size_t)read<uint64_t>();
+    auto index = _objects.size();
+    _objects.push_back(nullptr);
+    auto buffer = deserialize();
+    auto constructor = _ctx->load(JSTypedArray::getName(type));
+    auto value =
+        _ctx->createObject(constructor->getProperty(_ctx, L"prototype"));
+    value->setOpaque(JSTypedArray{
+        .buffer = buffer->getOpaque<common::AutoPtr<JSArrayBuffer>>(),
+        .object = buffer->getStore(),
+        .type = type,
+        .offset = offset,
+        .length = length,
+    });
+    value->getStore()->appendChild(buffer->getStore());
+    _objects[index] = value;
+    return value;
+  }
+
+  common::AutoPtr<JSValue> readDataView() {
+    auto offset = (size_t)read<uint64_t>();
+    auto length = (size_t)read<uint64_t>();
+    auto index = _objects.size();
+    _objects.push_back(nullptr);
+    auto buffer = deserialize();
+    auto value = _ctx->createObject(
+        _ctx->DataView()->getProperty(_ctx, L"prototype"));
+    value->setOpaque(JSDataView{
+        .buffer = buffer->getOpaque<common::AutoPtr<JSArrayBuffer>>(),
+        .object = buffer->getStore(),
+        .offset = offset,
+        .length = length,
+    });
+    value->getStore()->appendChild(buffer->getStore());
+    _objects[index] = value;
+    return value;
+  }
+
+public:
+  JSCloneReader(common::AutoPtr<JSContext> ctx, const JSCloneRecord &record)
+      : _ctx(ctx), _record(record), _input(record.data), _offset(0) {}
+
+  common::AutoPtr<JSValue> deserialize() {
+    switch ((JSCloneTag)read<uint8_t>()) {
+    case JSCloneTag::UNDEFINED:
+      return _ctx->undefined();
+    case JSCloneTag::NULL_VALUE:
+      return _ctx->null();
+    case JSCloneTag::FALSE_VALUE:
+      return _ctx->falsely();
+    case JSCloneTag::TRUE_VALUE:
+      return _ctx->truly();
+    case JSCloneTag::NUMBER:
+      return _ctx->createNumber(read<double>());
+    case JSCloneTag::NOT_A_NUMBER:
+      return _ctx->NaN();
+    case JSCloneTag::POSITIVE_INFINITY:
+      return _ctx->createInfinity();
+    case JSCloneTag::NEGATIVE_INFINITY:
+      return _ctx->createInfinity(true);
+    case JSCloneTag::STRING:
+      return _ctx->createString(readString());
+    case JSCloneTag::BIGINT:
+      return _ctx->createBigInt(common::BigInt<>(readString()));
+    case JSCloneTag::OBJECT: {
+      auto value = _ctx->createObject();
+      _objects.push_back(value);
+      readFields(value);
+      return value;
+    }
+    case JSCloneTag::ARRAY:
+      return readArray();
+    case JSCloneTag::ARRAY_BUFFER:
+      return readBuffer();
+    case JSCloneTag::TYPED_ARRAY:
+      return readTypedArray();
+    case JSCloneTag::DATA_VIEW:
+      return readDataView();
+    case JSCloneTag::REFERENCE:
+      return _objects[read<uint32_t>()];
+    case JSCloneTag::BUFFER_HANDLE:
+      return readHandle();
+    default:
+      return _ctx->undefined();
+    }
+  }
+};
+} // namespace
+
+common::AutoPtr<JSValue>
+JSStructuredClone::serialize(common::AutoPtr<JSContext> ctx,
+                             common::AutoPtr<JSValue> value,
+                             JSCloneRecord &output,
+                             common::AutoPtr<JSValue> transfer) {
+  JSCloneWriter writer(ctx, output);
+  writer.reserve(transfer);
+  if (!writer.serialize(value)) {
+    return writer.getException();
+  }
+  writer.transfer();
+  return nullptr;
+}
+
+common::AutoPtr<JSValue>
+JSStructuredClone::deserialize(common::AutoPtr<JSContext> ctx,
+                               const JSCloneRecord &input) {
+  if (input.data.empty()) {
+    return ctx->undefined();
+  }
+  JSCloneReader reader(ctx, input);
+  return reader.deserialize();
+}
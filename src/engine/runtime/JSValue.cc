@@ -1,6 +1,8 @@
 #include "engine/runtime/JSValue.hpp"
 #include "common/AutoPtr.hpp"
 #include "common/BigInt.hpp"
+#include "common/Number.hpp"
+#include "engine/base/JSElementsKind.hpp"
 #include "engine/base/JSValueType.hpp"
 #include "engine/entity/JSArrayEntity.hpp"
 #include "engine/entity/JSBigIntEntity.hpp"
@@ -15,6 +17,7 @@
 #include "engine/entity/JSObjectEntity.hpp"
 #include "engine/entity/JSStringEntity.hpp"
 #include "engine/entity/JSSymbolEntity.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
 #include "engine/runtime/JSContext.hpp"
 #include "engine/runtime/JSScope.hpp"
 #include "engine/runtime/JSStore.hpp"
@@ -26,6 +29,7 @@
 #include "error/JSTypeError.hpp"
 #include <cmath>
 #include <codecvt>
+#include <cstdint>
 #include <exception>
 #include <fmt/xchar.h>
 #include <locale>
@@ -92,6 +96,16 @@ std::optional<double> JSValue::getNumber() const {
   return std::nullopt;
 }
 
+std::optional<uint32_t> JSValue::getArrayIndex() const {
+  if (getType() == JSValueType::JS_NUMBER) {
+    auto value = getEntity<JSNumberEntity>()->getValue();
+    if (value >= 0 && value < 4294967295.0 && value == (uint32_t)value) {
+      return (uint32_t)value;
+    }
+  }
+  return std::nullopt;
+}
+
 std::optional<std::wstring> JSValue::getString() const {
   if (getType() == JSValueType::JS_STRING) {
     return getEntity<JSStringEntity>()->getValue();
@@ -189,7 +203,8 @@ JSValue::apply(common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> self,
     store =
         ctx->createException(e.getType(), e.getMessage(), location)->getStore();
   } catch (std::exception &e) {
-    static std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>> converter;
+    static thread_local std::wstring_convert<std::codecvt_utf8_utf16<wchar_t>>
+        converter;
     store = ctx->createException(L"InternalError",
                                  converter.from_bytes(e.what()), location)
                 ->getStore();
@@ -211,7 +226,7 @@ common::AutoPtr<JSValue> JSValue::toPrimitive(common::AutoPtr<JSContext> ctx,
     return this;
   }
   auto toPrimitive =
-      getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"toPrimitive"));
+      getProperty(ctx, ctx->getIntrinsic(JSIntrinsic::SYMBOL_TO_PRIMITIVE));
   if (toPrimitive->getType() == JSValueType::JS_NATIVE_FUNCTION) {
     auto res = toPrimitive->apply(ctx, this, {ctx->createString(L"default")});
     if (res->getType() < JSValueType::JS_OBJECT) {
@@ -251,9 +266,11 @@ common::AutoPtr<JSValue> JSValue::pack(common::AutoPtr<JSContext> ctx) {
   case JSValueType::JS_BOOLEAN:
     break;
   case JSValueType::JS_SYMBOL: {
-    auto val = ctx->createObject(ctx->Symbol()->getProperty(ctx, L"prototype"));
-    val->setProperty(ctx, ctx->internalSymbol(L"value"), this);
-    val->setProperty(ctx, ctx->internalSymbol(L"pack"), ctx->Symbol());
+    auto val =
+        ctx->createObject(ctx->getIntrinsic(JSIntrinsic::SYMBOL_PROTOTYPE));
+    val->setProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_VALUE), this);
+    val->setProperty(ctx, ctx->getIntrinsic(JSIntrinsic::INTERNAL_PACK),
+                     ctx->Symbol());
     return val;
   } break;
   case JSValueType::JS_NULL:
@@ -279,124 +296,14 @@ common::AutoPtr<JSValue> JSValue::toNumber(common::AutoPtr<JSContext> ctx) {
     value = getEntity<JSBooleanEntity>()->getValue() ? 1 : 0;
     break;
   case JSValueType::JS_STRING: {
-    auto raw = getEntity<JSStringEntity>()->getValue();
-    std::wstring snum;
-    size_t index = 0;
-    enum class TYPE { HEX, OCT, BIN, DEC } type = TYPE::DEC;
-    bool negative = false;
-    if (raw[index] == L'+' || raw[index] == L'-') {
-      if (raw[index] == L'-') {
-        negative = true;
-      }
-      index++;
-    }
-    if (raw[index] == '0') {
-      if (raw[index + 1] == L'x' || raw[index + 1] == L'X') {
-        index += 2;
-        while ((raw[index] >= '0' && raw[index] <= '9') ||
-               (raw[index] >= 'a' && raw[index] <= 'f') ||
-               (raw[index] >= 'A' && raw[index] <= 'Z')) {
-          snum += raw[index];
-          index++;
-        }
-        if (snum.empty()) {
-          snum = L'0';
-        } else {
-          snum = L"0x" + snum;
-          type = TYPE::HEX;
-        }
-      } else if (raw[index + 1] == L'o' || raw[index + 1] == L'O') {
-        index += 2;
-        while (raw[index] >= '0' && raw[index] <= '7') {
-          snum += raw[index];
-          index++;
-        }
-        if (snum.empty()) {
-          snum = L'0';
-        } else {
-          snum = L"0o" + snum;
-          type = TYPE::OCT;
-        }
-      } else if (raw[index + 1] == L'b' || raw[index + 1] == L'B') {
-        index += 2;
-        while (raw[index] >= '0' && raw[index] <= '1') {
-          snum += raw[index];
-          index++;
-        }
-        if (snum.empty()) {
-          snum = L'0';
-        } else {
-          snum = L"0b" + snum;
-          type = TYPE::BIN;
-        }
-      }
-    }
-    if (snum.empty()) {
-      if (raw[index] == L'.' && raw[index + 1] >= '0' &&
-          raw[index + 1] <= '9') {
-        snum += L'.';
-        index++;
-        while (raw[index] >= '0' && raw[index] <= '9') {
-          snum += raw[index];
-          index++;
-        }
-      } else if ((raw[index] >= '0' && raw[index] <= '9')) {
-        bool dec = false;
-        for (;;) {
-          if (raw[index] == L'.' && !dec) {
-            dec = true;
-          } else if (raw[index] < '0' || raw[index] > '9') {
-            break;
-          }
-          snum += raw[index];
-          index++;
-        }
-        bool negative = false;
-        if (raw[index] == L'e' || raw[index] == 'E') {
-          std::wstring exp;
-          index++;
-          if (raw[index] == L'+' || raw[index] == L'-') {
-            if (raw[index] == L'-') {
-              negative = true;
-            }
-            index++;
-          }
-          while (raw[index] >= '0' && raw[index] <= '9') {
-            exp += raw[index];
-            index++;
-          }
-          if (!exp.empty()) {
-            snum += L"e";
-            if (negative) {
-              snum += L'-';
-              snum += exp;
-            };
-          }
-        }
-      }
-    }
-    if (!snum.empty() && negative) {
-      snum = L'-' + snum;
-    }
-    if (!snum.empty() && raw[index] == L'\0') {
-      switch (type) {
-      case TYPE::HEX:
-        value = (double)std::stol(snum, nullptr, 16);
-        break;
-      case TYPE::OCT:
-        value = (double)std::stol(snum, nullptr, 8);
-        break;
-      case TYPE::BIN:
-        value = (double)std::stol(snum, nullptr, 2);
-        break;
-      case TYPE::DEC:
-        value = std::stold(snum);
-        break;
-      }
-      return ctx->createNumber(value);
-    } else {
+    value = common::Number::parse(getEntity<JSStringEntity>()->getValue());
+    if (std::isnan(value)) {
       return ctx->NaN();
     }
+    if (std::isinf(value)) {
+      return ctx->createInfinity(value < 0);
+    }
+    return ctx->createNumber(value);
   }
   case JSValueType::JS_BIGINT:
     throw error::JSTypeError(L"Cannot convert a BigInt value to a number");
@@ -470,7 +377,7 @@ common::AutoPtr<JSValue> JSValue::toString(common::AutoPtr<JSContext> ctx) {
     str = L"null";
     break;
   case JSValueType::JS_NUMBER:
-    str = fmt::format(L"{:g}", getEntity<JSNumberEntity>()->getValue());
+    str = common::Number::toString(getEntity<JSNumberEntity>()->getValue());
     break;
   case JSValueType::JS_BIGINT:
     str = getEntity<JSBigIntEntity>()->getValue().toString();
@@ -858,14 +765,20 @@ common::AutoPtr<JSValue> JSValue::getIndex(common::AutoPtr<JSContext> ctx,
     auto &items = entity->getItems();
     if (index < items.size()) {
       auto item = items[index];
+      if (entity->isPacked()) {
+        return ctx->createValue(item);
+      }
       if (!item) {
         return ctx->undefined();
       }
       if (item->getEntity()->getType() == JSValueType::JS_UNINITIALIZED) {
         return ctx->undefined();
       }
-      return ctx->createValue(items[index]);
+      return ctx->createValue(item);
     }
+  } else if (getType() == JSValueType::JS_OBJECT &&
+             hasOpaque<JSTypedArray>()) {
+    return getOpaque<JSTypedArray>().get(ctx, index);
   }
   return ctx->undefined();
 }
@@ -882,20 +795,50 @@ JSValue::setIndex(common::AutoPtr<JSContext> ctx, const uint32_t &index,
           toString(ctx)->getString().value()));
     }
     auto &items = entity->getItems();
-    store->appendChild((JSStore *)field->getStore());
-    if (index < items.size()) {
-      store->removeChild(items[index]);
-      ctx->getScope()->getRoot()->appendChild(items[index]);
+    auto item = (JSStore *)field->getStore();
+    if (index > items.size()) {
+      entity->transition(JSElementsKind::HOLEY);
+      items.resize(index, nullptr);
+    }
+    switch (field->getType()) {
+    case JSValueType::JS_NUMBER: {
+      auto value = field->getNumber().value();
+      if (value >= INT32_MIN && value <= INT32_MAX &&
+          value == (int32_t)value && (value != 0 || !std::signbit(value))) {
+        entity->transition(JSElementsKind::PACKED_SMI);
+      } else {
+        entity->transition(JSElementsKind::PACKED_DOUBLE);
+      }
+      break;
     }
-    while (items.size() < index) {
-      items.resize(index);
+    case JSValueType::JS_NAN:
+    case JSValueType::JS_INFINITY:
+      entity->transition(JSElementsKind::PACKED_DOUBLE);
+      break;
+    case JSValueType::JS_UNINITIALIZED:
+      entity->transition(JSElementsKind::HOLEY);
+      break;
+    default:
+      entity->transition(JSElementsKind::PACKED);
     }
-    if (items.size() == index) {
-      items.push_back((JSStore *)field->getStore());
+    if (index == items.size()) {
+      items.push_back(item);
     } else {
-      items[index] = (JSStore *)field->getStore();
+      auto old = items[index];
+      if (old == item) {
+        return ctx->truly();
+      }
+      if (old != nullptr) {
+        store->removeChild(old);
+        ctx->getScope()->getRoot()->appendChild(old);
+      }
+      items[index] = item;
     }
-    store->appendChild((JSStore *)field->getStore());
+    store->appendChild(item);
+    return ctx->truly();
+  }
+  if (getType() == JSValueType::JS_OBJECT && hasOpaque<JSTypedArray>()) {
+    getOpaque<JSTypedArray>().set(ctx, index, field);
     return ctx->truly();
   }
   return ctx->falsely();
@@ -1140,6 +1083,20 @@ common::AutoPtr<JSValue> JSValue::setPropertyDescriptor(
 common::AutoPtr<JSValue> JSValue::getProperty(common::AutoPtr<JSContext> ctx,
                                               common::AutoPtr<JSValue> name,
                                               common::AutoPtr<JSValue> vself) {
+  if (getType() == JSValueType::JS_ARRAY) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      return getIndex(ctx, index.value());
+    }
+  }
+  if (name->getType() == JSValueType::JS_NUMBER &&
+      getType() == JSValueType::JS_OBJECT && hasOpaque<JSTypedArray>()) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      return getIndex(ctx, index.value());
+    }
+    return ctx->undefined();
+  }
   auto key = name->toPrimitive(ctx);
   if (key->getType() != JSValueType::JS_SYMBOL) {
     if (getType() == JSValueType::JS_ARRAY) {
@@ -1171,8 +1128,26 @@ common::AutoPtr<JSValue> JSValue::getProperty(common::AutoPtr<JSContext> ctx,
 common::AutoPtr<JSValue> JSValue::setProperty(
     common::AutoPtr<JSContext> ctx, common::AutoPtr<JSValue> name,
     const common::AutoPtr<JSValue> &field, common::AutoPtr<JSValue> vself) {
-  auto key = name->toPrimitive(ctx);
   if (getType() == JSValueType::JS_ARRAY) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      if (vself != nullptr) {
+        return vself->setIndex(ctx, index.value(), field);
+      }
+      return setIndex(ctx, index.value(), field);
+    }
+  }
+  if (name->getType() == JSValueType::JS_NUMBER &&
+      getType() == JSValueType::JS_OBJECT && hasOpaque<JSTypedArray>()) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      return setIndex(ctx, index.value(), field);
+    }
+    return ctx->truly();
+  }
+  auto key = name->toPrimitive(ctx);
+  if (getType() == JSValueType::JS_ARRAY &&
+      key->getType() != JSValueType::JS_SYMBOL) {
     auto num = key->toNumber(ctx)->getNumber();
     if (num.has_value()) {
       if (vself != nullptr) {
@@ -1260,15 +1235,18 @@ common::AutoPtr<JSValue>
 JSValue::removeProperty(common::AutoPtr<JSContext> ctx,
                         common::AutoPtr<JSValue> name) {
   auto key = name->toPrimitive(ctx);
-  if (getType() == JSValueType::JS_ARRAY) {
+  if (getType() == JSValueType::JS_ARRAY &&
+      key->getType() != JSValueType::JS_SYMBOL) {
     auto num = key->toNumber(ctx)->getNumber();
     if (num.has_value()) {
-      auto &items = getEntity<JSArrayEntity>()->getItems();
+      auto entity = getEntity<JSArrayEntity>();
+      auto &items = entity->getItems();
       if (num.value() < items.size()) {
         if (items[num.value()] != nullptr) {
           _store->removeChild(items[num.value()]);
         }
         items[num.value()] = nullptr;
+        entity->transition(JSElementsKind::HOLEY);
       }
       return ctx->truly();
     }
@@ -1312,10 +1290,12 @@ JSValue::removeProperty(common::AutoPtr<JSContext> ctx,
 }
 
 common::AutoPtr<JSValue> JSValue::unaryPlus(common::AutoPtr<JSContext> ctx) {
-  if (getType() == JSValueType::JS_INFINITY) {
-    return ctx->createInfinity(getEntity<JSInfinityEntity>()->isNegative());
+  auto number = toNumber(ctx);
+  if (number->getType() == JSValueType::JS_INFINITY) {
+    return ctx->createInfinity(
+        number->getEntity<JSInfinityEntity>()->isNegative());
   }
-  auto value = toNumber(ctx)->getNumber();
+  auto value = number->getNumber();
   if (value.has_value()) {
     return ctx->createNumber(value.value());
   }
@@ -1324,13 +1304,15 @@ common::AutoPtr<JSValue> JSValue::unaryPlus(common::AutoPtr<JSContext> ctx) {
 
 common::AutoPtr<JSValue>
 JSValue::unaryNetation(common::AutoPtr<JSContext> ctx) {
-  if (getType() == JSValueType::JS_INFINITY) {
-    return ctx->createInfinity(!getEntity<JSInfinityEntity>()->isNegative());
-  }
   if (getType() == JSValueType::JS_BIGINT) {
     return ctx->createBigInt(-getEntity<JSBigIntEntity>()->getValue());
   }
-  auto value = toNumber(ctx)->getNumber();
+  auto number = toNumber(ctx);
+  if (number->getType() == JSValueType::JS_INFINITY) {
+    return ctx->createInfinity(
+        !number->getEntity<JSInfinityEntity>()->isNegative());
+  }
+  auto value = number->getNumber();
   if (value.has_value()) {
     return ctx->createNumber(-value.value());
   }
@@ -1343,6 +1325,7 @@ void JSValue::increment(common::AutoPtr<JSContext> ctx) {
   if (getType() == JSValueType::JS_BIGINT) {
     auto &value = getEntity<JSBigIntEntity>()->getValue();
     value += 1;
+    return;
   }
   auto value = toNumber(ctx)->getNumber();
   if (value.has_value()) {
@@ -1358,6 +1341,7 @@ void JSValue::decrement(common::AutoPtr<JSContext> ctx) {
   if (getType() == JSValueType::JS_BIGINT) {
     auto &value = getEntity<JSBigIntEntity>()->getValue();
     value -= 1;
+    return;
   }
   auto value = toNumber(ctx)->getNumber();
   if (value.has_value()) {
@@ -1387,12 +1371,21 @@ common::AutoPtr<JSValue> JSValue::add(common::AutoPtr<JSContext> ctx,
                                       common::AutoPtr<JSValue> another) {
   auto left = toPrimitive(ctx);
   auto right = another->toPrimitive(ctx);
-  if (left->getType() == JSValueType::JS_BIGINT ||
-      right->getType() == JSValueType::JS_BIGINT) {
+  if ((left->getType() == JSValueType::JS_BIGINT ||
+       right->getType() == JSValueType::JS_BIGINT) &&
+      left->getType() != JSValueType::JS_STRING &&
+      right->getType() != JSValueType::JS_STRING) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() +
-                               right->getEntity<JSBigIntEntity>()->getValue());
+      auto &lhs = left->getEntity<JSBigIntEntity>()->getValue();
+      auto &rhs = right->getEntity<JSBigIntEntity>()->getValue();
+      auto a = lhs.toInt64();
+      auto b = rhs.toInt64();
+      int64_t result = 0;
+      if (a && b && !__builtin_add_overflow(a.value(), b.value(), &result)) {
+        return ctx->createBigInt(result);
+      }
+      return ctx->createBigInt(lhs + rhs);
     } else {
       throw error::JSTypeError(
           L"Cannot mix BigInt and other types, use explicit conversions");
@@ -1429,8 +1422,15 @@ common::AutoPtr<JSValue> JSValue::sub(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() -
-                               right->getEntity<JSBigIntEntity>()->getValue());
+      auto &lhs = left->getEntity<JSBigIntEntity>()->getValue();
+      auto &rhs = right->getEntity<JSBigIntEntity>()->getValue();
+      auto a = lhs.toInt64();
+      auto b = rhs.toInt64();
+      int64_t result = 0;
+      if (a && b && !__builtin_sub_overflow(a.value(), b.value(), &result)) {
+        return ctx->createBigInt(result);
+      }
+      return ctx->createBigInt(lhs - rhs);
     } else {
       throw error::JSTypeError(
           L"Cannot mix BigInt and other types, use explicit conversions");
@@ -1466,8 +1466,15 @@ common::AutoPtr<JSValue> JSValue::mul(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() *
-                               right->getEntity<JSBigIntEntity>()->getValue());
+      auto &lhs = left->getEntity<JSBigIntEntity>()->getValue();
+      auto &rhs = right->getEntity<JSBigIntEntity>()->getValue();
+      auto a = lhs.toInt64();
+      auto b = rhs.toInt64();
+      int64_t result = 0;
+      if (a && b && !__builtin_mul_overflow(a.value(), b.value(), &result)) {
+        return ctx->createBigInt(result);
+      }
+      return ctx->createBigInt(lhs * rhs);
     } else {
       throw error::JSTypeError(
           L"Cannot mix BigInt and other types, use explicit conversions");
@@ -1587,8 +1594,8 @@ common::AutoPtr<JSValue> JSValue::pow(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
+      if (right->getEntity<JSBigIntEntity>()->getValue() < 0) {
+        throw error::JSRangeError(L"Exponent must be non-negative");
       }
       return ctx->createBigInt(
           left->getEntity<JSBigIntEntity>()->getValue().pow(
@@ -1644,9 +1651,6 @@ common::AutoPtr<JSValue> JSValue::shl(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBigInt(
           left->getEntity<JSBigIntEntity>()->getValue()
           << right->getEntity<JSBigIntEntity>()->getValue());
@@ -1679,9 +1683,6 @@ common::AutoPtr<JSValue> JSValue::shr(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() >>
                                right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -1744,9 +1745,6 @@ common::AutoPtr<JSValue> JSValue::ge(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBoolean(left->getEntity<JSBigIntEntity>()->getValue() >=
                                 right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -1792,9 +1790,6 @@ common::AutoPtr<JSValue> JSValue::le(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBoolean(left->getEntity<JSBigIntEntity>()->getValue() <=
                                 right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -1841,9 +1836,6 @@ common::AutoPtr<JSValue> JSValue::gt(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBoolean(left->getEntity<JSBigIntEntity>()->getValue() >
                                 right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -1890,9 +1882,6 @@ common::AutoPtr<JSValue> JSValue::lt(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBoolean(left->getEntity<JSBigIntEntity>()->getValue() <
                                 right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -1939,9 +1928,6 @@ common::AutoPtr<JSValue> JSValue::and_(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() &
                                right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -1967,9 +1953,6 @@ common::AutoPtr<JSValue> JSValue::or_(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() |
                                right->getEntity<JSBigIntEntity>()->getValue());
     } else {
@@ -2002,9 +1985,6 @@ common::AutoPtr<JSValue> JSValue::xor_(common::AutoPtr<JSContext> ctx,
       right->getType() == JSValueType::JS_BIGINT) {
     if (left->getType() == JSValueType::JS_BIGINT &&
         right->getType() == JSValueType::JS_BIGINT) {
-      if (right->getEntity<JSBigIntEntity>()->getValue() == 0) {
-        throw error::JSRangeError(L"Division by zero");
-      }
       return ctx->createBigInt(left->getEntity<JSBigIntEntity>()->getValue() ^
                                right->getEntity<JSBigIntEntity>()->getValue());
     } else {
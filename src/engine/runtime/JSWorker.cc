@@ -0,0 +1,112 @@
+#include "engine/runtime/JSWorker.hpp"
+#include "common/AutoPtr.hpp"
+#include "engine/base/JSEvalType.hpp"
+#include "engine/lib/JSWorkerConstructor.hpp"
+#include "engine/runtime/JSContext.hpp"
+#include "engine/runtime/JSStructuredClone.hpp"
+#include "error/JSError.hpp"
+#include <exception>
+#include <string>
+#include <utility>
+using namespace spark;
+using namespace spark::engine;
+
+JSWorker::JSWorker(const std::wstring &filename,
+                   const common::AutoPtr<JSRuntime> &runtime,
+                   const common::AutoPtr<JSMessageQueue> &parent)
+    : _filename(filename), _runtime(runtime), _parent(parent),
+      _closed(false) {
+  static std::atomic<uint32_t> index = PARENT + 1;
+  _port = index++;
+  _inbox = new JSMessageQueue();
+}
+
+JSWorker::~JSWorker() {
+  terminate();
+  join();
+}
+
+void JSWorker::run() {
+  std::wstring reason;
+  {
+    common::AutoPtr ctx = new JSContext(_runtime);
+    try {
+      ctx->setWorker(this);
+      JSWorkerConstructor::initializeWorker(ctx);
+      auto &callback = _runtime->getWorkerCallback();
+      if (callback) {
+        callback(ctx);
+      }
+      auto res = ctx->eval(_filename, JSEvalType::MODULE);
+      while (!res->isException() && !_closed) {
+        if (ctx->isTaskComplete() &&
+            !ctx->load(L"onmessage")->isFunction()) {
+          break;
+        }
+        auto err = ctx->nextTick();
+        if (err != nullptr) {
+          res = err;
+        }
+      }
+      if (res->isException()) {
+        reason = res->toString(ctx)->getString().value();
+      }
+    } catch (error::JSError &e) {
+      reason = fmt::format(L"{}: {}", e.getType(), e.getMessage());
+    } catch (std::exception &e) {
+      std::string message = e.what();
+      reason = std::wstring(message.begin(), message.end());
+    }
+    if (!reason.empty()) {
+      JSCloneRecord record;
+      JSStructuredClone::serialize(ctx, ctx->createString(reason), record);
+      postParent(JSMessageQueue::JSMessageType::EXCEPTION, std::move(record));
+    }
+  }
+  _runtime = nullptr;
+  postParent(JSMessageQueue::JSMessageType::EXIT);
+}
+
+void JSWorker::start() {
+  _thread = std::thread([this]() { run(); });
+}
+
+uint32_t JSWorker::getPort() const { return _port; }
+
+const common::AutoPtr<JSMessageQueue> &JSWorker::getInbox() const {
+  return _inbox;
+}
+
+void JSWorker::postMessage(JSCloneRecord &&record) {
+  if (!_closed) {
+    _inbox->post({
+        .port = PARENT,
+        .type = JSMessageQueue::JSMessageType::MESSAGE,
+        .record = std::move(record),
+    });
+  }
+}
+
+void JSWorker::postParent(JSMessageQueue::JSMessageType type,
+                          JSCloneRecord &&record) {
+  _parent->post({.port = _port, .type = type, .record = std::move(record)});
+}
+
+void JSWorker::close() { _closed = true; }
+
+bool JSWorker::isClosed() const { return _closed; }
+
+void JSWorker::terminate() {
+  _closed = true;
+  _inbox->post({
+      .port = PARENT,
+      .type = JSMessageQueue::JSMessageType::TERMINATE,
+      .record = {},
+  });
+}
+
+void JSWorker::join() {
+  if (_thread.joinable()) {
+    _thread.join();
+  }
+}
@@ -3,13 +3,16 @@
 #include "engine/base/JSValueType.hpp"
 #include "engine/entity/JSEntity.hpp"
 #include "engine/runtime/JSContext.hpp"
+#include "engine/runtime/JSProfiler.hpp"
 #include "engine/runtime/JSRuntime.hpp"
 #include "engine/runtime/JSValue.hpp"
 #include "error/JSError.hpp"
 #include "error/JSTypeError.hpp"
 #include "vm/JSAsmOperator.hpp"
+#include <algorithm>
 #include <chrono>
 #include <cstdint>
+#include <cstdlib>
 #include <exception>
 #include <fmt/chrono.h>
 #include <fmt/xchar.h>
@@ -97,6 +100,11 @@ void write(common::AutoPtr<compiler::JSModule> module) {
     out << L".const_" << index << " \"" << str << "\"" << std::endl;
     index++;
   }
+  index = 0;
+  for (auto &bigint : module->bigints) {
+    out << L".bigint_" << index << " " << bigint.toString() << std::endl;
+    index++;
+  }
   out << L"[section .text]" << std::endl;
   size_t offset = 0;
   auto buffer = module->codes.data();
@@ -301,17 +309,10 @@ void write(common::AutoPtr<compiler::JSModule> module) {
       out << L"jnull " << *(uint32_t *)(buffer + offset);
       offset += sizeof(uint32_t);
       break;
-    case vm::JSAsmOperator::TRY:
-      out << L"try " << *(uint32_t *)(buffer + offset);
-      offset += sizeof(uint32_t);
-      break;
     case vm::JSAsmOperator::DEFER:
       out << L"defer " << *(uint32_t *)(buffer + offset);
       offset += sizeof(uint32_t);
       break;
-    case vm::JSAsmOperator::END_TRY:
-      out << L"endtry";
-      break;
     case vm::JSAsmOperator::ADD:
       out << L"add";
       break;
@@ -451,6 +452,26 @@ void write(common::AutoPtr<compiler::JSModule> module) {
       out << L" " << *(uint32_t *)(buffer + offset);
       offset += sizeof(uint32_t);
       break;
+    case vm::JSAsmOperator::GET_NAMED_FIELD:
+      out << L"get_named_field " << *(uint32_t *)(buffer + offset);
+      offset += sizeof(uint32_t);
+      break;
+    case vm::JSAsmOperator::CALL_DISCARD:
+      out << L"call_discard " << *(uint32_t *)(buffer + offset);
+      offset += sizeof(uint32_t);
+      break;
+    case vm::JSAsmOperator::MEMBER_CALL_DISCARD:
+      out << L"member_call_discard " << *(uint32_t *)(buffer + offset);
+      offset += sizeof(uint32_t);
+      break;
+    case vm::JSAsmOperator::INC_LOCAL:
+      out << L"inc_local " << *(uint32_t *)(buffer + offset);
+      offset += sizeof(uint32_t);
+      break;
+    case vm::JSAsmOperator::DEC_LOCAL:
+      out << L"dec_local " << *(uint32_t *)(buffer + offset);
+      offset += sizeof(uint32_t);
+      break;
     case vm::JSAsmOperator::SET_PRIVATE_FIELD:
       out << L"set_private_field";
       break;
@@ -470,6 +491,11 @@ void write(common::AutoPtr<compiler::JSModule> module) {
     }
     out << std::endl;
   }
+  out << L"[section .handler]" << std::endl;
+  for (auto &handler : module->handlers) {
+    out << L"." << handler.begin << " " << handler.end << " " << handler.handle
+        << " " << handler.defer << " " << handler.depth << std::endl;
+  }
   out << L"[section .map]" << std::endl;
   for (auto &[offset, mapping] : module->sourceMap) {
     out << L"." << offset << " " << mapping.column << "," << mapping.line
@@ -478,19 +504,51 @@ void write(common::AutoPtr<compiler::JSModule> module) {
   out.close();
 }
 
+// index.folded feeds flamegraph.pl, index.cpuprofile opens in DevTools
+void writeProfile(common::AutoPtr<engine::JSProfiler> profiler) {
+  std::wofstream folded("index.folded");
+  folded << profiler->getCollapsedStacks();
+  folded.close();
+  std::wofstream cpuprofile("index.cpuprofile");
+  cpuprofile << profiler->getCpuProfile();
+  cpuprofile.close();
+}
+
+void setup(common::AutoPtr<engine::JSContext> ctx) {
+  ctx->createNativeFunction(print, L"print", L"print");
+  ctx->createNativeFunction(setTimeout, L"setTimeout", L"setTimeout");
+  ctx->createNativeFunction(nextTick, L"nextTick", L"nextTick");
+}
+
 int spark_main(int argc, char *argv[]) {
   common::AutoPtr runtime = new engine::JSRuntime(argc, argv);
+  runtime->setWorkerCallback(setup);
+  bool profile = false;
+  std::chrono::microseconds interval(1000);
+  for (int i = 1; i < argc; i++) {
+    std::string arg = argv[i];
+    if (arg == "--optimize") {
+      runtime->setOptimize(true);
+    } else if (arg == "--prof") {
+      profile = true;
+    } else if (arg.starts_with("--prof-interval=")) {
+      profile = true;
+      interval = std::chrono::microseconds(
+          std::max(std::atoll(arg.c_str() + 16), 1LL));
+    }
+  }
   fmt::print(L"{}\n", runtime->getCurrentPath());
   try {
     common::AutoPtr ctx = new engine::JSContext(runtime);
-    ctx->createNativeFunction(print, L"print", L"print");
-    ctx->createNativeFunction(setTimeout, L"setTimeout", L"setTimeout");
-    ctx->createNativeFunction(nextTick, L"nextTick", L"nextTick");
+    setup(ctx);
     fmt::print(L"{}:start compile\n", std::chrono::system_clock::now());
     auto source = read(L"index.js");
     auto module = ctx->compile(source, L"index.js");
     write(module);
     fmt::print(L"{}:end compile\n", std::chrono::system_clock::now());
+    if (profile) {
+      runtime->startProfiling(interval);
+    }
     auto res = ctx->eval(L"index.js", JSEvalType::MODULE);
     if (!res->isException()) {
       while (!ctx->isTaskComplete()) {
@@ -505,6 +563,9 @@ int spark_main(int argc, char *argv[]) {
       fmt::print(L"Uncaught {}\n", res->toString(ctx)->getString().value());
     }
     fmt::print(L"{}:finish\n", std::chrono::system_clock::now());
+    if (profile) {
+      writeProfile(runtime->stopProfiling());
+    }
   } catch (error::JSError &e) {
     std::cout << e.what();
     fmt::print(L"\n  at {} ({}:{}:{})", e.getLocation().funcname,
@@ -9,8 +9,10 @@
 #include "engine/entity/JSFunctionEntity.hpp"
 #include "engine/entity/JSNativeFunctionEntity.hpp"
 #include "engine/entity/JSObjectEntity.hpp"
+#include "engine/entity/JSStringEntity.hpp"
 #include "engine/entity/JSSymbolEntity.hpp"
-#include "engine/entity/JSTasKEntity.hpp"
+#include "engine/runtime/JSArrayBuffer.hpp"
+#include "engine/runtime/JSCollection.hpp"
 #include "engine/runtime/JSContext.hpp"
 #include "engine/runtime/JSScope.hpp"
 #include "engine/runtime/JSStore.hpp"
@@ -19,18 +21,18 @@
 #include "error/JSSyntaxError.hpp"
 #include "error/JSTypeError.hpp"
 #include "vm/JSAsmOperator.hpp"
-#include "vm/JSErrorFrame.hpp"
 #include "vm/JSEvalContext.hpp"
 #include <_mingw_stat64.h>
 #include <algorithm>
 #include <cstdint>
-#include <filesystem>
 #include <string>
 #include <vector>
 
 using namespace spark;
 using namespace spark::vm;
-JSVirtualMachine::JSVirtualMachine() { _ctx = new JSEvalContext; }
+JSVirtualMachine::JSVirtualMachine() : _profiler(nullptr) {
+  _ctx = new JSEvalContext;
+}
 
 vm::JSAsmOperator
 JSVirtualMachine::next(const common::AutoPtr<compiler::JSModule> &module) {
@@ -114,8 +116,8 @@ JS_OPT(JSVirtualMachine::pushThis) {
 }
 
 JS_OPT(JSVirtualMachine::pushBigint) {
-  auto s = args(module);
-  _ctx->stack.push_back(ctx->createBigInt(s));
+  auto index = argi(module);
+  _ctx->stack.push_back(ctx->createBigInt(module->bigints.at(index)));
 }
 
 JS_OPT(JSVirtualMachine::pushRegex) {
@@ -151,8 +153,8 @@ JS_OPT(JSVirtualMachine::pushClass) {
   auto prototype = ctx->createObject(extends->getProperty(ctx, L"prototype"));
   prototype->setPropertyDescriptor(ctx, L"constructor", func);
   func->setPropertyDescriptor(ctx, L"prototype", prototype);
-  prototype->setPropertyDescriptor(ctx, ctx->internalSymbol(L"identify"),
-                                   identify);
+  prototype->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY), identify);
   _ctx->stack.push_back(func);
 }
 
@@ -196,6 +198,21 @@ JS_OPT(JSVirtualMachine::setField) {
   auto field = *_ctx->stack.rbegin();
   _ctx->stack.pop_back();
   auto obj = *_ctx->stack.rbegin();
+  if (obj->getType() == engine::JSValueType::JS_ARRAY) {
+    auto index = name->getArrayIndex();
+    if (index.has_value() && !field->isFunction()) {
+      obj->setIndex(ctx, index.value(), field);
+      return;
+    }
+  } else if (name->getType() == engine::JSValueType::JS_NUMBER &&
+             obj->getType() == engine::JSValueType::JS_OBJECT &&
+             obj->hasOpaque<engine::JSTypedArray>()) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      obj->getOpaque<engine::JSTypedArray>().set(ctx, index.value(), field);
+      return;
+    }
+  }
   if (field->isFunction() && field->getProperty(ctx, L"name")->isUndefined()) {
     std::wstring fieldname;
     if (name->getType() == engine::JSValueType::JS_SYMBOL) {
@@ -244,7 +261,8 @@ JS_OPT(JSVirtualMachine::setPrivateField) {
   auto obj = *_ctx->stack.rbegin();
   if (obj->isObject()) {
     auto prop = obj->getPrototype(ctx);
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -253,7 +271,8 @@ JS_OPT(JSVirtualMachine::setPrivateField) {
     }
   } else if (obj->isFunction()) {
     auto prop = obj->getProperty(ctx, L"prototype");
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -281,7 +300,8 @@ JS_OPT(JSVirtualMachine::setPrivateMethod) {
   auto obj = *_ctx->stack.rbegin();
   if (obj->isObject()) {
     auto prop = obj;
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -290,7 +310,8 @@ JS_OPT(JSVirtualMachine::setPrivateMethod) {
     }
   } else if (obj->isFunction()) {
     auto prop = obj->getProperty(ctx, L"prototype");
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -317,7 +338,8 @@ JS_OPT(JSVirtualMachine::getPrivateField) {
   _ctx->stack.pop_back();
   if (obj->isObject()) {
     auto prop = obj->getPrototype(ctx);
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -326,7 +348,8 @@ JS_OPT(JSVirtualMachine::getPrivateField) {
     }
   } else if (obj->isFunction()) {
     auto prop = obj->getProperty(ctx, L"prototype");
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -345,6 +368,29 @@ JS_OPT(JSVirtualMachine::getField) {
   _ctx->stack.pop_back();
   auto obj = *_ctx->stack.rbegin();
   _ctx->stack.pop_back();
+  if (obj->getType() == engine::JSValueType::JS_ARRAY) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      _ctx->stack.push_back(obj->getIndex(ctx, index.value()));
+      return;
+    }
+  } else if (name->getType() == engine::JSValueType::JS_NUMBER &&
+             obj->getType() == engine::JSValueType::JS_OBJECT &&
+             obj->hasOpaque<engine::JSTypedArray>()) {
+    auto index = name->getArrayIndex();
+    if (index.has_value()) {
+      _ctx->stack.push_back(
+          obj->getOpaque<engine::JSTypedArray>().get(ctx, index.value()));
+      return;
+    }
+  }
+  _ctx->stack.push_back(obj->getProperty(ctx, name));
+}
+
+JS_OPT(JSVirtualMachine::getNamedField) {
+  auto &name = args(module);
+  auto obj = *_ctx->stack.rbegin();
+  _ctx->stack.pop_back();
   _ctx->stack.push_back(obj->getProperty(ctx, name));
 }
 
@@ -395,7 +441,8 @@ JS_OPT(JSVirtualMachine::setPrivateAccessor) {
   auto obj = *_ctx->stack.rbegin();
   if (obj->isObject()) {
     auto prop = obj;
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -404,7 +451,8 @@ JS_OPT(JSVirtualMachine::setPrivateAccessor) {
     }
   } else if (obj->isFunction()) {
     auto prop = obj->getProperty(ctx, L"prototype");
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -457,8 +505,16 @@ JS_OPT(JSVirtualMachine::merge) {
     }
   } else if (obj->getType() == engine::JSValueType::JS_ARRAY) {
     auto size = obj->getEntity<engine::JSArrayEntity>()->getItems().size();
-    auto iterator =
-        obj1->getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"iterator"));
+    if (isIndexIterable(ctx, obj1)) {
+      auto index = ctx->createNumber(0);
+      for (auto val = nextIndex(ctx, obj1, index); val != nullptr;
+           val = nextIndex(ctx, obj1, index)) {
+        obj->setIndex(ctx, size++, val);
+      }
+      return;
+    }
+    auto iterator = obj1->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR));
     if (!iterator->isFunction()) {
       throw error::JSTypeError(L"array pattern rest require iterator");
     }
@@ -467,6 +523,14 @@ JS_OPT(JSVirtualMachine::merge) {
       throw error::JSTypeError(
           L"Result of the Symbol.iterator method is not an object");
     }
+    if (gen->hasOpaque<engine::JSCollection::Iterator>()) {
+      auto &iterator = gen->getOpaque<engine::JSCollection::Iterator>();
+      for (auto val = iterator.collection->next(ctx, iterator);
+           val != nullptr; val = iterator.collection->next(ctx, iterator)) {
+        obj->setIndex(ctx, size++, val);
+      }
+      return;
+    }
     auto next = gen->getProperty(ctx, L"next");
     if (!next->isFunction()) {
       throw error::JSTypeError(L"array pattern require iterator");
@@ -600,9 +664,7 @@ JS_OPT(JSVirtualMachine::new_) {
 JS_OPT(JSVirtualMachine::yield) {
   auto value = *_ctx->stack.rbegin();
   _ctx->stack.pop_back();
-  _ctx->stack.push_back(ctx->createValue(
-      new engine::JSStore(new engine::JSTaskEntity(value->getStore(), _pc))));
-  _pc = module->codes.size();
+  suspend(module, value, _pc);
 }
 
 JS_OPT(JSVirtualMachine::yieldDelegate) {
@@ -614,8 +676,8 @@ JS_OPT(JSVirtualMachine::yieldDelegate) {
   _ctx->stack.pop_back();
   auto nextpc = _pc;
   if (gen->isUndefined()) {
-    auto iterator =
-        value->getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"iterator"));
+    auto iterator = value->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR));
     if (!iterator->isFunction()) {
       throw error::JSTypeError(L"yield delegate require iterator");
     }
@@ -642,35 +704,165 @@ JS_OPT(JSVirtualMachine::yieldDelegate) {
   auto done = val->getProperty(ctx, L"done");
   auto result = val->getProperty(ctx, L"value");
   if (done->toBoolean(ctx)->getBoolean().value()) {
+    _ctx->stack.push_back(result);
     _pc = nextpc;
   } else {
     _ctx->stack.push_back(value);
     _ctx->stack.push_back(gen);
-    _ctx->stack.push_back(
-        ctx->createValue(new engine::JSStore(new engine::JSTaskEntity(
-            result->getStore(), nextpc - sizeof(uint16_t)))));
-    _pc = module->codes.size();
+    suspend(module, result, nextpc - sizeof(uint16_t));
   }
 }
 
+// Leaves value on top of the stack and stops the frame. The resumer reads
+// the address back from the eval context.
+void JSVirtualMachine::suspend(
+    const common::AutoPtr<compiler::JSModule> &module,
+    common::AutoPtr<engine::JSValue> value, size_t address) {
+  _ctx->stack.push_back(value);
+  _ctx->suspended = true;
+  _ctx->address = address;
+  _pc = module->codes.size();
+}
+
+// Called when the frame leaves through the instruction at address with a
+// return value or an exception on top of the stack. Handlers of a module
+// are stored innermost first, so the first range covering address wins.
+// Returns only stop at a finally block.
+void JSVirtualMachine::unwind(common::AutoPtr<engine::JSContext> ctx,
+                              const common::AutoPtr<compiler::JSModule> &module,
+                              size_t address) {
+  if (_ctx->stack.empty()) {
+    return;
+  }
+  auto result = *_ctx->stack.rbegin();
+  auto exception = result->getType() == engine::JSValueType::JS_EXCEPTION;
+  for (auto &handler : module->handlers) {
+    if (address < handler.begin || address >= handler.end) {
+      continue;
+    }
+    if (!exception && handler.defer == 0) {
+      continue;
+    }
+    auto depth = _ctx->depth + handler.depth;
+    ctx->getScope()->getRootScope()->getRoot()->appendChild(
+        result->getStore());
+    _ctx->stack.pop_back();
+    while (ctx->getScope()->getDepth() > depth) {
+      popScope(ctx, module);
+    }
+    if (exception && handler.handle != 0) {
+      _ctx->stack.push_back(ctx->createError(result));
+      _pc = handler.handle;
+    } else {
+      _ctx->stack.push_back(result);
+      _ctx->deferStack.push_back({_pc, _ctx->stack.size()});
+      _pc = handler.defer;
+    }
+    return;
+  }
+}
+
+bool JSVirtualMachine::isIndexIterable(common::AutoPtr<engine::JSContext> ctx,
+                                       common::AutoPtr<engine::JSValue> value) {
+  if (value->getType() == engine::JSValueType::JS_STRING) {
+    return true;
+  }
+  if (value->getType() != engine::JSValueType::JS_ARRAY &&
+      value->getType() != engine::JSValueType::JS_OBJECT) {
+    return false;
+  }
+  auto iterator = value->getProperty(
+      ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR));
+  return iterator->getStore() ==
+         ctx->getIntrinsic(engine::JSIntrinsic::ARRAY_VALUES)->getStore();
+}
+
+common::AutoPtr<engine::JSValue>
+JSVirtualMachine::nextIndex(common::AutoPtr<engine::JSContext> ctx,
+                            common::AutoPtr<engine::JSValue> value,
+                            common::AutoPtr<engine::JSValue> index) {
+  auto current = index->getNumber().value();
+  if (current < 0) {
+    return nullptr;
+  }
+  auto offset = (uint32_t)current;
+  if (value->getType() == engine::JSValueType::JS_STRING) {
+    auto &str = value->getEntity<engine::JSStringEntity>()->getValue();
+    if (offset < str.size()) {
+      auto size = 1;
+      if (sizeof(wchar_t) == 2 && str[offset] >= 0xd800 &&
+          str[offset] <= 0xdbff && offset + 1 < str.size() &&
+          str[offset + 1] >= 0xdc00 && str[offset + 1] <= 0xdfff) {
+        size = 2;
+      }
+      index->setNumber(offset + size);
+      return ctx->createString(str.substr(offset, size));
+    }
+  } else if (value->getType() == engine::JSValueType::JS_ARRAY) {
+    auto entity = value->getEntity<engine::JSArrayEntity>();
+    if (offset < entity->getItems().size()) {
+      index->setNumber(offset + 1);
+      return value->getIndex(ctx, offset);
+    }
+  } else if (value->hasOpaque<engine::JSTypedArray>()) {
+    auto &array = value->getOpaque<engine::JSTypedArray>();
+    if (offset < array.length) {
+      index->setNumber(offset + 1);
+      return array.get(ctx, offset);
+    }
+  } else {
+    auto length =
+        value->getProperty(ctx, L"length")->toNumber(ctx)->getNumber();
+    if (length.has_value() && offset < length.value()) {
+      index->setNumber(offset + 1);
+      return value->getProperty(ctx, fmt::format(L"{}", offset));
+    }
+  }
+  index->setNumber(-1);
+  return nullptr;
+}
+
 JS_OPT(JSVirtualMachine::next) {
   auto gen = *_ctx->stack.rbegin();
   auto pc = _pc;
   if (gen->isUndefined()) {
     _ctx->stack.pop_back();
     auto value = *_ctx->stack.rbegin();
-    auto iterator =
-        value->getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"iterator"));
-    if (!iterator->isFunction()) {
-      throw error::JSTypeError(L"array pattern require iterator");
-    }
-    gen = iterator->apply(ctx, value);
-    if (gen->getType() != engine::JSValueType::JS_OBJECT) {
-      throw error::JSTypeError(
-          L"Result of the Symbol.iterator method is not an object");
+    if (isIndexIterable(ctx, value)) {
+      gen = ctx->createNumber(0);
+    } else {
+      auto iterator = value->getProperty(
+          ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR));
+      if (!iterator->isFunction()) {
+        throw error::JSTypeError(L"array pattern require iterator");
+      }
+      gen = iterator->apply(ctx, value);
+      if (gen->getType() != engine::JSValueType::JS_OBJECT) {
+        throw error::JSTypeError(
+            L"Result of the Symbol.iterator method is not an object");
+      }
     }
     _ctx->stack.push_back(gen);
   }
+  if (gen->getType() == engine::JSValueType::JS_NUMBER ||
+      gen->hasOpaque<engine::JSCollection::Iterator>()) {
+    common::AutoPtr<engine::JSValue> val;
+    if (gen->getType() == engine::JSValueType::JS_NUMBER) {
+      val = nextIndex(ctx, *(_ctx->stack.rbegin() + 1), gen);
+    } else {
+      auto &iterator = gen->getOpaque<engine::JSCollection::Iterator>();
+      val = iterator.collection->next(ctx, iterator);
+    }
+    if (val != nullptr) {
+      _ctx->stack.push_back(val);
+      _ctx->stack.push_back(ctx->falsely());
+    } else {
+      _ctx->stack.push_back(ctx->undefined());
+      _ctx->stack.push_back(ctx->truly());
+    }
+    _pc = pc;
+    return;
+  }
   auto next = gen->getProperty(ctx, L"next");
   if (!next->isFunction()) {
     throw error::JSTypeError(L"array pattern require iterator");
@@ -695,10 +887,10 @@ JS_OPT(JSVirtualMachine::awaitNext) {
     _ctx->stack.pop_back();
     auto value = *_ctx->stack.rbegin();
     auto iterator = value->getProperty(
-        ctx, ctx->Symbol()->getProperty(ctx, L"asyncIterator"));
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ASYNC_ITERATOR));
     if (!iterator->isFunction()) {
-      iterator =
-          value->getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"iterator"));
+      iterator = value->getProperty(
+          ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR));
 
       if (!iterator->isFunction()) {
         throw error::JSTypeError(L"for await require iterator");
@@ -722,9 +914,7 @@ JS_OPT(JSVirtualMachine::awaitNext) {
                     res->toString(ctx)->getString().value()));
   }
   if (res->instanceof (ctx, ctx->AsyncGenerator())->getBoolean().value()) {
-    _ctx->stack.push_back(ctx->createValue(
-        new engine::JSStore(new engine::JSTaskEntity(res->getStore(), _pc))));
-    _pc = module->codes.size();
+    suspend(module, res, _pc);
   } else {
     _ctx->stack.push_back(res);
     _pc = pc;
@@ -737,18 +927,46 @@ JS_OPT(JSVirtualMachine::restArray) {
   if (gen->isUndefined()) {
     _ctx->stack.pop_back();
     auto value = *_ctx->stack.rbegin();
-    auto iterator =
-        value->getProperty(ctx, ctx->Symbol()->getProperty(ctx, L"iterator"));
-    if (!iterator->isFunction()) {
-      throw error::JSTypeError(L"array pattern require iterator");
-    }
-    gen = iterator->apply(ctx, value);
-    if (gen->getType() != engine::JSValueType::JS_OBJECT) {
-      throw error::JSTypeError(
-          L"Result of the Symbol.iterator method is not an object");
+    if (isIndexIterable(ctx, value)) {
+      gen = ctx->createNumber(0);
+    } else {
+      auto iterator = value->getProperty(
+          ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR));
+      if (!iterator->isFunction()) {
+        throw error::JSTypeError(L"array pattern require iterator");
+      }
+      gen = iterator->apply(ctx, value);
+      if (gen->getType() != engine::JSValueType::JS_OBJECT) {
+        throw error::JSTypeError(
+            L"Result of the Symbol.iterator method is not an object");
+      }
     }
     _ctx->stack.push_back(gen);
   }
+  if (gen->getType() == engine::JSValueType::JS_NUMBER) {
+    auto value = *(_ctx->stack.rbegin() + 1);
+    auto arr = ctx->createArray();
+    uint32_t index = 0;
+    for (auto val = nextIndex(ctx, value, gen); val != nullptr;
+         val = nextIndex(ctx, value, gen)) {
+      arr->setIndex(ctx, index++, val);
+    }
+    _ctx->stack.push_back(arr);
+    _pc = pc;
+    return;
+  }
+  if (gen->hasOpaque<engine::JSCollection::Iterator>()) {
+    auto &iterator = gen->getOpaque<engine::JSCollection::Iterator>();
+    auto arr = ctx->createArray();
+    uint32_t index = 0;
+    for (auto val = iterator.collection->next(ctx, iterator); val != nullptr;
+         val = iterator.collection->next(ctx, iterator)) {
+      arr->setIndex(ctx, index++, val);
+    }
+    _ctx->stack.push_back(arr);
+    _pc = pc;
+    return;
+  }
   auto next = gen->getProperty(ctx, L"next");
   if (!next->isFunction()) {
     throw error::JSTypeError(L"array pattern require iterator");
@@ -803,9 +1021,7 @@ JS_OPT(JSVirtualMachine::restObject) {
 JS_OPT(JSVirtualMachine::await) {
   auto value = *_ctx->stack.rbegin();
   _ctx->stack.pop_back();
-  _ctx->stack.push_back(ctx->createValue(
-      new engine::JSStore(new engine::JSTaskEntity(value->getStore(), _pc))));
-  _pc = module->codes.size();
+  suspend(module, value, _pc);
 }
 
 JS_OPT(JSVirtualMachine::void_) {
@@ -926,6 +1142,22 @@ JS_OPT(JSVirtualMachine::memberCall) {
   }
 }
 
+JS_OPT(JSVirtualMachine::callDiscard) {
+  call(ctx, module);
+  auto res = *_ctx->stack.rbegin();
+  if (res->getType() != engine::JSValueType::JS_EXCEPTION) {
+    _ctx->stack.pop_back();
+  }
+}
+
+JS_OPT(JSVirtualMachine::memberCallDiscard) {
+  memberCall(ctx, module);
+  auto res = *_ctx->stack.rbegin();
+  if (res->getType() != engine::JSValueType::JS_EXCEPTION) {
+    _ctx->stack.pop_back();
+  }
+}
+
 JS_OPT(JSVirtualMachine::memberPrivateCall) {
   auto offset = _pc - sizeof(uint16_t);
   auto size = argi(module);
@@ -943,7 +1175,8 @@ JS_OPT(JSVirtualMachine::memberPrivateCall) {
   _ctx->stack.pop_back();
   if (self->isObject()) {
     auto prop = self->getPrototype(ctx);
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -952,7 +1185,8 @@ JS_OPT(JSVirtualMachine::memberPrivateCall) {
     }
   } else if (self->isFunction()) {
     auto prop = self->getProperty(ctx, L"prototype");
-    auto current = prop->getProperty(ctx, ctx->internalSymbol(L"identify"));
+    auto current = prop->getProperty(
+        ctx, ctx->getIntrinsic(engine::JSIntrinsic::INTERNAL_IDENTIFY));
     if (!current->strictEqual(ctx, identify)
              ->toBoolean(ctx)
              ->getBoolean()
@@ -1244,6 +1478,14 @@ JS_OPT(JSVirtualMachine::dec) {
     _ctx->stack.push_back(ctx->createValue(val));
   }
 }
+JS_OPT(JSVirtualMachine::incLocal) {
+  auto &name = args(module);
+  ctx->load(name)->increment(ctx);
+}
+JS_OPT(JSVirtualMachine::decLocal) {
+  auto &name = args(module);
+  ctx->load(name)->decrement(ctx);
+}
 JS_OPT(JSVirtualMachine::plus) {
   auto val = *_ctx->stack.rbegin();
   _ctx->stack.pop_back();
@@ -1370,29 +1612,19 @@ JS_OPT(JSVirtualMachine:: instanceof) {
   _ctx->stack.push_back(arg1->instanceof (ctx, arg2));
 }
 
-JS_OPT(JSVirtualMachine::tryStart) {
-  auto handle = argi(module);
-  _ctx->errorStacks = new JSErrorFrame(_ctx->errorStacks, ctx->getScope());
-  _ctx->errorStacks->handle = handle;
-}
-
-JS_OPT(JSVirtualMachine::tryEnd) {
-  auto defer = _ctx->errorStacks->defer;
-  _ctx->errorStacks = _ctx->errorStacks->parent;
-  if (defer) {
-    _ctx->deferStack.push_back(_pc);
-    _pc = defer;
-  }
-}
-
 JS_OPT(JSVirtualMachine::defer) {
   auto addr = argi(module);
-  _ctx->errorStacks->defer = addr;
+  _ctx->deferStack.push_back({_pc, _ctx->stack.size()});
+  _pc = addr;
 }
 
+// The completion value of a finally block is dropped, leaving a pending
+// return value or exception on top again.
 JS_OPT(JSVirtualMachine::deferEnd) {
-  _pc = *_ctx->deferStack.rbegin();
+  auto [pc, top] = *_ctx->deferStack.rbegin();
   _ctx->deferStack.pop_back();
+  _ctx->stack.resize(top);
+  _pc = pc;
 }
 
 JS_OPT(JSVirtualMachine::jmp) {
@@ -1445,29 +1677,18 @@ JS_OPT(JSVirtualMachine::import) {
 }
 
 JS_OPT(JSVirtualMachine::importModule) {
-  using namespace std::filesystem;
   auto source = args(module);
   auto mod = ctx->getModule(source);
   if (mod != nullptr) {
     _ctx->stack.push_back(mod);
+    return;
   }
   auto [path, _] = ctx->getCurrentModule();
-  auto next = ctx->getRuntime()->getPathResolver()(path, source);
-  if (exists(next) && !is_directory(next)) {
-    mod = ctx->eval(next, engine::JSEvalType::MODULE);
-  } else if (exists(next + L".js") && !is_directory(next + L".js")) {
-    mod = ctx->eval(next + L".js", engine::JSEvalType::MODULE);
-  } else if (exists(next + L"/index.js") &&
-             !is_directory(next + L"/index.js")) {
-    mod = ctx->eval(next + L"/index.module", engine::JSEvalType::MODULE);
-  } else if (exists(next + L"/index.module") &&
-             !is_directory(next + L"/index.module")) {
-    mod = ctx->eval(next + L"/index.module", engine::JSEvalType::BINARY);
-  } else if (exists(next + L".module") && !is_directory(next + L".module")) {
-    mod = ctx->eval(next + L".module", engine::JSEvalType::BINARY);
-  } else {
+  auto [next, type] = ctx->getRuntime()->resolveModule(path, source);
+  if (next.empty()) {
     throw error::JSError(fmt::format(L"Cannot find module '{}'", source));
   }
+  mod = ctx->eval(next, type);
   mod->setOpaque(source);
   _ctx->stack.push_back(mod);
 }
@@ -1503,42 +1724,28 @@ JS_OPT(JSVirtualMachine::cleanupDirective) {
 void JSVirtualMachine::run(common::AutoPtr<engine::JSContext> ctx,
                            const common::AutoPtr<compiler::JSModule> &module,
                            size_t offset) {
+  // Generator frames are resumed from inside other instructions, so the
+  // caller's pc is kept across the nested run.
+  auto pc = _pc;
   _pc = offset;
+  auto address = offset;
+  if (offset == module->codes.size() && _ctx->address != 0) {
+    // Frames thrown into or returned from at the end unwind from the
+    // instruction they were suspended at.
+    address = _ctx->address - 1;
+  }
   for (;;) {
-    if (_pc == module->codes.size()) {
-      if (_ctx->errorStacks != nullptr) {
-        auto result = *_ctx->stack.rbegin();
-        if (result->getType() == engine::JSValueType::JS_TASK) {
-          break;
-        }
-        auto handle = _ctx->errorStacks->handle;
-        auto defer = _ctx->errorStacks->defer;
-        auto scope = _ctx->errorStacks->scope;
-        _ctx->errorStacks = _ctx->errorStacks->parent;
-        scope->getRootScope()->getRoot()->appendChild(result->getStore());
-        _ctx->stack.pop_back();
-        while (ctx->getScope() != scope) {
-          popScope(ctx, module);
-        }
-        _ctx->stack.push_back(result);
-        if (result->getType() == engine::JSValueType::JS_EXCEPTION) {
-          if (handle != 0) {
-            _ctx->stack.pop_back();
-            auto entity = result->getEntity<engine::JSExceptionEntity>();
-            _ctx->stack.push_back(ctx->createError(result));
-            _pc = handle;
-          }
-        }
-        if (defer != 0) {
-          _ctx->deferStack.push_back(_pc);
-          _pc = defer;
-        }
-      }
+    if (_pc == module->codes.size() && !_ctx->suspended) {
+      unwind(ctx, module, address);
     }
     if (_pc == module->codes.size()) {
       break;
     }
+    if (_profiler != nullptr && _profiler->isPending()) {
+      _profiler->sample(ctx, module, _pc);
+    }
     try {
+      address = _pc;
       auto code = next(module);
       switch (code) {
       case vm::JSAsmOperator::PUSH_NULL:
@@ -1829,18 +2036,12 @@ void JSVirtualMachine::run(common::AutoPtr<engine::JSContext> ctx,
       case vm::JSAsmOperator::JNULL:
         jnull(ctx, module);
         break;
-      case vm::JSAsmOperator::TRY:
-        tryStart(ctx, module);
-        break;
       case vm::JSAsmOperator::DEFER:
         defer(ctx, module);
         break;
       case vm::JSAsmOperator::END_DEFER:
         deferEnd(ctx, module);
         break;
-      case vm::JSAsmOperator::END_TRY:
-        tryEnd(ctx, module);
-        break;
       case vm::JSAsmOperator::NEW:
         new_(ctx, module);
         break;
@@ -1862,14 +2063,28 @@ void JSVirtualMachine::run(common::AutoPtr<engine::JSContext> ctx,
       case vm::JSAsmOperator::SET_IMPORT_ATTRIBUTE:
         setImportAttribute(ctx, module);
         break;
+      case vm::JSAsmOperator::GET_NAMED_FIELD:
+        getNamedField(ctx, module);
+        break;
+      case vm::JSAsmOperator::CALL_DISCARD:
+        callDiscard(ctx, module);
+        break;
+      case vm::JSAsmOperator::MEMBER_CALL_DISCARD:
+        memberCallDiscard(ctx, module);
+        break;
+      case vm::JSAsmOperator::INC_LOCAL:
+        incLocal(ctx, module);
+        break;
+      case vm::JSAsmOperator::DEC_LOCAL:
+        decLocal(ctx, module);
+        break;
       }
     } catch (error::JSError &e) {
-      auto exp =
-          ctx->createException(e.getType(), e.getMessage(), e.getLocation());
-      _ctx->stack.push_back(exp);
+      _ctx->stack.push_back(ctx->createException(e));
       _pc = module->codes.size();
     }
   }
+  _pc = pc;
 }
 
 common::AutoPtr<engine::JSValue>
@@ -1878,7 +2093,10 @@ JSVirtualMachine::eval(common::AutoPtr<engine::JSContext> ctx,
                        size_t offset) {
   auto scope = ctx->getScope();
   auto pc = _pc;
+  auto depth = _ctx->depth;
+  _ctx->depth = scope->getDepth();
   run(ctx, module, offset);
+  _ctx->depth = depth;
   _pc = pc;
   auto value = ctx->undefined();
   if (!_ctx->stack.empty()) {
@@ -1926,11 +2144,9 @@ JSVirtualMachine::apply(common::AutoPtr<engine::JSContext> ctx,
   arguments->setPropertyDescriptor(ctx, L"length",
                                    ctx->createNumber(args.size()));
 
-  arguments->setPropertyDescriptor(ctx,
-                                   ctx->Symbol()->getProperty(ctx, L"iterator"),
-                                   ctx->Array()
-                                       ->getProperty(ctx, L"prototype")
-                                       ->getProperty(ctx, L"values"));
+  arguments->setPropertyDescriptor(
+      ctx, ctx->getIntrinsic(engine::JSIntrinsic::SYMBOL_ITERATOR),
+      ctx->getIntrinsic(engine::JSIntrinsic::ARRAY_VALUES));
   auto bind = func->getBind(ctx);
   if (bind == nullptr) {
     bind = self;
@@ -1968,4 +2184,8 @@ common::AutoPtr<JSEvalContext> JSVirtualMachine::getContext() { return _ctx; }
 
 void JSVirtualMachine::setContext(common::AutoPtr<JSEvalContext> ctx) {
   _ctx = ctx;
+}
+
+void JSVirtualMachine::setProfiler(engine::JSProfiler *profiler) {
+  _profiler = profiler;
 }
\ No newline at end of file